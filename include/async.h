@@ -0,0 +1,189 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/async.h
+ *
+ * @brief Non-blocking operations for event-driven callers
+ *
+ * An asynchronous op returns immediately with a handle while its body runs on
+ * the pool of the given context. Completion is signalled by an optional
+ * callback and, for callers driven by epoll or poll, by incrementing an
+ * eventfd, so a reactor thread never blocks on thread_pool_wait().
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_ASYNC_H
+#define LINEAR_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Define the state of an asynchronous op
+ *
+ * @param ASYNC_PENDING   The op has not completed
+ * @param ASYNC_SUCCEEDED The op completed and its result is available
+ * @param ASYNC_FAILED    The op completed without a result
+ */
+typedef enum LinearAsyncStatus {
+    ASYNC_PENDING,   // The op has not completed
+    ASYNC_SUCCEEDED, // The op completed and its result is available
+    ASYNC_FAILED,    // The op completed without a result
+} linear_async_status_t;
+
+typedef struct LinearAsync linear_async_t;
+
+/**
+ * @brief Body of an asynchronous op executed on a pool worker
+ *
+ * Reads op->arguments and stores its outcome in op->result or op->value.
+ *
+ * @return true on success, false otherwise
+ */
+typedef bool (*linear_async_routine_t)(linear_async_t* op);
+
+/**
+ * @brief Invoked on the executing thread once an op completes
+ *
+ * @note The callback must not free the op, see linear_async_free().
+ */
+typedef void (*linear_async_callback_t)(linear_async_t* op, void* user);
+
+/**
+ * @brief Completion notification of an asynchronous op
+ *
+ * @param callback Invoked once the op completes, or NULL
+ * @param user     Opaque pointer forwarded to the callback
+ * @param event_fd An eventfd incremented once the op completes, or -1
+ *
+ * @note A single eventfd may be shared by many ops, e.g. one per reactor.
+ */
+typedef struct LinearAsyncOptions {
+    linear_async_callback_t callback; // Invoked upon completion
+    void*                   user;     // Forwarded to the callback
+    int                     event_fd; // Incremented upon completion, or -1
+} linear_async_options_t;
+
+/**
+ * @brief Handle of an asynchronous op
+ *
+ * @param context   The context the op executes on
+ * @param routine   The body of the op
+ * @param arguments A copy of the arguments owned by the op
+ * @param result    Pointer result of the op, e.g. a new matrix
+ * @param value     Scalar result of the op, e.g. a reduction
+ * @param options   Completion notification
+ * @param status    The state of the op
+ * @param finished  Flag set once the executing thread released the op
+ * @param mutex     Mutex guarding finished
+ * @param released  Condition variable signalling finished
+ */
+struct LinearAsync {
+    linear_context_t*      context;   // The executing context
+    linear_async_routine_t routine;   // Body of the op
+    void*                  arguments; // Copy of the arguments
+    void*                  result;    // Pointer result, if any
+    float                  value;     // Scalar result, if any
+    linear_async_options_t options;   // Completion notification
+    atomic_int             status;    // linear_async_status_t of the op
+    bool                   finished;  // Executing thread released the op
+    pthread_mutex_t        mutex;     // Guards finished
+    pthread_cond_t         released;  // Signals finished
+};
+
+/**
+ * @brief Options without a callback or eventfd, for ops that are polled
+ */
+linear_async_options_t linear_async_options_default(void);
+
+/**
+ * @brief Start an asynchronous op on the pool of a context
+ *
+ * The arguments are copied, so they may live on the caller's stack. Operands
+ * they point to must remain valid until the op completes.
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param routine   The body of the op
+ * @param arguments The arguments of the op, or NULL
+ * @param size      The size of the arguments in bytes
+ * @param options   Completion notification, or NULL for none
+ *
+ * @return A handle to be freed with linear_async_free(), or NULL upon failure
+ *
+ * @note A context without a pool executes the op on the calling thread, so it
+ *       has completed, and notified, by the time this returns.
+ * @note Submitting blocks while the priority queue of the pool is full.
+ */
+linear_async_t* linear_async_submit(
+    linear_context_t*             context,
+    linear_async_routine_t        routine,
+    const void*                   arguments,
+    size_t                        size,
+    const linear_async_options_t* options
+);
+
+/**
+ * @brief The state of an op, without blocking
+ */
+linear_async_status_t linear_async_status(linear_async_t* op);
+
+/**
+ * @brief Block until an op completes
+ *
+ * @return true if the op succeeded, false otherwise
+ *
+ * @note Must not be called from a worker of the op's pool.
+ */
+bool linear_async_wait(linear_async_t* op);
+
+/**
+ * @brief Pointer result of a completed op, or NULL
+ *
+ * Ownership of the result passes to the caller, e.g. a matrix created by
+ * matrix_product_async() must be freed with matrix_free_ctx().
+ */
+void* linear_async_result(linear_async_t* op);
+
+/**
+ * @brief Scalar result of a completed op, or NAN
+ */
+float linear_async_value(linear_async_t* op);
+
+/**
+ * @brief Free an op, waiting for it to complete if necessary
+ *
+ * @note Unclaimed pointer results are not freed.
+ */
+void linear_async_free(linear_async_t* op);
+
+// Event notification
+
+/**
+ * @brief Create a non-blocking eventfd to be registered with epoll
+ *
+ * @return The file descriptor, or -1 upon failure
+ */
+int linear_async_eventfd(void);
+
+/**
+ * @brief Consume pending notifications of an eventfd
+ *
+ * @return The number of ops completed since the last call, 0 if none
+ */
+uint64_t linear_async_eventfd_drain(int event_fd);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_ASYNC_H
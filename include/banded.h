@@ -0,0 +1,232 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/banded.h
+ *
+ * @brief Banded and batched tridiagonal matrices
+ *
+ * A banded matrix with lower subdiagonals and upper superdiagonals stores
+ * only the lower + upper + 1 diagonals around the main one. Rows of the band
+ * are stored back to back in row-major order, row i holding the elements
+ * (i, i - lower) through (i, i + upper) at offsets i * width through
+ * i * width + width - 1, width being lower + upper + 1. Band positions
+ * falling outside the matrix are padding and hold zero.
+ *
+ * A tridiagonal batch holds many independent systems of the same order in
+ * an interleaved layout: element i of system s is stored at i * batch + s,
+ * so every step of a solve is a contiguous, vectorizable sweep over the
+ * batch. Right-hand sides and solutions use the same layout as an
+ * order x batch matrix_t, each column holding one system.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_BANDED_H
+#define LINEAR_BANDED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A matrix storing the diagonals of a band.
+ *
+ * @param data    The rows x (lower + upper + 1) band elements, see above.
+ * @param rows    The number of rows of the matrix.
+ * @param columns The number of columns of the matrix.
+ * @param lower   The number of subdiagonals stored.
+ * @param upper   The number of superdiagonals stored.
+ */
+typedef struct Banded {
+    float*   data;    ///< Rows of the band, back to back.
+    uint32_t rows;    ///< Number of rows.
+    uint32_t columns; ///< Number of columns.
+    uint32_t lower;   ///< Number of subdiagonals.
+    uint32_t upper;   ///< Number of superdiagonals.
+} banded_t;
+
+/**
+ * @brief A batch of independent tridiagonal systems of the same order.
+ *
+ * Each array holds order x batch elements, element i of system s at
+ * i * batch + s.
+ *
+ * @param lower    Subdiagonals, (i, i - 1) of each system; row 0 is unused.
+ * @param diagonal Diagonals, (i, i) of each system.
+ * @param upper    Superdiagonals, (i, i + 1); row order - 1 is unused.
+ * @param order    The number of unknowns of each system.
+ * @param batch    The number of systems.
+ */
+typedef struct Tridiagonal {
+    float*   lower;    ///< Subdiagonals of the batch.
+    float*   diagonal; ///< Diagonals of the batch.
+    float*   upper;    ///< Superdiagonals of the batch.
+    uint32_t order;    ///< Number of unknowns per system.
+    uint32_t batch;    ///< Number of systems.
+} tridiagonal_t;
+
+// Lifecycle management
+
+/**
+ * @brief Create a zero initialized banded matrix using the given context
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param rows    The number of rows of the matrix.
+ * @param columns The number of columns of the matrix.
+ * @param lower   The number of subdiagonals.
+ * @param upper   The number of superdiagonals.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note Banded matrices must be freed with banded_free_ctx().
+ */
+banded_t* banded_create_ctx(
+    linear_context_t* context,
+    uint32_t          rows,
+    uint32_t          columns,
+    uint32_t          lower,
+    uint32_t          upper
+);
+void banded_free_ctx(linear_context_t* context, banded_t* banded);
+
+/**
+ * @brief Create a zero initialized batch of tridiagonal systems
+ *
+ * @note Batches must be freed with tridiagonal_free_ctx().
+ */
+tridiagonal_t* tridiagonal_create_ctx(
+    linear_context_t* context, uint32_t order, uint32_t batch
+);
+void tridiagonal_free_ctx(linear_context_t* context, tridiagonal_t* batch);
+
+// Element Access
+
+// Number of stored elements, padding included, rows * (lower + upper + 1)
+size_t banded_element_count(const banded_t* banded);
+
+/**
+ * @brief Access an element by its row and column in the full matrix.
+ *
+ * Getting an element outside the band returns zero, setting one fails.
+ */
+float banded_element_get(
+    const banded_t* banded, uint32_t row, uint32_t column
+);
+bool banded_element_set(
+    banded_t* banded, uint32_t row, uint32_t column, float value
+);
+
+// Conversion
+
+/**
+ * @brief Store the band of a dense matrix, ignoring elements outside it.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  The dense matrix.
+ * @param lower   The number of subdiagonals to keep.
+ * @param upper   The number of superdiagonals to keep.
+ *
+ * @return A new banded matrix, or NULL upon failure
+ */
+banded_t* banded_from_matrix_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          lower,
+    uint32_t          upper
+);
+
+/**
+ * @brief Expand into a new dense matrix, zero outside the band.
+ *
+ * @return A new matrix, freed with matrix_free_ctx(), or NULL upon failure
+ */
+matrix_t*
+banded_to_matrix_ctx(linear_context_t* context, const banded_t* banded);
+
+// Products
+
+/**
+ * @brief Banded matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * Rows are split across the pool, each costing a dot product over the band.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and x.
+ * @param a       A banded matrix of size m x n.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param beta    Scales y before accumulating, 0 overwrites y.
+ * @param y       A NUMERIC_FLOAT32 vector with m elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool banded_gbmv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const banded_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+// Solvers
+
+/**
+ * @brief Solve a * x = b for a square banded a.
+ *
+ * Factors a copy of a as p * l * u with partial pivoting restricted to the
+ * band, as LAPACK's GBTRF does, so u widens to lower + upper superdiagonals.
+ * The factorization costs about n * lower * (lower + upper) multiply-adds and
+ * runs on the calling thread, while the substitutions split the right-hand
+ * sides across the pool.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       A square banded matrix of order n.
+ * @param b       The n x r right-hand sides.
+ * @param x       Receives the n x r solutions, may be b itself.
+ *
+ * @return true on success, false if a is singular or upon failure
+ */
+bool banded_solve_ctx(
+    linear_context_t* context,
+    const banded_t*   a,
+    const matrix_t*   b,
+    matrix_t*         x
+);
+
+/**
+ * @brief Solve every system of a tridiagonal batch by the Thomas algorithm.
+ *
+ * Systems are split across the pool, and each task sweeps its systems
+ * together, one row at a time, so the inner loops run over contiguous
+ * elements of the interleaved layout. The Thomas algorithm does not pivot
+ * and is stable for diagonally dominant or symmetric positive definite
+ * systems, the usual case for splines and implicit PDE steps.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       The batch of tridiagonal systems.
+ * @param b       The order x batch right-hand sides, one system per column.
+ * @param x       Receives the order x batch solutions, may be b itself.
+ *
+ * @return true on success, false if a pivot of any system vanished or was
+ *         not finite, or upon failure
+ */
+bool tridiagonal_solve_ctx(
+    linear_context_t*    context,
+    const tridiagonal_t* a,
+    const matrix_t*      b,
+    matrix_t*            x
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_BANDED_H
@@ -0,0 +1,180 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/bsr.h
+ *
+ * @brief Block-sparse row (BSR) matrices
+ *
+ * A BSR matrix tiles a dense matrix with square blocks of a fixed size and
+ * stores only the nonzero blocks, in the layout CSR uses for elements:
+ *
+ * - values holds the blocks of block row 0, then block row 1, and so on,
+ *   each block as size x size row-major elements.
+ * - indices holds the block column of each stored block, ascending within
+ *   a block row.
+ * - offsets holds, for each block row, the index of its first stored block,
+ *   followed by the number of stored blocks.
+ *
+ * Products visit each stored block as a small dense matrix whose size is a
+ * compile-time constant, so the kernels unroll and vectorize like a dense
+ * GEMM does, where CSR would gather one element at a time.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_BSR_H
+#define LINEAR_BSR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A matrix storing its nonzero square blocks.
+ *
+ * @param values  The blocks * size * size stored elements, see above.
+ * @param indices The block column of each stored block.
+ * @param offsets The rows / size + 1 offsets of each block row into indices.
+ * @param rows    The number of rows, a multiple of size.
+ * @param columns The number of columns, a multiple of size.
+ * @param size    The number of rows, and columns, of a block: 4, 8 or 16.
+ * @param blocks  The number of stored blocks.
+ */
+typedef struct Bsr {
+    float*    values;  ///< Stored blocks, row-major within each block.
+    uint32_t* indices; ///< Block column of each stored block.
+    uint32_t* offsets; ///< First stored block of each block row.
+    uint32_t  rows;    ///< Number of rows.
+    uint32_t  columns; ///< Number of columns.
+    uint32_t  size;    ///< Rows and columns of a block.
+    uint32_t  blocks;  ///< Number of stored blocks.
+} bsr_t;
+
+/**
+ * @brief Columns of b and c a block row of a BSR GEMM visits per pass
+ *
+ * @note A 16 x 16 block reads and writes 16 x 64 tiles, 4 KiB each.
+ */
+#ifndef LINEAR_BSR_TILE
+    #define LINEAR_BSR_TILE 64
+#endif // LINEAR_BSR_TILE
+
+// Lifecycle management
+
+/**
+ * @brief Create a BSR matrix with room for the given number of blocks
+ *
+ * The offsets are zero initialized, so the matrix starts with no stored
+ * blocks; callers filling it directly must set offsets, indices and values.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param rows    The number of rows, a multiple of size.
+ * @param columns The number of columns, a multiple of size.
+ * @param size    The block size, 4, 8 or 16.
+ * @param blocks  The number of blocks to allocate.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note BSR matrices must be freed with bsr_free_ctx().
+ */
+bsr_t* bsr_create_ctx(
+    linear_context_t* context,
+    uint32_t          rows,
+    uint32_t          columns,
+    uint32_t          size,
+    uint32_t          blocks
+);
+void bsr_free_ctx(linear_context_t* context, bsr_t* bsr);
+
+// Fraction of the blocks of the matrix that are stored, in [0, 1]
+float bsr_density(const bsr_t* bsr);
+
+// Conversion
+
+/**
+ * @brief Store the blocks of a dense matrix whose magnitude exceeds threshold
+ *
+ * The magnitude of a block is its Frobenius norm, so pruning a whole block
+ * of small weights keeps the blocks carrying most of the energy. A threshold
+ * of zero stores every block holding a nonzero. Blocks holding NaN are
+ * always stored, so invalid inputs are not silently dropped.
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param matrix    The dense matrix, whose dimensions are multiples of size.
+ * @param size      The block size, 4, 8 or 16.
+ * @param threshold The largest magnitude of a dropped block.
+ *
+ * @return A new BSR matrix, or NULL upon failure
+ */
+bsr_t* bsr_from_matrix_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          size,
+    float             threshold
+);
+
+/**
+ * @brief Expand into a new dense matrix, zero outside the stored blocks.
+ *
+ * @return A new matrix, freed with matrix_free_ctx(), or NULL upon failure
+ */
+matrix_t* bsr_to_matrix_ctx(linear_context_t* context, const bsr_t* bsr);
+
+// Products
+
+/**
+ * @brief Block-sparse matrix multiply, c = alpha * a * b + beta * c.
+ *
+ * Block rows are split across the pool. Each stored block multiplies the
+ * matching rows of b into the rows of c as a dense size x size GEMM, tiled
+ * over the columns of b so both tiles stay in the L1 cache.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and b.
+ * @param a       A BSR matrix of size m x k.
+ * @param b       A dense k x n matrix.
+ * @param beta    Scales c before accumulating, 0 overwrites c.
+ * @param c       A dense m x n matrix, distinct from b.
+ *
+ * @return true on success, false otherwise
+ */
+bool bsr_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const bsr_t*      a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+);
+
+/**
+ * @brief Block-sparse matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * @param a A BSR matrix of size m x k.
+ * @param x A NUMERIC_FLOAT32 vector with k elements.
+ * @param y A NUMERIC_FLOAT32 vector with m elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool bsr_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const bsr_t*      a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_BSR_H
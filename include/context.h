@@ -0,0 +1,480 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/context.h
+ *
+ * @brief An explicit execution context for the Linear API
+ *
+ * A context carries the state that is otherwise global and fixed at compile
+ * time: the thread pool, the memory allocator, the backend device, the
+ * numeric precision, and the tuning profile. Operations suffixed with `_ctx`
+ * accept a context so independent tenants within one process can isolate
+ * their compute resources and select their own performance policies.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_CONTEXT_H
+#define LINEAR_CONTEXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "numeric_types.h"
+#include "thread.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Memory allocator used for operand and result storage
+ *
+ * @param allocate Allocates size bytes, returning NULL upon failure
+ * @param release  Releases memory previously returned by allocate
+ * @param user     Opaque pointer forwarded to both callbacks
+ */
+typedef struct LinearAllocator {
+    void* (*allocate)(size_t size, void* user); // Allocate a block
+    void (*release)(void* pointer, void* user); // Release a block
+    void* user; // User data forwarded to callbacks
+} linear_allocator_t;
+
+/**
+ * @brief Define the performance policy of a context
+ *
+ * @param TUNING_BALANCED   Moderate grain sizes, one task per worker
+ * @param TUNING_LATENCY    Large grain sizes, small inputs stay serial
+ * @param TUNING_THROUGHPUT Small grain sizes, several tasks per worker
+ * @param TUNING_COUNT      Number of tuning profiles
+ */
+typedef enum LinearTuning {
+    TUNING_BALANCED,   // Moderate grain sizes, one task per worker
+    TUNING_LATENCY,    // Large grain sizes, small inputs stay serial
+    TUNING_THROUGHPUT, // Small grain sizes, several tasks per worker
+    TUNING_COUNT,      // Number of tuning profiles
+} linear_tuning_t;
+
+/**
+ * @brief Define how a range is distributed over the tasks of an op
+ *
+ * @param SCHEDULE_STATIC  Equal contiguous chunks, one per task; the lowest
+ *                         overhead on processors with a single core type
+ * @param SCHEDULE_DYNAMIC Tasks repeatedly claim small fixed-size chunks
+ * @param SCHEDULE_GUIDED  Tasks repeatedly claim chunks proportional to the
+ *                         remaining work, shrinking towards the end, so faster
+ *                         cores take on more of the range
+ * @param SCHEDULE_COUNT   Number of schedules
+ */
+typedef enum LinearSchedule {
+    SCHEDULE_STATIC,  // Equal chunks, one per task
+    SCHEDULE_DYNAMIC, // Small fixed-size chunks claimed on demand
+    SCHEDULE_GUIDED,  // Shrinking chunks claimed on demand
+    SCHEDULE_COUNT,   // Number of schedules
+} linear_schedule_t;
+
+/**
+ * @brief Define how operands entering the library are validated
+ *
+ * Kernels never check elements for NaN or infinity themselves. Instead data is
+ * validated once where it enters, e.g. with vector_ingest_ctx() or
+ * matrix_ingest_ctx(), according to the policy of the context.
+ *
+ * @param VALIDATION_NONE     Operands are trusted, ingest is free
+ * @param VALIDATION_REJECT   Ingest fails if any element is NaN or infinite
+ * @param VALIDATION_SANITIZE Ingest replaces NaN with 0 and infinities with
+ *                            the largest finite values of the same sign
+ * @param VALIDATION_COUNT    Number of policies
+ */
+typedef enum LinearValidation {
+    VALIDATION_NONE,     // Operands are trusted
+    VALIDATION_REJECT,   // Non-finite operands fail to ingest
+    VALIDATION_SANITIZE, // Non-finite elements are replaced on ingest
+    VALIDATION_COUNT,    // Number of policies
+} linear_validation_t;
+
+/**
+ * @brief Number of chunks per task under SCHEDULE_DYNAMIC
+ *
+ * @note SCHEDULE_GUIDED never claims chunks smaller than a quarter of this.
+ */
+#ifndef LINEAR_SCHEDULE_CHUNKS
+    #define LINEAR_SCHEDULE_CHUNKS 8
+#endif // LINEAR_SCHEDULE_CHUNKS
+
+/**
+ * @brief Tunable parameters derived from a tuning profile
+ *
+ * @param mode             The profile these parameters were derived from
+ * @param grain_size       Minimum number of elements assigned to a task
+ * @param tasks_per_thread Number of tasks submitted per worker thread
+ */
+typedef struct LinearTuningProfile {
+    linear_tuning_t mode;             // The originating profile
+    uint32_t        grain_size;       // Minimum elements per task
+    uint32_t        tasks_per_thread; // Tasks submitted per worker
+} linear_tuning_profile_t;
+
+/**
+ * @brief Execution context for the Linear API
+ *
+ * @param pool       Thread pool, or NULL to execute on the calling thread
+ * @param allocator  Allocator used for operand and result storage
+ * @param backend    Physical device used for execution
+ * @param precision  Element type of operands created by the context
+ * @param tuning     Performance policy of the context
+ * @param priority   Priority class of tasks submitted by the context
+ * @param schedule   Distribution of ranges over tasks
+ * @param validation Validation of operands upon ingest
+ * @param owns_pool  Flag set if the pool is freed alongside the context
+ */
+typedef struct LinearContext {
+    thread_pool_t*          pool;       // Thread pool, NULL if serial
+    linear_allocator_t      allocator;  // Operand and result storage
+    thread_backend_t        backend;    // Physical execution device
+    numeric_data_t          precision;  // Element type of created operands
+    linear_tuning_profile_t tuning;     // Performance policy
+    thread_priority_t       priority;   // Priority class of submitted tasks
+    linear_schedule_t       schedule;   // Distribution of ranges over tasks
+    linear_validation_t     validation; // Validation of operands upon ingest
+    bool                    owns_pool;  // Free the pool with the context
+} linear_context_t;
+
+// Context lifecycle management
+
+/**
+ * @brief Create a new execution context with its own thread pool
+ *
+ * @param num_threads The number of workers; 0 selects LINEAR_THREAD_COUNT and
+ *                    1 executes on the calling thread without a pool
+ *
+ * @return A pointer to the new context, or NULL upon failure
+ */
+linear_context_t* linear_context_create(uint32_t num_threads);
+
+/**
+ * @brief Create a new execution context whose pool spawns upon first use
+ *
+ * Intended for processes that initialize in a parent and fork workers, see
+ * thread_pool_create_deferred().
+ *
+ * @param num_threads The number of workers; 0 selects LINEAR_THREAD_COUNT and
+ *                    1 executes on the calling thread without a pool
+ *
+ * @return A pointer to the new context, or NULL upon failure
+ */
+linear_context_t* linear_context_create_deferred(uint32_t num_threads);
+
+/**
+ * @brief Free a context along with its pool if the context owns it
+ *
+ * @param context The context to free
+ */
+void linear_context_free(linear_context_t* context);
+
+/**
+ * @brief The process-wide context used when NULL is given to a `_ctx` op
+ *
+ * Lazily created on first use. It owns a deferred pool of LINEAR_THREAD_COUNT
+ * workers if LINEAR_THREAD is defined and executes serially otherwise.
+ *
+ * @return A pointer to the default context
+ *
+ * @note The default context lives for the remainder of the process.
+ */
+linear_context_t* linear_context_default(void);
+
+/**
+ * @brief Resolve a context argument, substituting the default for NULL
+ */
+linear_context_t* linear_context_resolve(linear_context_t* context);
+
+// Context configuration
+
+/**
+ * @brief Share an externally owned thread pool with the context
+ *
+ * A pool owned by the context is freed before the new one is attached.
+ *
+ * @param context The context to configure
+ * @param pool    The pool to borrow, or NULL to execute serially
+ */
+void linear_context_set_pool(linear_context_t* context, thread_pool_t* pool);
+
+/**
+ * @brief Replace the allocator used by the context
+ *
+ * @note Objects must be freed by the same context that created them.
+ */
+void linear_context_set_allocator(
+    linear_context_t* context, linear_allocator_t allocator
+);
+
+/**
+ * @brief Select the backend device of the context
+ *
+ * @return true if the backend is available, false otherwise
+ */
+bool linear_context_set_backend(
+    linear_context_t* context, thread_backend_t backend
+);
+
+/**
+ * @brief Select the element type of operands created by the context
+ *
+ * @return true if the precision is supported, false otherwise
+ */
+bool linear_context_set_precision(
+    linear_context_t* context, numeric_data_t precision
+);
+
+/**
+ * @brief Select the tuning profile of the context
+ */
+void linear_context_set_tuning(
+    linear_context_t* context, linear_tuning_t mode
+);
+
+/**
+ * @brief Select the priority class of tasks submitted by the context
+ *
+ * @note Contexts sharing a pool may use different priority classes, e.g. a
+ *       latency-critical tenant at THREAD_PRIORITY_HIGH and a batch tenant at
+ *       THREAD_PRIORITY_LOW.
+ */
+void linear_context_set_priority(
+    linear_context_t* context, thread_priority_t priority
+);
+
+/**
+ * @brief Select how ranges are distributed over the tasks of the context
+ *
+ * Contexts default to SCHEDULE_GUIDED on hybrid processors, so performance
+ * cores do not wait on efficiency cores, and SCHEDULE_STATIC otherwise.
+ */
+void linear_context_set_schedule(
+    linear_context_t* context, linear_schedule_t schedule
+);
+
+/**
+ * @brief Select how operands are validated upon ingest
+ *
+ * Contexts default to VALIDATION_NONE.
+ */
+void linear_context_set_validation(
+    linear_context_t* context, linear_validation_t validation
+);
+
+/**
+ * @brief Restrict the workers of the context to a type of core
+ *
+ * e.g. THREAD_CORE_PERFORMANCE for a context serving latency-critical ops.
+ *
+ * @return true on success or without a pool, false otherwise
+ *
+ * @note Affects every context sharing the pool, see thread_pool_set_cores().
+ */
+bool linear_context_set_cores(linear_context_t* context, thread_core_t cores);
+
+/**
+ * @brief The default parameters of the given tuning profile
+ */
+linear_tuning_profile_t linear_tuning_profile(linear_tuning_t mode);
+
+// Context memory management
+
+/**
+ * @brief Allocate memory using the allocator of the context
+ */
+void* linear_context_allocate(linear_context_t* context, size_t size);
+
+/**
+ * @brief Release memory using the allocator of the context
+ */
+void linear_context_release(linear_context_t* context, void* pointer);
+
+// Context execution
+
+/**
+ * @brief Number of workers available to the context, at least 1
+ */
+uint32_t linear_context_thread_count(const linear_context_t* context);
+
+/**
+ * @brief Number of tasks to split count elements into
+ *
+ * Honors the grain size and tasks per thread of the tuning profile.
+ *
+ * @param context The execution context
+ * @param count   The number of elements to process
+ *
+ * @return The number of tasks, at least 1
+ */
+uint32_t linear_context_task_count(
+    const linear_context_t* context, uint32_t count
+);
+
+/**
+ * @brief Execute an array of tasks and wait for all of them to complete
+ *
+ * Tasks are submitted to the pool of the context, or executed in order on the
+ * calling thread if the context has no pool or holds a single task.
+ *
+ * Only the given tasks are waited on. When called from a task already running
+ * on the pool, the calling worker executes pending tasks while it waits, so
+ * parallel operations may be nested, e.g. a batched op whose items are
+ * themselves parallel.
+ *
+ * @param context The execution context
+ * @param tasks   The tasks to execute
+ * @param count   The number of tasks
+ */
+void linear_context_run(
+    linear_context_t* context, thread_data_t* tasks, uint32_t count
+);
+
+/**
+ * @brief Execute a range over tasks according to the schedule of the context
+ *
+ * Under SCHEDULE_STATIC every task executes the range it was split with. Under
+ * SCHEDULE_DYNAMIC and SCHEDULE_GUIDED the ranges of the tasks are ignored and
+ * each task repeatedly claims the next chunk of [0, count) instead, so a task
+ * may execute its routine several times. Routines producing a per-task result,
+ * e.g. the partial sum of a reduction, must therefore accumulate into it.
+ *
+ * @param context The execution context
+ * @param tasks   The tasks, typically from linear_context_split()
+ * @param n       The number of tasks
+ * @param count   The number of elements to process
+ */
+void linear_context_schedule(
+    linear_context_t* context, thread_data_t* tasks, uint32_t n, uint32_t count
+);
+
+/**
+ * @brief Verify the context targets a backend with host kernels
+ *
+ * @return true if the backend is BACKEND_CPU, false and logs otherwise
+ */
+bool linear_context_is_cpu(const linear_context_t* context);
+
+/**
+ * @brief Split a range kernel over [0, count) into tasks
+ *
+ * The template task is copied once per chunk with begin and end assigned, so
+ * callers may adjust each task, e.g. to point result at a partial sum.
+ *
+ * @param context    The execution context
+ * @param task       The template task
+ * @param count      The number of elements to process
+ * @param task_count Receives the number of tasks
+ *
+ * @return An array of tasks to be freed with free(), or NULL upon failure
+ */
+thread_data_t* linear_context_split(
+    const linear_context_t* context,
+    thread_data_t           task,
+    uint32_t                count,
+    uint32_t*               task_count
+);
+
+/**
+ * @brief Split a range kernel into tasks held by the caller's scratch memory
+ *
+ * Equivalent to linear_context_split() without allocating in steady state.
+ *
+ * @return An array of tasks released with linear_context_scratch_release(),
+ *         or NULL upon failure
+ */
+thread_data_t* linear_context_split_scratch(
+    linear_context_t* context,
+    thread_data_t     task,
+    uint32_t          count,
+    uint32_t*         task_count
+);
+
+// Scratch memory
+
+/**
+ * @brief Mark the calling thread's scratch workspace for the context's pool
+ *
+ * Kernels take a mark, allocate their temporaries with
+ * linear_context_scratch_alloc() and release them back to the mark, so
+ * repeated calls reuse the same memory. See thread_scratch_alloc().
+ */
+size_t linear_context_scratch_mark(linear_context_t* context);
+
+/**
+ * @brief Allocate aligned, uninitialized scratch memory for the calling thread
+ *
+ * @return Pointer to the memory, or NULL upon failure
+ */
+void* linear_context_scratch_alloc(linear_context_t* context, size_t size);
+
+/**
+ * @brief Release the scratch memory allocated after a mark
+ */
+void linear_context_scratch_release(linear_context_t* context, size_t mark);
+
+/**
+ * @brief Execute a range kernel over [0, count) in parallel
+ *
+ * The template task is copied once per task and scheduled according to the
+ * context, see linear_context_schedule().
+ *
+ * @param context The execution context
+ * @param task    The template task; task.routine must be set
+ * @param count   The number of elements to process
+ *
+ * @return true on success, false otherwise
+ */
+bool linear_context_parallel(
+    linear_context_t* context, thread_data_t task, uint32_t count
+);
+
+/**
+ * @brief Execute a range kernel over [0, count) in parallel, sizing the tasks
+ *        by the total work rather than the number of elements
+ *
+ * Intended for kernels whose cost per element is far from uniform with the
+ * element-wise ops, e.g. a GEMM splitting rows that each cost columns * inner
+ * multiply-adds. No more than count tasks are created.
+ *
+ * @param context The execution context
+ * @param task    The template task; task.routine must be set
+ * @param count   The number of elements to process
+ * @param work    The total work in units comparable to the grain size
+ *
+ * @return true on success, false otherwise
+ */
+bool linear_context_parallel_work(
+    linear_context_t* context,
+    thread_data_t     task,
+    uint32_t          count,
+    uint64_t          work
+);
+
+/**
+ * @brief Execute a parallel region on the pool of the context
+ *
+ * Every worker of the pool joins the calling thread for the duration of the
+ * region, see thread_pool_region(). A context without a pool runs the region
+ * with a team of one. Ops given the context by member 0 execute on member 0
+ * alone, while ops from the other members would wait on held workers.
+ *
+ * @param context The execution context
+ * @param region  The function every member executes
+ * @param arg     Forwarded to the region
+ *
+ * @return The number of members that executed the region, 0 upon failure
+ */
+uint32_t linear_context_region(
+    linear_context_t* context, thread_region_t region, void* arg
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_CONTEXT_H
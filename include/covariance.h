@@ -0,0 +1,230 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/covariance.h
+ *
+ * @brief Streaming covariance and incremental PCA over blocks of rows
+ *
+ * Both accumulators ingest a dataset a block of rows at a time, so the data
+ * never has to fit in memory at once, and keep only O(d * d), respectively
+ * O(d * k), state for d columns and k components.
+ *
+ * Partial accumulators merge exactly, by the pairwise update of Chan, Golub
+ * and LeVeque, so blocks may be ingested by separate threads or processes
+ * and combined in any order. Their state is plain arrays, which processes
+ * exchange as they see fit.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_COVARIANCE_H
+#define LINEAR_COVARIANCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Running mean and scatter of the rows ingested so far.
+ *
+ * Both are kept in double precision, so long streams do not lose the
+ * contributions of late blocks.
+ *
+ * @param mean      The d running column means.
+ * @param scatter   The d x d sums of products of deviations from the mean,
+ *                  row-major, of which only the upper triangle is kept.
+ * @param count     The number of rows ingested.
+ * @param dimension The number of columns d.
+ */
+typedef struct Covariance {
+    double*  mean;      ///< Running column means.
+    double*  scatter;   ///< Upper triangle of the scatter matrix.
+    uint64_t count;     ///< Number of rows ingested.
+    uint32_t dimension; ///< Number of columns.
+} covariance_t;
+
+/**
+ * @brief Leading principal axes of the rows ingested so far.
+ *
+ * @param components The k x d principal axes by rows, orthonormal, by
+ *                   decreasing singular value; only the first size are set.
+ * @param singular   The k singular values of the centered data, such that
+ *                   singular[t]^2 / (count - 1) is the variance along axis t.
+ * @param mean       The d running column means.
+ * @param count      The number of rows ingested.
+ * @param dimension  The number of columns d.
+ * @param rank       The number of components kept, k.
+ * @param size       The number of components found so far, at most k.
+ */
+typedef struct Pca {
+    matrix_t* components; ///< Principal axes by rows.
+    float*    singular;   ///< Singular values of the centered data.
+    double*   mean;       ///< Running column means.
+    uint64_t  count;      ///< Number of rows ingested.
+    uint32_t  dimension;  ///< Number of columns.
+    uint32_t  rank;       ///< Number of components kept.
+    uint32_t  size;       ///< Number of components found so far.
+} pca_t;
+
+/**
+ * @brief Rows, and columns, of the scatter tiles a covariance update
+ *        computes per task
+ *
+ * @note A 64 x 64 tile accumulates in 16 KiB, next to the two 64-element
+ *       slices of the row it multiplies, within the L1 cache.
+ */
+#ifndef LINEAR_COVARIANCE_TILE
+    #define LINEAR_COVARIANCE_TILE 64
+#endif // LINEAR_COVARIANCE_TILE
+
+// Lifecycle management
+
+/**
+ * @brief Create an empty covariance accumulator using the given context
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param dimension The number of columns d of the rows ingested.
+ *
+ * @return A pointer to the new accumulator, or NULL upon failure
+ *
+ * @note Accumulators must be freed with covariance_free_ctx().
+ */
+covariance_t*
+covariance_create_ctx(linear_context_t* context, uint32_t dimension);
+void covariance_free_ctx(linear_context_t* context, covariance_t* covariance);
+
+/**
+ * @brief Create an empty incremental PCA using the given context
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param dimension The number of columns d of the rows ingested.
+ * @param rank      The number of components k to keep, at most d.
+ *
+ * @return A pointer to the new PCA, or NULL upon failure
+ *
+ * @note PCAs must be freed with pca_free_ctx().
+ */
+pca_t* pca_create_ctx(
+    linear_context_t* context, uint32_t dimension, uint32_t rank
+);
+void pca_free_ctx(linear_context_t* context, pca_t* pca);
+
+// Covariance
+
+/**
+ * @brief Ingest a block of rows
+ *
+ * Centers the block on its own mean, accumulates its scatter with a
+ * SYRK-style kernel that computes only the upper triangle tiles, split
+ * across the pool, and merges the result as a partial accumulator.
+ *
+ * @param context    The execution context, or NULL for the default context
+ * @param covariance The accumulator.
+ * @param rows       A b x d matrix of rows.
+ *
+ * @return true on success, false otherwise
+ */
+bool covariance_update_ctx(
+    linear_context_t* context, covariance_t* covariance, const matrix_t* rows
+);
+
+/**
+ * @brief Merge a partial accumulator into another
+ *
+ * @param covariance The accumulator receiving the rows of other.
+ * @param other      A partial accumulator of the same dimension, unchanged.
+ *
+ * @return true on success, false otherwise
+ */
+bool covariance_merge_ctx(
+    linear_context_t*   context,
+    covariance_t*       covariance,
+    const covariance_t* other
+);
+
+/**
+ * @brief Copy the running means into a new NUMERIC_FLOAT32 vector.
+ *
+ * @return A new vector of d elements, or NULL upon failure
+ */
+vector_t* covariance_mean_ctx(
+    linear_context_t* context, const covariance_t* covariance
+);
+
+/**
+ * @brief Expand the covariance into a new dense symmetric matrix.
+ *
+ * @param unbiased Divide the scatter by count - 1 rather than count.
+ *
+ * @return A new d x d matrix, or NULL if too few rows were ingested or upon
+ *         failure
+ */
+matrix_t* covariance_to_matrix_ctx(
+    linear_context_t*   context,
+    const covariance_t* covariance,
+    bool                unbiased
+);
+
+// Incremental PCA
+
+/**
+ * @brief Ingest a block of rows, keeping the top k components
+ *
+ * Stacks the current components scaled by their singular values, the block
+ * centered on its own mean and a row correcting for the shift of the mean,
+ * then takes the top k singular vectors of the stack, which only has
+ * k + b + 1 rows. See Ross et al. (2008).
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param pca     The PCA.
+ * @param rows    A b x d matrix of rows.
+ *
+ * @return true on success, false otherwise
+ *
+ * @note The decomposition is exact while the data has rank at most k, and
+ *       otherwise tracks the leading subspace as blocks arrive.
+ */
+bool pca_update_ctx(
+    linear_context_t* context, pca_t* pca, const matrix_t* rows
+);
+
+/**
+ * @brief Merge a partial PCA into another
+ *
+ * @param pca   The PCA receiving the rows of other.
+ * @param other A partial PCA of the same dimension, unchanged.
+ *
+ * @return true on success, false otherwise
+ */
+bool pca_merge_ctx(
+    linear_context_t* context, pca_t* pca, const pca_t* other
+);
+
+/**
+ * @brief Project rows onto the components found so far
+ *
+ * @param rows   A b x d matrix of rows.
+ * @param scores A b x size matrix receiving the centered rows times the
+ *               transposed components.
+ *
+ * @return true on success, false otherwise
+ */
+bool pca_transform_ctx(
+    linear_context_t* context,
+    const pca_t*      pca,
+    const matrix_t*   rows,
+    matrix_t*         scores
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_COVARIANCE_H
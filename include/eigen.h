@@ -0,0 +1,192 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/eigen.h
+ *
+ * @brief Iterative eigensolvers over abstract linear operators
+ *
+ * The solvers only touch the operator through a matvec callback, so they
+ * apply to dense, banded, block-sparse or implicit matrices alike, e.g. the
+ * Google matrix of a graph too large to store densely. Each step calls the
+ * matvec, which parallelizes itself, then runs the vector work of the step,
+ * fused dots, axpys and norms, in a single parallel region whose phases
+ * synchronize through the team reductions.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_EIGEN_H
+#define LINEAR_EIGEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Compute y = a * x for the operator a described by operand.
+ *
+ * @param context The execution context the solver was given
+ * @param operand The operand of the operator, e.g. a matrix_t.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param y       A NUMERIC_FLOAT32 vector with n elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+typedef bool (*eigen_matvec_t)(
+    linear_context_t* context,
+    const void*       operand,
+    const vector_t*   x,
+    vector_t*         y
+);
+
+/**
+ * @brief A square linear operator known only through its matvec.
+ *
+ * @param matvec  Computes y = a * x.
+ * @param operand Forwarded to matvec.
+ * @param order   The number of rows, and columns, n.
+ */
+typedef struct EigenOperator {
+    eigen_matvec_t matvec;  ///< Computes y = a * x.
+    const void*    operand; ///< Forwarded to matvec.
+    uint32_t       order;   ///< Number of rows and columns.
+} eigen_operator_t;
+
+// Operators
+
+/**
+ * @brief Matvec of a square matrix_t operand, see matrix_gemv_ctx().
+ */
+bool eigen_matrix_matvec(
+    linear_context_t* context,
+    const void*       operand,
+    const vector_t*   x,
+    vector_t*         y
+);
+
+/**
+ * @brief Matvec of a square bsr_t operand, see bsr_gemv_ctx().
+ */
+bool eigen_bsr_matvec(
+    linear_context_t* context,
+    const void*       operand,
+    const vector_t*   x,
+    vector_t*         y
+);
+
+// Solvers
+
+/**
+ * @brief Power iteration for the eigenpair of largest magnitude
+ *
+ * Repeats x = a * x / ||a * x|| until ||a * x - value * x|| is at most
+ * tolerance * |value|, value being the Rayleigh quotient x' * a * x. The
+ * operator need not be symmetric, e.g. the stochastic matrix whose
+ * stationary vector PageRank seeks.
+ *
+ * @param context    The execution context, or NULL for the default context
+ * @param op         The operator.
+ * @param x          A nonzero NUMERIC_FLOAT32 vector with n elements to start
+ *                   from, receiving the unit eigenvector.
+ * @param tolerance  The residual at which to stop, relative to |value|.
+ * @param iterations The largest number of matvecs.
+ * @param value      Receives the eigenvalue.
+ *
+ * @return true if the residual converged, false otherwise, leaving the last
+ *         iterate in x and value
+ *
+ * @note Converges as |lambda2 / lambda1|^k, and not at all when the two
+ *       largest eigenvalues have the same magnitude, e.g. for a periodic
+ *       Markov chain.
+ */
+bool eigen_power_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    vector_t*               x,
+    float                   tolerance,
+    uint32_t                iterations,
+    float*                  value
+);
+
+/**
+ * @brief Block power iteration for the k eigenpairs of largest magnitude of
+ *        a symmetric operator
+ *
+ * Applies the operator to an orthonormal block of k vectors, rotates the
+ * result by the eigenvectors of the k x k projection of the operator onto
+ * the block, a Rayleigh-Ritz step carried out by GEMMs, and orthonormalizes
+ * it again. Stops once every residual ||a * x - value * x|| is at most
+ * tolerance times the largest |value|.
+ *
+ * @param context    The execution context, or NULL for the default context
+ * @param op         The symmetric operator.
+ * @param vectors    A k x n matrix of linearly independent rows to start
+ *                   from, receiving the unit eigenvectors by rows.
+ * @param values     A NUMERIC_FLOAT32 vector receiving the k eigenvalues, by
+ *                   decreasing magnitude.
+ * @param tolerance  The residual at which to stop, relative to the largest
+ *                   |value|.
+ * @param iterations The largest number of block matvecs.
+ *
+ * @return true if every residual converged, false otherwise, leaving the
+ *         last Ritz pairs in vectors and values
+ *
+ * @note Converges as |lambda(k + 1) / lambda(k)|^k, so a block slightly
+ *       larger than the number of pairs sought often pays for itself.
+ */
+bool eigen_block_power_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    matrix_t*               vectors,
+    vector_t*               values,
+    float                   tolerance,
+    uint32_t                iterations
+);
+
+/**
+ * @brief Lanczos iteration for the k eigenpairs of largest magnitude of a
+ *        symmetric operator
+ *
+ * Builds an orthonormal basis of the Krylov space of start, one matvec per
+ * step, in which the operator is tridiagonal. Each new vector is
+ * reorthogonalized against the whole basis, so rounding never produces
+ * spurious copies of converged eigenvalues. The Ritz vectors are the top
+ * eigenvectors of the tridiagonal matrix mapped back through the basis by a
+ * GEMM.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param op      The symmetric operator.
+ * @param start   A nonzero NUMERIC_FLOAT32 vector with n elements, or NULL
+ *                for a fixed positive vector.
+ * @param steps   The dimension m of the Krylov space, k <= m <= n.
+ * @param vectors A k x n matrix receiving the unit Ritz vectors by rows.
+ * @param values  A NUMERIC_FLOAT32 vector receiving the k Ritz values, by
+ *                decreasing magnitude.
+ *
+ * @return true on success, false if the Krylov space of start has fewer
+ *         than k dimensions or upon failure
+ *
+ * @note Stores the m x n basis. The extreme eigenvalues converge first, in
+ *       far fewer steps than power iteration takes.
+ */
+bool eigen_lanczos_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    const vector_t*         start,
+    uint32_t                steps,
+    matrix_t*               vectors,
+    vector_t*               values
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_EIGEN_H
@@ -0,0 +1,177 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/lowrank.h
+ *
+ * @brief Low-rank matrices stored as a pair of factors
+ *
+ * A low-rank matrix of size m x n and rank k is stored as the factors
+ * u (m x k) and v (n x k) of a = u * v', so it takes (m + n) * k elements
+ * instead of m * n. Products associate through the k-dimensional inner
+ * space, e.g. a * x = u * (v' * x), and never form the m x n matrix.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_LOWRANK_H
+#define LINEAR_LOWRANK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief A matrix stored as the product of two thin factors, u * v'.
+ *
+ * @param u The m x k left factor, its columns scaled by the singular values
+ *          when compressed by lowrank_from_matrix_ctx().
+ * @param v The n x k right factor.
+ */
+typedef struct LowRank {
+    matrix_t* u; ///< Left factor, m x k.
+    matrix_t* v; ///< Right factor, n x k.
+} lowrank_t;
+
+/**
+ * @brief Extra dimensions sketched beyond the rank when compressing
+ *
+ * @note Oversampling makes the sketch capture the top k singular directions
+ *       with high probability, see Halko, Martinsson and Tropp (2011).
+ */
+#ifndef LINEAR_LOWRANK_OVERSAMPLE
+    #define LINEAR_LOWRANK_OVERSAMPLE 8
+#endif // LINEAR_LOWRANK_OVERSAMPLE
+
+/**
+ * @brief Power iterations refining the sketch when compressing
+ *
+ * @note Each iteration costs two more passes over the dense matrix, and
+ *       sharpens the sketch when the singular values decay slowly.
+ */
+#ifndef LINEAR_LOWRANK_POWER
+    #define LINEAR_LOWRANK_POWER 2
+#endif // LINEAR_LOWRANK_POWER
+
+// Lifecycle management
+
+/**
+ * @brief Create a zero initialized low-rank matrix using the given context
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param rows    The number of rows m of the matrix.
+ * @param columns The number of columns n of the matrix.
+ * @param rank    The number of columns k of both factors.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note Low-rank matrices must be freed with lowrank_free_ctx().
+ */
+lowrank_t* lowrank_create_ctx(
+    linear_context_t* context, uint32_t rows, uint32_t columns, uint32_t rank
+);
+void lowrank_free_ctx(linear_context_t* context, lowrank_t* lowrank);
+
+// Conversion
+
+/**
+ * @brief Compress a dense matrix to its best approximation of a given rank
+ *
+ * Computes a truncated SVD by randomized range finding: a deterministic
+ * sketch of LINEAR_LOWRANK_OVERSAMPLE more columns than the rank, refined by
+ * LINEAR_LOWRANK_POWER power iterations, projects the matrix onto a small
+ * basis whose SVD is taken by one-sided Jacobi rotations. The passes over
+ * the dense matrix are GEMMs split across the pool, while the Jacobi sweeps
+ * only touch the small projection.
+ *
+ * The result is exact when the matrix has rank at most the sketch size,
+ * which includes any rank at least min(m, n) - LINEAR_LOWRANK_OVERSAMPLE.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  The dense m x n matrix.
+ * @param rank    The rank k, reduced to min(m, n) if larger.
+ *
+ * @return A new low-rank matrix whose u holds the left singular vectors
+ *         scaled by the k largest singular values, in decreasing order, and
+ *         whose v holds the right singular vectors, or NULL upon failure
+ */
+lowrank_t* lowrank_from_matrix_ctx(
+    linear_context_t* context, const matrix_t* matrix, uint32_t rank
+);
+
+/**
+ * @brief Expand into a new dense matrix, u * v'.
+ *
+ * @return A new matrix, freed with matrix_free_ctx(), or NULL upon failure
+ */
+matrix_t*
+lowrank_to_matrix_ctx(linear_context_t* context, const lowrank_t* lowrank);
+
+// Products
+
+/**
+ * @brief Low-rank matrix-vector multiply, y = alpha * u * (v' * x) + beta * y
+ *
+ * Costs (m + n) * k multiply-adds instead of m * n.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and x.
+ * @param a       A low-rank matrix of size m x n.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param beta    Scales y before accumulating, 0 overwrites y.
+ * @param y       A NUMERIC_FLOAT32 vector with m elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool lowrank_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const lowrank_t*  a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+/**
+ * @brief Low-rank matrix multiply, c = alpha * u * (v' * b) + beta * c
+ *
+ * Costs (m + n) * k * p multiply-adds for a p-column b instead of m * n * p.
+ *
+ * @param a A low-rank matrix of size m x n.
+ * @param b A dense n x p matrix.
+ * @param c A dense m x p matrix, distinct from b.
+ *
+ * @return true on success, false otherwise
+ */
+bool lowrank_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const lowrank_t*  a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+);
+
+/**
+ * @brief Accumulate a low-rank matrix into a dense one, c += alpha * u * v'
+ *
+ * @param a A low-rank matrix of size m x n.
+ * @param c A dense m x n matrix.
+ *
+ * @return true on success, false otherwise
+ */
+bool lowrank_add_to_matrix_ctx(
+    linear_context_t* context, float alpha, const lowrank_t* a, matrix_t* c
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_LOWRANK_H
@@ -31,7 +31,18 @@ typedef enum MatrixState {
     MATRIX_TRANSPOSED = 1 << 0, // 0b0001
     MATRIX_SCALED     = 1 << 1, // 0b0010
     MATRIX_ROTATED    = 1 << 2, // 0b0100
-    MATRIX_TRANSLATED = 1 << 3  // 0b1000
+    MATRIX_TRANSLATED = 1 << 3, // 0b1000
+
+    // Structure cached by matrix_analyze_ctx(), see matrix_structure_t
+    MATRIX_ANALYZED  = 1 << 4,  // The structure flags below are valid
+    MATRIX_ZERO      = 1 << 5,  // Every element is zero
+    MATRIX_IDENTITY  = 1 << 6,  // Square with ones on the diagonal
+    MATRIX_DIAGONAL  = 1 << 7,  // Zero outside the diagonal
+    MATRIX_UPPER     = 1 << 8,  // Zero below the diagonal
+    MATRIX_LOWER     = 1 << 9,  // Zero above the diagonal
+    MATRIX_SYMMETRIC = 1 << 10, // Square and equal to its transpose
+    MATRIX_BANDED    = 1 << 11, // Zero outside a band of diagonals
+    MATRIX_STRUCTURE = 0xff0    // Mask of every structure flag
 } matrix_state_t;
 
 /**
@@ -46,6 +57,8 @@ typedef enum MatrixState {
  * @param rows The number of rows in the matrix.
  * @param state Bitwise flags representing the matrix's state (e.g.,
  * transposed, scaled).
+ * @param lower The lower bandwidth, valid while the state is MATRIX_ANALYZED.
+ * @param upper The upper bandwidth, valid while the state is MATRIX_ANALYZED.
  *
  * @note The matrix uses uint32_t for dimensions to maintain 4-byte alignment,
  *       minimizing memory overhead compared to size_t (8 bytes).
@@ -55,6 +68,8 @@ typedef struct Matrix {
     uint32_t columns; ///< Number of columns in the matrix.
     uint32_t rows;    ///< Number of rows in the matrix.
     uint32_t state;   ///< State flags using bitwise operations.
+    uint32_t lower;   ///< Nonzero diagonals below the main diagonal.
+    uint32_t upper;   ///< Nonzero diagonals above the main diagonal.
 } matrix_t;
 
 // Matrix lifecycle management
@@ -187,4 +202,723 @@ matrix_t* matrix_matrix_divide(const matrix_t* a, const matrix_t* b);
 matrix_t* matrix_transpose(matrix_t* matrix);
 float     matrix_dot_product(const matrix_t* a, const matrix_t* b);
 
+// Context Operations
+
+/**
+ * @brief Create a zero initialized matrix using the given context
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param rows    The number of rows in the matrix.
+ * @param columns The number of columns in the matrix.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note Matrices created by a context must be freed with matrix_free_ctx().
+ */
+matrix_t* matrix_create_ctx(
+    linear_context_t* context, const uint32_t rows, const uint32_t columns
+);
+void      matrix_free_ctx(linear_context_t* context, matrix_t* matrix);
+matrix_t* matrix_deep_copy_ctx(
+    linear_context_t* context, const matrix_t* matrix
+);
+
+/**
+ * @brief Create the transpose of a matrix in parallel
+ *
+ * Rows of the transpose are split across the pool, each task reading the
+ * source in tiles of LINEAR_TRANSPOSE_TILE rows so the strided reads stay
+ * within a few cache lines per row.
+ *
+ * @return A new columns x rows matrix, or NULL upon failure
+ */
+matrix_t*
+matrix_transpose_ctx(linear_context_t* context, const matrix_t* matrix);
+
+#ifndef LINEAR_TRANSPOSE_TILE
+    #define LINEAR_TRANSPOSE_TILE 32
+#endif // LINEAR_TRANSPOSE_TILE
+
+void matrix_fill_ctx(
+    linear_context_t* context, matrix_t* matrix, const float value
+);
+
+/**
+ * @brief Perform an element-wise scalar operation on a matrix in parallel.
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param matrix    A pointer to the matrix to operate on.
+ * @param scalar    The scalar value to apply.
+ * @param operation The operation to apply element-wise.
+ *
+ * @return A new matrix containing the results of the operation.
+ */
+matrix_t* matrix_scalar_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    matrix,
+    float              scalar,
+    scalar_operation_t operation
+);
+matrix_t* matrix_scalar_add_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+);
+matrix_t* matrix_scalar_subtract_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+);
+matrix_t* matrix_scalar_multiply_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+);
+matrix_t* matrix_scalar_divide_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+);
+
+/**
+ * @brief Apply an operation between each row of a matrix and a vector.
+ *
+ * The NUMERIC_FLOAT32 vector must have as many columns as the matrix.
+ */
+matrix_t* matrix_vector_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    matrix,
+    const vector_t*    vector,
+    scalar_operation_t operation
+);
+matrix_t* matrix_vector_add_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+);
+matrix_t* matrix_vector_subtract_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+);
+matrix_t* matrix_vector_multiply_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+);
+matrix_t* matrix_vector_divide_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+);
+
+/**
+ * @brief Apply an element-wise operation between two matrices in parallel.
+ */
+matrix_t* matrix_matrix_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    a,
+    const matrix_t*    b,
+    scalar_operation_t operation
+);
+matrix_t* matrix_matrix_add_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+);
+matrix_t* matrix_matrix_subtract_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+);
+matrix_t* matrix_matrix_multiply_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+);
+matrix_t* matrix_matrix_divide_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+);
+
+/**
+ * @brief General matrix multiply, c = alpha * a * b + beta * c, in parallel.
+ *
+ * Rows of c are split across the pool of the context. Once a has been
+ * analyzed, see matrix_analyze_ctx(), each row of c only visits the band of
+ * the matching row of a, so diagonal, triangular and banded operands cost
+ * proportionally less.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and b.
+ * @param a       An m x k matrix.
+ * @param b       A k x n matrix.
+ * @param beta    Scales c before accumulating, 0 overwrites c.
+ * @param c       An m x n matrix receiving the result.
+ *
+ * @return true on success, false otherwise
+ */
+bool matrix_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+);
+
+/**
+ * @brief Compute the matrix product a * b into a new matrix.
+ */
+matrix_t* matrix_product_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+);
+
+/**
+ * @brief Perform count independent GEMMs, c[i] = alpha * a[i] * b[i] + beta *
+ *        c[i], in parallel.
+ *
+ * Items are distributed across the pool and each item's GEMM is itself
+ * parallel, so a few large items and many small items both occupy the pool.
+ *
+ * @return true if every item succeeded, false otherwise
+ */
+bool matrix_gemm_batched_ctx(
+    linear_context_t*      context,
+    uint32_t               count,
+    float                  alpha,
+    const matrix_t* const* a,
+    const matrix_t* const* b,
+    float                  beta,
+    matrix_t* const*       c
+);
+
+/**
+ * @brief Euclidean distance between a query vector and every row of a matrix.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  An m x n matrix whose rows are scanned.
+ * @param query   A NUMERIC_FLOAT32 vector with n columns.
+ *
+ * @return A new NUMERIC_FLOAT32 vector of m distances, or NULL upon failure
+ */
+vector_t* matrix_row_distance_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* query
+);
+
+// Bulk Access and Indexing
+
+/**
+ * @brief Copy a whole row or column between a matrix and a vector.
+ *
+ * Unlike matrix_element_get() and matrix_element_set(), bounds are checked
+ * once per call rather than once per element, and long rows or columns are
+ * copied in parallel.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  The matrix to read from or write to.
+ * @param row     The index of the row, or column, to access.
+ * @param values  A NUMERIC_FLOAT32 vector with as many elements as the row,
+ *                or column.
+ *
+ * @return true on success, false if an operand is invalid
+ */
+bool matrix_row_get_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          row,
+    vector_t*         values
+);
+bool matrix_row_set_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    uint32_t          row,
+    const vector_t*   values
+);
+bool matrix_column_get_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          column,
+    vector_t*         values
+);
+bool matrix_column_set_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    uint32_t          column,
+    const vector_t*   values
+);
+
+/**
+ * @brief Gather, scatter or scatter-add elements by flat row-major index.
+ *
+ * For each i, gather reads values[i] = data[indices[i]], scatter writes
+ * data[indices[i]] = values[i] and scatter-add accumulates data[indices[i]]
+ * += values[i]. The number of indices is the number of values. Large index
+ * lists are split across the pool.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  The indexed matrix.
+ * @param indices Flat indices, row * columns + column, of the elements.
+ * @param values  A NUMERIC_FLOAT32 vector with one value per index.
+ *
+ * @return true on success, false if an operand or any index is invalid
+ *
+ * @note Out of bounds indices are skipped, gathering NAN, and reported once.
+ * @note Scatter-add is safe for duplicate indices, accumulating each value
+ *       atomically, though the order of the additions is unspecified. Scatter
+ *       stores one of the values of a duplicate index.
+ */
+bool matrix_gather_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   indices,
+    vector_t*         values
+);
+bool matrix_scatter_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   indices,
+    const vector_t*   values
+);
+bool matrix_scatter_add_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   indices,
+    const vector_t*   values
+);
+
+/**
+ * @brief Copy the indexed rows of a matrix into the rows of result.
+ *
+ * Row i of result receives row rows[i] of the matrix, e.g. to look up the
+ * features of a batch of ids. Reusing result avoids allocating per lookup.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  The matrix to select from.
+ * @param rows    One row index per row of result.
+ * @param result  A matrix with as many columns as the matrix.
+ *
+ * @return true on success, false if an operand or any index is invalid
+ */
+bool matrix_gather_rows_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   rows,
+    matrix_t*         result
+);
+
+/**
+ * @brief Select count rows of a matrix into a new count x columns matrix.
+ *
+ * @return A new matrix, or NULL if an operand or any index is invalid
+ */
+matrix_t* matrix_index_select_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   rows,
+    uint32_t          count
+);
+
+/**
+ * @brief Accumulate each row i of values into row rows[i] of the matrix.
+ *
+ * The inverse of matrix_gather_rows_ctx(), e.g. to accumulate the gradient
+ * of a lookup. Duplicate row indices accumulate atomically.
+ *
+ * @return true on success, false if an operand or any index is invalid
+ */
+bool matrix_scatter_add_rows_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   rows,
+    const matrix_t*   values
+);
+
+// Embedding Bags
+
+/**
+ * @brief Number of indices ahead whose rows an embedding bag prefetches
+ *
+ * @note 0 disables prefetching, e.g. for tables that fit in cache.
+ */
+#ifndef LINEAR_EMBEDDING_PREFETCH
+    #define LINEAR_EMBEDDING_PREFETCH 4
+#endif // LINEAR_EMBEDDING_PREFETCH
+
+/**
+ * @brief Reduction applied over the rows of an embedding bag
+ *
+ * @param MATRIX_POOL_SUM   Sum of the, optionally weighted, rows
+ * @param MATRIX_POOL_MEAN  Sum of the, optionally weighted, rows divided by
+ *                          their number
+ * @param MATRIX_POOL_MAX   Element-wise maximum of the rows
+ * @param MATRIX_POOL_COUNT Number of pooling modes
+ */
+typedef enum MatrixPooling {
+    MATRIX_POOL_SUM,   // Sum of the rows
+    MATRIX_POOL_MEAN,  // Mean of the rows
+    MATRIX_POOL_MAX,   // Element-wise maximum of the rows
+    MATRIX_POOL_COUNT, // Number of pooling modes
+} matrix_pooling_t;
+
+/**
+ * @brief Look up and pool bags of table rows in a single fused pass.
+ *
+ * Row b of result receives the pooling of rows indices[offsets[b]] through
+ * indices[offsets[b + 1] - 1] of the table, accumulated directly into result
+ * without gathering the rows first. Bags are split across the pool and the
+ * rows of upcoming indices are prefetched, see LINEAR_EMBEDDING_PREFETCH.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param table   The embedding table, one row per id.
+ * @param indices Row indices of every bag, concatenated.
+ * @param offsets result->rows + 1 non-decreasing offsets into indices.
+ * @param weights Optional per-index weights for sum and mean pooling, or NULL.
+ * @param pooling The reduction over the rows of each bag.
+ * @param result  A bags x columns matrix receiving one pooled row per bag.
+ *
+ * @return true on success, false if an operand or any index is invalid
+ *
+ * @note Empty bags pool to zero. Out of bounds indices are skipped and
+ *       reported once. A NaN in any row of a bag yields NaN for that element
+ *       under every pooling, including MATRIX_POOL_MAX.
+ */
+bool matrix_embedding_bag_ctx(
+    linear_context_t* context,
+    const matrix_t*   table,
+    const uint32_t*   indices,
+    const uint32_t*   offsets,
+    const float*      weights,
+    matrix_pooling_t  pooling,
+    matrix_t*         result
+);
+
+// Non-finite Detection and Sanitization
+
+/**
+ * @brief Non-finite detection and sanitization over the elements of a matrix
+ *
+ * The matrix is processed as a flat vector of its elements, see
+ * vector_all_finite_ctx(), vector_count_nonfinite_ctx(),
+ * vector_nan_to_num_ctx() and vector_ingest_ctx().
+ */
+bool matrix_all_finite_ctx(linear_context_t* context, const matrix_t* matrix);
+uint32_t
+matrix_count_nonfinite_ctx(linear_context_t* context, const matrix_t* matrix);
+bool matrix_nan_to_num_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    float             nan,
+    float             posinf,
+    float             neginf
+);
+bool matrix_ingest_ctx(linear_context_t* context, matrix_t* matrix);
+
+// Approximate Comparison
+
+/**
+ * @brief Check that every pair of elements of two matrices is close
+ *
+ * The reported mismatch is the row-major index of the element, see
+ * vector_is_close_ctx().
+ */
+bool matrix_is_close_ctx(
+    linear_context_t*         context,
+    const matrix_t*           a,
+    const matrix_t*           b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+);
+
+/**
+ * @brief Parallel variants of matrix_is_zero() and matrix_is_identity()
+ *
+ * Both compare exactly and return as soon as any element differs.
+ */
+bool matrix_is_zero_ctx(linear_context_t* context, const matrix_t* matrix);
+bool matrix_is_identity_ctx(
+    linear_context_t* context, const matrix_t* matrix
+);
+
+// Structure Detection and Dispatch
+
+/**
+ * @brief The structure of a matrix found by matrix_analyze_ctx()
+ *
+ * @param lower     Number of nonzero diagonals below the main diagonal
+ * @param upper     Number of nonzero diagonals above the main diagonal
+ * @param nonzeros  Number of nonzero elements, NaN counting as nonzero
+ * @param sparsity  Fraction of elements that are zero, 1 for an empty matrix
+ * @param flags     The MATRIX_ZERO through MATRIX_BANDED flags that hold
+ *
+ * @note The flags are properties rather than categories, so several may hold
+ *       at once, e.g. the identity is also diagonal, triangular and symmetric.
+ *       A matrix is banded when its band excludes at least one diagonal of
+ *       its columns, i.e. lower + upper + 1 < columns.
+ */
+typedef struct MatrixStructure {
+    uint32_t lower;    // Lower bandwidth
+    uint32_t upper;    // Upper bandwidth
+    uint64_t nonzeros; // Number of nonzero elements
+    float    sparsity; // Fraction of zero elements
+    uint32_t flags;    // Structure flags of matrix_state_t
+} matrix_structure_t;
+
+/**
+ * @brief Detect the structure of a matrix in a single parallel pass
+ *
+ * The flags and bandwidths are cached in the state of the matrix, which
+ * matrix_gemm_ctx(), matrix_gemv_ctx() and matrix_solve_ctx() consult to
+ * dispatch specialized kernels, and which matrix_is_zero() and
+ * matrix_is_identity() return without scanning.
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param matrix    The matrix to analyze.
+ * @param structure Receives the structure, or NULL.
+ *
+ * @return true on success, false otherwise
+ *
+ * @note Library ops writing to a matrix invalidate its cached structure.
+ *       Callers writing to matrix->data directly must call
+ *       matrix_invalidate() afterwards, or the stale structure may produce
+ *       wrong results.
+ * @note Specialized kernels skip the zeros of an analyzed matrix, so
+ *       non-finite elements of another operand facing those zeros no longer
+ *       propagate into the result.
+ */
+bool matrix_analyze_ctx(
+    linear_context_t*   context,
+    matrix_t*           matrix,
+    matrix_structure_t* structure
+);
+
+/**
+ * @brief Discard the structure cached by matrix_analyze_ctx()
+ */
+void matrix_invalidate(matrix_t* matrix);
+
+/**
+ * @brief General matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * Rows of a are split across the pool and, once a has been analyzed, only
+ * their band is visited.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and x.
+ * @param a       An m x n matrix.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param beta    Scales y before accumulating, 0 overwrites y.
+ * @param y       A NUMERIC_FLOAT32 vector with m elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool matrix_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const matrix_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+/**
+ * @brief Solve a * x = b for every column of b.
+ *
+ * The structure of a is analyzed unless already cached, then:
+ * - the identity copies b,
+ * - diagonal and triangular matrices use band-limited substitution,
+ * - symmetric matrices use a banded Cholesky factorization, falling back to
+ *   LU when a is not positive definite,
+ * - any other matrix uses a banded LU factorization with partial pivoting.
+ * Substitutions split the columns of b, and factorizations the rows of each
+ * trailing update, across the pool.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       An n x n matrix.
+ * @param b       An n x r matrix of right-hand sides.
+ * @param x       An n x r matrix receiving the solutions, which may be b.
+ *
+ * @return true on success, false if an operand is invalid or a is singular
+ */
+bool matrix_solve_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    matrix_t*         x
+);
+
+// Factorization updates
+
+/**
+ * @brief Cholesky factorization of a symmetric positive definite matrix,
+ *        a = r' * r.
+ *
+ * Only the upper triangle of a is read. The rows of each trailing update
+ * are split across the pool and, once a has been analyzed, only its band is
+ * visited. The factor is the starting point of matrix_cholesky_update_ctx()
+ * and matrix_cholesky_downdate_ctx().
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       An n x n symmetric matrix.
+ * @param r       An n x n matrix receiving the upper triangular factor, zero
+ *                below the diagonal, which may be a.
+ *
+ * @return true on success, false if a is not positive definite or upon
+ *         failure, leaving r unspecified
+ */
+bool matrix_cholesky_ctx(
+    linear_context_t* context, const matrix_t* a, matrix_t* r
+);
+
+/**
+ * @brief Update a Cholesky factor in place to that of a + x * x'.
+ *
+ * Rotates x into r one row at a time in O(n * n), instead of refactoring
+ * in O(n * n * n). Each rotation streams a row of r, split across the pool
+ * for large orders.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param r       The n x n upper triangular factor of a, a = r' * r.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements, left unchanged.
+ *
+ * @return true on success, false otherwise
+ */
+bool matrix_cholesky_update_ctx(
+    linear_context_t* context, matrix_t* r, const vector_t* x
+);
+
+/**
+ * @brief Downdate a Cholesky factor in place to that of a - x * x'.
+ *
+ * Solves r' * p = x first, so a downdate losing positive definiteness,
+ * ||p|| >= 1, is detected before r is modified. Then rotates the extra row
+ * out of r one row at a time, from the last, in O(n * n).
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param r       The n x n upper triangular factor of a, a = r' * r.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements, left unchanged.
+ *
+ * @return true on success, false if a - x * x' is not positive definite,
+ *         leaving r unchanged, or upon failure
+ */
+bool matrix_cholesky_downdate_ctx(
+    linear_context_t* context, matrix_t* r, const vector_t* x
+);
+
+/**
+ * @brief Update an explicit inverse in place to that of a + u * v'.
+ *
+ * Applies the Sherman-Morrison-Woodbury formula,
+ *
+ *     (a + u v')^-1 = b - (b u) (i + v' b u)^-1 (v' b), where b = a^-1,
+ *
+ * in O(n * n * k) for a rank k update instead of the O(n * n * n) of a new
+ * inverse. The products are GEMMs split across the pool, and only the
+ * k x k capacitance matrix i + v' b u is solved.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param inverse The n x n inverse b of a, updated in place.
+ * @param u       An n x k matrix, e.g. a single column for Sherman-Morrison.
+ * @param v       An n x k matrix, or NULL for the symmetric update u * u'.
+ *
+ * @return true on success, false if a + u * v' is singular, leaving inverse
+ *         unchanged, or upon failure
+ */
+bool matrix_inverse_update_ctx(
+    linear_context_t* context,
+    matrix_t*         inverse,
+    const matrix_t*   u,
+    const matrix_t*   v
+);
+
+// Least Squares
+
+/**
+ * @brief Minimize ||a * x - b||^2 + lambda * ||x||^2 by a QR factorization.
+ *
+ * Reduces the augmented matrix [a | b] with Householder reflections, each
+ * projection splitting the columns, and each reflection the rows, across
+ * the pool, then back substitutes r * x = q' * b. A ridge appends the rows
+ * sqrt(lambda) * i to a. Never forms a' * a, so its accuracy depends on the
+ * condition number of a rather than its square.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       An m x n design matrix, m >= n unless lambda > 0.
+ * @param b       An m x r matrix of targets, one regression per column.
+ * @param lambda  The ridge penalty, 0 for ordinary least squares.
+ * @param x       An n x r matrix receiving the coefficients.
+ *
+ * @return true on success, false if a is rank deficient or upon failure
+ */
+bool matrix_lstsq_qr_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             lambda,
+    matrix_t*         x
+);
+
+/**
+ * @brief Minimize ||a * x - b||^2 + lambda * ||x||^2 by the normal equations.
+ *
+ * Forms a' * a + lambda * i and a' * b with GEMMs, then solves by Cholesky.
+ * Costs about half of matrix_lstsq_qr_ctx() for tall a, at the price of
+ * squaring its condition number, which a ridge offsets.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       An m x n design matrix.
+ * @param b       An m x r matrix of targets, one regression per column.
+ * @param lambda  The ridge penalty, 0 for ordinary least squares.
+ * @param x       An n x r matrix receiving the coefficients, distinct from b.
+ *
+ * @return true on success, false if a' * a + lambda * i is not positive
+ *         definite or upon failure
+ */
+bool matrix_lstsq_normal_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             lambda,
+    matrix_t*         x
+);
+
+/**
+ * @brief Solve count independent regressions sharing a design matrix by the
+ *        normal equations.
+ *
+ * Factors a' * a + lambda * i once, then distributes the items across the
+ * pool, each forming a' * b[i] with a nested GEMM and substituting against
+ * the shared factor.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       An m x n design matrix.
+ * @param lambda  The ridge penalty, 0 for ordinary least squares.
+ * @param count   The number of items.
+ * @param b       The m x r[i] targets of each item.
+ * @param x       The n x r[i] matrices receiving the coefficients of each
+ *                item, distinct from b[i].
+ *
+ * @return true if every item succeeded, false otherwise
+ */
+bool matrix_lstsq_batched_ctx(
+    linear_context_t*      context,
+    const matrix_t*        a,
+    float                  lambda,
+    uint32_t               count,
+    const matrix_t* const* b,
+    matrix_t* const*       x
+);
+
+// Asynchronous Operations
+
+/**
+ * @brief Non-blocking variants of the GEMM and distance scan.
+ *
+ * Return immediately with a handle. matrix_gemm_async() signals success
+ * through the status of the handle, matrix_product_async() and
+ * matrix_row_distance_async() through linear_async_result(), which passes
+ * ownership of the new matrix or vector to the caller. Operands must remain
+ * valid until the op completes.
+ *
+ * @param options Completion notification, or NULL to poll the handle
+ */
+linear_async_t* matrix_gemm_async(
+    linear_context_t*             context,
+    float                         alpha,
+    const matrix_t*               a,
+    const matrix_t*               b,
+    float                         beta,
+    matrix_t*                     c,
+    const linear_async_options_t* options
+);
+linear_async_t* matrix_product_async(
+    linear_context_t*             context,
+    const matrix_t*               a,
+    const matrix_t*               b,
+    const linear_async_options_t* options
+);
+linear_async_t* matrix_row_distance_async(
+    linear_context_t*             context,
+    const matrix_t*               matrix,
+    const vector_t*               query,
+    const linear_async_options_t* options
+);
+
 #endif // LINEAR_MATRIX_H
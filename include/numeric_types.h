@@ -21,6 +21,7 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -50,6 +51,15 @@ typedef union NumericUnionType {
     int32_t bits;
 } numeric_union_t;
 
+/**
+ * @brief Returns the size in bytes of a single element of the given type.
+ *
+ * @param[in] type The enumerable data type.
+ *
+ * @return The element size in bytes, or 0 if the type is unsupported.
+ */
+size_t numeric_data_size(numeric_data_t type);
+
 /**
  * @brief Encodes a given float value into its corresponding 32-bit
  *        representation.
@@ -0,0 +1,199 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/packed.h
+ *
+ * @brief Packed storage for symmetric and triangular matrices
+ *
+ * A packed matrix of order n stores only the n * (n + 1) / 2 elements of one
+ * triangle, halving the memory of a dense matrix_t. Rows of the triangle are
+ * stored contiguously in row-major order, so kernels stream them like the
+ * rows of a dense matrix:
+ *
+ * - lower triangles, including symmetric matrices, store row i as the i + 1
+ *   elements (i, 0) through (i, i), starting at offset i * (i + 1) / 2.
+ * - upper triangles store row i as the n - i elements (i, i) through
+ *   (i, n - 1), starting at offset i * n - i * (i - 1) / 2.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_PACKED_H
+#define LINEAR_PACKED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Define the structure of a packed matrix
+ *
+ * @param PACKED_SYMMETRIC Symmetric, storing the lower triangle
+ * @param PACKED_LOWER     Lower triangular, zero above the diagonal
+ * @param PACKED_UPPER     Upper triangular, zero below the diagonal
+ * @param PACKED_COUNT     Number of packed structures
+ */
+typedef enum PackedKind {
+    PACKED_SYMMETRIC, // Symmetric, storing the lower triangle
+    PACKED_LOWER,     // Lower triangular
+    PACKED_UPPER,     // Upper triangular
+    PACKED_COUNT,     // Number of packed structures
+} packed_kind_t;
+
+/**
+ * @brief A square matrix storing a single triangle of elements.
+ *
+ * @param data  The n * (n + 1) / 2 elements of the triangle, see above.
+ * @param order The number of rows, and columns, n of the matrix.
+ * @param kind  The structure of the matrix.
+ */
+typedef struct Packed {
+    float*        data;  ///< Rows of the stored triangle, back to back.
+    uint32_t      order; ///< Number of rows and columns.
+    packed_kind_t kind;  ///< Structure of the matrix.
+} packed_t;
+
+// Lifecycle management
+
+/**
+ * @brief Create a zero initialized packed matrix using the given context
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param order   The number of rows, and columns, of the matrix.
+ * @param kind    The structure of the matrix.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note Packed matrices must be freed with packed_free_ctx().
+ */
+packed_t* packed_create_ctx(
+    linear_context_t* context, uint32_t order, packed_kind_t kind
+);
+void packed_free_ctx(linear_context_t* context, packed_t* packed);
+
+// Element Access
+
+// Number of stored elements, order * (order + 1) / 2
+size_t packed_element_count(const packed_t* packed);
+
+/**
+ * @brief Access an element by its row and column in the full matrix.
+ *
+ * Symmetric matrices mirror elements across the diagonal, so (i, j) and
+ * (j, i) are the same stored element. Getting an element outside the
+ * triangle of a triangular matrix returns zero, setting one fails.
+ */
+float packed_element_get(
+    const packed_t* packed, uint32_t row, uint32_t column
+);
+bool packed_element_set(
+    packed_t* packed, uint32_t row, uint32_t column, float value
+);
+
+// Conversion
+
+/**
+ * @brief Pack the triangle of a square matrix.
+ *
+ * Symmetric packing keeps the lower triangle and ignores the upper one,
+ * triangular packing ignores the other triangle.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param matrix  A square matrix.
+ * @param kind    The structure of the packed matrix.
+ *
+ * @return A new packed matrix, or NULL upon failure
+ */
+packed_t* packed_from_matrix_ctx(
+    linear_context_t* context, const matrix_t* matrix, packed_kind_t kind
+);
+
+/**
+ * @brief Unpack into a new dense matrix, mirroring symmetric matrices.
+ *
+ * @return A new matrix, freed with matrix_free_ctx(), or NULL upon failure
+ */
+matrix_t*
+packed_to_matrix_ctx(linear_context_t* context, const packed_t* packed);
+
+// Products
+
+/**
+ * @brief Symmetric matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * Rows of the packed triangle are split across the pool into ranges holding
+ * about as many elements, and each row contributes to y both as a row and as
+ * the mirrored column, so a is read once, contiguously.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and x.
+ * @param a       A PACKED_SYMMETRIC matrix of order n.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param beta    Scales y before accumulating, 0 overwrites y.
+ * @param y       A NUMERIC_FLOAT32 vector with n elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool packed_symv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const packed_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+/**
+ * @brief Symmetric matrix multiply, c = alpha * a * b + beta * c.
+ *
+ * Columns of b and c are split across the pool, each task streaming the
+ * packed triangle once.
+ *
+ * @param a A PACKED_SYMMETRIC matrix of order n.
+ * @param b An n x m matrix.
+ * @param c An n x m matrix, distinct from b.
+ *
+ * @return true on success, false otherwise
+ */
+bool packed_symm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const packed_t*   a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+);
+
+/**
+ * @brief Triangular matrix-vector multiply, y = a * x.
+ *
+ * Unlike the in-place BLAS TRMV, the product is written to y so that rows
+ * can be split across the pool without reading elements of x already
+ * overwritten by another task.
+ *
+ * @param a A PACKED_LOWER or PACKED_UPPER matrix of order n.
+ * @param x A NUMERIC_FLOAT32 vector with n elements.
+ * @param y A NUMERIC_FLOAT32 vector with n elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool packed_trmv_ctx(
+    linear_context_t* context,
+    const packed_t*   a,
+    const vector_t*   x,
+    vector_t*         y
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_PACKED_H
@@ -46,4 +46,18 @@ void tensor_random_fill(tensor_t* tensor, const float min, const float max);
 tensor_t* tensor_deep_copy(const tensor_t* tensor);
 tensor_t* tensor_shallow_copy(const tensor_t* tensor);
 
+// Non-finite detection and sanitization, over the elements as a flat vector
+// with at most UINT32_MAX elements, see vector_all_finite_ctx()
+bool tensor_all_finite_ctx(linear_context_t* context, const tensor_t* tensor);
+uint32_t
+tensor_count_nonfinite_ctx(linear_context_t* context, const tensor_t* tensor);
+bool tensor_nan_to_num_ctx(
+    linear_context_t* context,
+    tensor_t*         tensor,
+    float             nan,
+    float             posinf,
+    float             neginf
+);
+bool tensor_ingest_ctx(linear_context_t* context, tensor_t* tensor);
+
 #endif // LINEAR_TENSOR_H
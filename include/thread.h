@@ -23,6 +23,8 @@ extern "C" {
 #include "scalar.h"
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -32,8 +34,9 @@ extern "C" {
  * @param LINEAR_THREAD_COUNT The number of CPU threads to utilize
  *
  * @note The thread count should always be configurable.
- * @note `get_nprocs_conf()` is GNU-specific and not available if GNU C is
- * unavailable. Testing for __linux__ becomes moot as a result.
+ * @note The default is resolved at runtime by `linear_thread_count()` which
+ *       honors the process affinity mask and the cgroup CPU quota rather than
+ *       the number of configured processors.
  *
  * @ref See GNU C Extensions for more information
  * - https://gcc.gnu.org/onlinedocs/gcc-12.2.0/gcc/C-Extensions.html
@@ -41,16 +44,25 @@ extern "C" {
  * - https://stackoverflow.com/a/26225829/20035933
  */
 #ifndef LINEAR_THREAD_COUNT
-    #ifdef __GNUC__ // GNU C Only
-        #include <sys/sysinfo.h>
-        #define LINEAR_THREAD_COUNT get_nprocs_conf()
-    #elif _POSIX_VERSION // POSIX Only
-        #include <unistd.h>
-        #define LINEAR_THREAD_COUNT sysconf(_SC_NPROCESSORS_ONLN)
-    #else // Unknown/Unsupported
-        #define LINEAR_THREAD_COUNT 8
-    #endif // __GNUC__
-#endif     // LINEAR_THREAD_COUNT
+    #define LINEAR_THREAD_COUNT linear_thread_count()
+#endif // LINEAR_THREAD_COUNT
+
+/**
+ * @brief Environment variable used to override the default thread count
+ *
+ * @note e.g. `LINEAR_NUM_THREADS=4 ./app` pins every default sized pool to 4
+ *       workers regardless of affinity or quota.
+ */
+#ifndef LINEAR_THREAD_COUNT_ENV
+    #define LINEAR_THREAD_COUNT_ENV "LINEAR_NUM_THREADS"
+#endif // LINEAR_THREAD_COUNT_ENV
+
+/**
+ * @brief Fallback thread count when the platform cannot be queried
+ */
+#ifndef LINEAR_THREAD_COUNT_FALLBACK
+    #define LINEAR_THREAD_COUNT_FALLBACK 8
+#endif // LINEAR_THREAD_COUNT_FALLBACK
 
 #ifndef LINEAR_MESSAGE_QUEUE_NAME
     #define LINEAR_MESSAGE_QUEUE_NAME "linear_thread_pool"
@@ -61,6 +73,63 @@ extern "C" {
     #define LINEAR_MESSAGE_QUEUE_MAX_SIZE 1024
 #endif // LINEAR_MESSAGE_QUEUE_MAX_SIZE
 
+/**
+ * @brief Capacity of each task queue within a thread pool
+ *
+ * @note Submitting to a full queue blocks until a worker dequeues a task.
+ * @note Must be a power of two, so ring positions map to slots with a mask.
+ */
+#ifndef LINEAR_THREAD_QUEUE_SIZE
+    #define LINEAR_THREAD_QUEUE_SIZE 256
+#endif // LINEAR_THREAD_QUEUE_SIZE
+
+#if (LINEAR_THREAD_QUEUE_SIZE & (LINEAR_THREAD_QUEUE_SIZE - 1)) != 0
+    #error "LINEAR_THREAD_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Maximum number of consecutive dequeues that may bypass a non-empty
+ *        lower priority queue before it is served
+ *
+ * @note Lower values favor fairness, higher values favor latency.
+ */
+#ifndef LINEAR_THREAD_STARVATION_LIMIT
+    #define LINEAR_THREAD_STARVATION_LIMIT 8
+#endif // LINEAR_THREAD_STARVATION_LIMIT
+
+/**
+ * @brief Number of busy-wait iterations before a team barrier yields the CPU
+ *
+ * @note Spinning keeps the latency of a barrier below a microsecond while the
+ *       team is running; yielding keeps oversubscribed hosts progressing.
+ */
+#ifndef LINEAR_THREAD_SPIN_LIMIT
+    #define LINEAR_THREAD_SPIN_LIMIT 4096
+#endif // LINEAR_THREAD_SPIN_LIMIT
+
+/**
+ * @brief Size of a cache line, used to keep per-member team state apart
+ */
+#ifndef LINEAR_CACHE_LINE_SIZE
+    #define LINEAR_CACHE_LINE_SIZE 64
+#endif // LINEAR_CACHE_LINE_SIZE
+
+/**
+ * @brief Alignment of every scratch allocation, suited to aligned vector loads
+ *
+ * @note Must be a power of two.
+ */
+#ifndef LINEAR_THREAD_SCRATCH_ALIGNMENT
+    #define LINEAR_THREAD_SCRATCH_ALIGNMENT LINEAR_CACHE_LINE_SIZE
+#endif // LINEAR_THREAD_SCRATCH_ALIGNMENT
+
+/**
+ * @brief Size in bytes of the first block of a scratch workspace
+ */
+#ifndef LINEAR_THREAD_SCRATCH_SIZE
+    #define LINEAR_THREAD_SCRATCH_SIZE (64 * 1024)
+#endif // LINEAR_THREAD_SCRATCH_SIZE
+
 /**
  * @brief Define the linear device type
  *
@@ -79,6 +148,24 @@ typedef enum ThreadBackend {
     BACKEND_COUNT   // Number of supported devices
 } thread_backend_t;
 
+/**
+ * @brief Define the type of a CPU core on hybrid processors
+ *
+ * @param THREAD_CORE_ANY         Any core; also the type of every core on
+ *                                processors with a single core type
+ * @param THREAD_CORE_PERFORMANCE Performance cores, e.g. Intel P-cores or Arm
+ *                                big cores
+ * @param THREAD_CORE_EFFICIENCY  Efficiency cores, e.g. Intel E-cores or Arm
+ *                                LITTLE cores
+ * @param THREAD_CORE_COUNT       Number of core types
+ */
+typedef enum ThreadCore {
+    THREAD_CORE_ANY,         // Any core
+    THREAD_CORE_PERFORMANCE, // Performance cores
+    THREAD_CORE_EFFICIENCY,  // Efficiency cores
+    THREAD_CORE_COUNT,       // Number of core types
+} thread_core_t;
+
 /**
  * @brief Generalized thread structure using void pointers
  *
@@ -89,8 +176,40 @@ typedef enum ThreadBackend {
  * @param end Ending index for the thread to operate
  * @param type The data type for the operation
  * @param operation Pointer to the generalized operation function
+ * @param routine Optional range kernel executed instead of the operation
+ * @param deadline Absolute CLOCK_MONOTONIC deadline in nanoseconds, 0 for none
+ * @param cancel Optional callback invoked instead of executing an expired task
+ * @param group Optional group notified once the task completes
  */
-typedef struct ThreadData {
+typedef struct ThreadData thread_data_t;
+
+/**
+ * @brief Completion counter shared by a set of related tasks
+ *
+ * Submitting a task with a group increments its pending count, which is
+ * decremented once the task completes or is cancelled. Waiting on a group only
+ * waits for its own tasks, so independent, and nested, parallel operations may
+ * share a pool without waiting on each other.
+ *
+ * @param pending Number of submitted tasks that have not completed
+ *
+ * @note Zero initialize before use, e.g. `thread_group_t group = {0};`.
+ */
+typedef struct ThreadGroup {
+    atomic_uint pending; // Number of outstanding tasks
+} thread_group_t;
+
+/**
+ * @brief Range kernel executed by a worker thread
+ *
+ * A routine processes the half-open interval [begin, end) of the given task,
+ * typically applying task->operation element-wise over task->a and task->b.
+ *
+ * @param task The task describing the operands and range
+ */
+typedef void (*thread_routine_t)(thread_data_t* task);
+
+struct ThreadData {
     void*              a;         // Pointer to the first operand
     void*              b;         // Pointer to the second operand
     void*              result;    // Pointer to the resultant data
@@ -98,44 +217,590 @@ typedef struct ThreadData {
     uint32_t           end;       // Threads ending index
     numeric_data_t     type;      // The operations data type
     scalar_operation_t operation; // Pointer to the operation function
-} thread_data_t;
+    thread_routine_t   routine;   // Pointer to the range kernel, if any
+    uint64_t           deadline;  // Monotonic deadline in ns, 0 for none
+    thread_routine_t   cancel;    // Invoked if the deadline has passed
+    thread_group_t*    group;     // Notified upon completion, if any
+};
+
+/**
+ * @brief Define the priority class of a task
+ *
+ * Workers always prefer the highest non-empty class, except that a lower
+ * class is served once it has been bypassed LINEAR_THREAD_STARVATION_LIMIT
+ * consecutive times, so background work still progresses under load.
+ *
+ * @param THREAD_PRIORITY_HIGH   Latency-critical tasks
+ * @param THREAD_PRIORITY_NORMAL Default tasks
+ * @param THREAD_PRIORITY_LOW    Background and batch tasks
+ * @param THREAD_PRIORITY_COUNT  Number of priority classes
+ */
+typedef enum ThreadPriority {
+    THREAD_PRIORITY_HIGH,   // Latency-critical tasks
+    THREAD_PRIORITY_NORMAL, // Default tasks
+    THREAD_PRIORITY_LOW,    // Background and batch tasks
+    THREAD_PRIORITY_COUNT,  // Number of priority classes
+} thread_priority_t;
+
+/**
+ * @brief Slot of a task queue
+ *
+ * The sequence number tells producers and consumers whose turn it is: a slot
+ * at position pos is free to enqueue once its sequence equals pos, and holds a
+ * task ready to dequeue once its sequence equals pos + 1. Dequeuing advances
+ * the sequence to pos + queue_size, freeing the slot for the next lap.
+ *
+ * @param sequence Position the slot is ready for
+ * @param task     The queued task
+ */
+typedef struct ThreadSlot {
+    atomic_size_t sequence; // Position the slot is ready for
+    thread_data_t task;     // The queued task
+} thread_slot_t;
+
+/**
+ * @brief Bounded lock-free MPMC FIFO ring of tasks sharing a priority class
+ *
+ * Producers reserve slots by advancing tail and consumers claim them by
+ * advancing head, each with a single compare-and-swap, so neither submitting
+ * nor dequeuing takes the queue_mutex of the pool.
+ *
+ * @param slots   Array of queue_size slots
+ * @param head    Position of the next task to dequeue
+ * @param tail    Position of the next slot to enqueue
+ * @param skipped Consecutive dequeues that bypassed this queue while pending
+ *
+ * @note head and tail are a cache line apart, so consumers and producers do
+ *       not invalidate each other.
+ */
+typedef struct ThreadQueue {
+    thread_slot_t* slots;   // Array of slots
+    atomic_size_t  head;    // Position of the next task to dequeue
+    char           padding[LINEAR_CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+    atomic_size_t  tail;    // Position of the next slot to enqueue
+    atomic_uint    skipped; // Consecutive times bypassed while pending
+} thread_queue_t;
+
+typedef struct ThreadScratchBlock thread_scratch_block_t;
+
+/**
+ * @brief Growable stack of scratch memory owned by a single thread
+ *
+ * Allocations are bumped off the current block and released in LIFO order
+ * back to a mark. A workspace outgrowing its block chains a larger one, and
+ * once it is empty again the chain is replaced by a single block covering the
+ * peak, so repeated calls of the same shape allocate nothing.
+ *
+ * @param block    Current block, earlier blocks are chained behind it
+ * @param used     Bytes allocated, which is the mark of the next allocation
+ * @param peak     Most bytes allocated at once since the last trim
+ * @param capacity Bytes held by every block
+ * @param epoch    Last trim request of the pool that was honored
+ * @param trim     Flag set while a trim request waits for the stack to empty
+ */
+typedef struct ThreadScratch {
+    thread_scratch_block_t* block;    // Current block
+    size_t                  used;     // Bytes allocated
+    size_t                  peak;     // Most bytes allocated at once
+    atomic_size_t           capacity; // Bytes held by every block
+    uint32_t                epoch;    // Last honored trim request
+    bool                    trim;     // Trim once the stack is empty
+} thread_scratch_t;
 
 /**
  * @brief Thread pool structure
  *
  * Manages a pool of threads and tasks.
  *
+ * @param queues         Task queues indexed by priority class
  * @param threads        Array of threads
- * @param task_queue     Task queue
- * @param queue_size     Max queue size
- * @param task_count     Current task count
- * @param head           Index of the queue head
- * @param tail           Index of the queue tail
- * @param queue_mutex    Mutex for synchronizing access to the task queue
+ * @param queue_mutex    Mutex guarding workers and waiters going to sleep
+ * @param region_mutex   Mutex serializing parallel regions over the pool
+ * @param start_mutex    Mutex serializing the spawning of deferred workers
  * @param task_available Condition variable to signal the availability of tasks
- * @param task_done      Condition variable to signal all tasks completed
+ * @param task_done      Condition variable to signal a task was dequeued or
+ *                       all tasks completed
+ * @param queue_size     Max queue size of each priority class
+ * @param task_count     Current task count over all priority classes
+ * @param active_count   Number of tasks currently executing
+ * @param waiting_count  Number of workers executing tasks while they wait
+ * @param nested_count   Number of workers waiting within thread_pool_wait
+ * @param idle_count     Number of workers asleep on task_available
+ * @param blocked_count  Number of submitters asleep on a full queue
  * @param thread_count   Number of worker threads
+ * @param expired_count  Number of tasks cancelled for missing their deadline
  * @param stop           Flag to stop the pool
+ * @param fixed          Flag set when the thread count was given explicitly
+ * @param cores          Type of the cores the workers are restricted to
+ * @param scratch        Scratch workspaces indexed by worker
+ * @param members        Team member state of the running parallel region
+ * @param spawned_count  Number of workers that claimed a scratch workspace
+ * @param trim_epoch     Number of trim requests made to the workers
+ * @param started        Flag set while the workers are running
+ * @param next           Next pool in the registry used by the fork handlers
+ */
+typedef struct ThreadPool thread_pool_t;
+
+typedef struct ThreadTeamMember thread_team_member_t;
+
+struct ThreadPool {
+    thread_queue_t        queues[THREAD_PRIORITY_COUNT]; // Queues by priority
+    pthread_t*            threads;        // Array of threads
+    pthread_mutex_t       queue_mutex;    // Guards going to sleep
+    pthread_mutex_t       region_mutex;   // Serializes parallel regions
+    pthread_mutex_t       start_mutex;    // Serializes spawning the workers
+    pthread_cond_t        task_available; // Signals the availability of tasks
+    pthread_cond_t        task_done;      // Signals dequeued or finished tasks
+    uint32_t              queue_size;     // Max queue size per priority
+    atomic_uint           task_count;     // Current task count
+    atomic_uint           active_count;   // Number of tasks executing
+    atomic_uint           waiting_count;  // Workers helping while waiting
+    atomic_uint           nested_count;   // Workers in thread_pool_wait
+    atomic_uint           idle_count;     // Number of workers asleep
+    atomic_uint           blocked_count;  // Number of submitters asleep
+    uint32_t              thread_count;   // Number of worker threads
+    atomic_ullong         expired_count;  // Tasks that missed a deadline
+    int                   stop;           // Flag to stop the pool
+    bool                  fixed;          // Thread count was given explicitly
+    thread_core_t         cores;          // Core type the workers may run on
+    thread_scratch_t*     scratch;        // Scratch workspaces by worker
+    thread_team_member_t* members;        // Members of the running region
+    atomic_uint           spawned_count;  // Workers that claimed a workspace
+    atomic_uint           trim_epoch;     // Trim requests made to the workers
+    atomic_bool           started;        // Workers are running
+    thread_pool_t*        next;           // Next pool in the fork registry
+};
+
+// Thread count detection
+
+/**
+ * @brief Number of CPUs this process may run on
+ *
+ * Counts the CPUs within the scheduler affinity mask of the calling process,
+ * falling back to the number of online processors.
+ *
+ * @return The number of usable CPUs, at least 1
+ */
+uint32_t linear_thread_affinity_count(void);
+
+/**
+ * @brief Number of CPUs granted by the cgroup CPU quota
+ *
+ * Reads `cpu.max` for cgroup v2 and `cpu.cfs_quota_us`/`cpu.cfs_period_us`
+ * for cgroup v1. Fractional quotas are rounded up, e.g. 2.5 CPUs become 3.
+ * Under cgroup v2 every cgroup from that of the process up to the root is
+ * read and the smallest quota wins, so the quota of an enclosing systemd
+ * slice or Kubernetes pod is honored.
+ *
+ * @return The quota in whole CPUs, or 0 if no quota is imposed
+ */
+uint32_t linear_thread_quota_count(void);
+
+/**
+ * @brief Default number of worker threads
+ *
+ * Resolves, in order of precedence, the `LINEAR_THREAD_COUNT_ENV` override,
+ * then the lesser of the affinity count and the cgroup quota. The result is
+ * cached after the first call.
+ *
+ * @return The default thread count, at least 1
+ *
+ * @note Use `linear_thread_count_refresh()` to observe quota changes.
+ */
+uint32_t linear_thread_count(void);
+
+/**
+ * @brief Recompute and cache the default number of worker threads
+ *
+ * @return The refreshed default thread count, at least 1
  */
-typedef struct ThreadPool {
-    thread_data_t*  task_queue;     // Array of threads
-    pthread_t*      threads;        // Task queue
-    pthread_mutex_t queue_mutex;    // Max queue size
-    pthread_cond_t  task_available; // Current task count
-    pthread_cond_t  task_done;      // Index of the queue head
-    uint32_t        queue_size;     // Index of the queue tail
-    uint32_t        task_count;     // Mutex for synchronizing access
-    uint32_t        head;           // Signals the availability of tasks
-    uint32_t        tail;           // Signals all tasks completed
-    uint32_t        thread_count;   // Number of worker threads
-    int             stop;           // Flag to stop the pool
-} thread_pool_t;
+uint32_t linear_thread_count_refresh(void);
+
+// Hybrid core detection
+
+/**
+ * @brief Type of the given logical CPU
+ *
+ * Detected from sysfs, in order of precedence, by the Intel hybrid PMU lists
+ * `/sys/devices/cpu_core/cpus` and `/sys/devices/cpu_atom/cpus`, then the Arm
+ * `cpu_capacity` of each CPU, then the maximum frequency of each CPU. CPUs of
+ * the highest capacity or frequency are performance cores.
+ *
+ * @return THREAD_CORE_PERFORMANCE or THREAD_CORE_EFFICIENCY on hybrid
+ *         processors, THREAD_CORE_ANY otherwise
+ */
+thread_core_t linear_thread_core_type(uint32_t cpu);
+
+/**
+ * @brief Whether this process may run on more than one type of core
+ */
+bool linear_thread_is_hybrid(void);
+
+/**
+ * @brief Number of CPUs of the given type within the affinity mask
+ *
+ * @return The number of CPUs, THREAD_CORE_ANY counts every usable CPU
+ */
+uint32_t linear_thread_core_count(thread_core_t type);
 
 // Function prototypes for thread pool API
 thread_pool_t* thread_pool_create(uint32_t num_threads);
+
+/**
+ * @brief Create a thread pool whose workers are spawned upon first use
+ *
+ * No threads are created until the first task is submitted, so a process may
+ * configure its pools once and fork before any worker exists, e.g. a prefork
+ * server initializing its libraries in the parent.
+ *
+ * @param num_threads The number of workers, 0 selects LINEAR_THREAD_COUNT
+ *
+ * @return A pointer to the new pool, or NULL upon failure
+ *
+ * @note Every pool is fork-safe regardless of how it was created. A fork
+ *       handler holds the queues of every pool while the address space is
+ *       copied, and the child resets each pool to the deferred state, so its
+ *       workers are spawned again upon first use. Tasks queued or executing
+ *       in the parent at the time of the fork do not carry over to the child.
+ */
+thread_pool_t* thread_pool_create_deferred(uint32_t num_threads);
+
 void           thread_pool_free(thread_pool_t* pool);
 void           thread_pool_submit(thread_pool_t* pool, thread_data_t task);
-void           thread_pool_wait(thread_pool_t* pool);
+
+/**
+ * @brief Wait for all submitted tasks to complete
+ *
+ * When called from one of the pool's own workers, e.g. by a task that
+ * submitted subtasks, the worker executes pending tasks while it waits rather
+ * than idle, and returns once every task still executing is itself waiting.
+ * Prefer thread_group_wait() to wait for a specific set of tasks.
+ *
+ * @param pool The pool to wait on
+ *
+ * @note Must not be called from within a parallel region over the pool,
+ *       whose members count as executing tasks until the region ends.
+ */
+void thread_pool_wait(thread_pool_t* pool);
+
+/**
+ * @brief Wait for every task submitted with the given group to complete
+ *
+ * When called from one of the pool's own workers, the worker executes pending
+ * tasks, of any group, while it waits. Tasks running on the pool may therefore
+ * submit subtasks and wait on them without deadlocking, even when every worker
+ * is doing the same. The leader of a parallel region over the pool helps in
+ * the same way, since the workers of its team never return to the queues.
+ * Other threads block until the group completes.
+ *
+ * @param pool  The pool the tasks were submitted to
+ * @param group The group to wait on
+ */
+void thread_group_wait(thread_pool_t* pool, thread_group_t* group);
+
+/**
+ * @brief Whether the calling thread is one of the pool's workers
+ */
+bool thread_pool_is_worker(const thread_pool_t* pool);
+
+/**
+ * @brief Whether the calling thread leads a parallel region over the pool
+ */
+bool thread_pool_is_leader(const thread_pool_t* pool);
+
+/**
+ * @brief Submit a task to the queue of the given priority class
+ *
+ * Blocks while the queue of the priority class is full. thread_pool_submit()
+ * is equivalent to submitting with THREAD_PRIORITY_NORMAL.
+ *
+ * If task.deadline is non-zero and has passed by the time a worker dequeues
+ * the task, the task is not executed; task.cancel is invoked instead, if set.
+ *
+ * If task.group is set, its pending count is incremented until the task
+ * completes. A worker submitting to a full queue executes pending tasks until
+ * a slot is available rather than block.
+ *
+ * @param pool     The pool to submit to
+ * @param task     The task to execute
+ * @param priority The priority class of the task
+ */
+void thread_pool_submit_priority(
+    thread_pool_t* pool, thread_data_t task, thread_priority_t priority
+);
+
+/**
+ * @brief Submit a batch of tasks to the queue of the given priority class
+ *
+ * The tasks are enqueued under a single reservation of consecutive slots and
+ * the sleeping workers are woken once for the whole batch, rather than paying
+ * a compare-and-swap and a wakeup per task. Batches larger than the free
+ * capacity of the queue are enqueued in as few reservations as possible.
+ *
+ * @param pool     The pool to submit to
+ * @param tasks    Array of count tasks, copied into the queue
+ * @param count    The number of tasks
+ * @param priority The priority class of every task
+ *
+ * @note Blocks while the queue is full, as thread_pool_submit_priority() does.
+ */
+void thread_pool_submit_batch(
+    thread_pool_t*       pool,
+    const thread_data_t* tasks,
+    uint32_t             count,
+    thread_priority_t    priority
+);
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in nanoseconds
+ */
+uint64_t thread_clock_now(void);
+
+/**
+ * @brief Absolute deadline the given number of nanoseconds from now
+ */
+uint64_t thread_deadline_after(uint64_t nanoseconds);
+
+/**
+ * @brief Execute a task on the calling thread
+ *
+ * Runs task->routine if one is set, otherwise task->operation.
+ *
+ * @param task The task to execute
+ */
+void thread_task_execute(thread_data_t* task);
+
+/**
+ * @brief Resize the number of worker threads within the pool
+ *
+ * Pending tasks are drained before the workers are replaced.
+ *
+ * @param pool        The pool to resize
+ * @param num_threads The new number of workers, 0 selects the default
+ *
+ * @return true on success, false otherwise
+ *
+ * @note Must not be called from within one of the pool's own workers.
+ */
+bool thread_pool_resize(thread_pool_t* pool, uint32_t num_threads);
+
+/**
+ * @brief Resize the pool to match the current default thread count
+ *
+ * Refreshes the affinity and quota derived thread count and resizes the pool
+ * if it changed. Intended to be polled periodically by the owner of the pool,
+ * e.g. from a maintenance timer, so containers that have their CPU quota
+ * adjusted at runtime stop oversubscribing.
+ *
+ * @param pool The pool to refresh
+ *
+ * @return true if the pool was resized, false otherwise
+ *
+ * @note Pools created with an explicit thread count are left untouched.
+ */
+bool thread_pool_refresh(thread_pool_t* pool);
+
+/**
+ * @brief Restrict the workers of the pool to a type of core
+ *
+ * Intended for pools serving latency-critical ops on hybrid processors, which
+ * should not be slowed by a straggling efficiency core. Applies immediately to
+ * running workers and upon spawning to deferred or forked pools.
+ *
+ * @param pool  The pool to restrict
+ * @param cores The type of core, THREAD_CORE_ANY lifts the restriction
+ *
+ * @return true on success, false if no usable CPU is of the given type
+ *
+ * @note Has no effect on processors with a single core type.
+ */
+bool thread_pool_set_cores(thread_pool_t* pool, thread_core_t cores);
+
+// Scratch workspaces
+
+/**
+ * @brief Current mark of the calling thread's scratch workspace
+ *
+ * A worker of the given pool uses the workspace the pool keeps for it, any
+ * other thread, or any thread when pool is NULL, uses its own thread-local
+ * workspace. Pass the mark to thread_scratch_release() once done.
+ *
+ * @param pool The pool the caller may be a worker of, or NULL
+ *
+ * @return The number of bytes currently allocated from the workspace
+ */
+size_t thread_scratch_mark(thread_pool_t* pool);
+
+/**
+ * @brief Allocate scratch memory from the calling thread's workspace
+ *
+ * The memory is aligned to LINEAR_THREAD_SCRATCH_ALIGNMENT and uninitialized.
+ * It remains valid until the workspace is released to a mark taken before it,
+ * so kernels nested on the same thread, e.g. tasks executed while helping,
+ * may allocate on top of it.
+ *
+ * @param pool The pool the caller may be a worker of, or NULL
+ * @param size The number of bytes to allocate
+ *
+ * @return Pointer to the memory, or NULL upon failure
+ *
+ * @note Steady state calls allocate nothing once the workspace covers them.
+ */
+void* thread_scratch_alloc(thread_pool_t* pool, size_t size);
+
+/**
+ * @brief Release every scratch allocation made after the given mark
+ *
+ * @param pool The pool given to thread_scratch_mark()
+ * @param mark The mark returned by thread_scratch_mark()
+ */
+void thread_scratch_release(thread_pool_t* pool, size_t mark);
+
+/**
+ * @brief Return the scratch memory of a pool's workers to the system
+ *
+ * Intended for memory pressure. Idle workers free their workspace before
+ * going back to sleep, busy workers once their workspace is empty. The
+ * calling thread's own workspace is trimmed as well.
+ *
+ * @param pool The pool to trim, or NULL to trim the calling thread only
+ */
+void thread_pool_trim(thread_pool_t* pool);
+
+/**
+ * @brief Bytes of scratch memory currently held by a pool's workers
+ */
+size_t thread_pool_scratch_size(thread_pool_t* pool);
+
+// Parallel regions
+
+/**
+ * @brief Sense-reversing spin barrier
+ *
+ * The last member to arrive resets the count and flips the shared sense,
+ * releasing the members spinning on it. Each member tracks its own sense, so
+ * the barrier may be reused immediately without a second rendezvous.
+ *
+ * @param remaining Number of members yet to arrive
+ * @param sense     Flipped each time every member has arrived
+ * @param size      Number of members
+ */
+typedef struct ThreadBarrier {
+    atomic_uint remaining; // Members yet to arrive
+    atomic_bool sense;     // Flipped once every member arrived
+    uint32_t    size;      // Number of members
+} thread_barrier_t;
+
+/**
+ * @brief Per-member state of a team, padded to a cache line
+ *
+ * @param partials   Double buffered reduction slots
+ * @param reductions Number of reductions the member took part in
+ * @param sense      Local sense of the member for the team barrier
+ */
+struct ThreadTeamMember {
+    _Alignas(LINEAR_CACHE_LINE_SIZE) float partials[2]; // Reduction slots
+    uint32_t reductions; // Reductions taken part in
+    bool     sense;      // Local barrier sense
+};
+
+typedef struct ThreadTeam thread_team_t;
+
+/**
+ * @brief Function executed by every member of a parallel region
+ *
+ * @param team The team executing the region
+ * @param id   The member id within [0, team size)
+ * @param arg  The argument given to the region
+ */
+typedef void (*thread_region_t)(thread_team_t* team, uint32_t id, void* arg);
+
+/**
+ * @brief A fixed set of threads executing a parallel region
+ *
+ * Member 0 is the thread that entered the region, the remaining members are
+ * pool workers held for the whole region.
+ *
+ * @param barrier The team barrier
+ * @param members Per-member state indexed by id
+ * @param joined  Number of workers that began executing the region
+ * @param size    Number of members
+ * @param region  The function every member executes
+ * @param arg     The argument forwarded to the region
+ */
+struct ThreadTeam {
+    thread_barrier_t      barrier; // The team barrier
+    thread_team_member_t* members; // Per-member state
+    atomic_uint           joined;  // Workers that began the region
+    uint32_t              size;    // Number of members
+    thread_region_t       region;  // Executed by every member
+    void*                 arg;     // Forwarded to the region
+};
+
+/**
+ * @brief Execute a function on a team of threads
+ *
+ * Unlike submitting a task per phase, the team is assembled once and phases
+ * synchronize through thread_team_barrier() and the team reductions, which
+ * spin rather than sleep and cost well under a microsecond when the team has
+ * dedicated cores. Suited to iterative algorithms such as power iteration,
+ * conjugate gradients and k-means that alternate short parallel phases.
+ *
+ * The calling thread becomes member 0 and at most thread_count workers join
+ * it. Regions over the same pool are serialized, so concurrent regions never
+ * hold part of a team each.
+ *
+ * @param pool      The pool providing the team, or NULL to run serially
+ * @param team_size Requested number of members, 0 for every worker plus the
+ *                  calling thread
+ * @param region    The function every member executes
+ * @param arg       Forwarded to the region
+ *
+ * @return The number of members that executed the region, 0 upon failure
+ *
+ * @note A region entered from one of the pool's own workers, or nested in a
+ *       region over the same pool, runs with a team of one, since the
+ *       workers the team would spin on are held or may be waiting on the
+ *       caller.
+ * @note Member 0 may run parallel ops over the pool, e.g. a GEMM through a
+ *       linear_context_t, which then execute on the calling thread alone.
+ *       Other members must not, nor may any member wait on the whole pool
+ *       with thread_pool_wait().
+ */
+uint32_t thread_pool_region(
+    thread_pool_t* pool, uint32_t team_size, thread_region_t region, void* arg
+);
+
+/**
+ * @brief Wait for every member of the team to arrive
+ */
+void thread_team_barrier(thread_team_t* team, uint32_t id);
+
+/**
+ * @brief Sum a value over every member of the team
+ *
+ * Acts as a barrier. Every member receives the same result, accumulated in
+ * member order so it is reproducible for a given team size.
+ */
+float thread_team_reduce_sum(thread_team_t* team, uint32_t id, float value);
+
+/**
+ * @brief Maximum of a value over every member of the team
+ *
+ * Acts as a barrier. Every member receives the same result.
+ */
+float thread_team_reduce_max(thread_team_t* team, uint32_t id, float value);
+
+/**
+ * @brief Static share [begin, end) of count elements assigned to a member
+ */
+void thread_team_range(
+    const thread_team_t* team,
+    uint32_t             id,
+    uint32_t             count,
+    uint32_t*            begin,
+    uint32_t*            end
+);
 
 // Additional utilities and operations
 thread_data_t* thread_create(uint32_t num_threads);
@@ -0,0 +1,256 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file include/toeplitz.h
+ *
+ * @brief Toeplitz and circulant matrices stored by their defining vectors
+ *
+ * A Toeplitz matrix is constant along each diagonal, a[i][j] = t[i - j], so
+ * an n x n matrix is defined by its 2n - 1 diagonals. A circulant matrix
+ * further wraps its diagonals around, a[i][j] = c[(i - j) mod n], and is
+ * defined by its first column alone. Both take O(n) memory instead of
+ * O(n * n).
+ *
+ * Products are convolutions of the defining vector with the operand, taken
+ * by FFT in O(n log n) once the order exceeds LINEAR_TOEPLITZ_DIRECT.
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#ifndef LINEAR_TOEPLITZ_H
+#define LINEAR_TOEPLITZ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "context.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief A square matrix constant along its diagonals.
+ *
+ * @param data  The 2n - 1 diagonals, a[i][j] = data[n - 1 + i - j], so the
+ *              first row reversed is followed by the rest of the first column.
+ * @param order The number of rows, and columns, n.
+ */
+typedef struct Toeplitz {
+    float*   data;  ///< Diagonals, from the top right to the bottom left.
+    uint32_t order; ///< Number of rows and columns.
+} toeplitz_t;
+
+/**
+ * @brief A square matrix whose rows are cyclic shifts of each other.
+ *
+ * @param data  The first column c, a[i][j] = c[(i - j) mod n].
+ * @param order The number of rows, and columns, n.
+ */
+typedef struct Circulant {
+    float*   data;  ///< First column.
+    uint32_t order; ///< Number of rows and columns.
+} circulant_t;
+
+/**
+ * @brief Largest order whose products are summed directly
+ *
+ * @note Below a few dozen elements the O(n * n) sums beat the three
+ *       transforms of twice the order an FFT product takes.
+ */
+#ifndef LINEAR_TOEPLITZ_DIRECT
+    #define LINEAR_TOEPLITZ_DIRECT 64
+#endif // LINEAR_TOEPLITZ_DIRECT
+
+// Lifecycle management
+
+/**
+ * @brief Create a zero initialized Toeplitz matrix using the given context
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param order   The number of rows, and columns, of the matrix.
+ *
+ * @return A pointer to the new matrix, or NULL upon failure
+ *
+ * @note Toeplitz matrices must be freed with toeplitz_free_ctx().
+ */
+toeplitz_t* toeplitz_create_ctx(linear_context_t* context, uint32_t order);
+void        toeplitz_free_ctx(linear_context_t* context, toeplitz_t* toeplitz);
+
+/**
+ * @brief Create a zero initialized circulant matrix using the given context
+ *
+ * @note Circulant matrices must be freed with circulant_free_ctx().
+ */
+circulant_t* circulant_create_ctx(linear_context_t* context, uint32_t order);
+void circulant_free_ctx(linear_context_t* context, circulant_t* circulant);
+
+// Conversion
+
+/**
+ * @brief Create a Toeplitz matrix from its first column and first row
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param column  The first column, a NUMERIC_FLOAT32 vector of n elements.
+ * @param row     The first row, a NUMERIC_FLOAT32 vector of n elements whose
+ *                first element equals that of column, or NULL for the
+ *                symmetric matrix whose first row is column.
+ *
+ * @return A new Toeplitz matrix, or NULL upon failure
+ */
+toeplitz_t* toeplitz_from_vectors_ctx(
+    linear_context_t* context, const vector_t* column, const vector_t* row
+);
+
+/**
+ * @brief Create a circulant matrix from its first column
+ *
+ * @param column The first column, a NUMERIC_FLOAT32 vector of n elements.
+ *
+ * @return A new circulant matrix, or NULL upon failure
+ */
+circulant_t*
+circulant_from_vector_ctx(linear_context_t* context, const vector_t* column);
+
+/**
+ * @brief Expand into a new dense matrix.
+ *
+ * @return A new matrix, freed with matrix_free_ctx(), or NULL upon failure
+ */
+matrix_t*
+toeplitz_to_matrix_ctx(linear_context_t* context, const toeplitz_t* toeplitz);
+matrix_t* circulant_to_matrix_ctx(
+    linear_context_t* context, const circulant_t* circulant
+);
+
+// Products
+
+/**
+ * @brief Toeplitz matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * Above LINEAR_TOEPLITZ_DIRECT, the product is the middle of the linear
+ * convolution of the diagonals with x, taken by a radix-2 FFT of the first
+ * power of two covering 2n - 1 elements.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param alpha   Scales the product of a and x.
+ * @param a       A Toeplitz matrix of order n.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements.
+ * @param beta    Scales y before accumulating, 0 overwrites y.
+ * @param y       A NUMERIC_FLOAT32 vector with n elements, distinct from x.
+ *
+ * @return true on success, false otherwise
+ */
+bool toeplitz_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const toeplitz_t* a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+);
+
+/**
+ * @brief Toeplitz matrix multiply, c = alpha * a * b + beta * c.
+ *
+ * The spectrum of a is transformed once and shared, while the columns of b
+ * are split across the pool, each taking one forward and one inverse FFT.
+ *
+ * @param a A Toeplitz matrix of order n.
+ * @param b A dense n x p matrix.
+ * @param c A dense n x p matrix, distinct from b.
+ *
+ * @return true on success, false otherwise
+ */
+bool toeplitz_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const toeplitz_t* a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+);
+
+/**
+ * @brief Circulant matrix-vector multiply, y = alpha * a * x + beta * y.
+ *
+ * @see toeplitz_gemv_ctx()
+ */
+bool circulant_gemv_ctx(
+    linear_context_t*  context,
+    float              alpha,
+    const circulant_t* a,
+    const vector_t*    x,
+    float              beta,
+    vector_t*          y
+);
+
+/**
+ * @brief Circulant matrix multiply, c = alpha * a * b + beta * c.
+ *
+ * @see toeplitz_gemm_ctx()
+ */
+bool circulant_gemm_ctx(
+    linear_context_t*  context,
+    float              alpha,
+    const circulant_t* a,
+    const matrix_t*    b,
+    float              beta,
+    matrix_t*          c
+);
+
+// Solvers
+
+/**
+ * @brief Solve a * x = b for a Toeplitz matrix by Levinson recursion
+ *
+ * Grows forward and backward solutions of the leading principal submatrices
+ * one order at a time, in O(n * n) operations and O(n) memory instead of
+ * the O(n * n * n) of an LU factorization. Accumulates in double precision.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       A Toeplitz matrix of order n whose leading principal
+ *                submatrices are all nonsingular, as holds for symmetric
+ *                positive definite matrices such as autocorrelations.
+ * @param b       A NUMERIC_FLOAT32 vector with n elements.
+ * @param x       A NUMERIC_FLOAT32 vector with n elements receiving the
+ *                solution, which may be b.
+ *
+ * @return true on success, false if a leading principal submatrix is
+ *         singular or upon failure
+ */
+bool toeplitz_solve_ctx(
+    linear_context_t* context,
+    const toeplitz_t* a,
+    const vector_t*   b,
+    vector_t*         x
+);
+
+/**
+ * @brief Solve a * x = b for a circulant matrix by spectral division
+ *
+ * The DFT diagonalizes every circulant matrix, so x is the inverse DFT of
+ * the DFT of b divided by that of the first column, in O(n log n). Orders
+ * that are not powers of two take their DFTs by Bluestein's algorithm.
+ *
+ * @param a A circulant matrix of order n.
+ * @param b A NUMERIC_FLOAT32 vector with n elements.
+ * @param x A NUMERIC_FLOAT32 vector with n elements receiving the solution,
+ *          which may be b.
+ *
+ * @return true on success, false if a is singular or upon failure
+ */
+bool circulant_solve_ctx(
+    linear_context_t*  context,
+    const circulant_t* a,
+    const vector_t*    b,
+    vector_t*          x
+);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LINEAR_TOEPLITZ_H
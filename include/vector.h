@@ -21,6 +21,8 @@
 extern "C" {
 #endif // __cplusplus
 
+#include "async.h"
+#include "context.h"
 #include "lehmer.h"
 #include "numeric_types.h"
 #include "scalar.h"
@@ -463,6 +465,559 @@ vector_t* vector_polar_to_cartesian(const vector_t* polar_vector);
  */
 vector_t* vector_cartesian_to_polar(const vector_t* cartesian_vector);
 
+// Context operations
+
+/**
+ * @brief Create a new N-dimensional vector using the given context
+ *
+ * Elements are allocated by the allocator of the context and typed by its
+ * precision. The values in the vector are set to zero.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param columns The number of elements (dimensions) in the vector.
+ *
+ * @return A pointer to the newly created vector
+ *
+ * @note Vectors created by a context must be freed with vector_free_ctx().
+ */
+vector_t* vector_create_ctx(linear_context_t* context, const uint32_t columns);
+
+/**
+ * @brief Free a vector created by the given context
+ */
+void vector_free_ctx(linear_context_t* context, vector_t* vector);
+
+/**
+ * @brief Deep copy a vector using the allocator of the given context
+ */
+vector_t* vector_deep_copy_ctx(
+    linear_context_t* context, const vector_t* vector
+);
+
+/**
+ * @brief Fill a NUMERIC_FLOAT32 vector with a value in parallel
+ *
+ * @return true on success, false for invalid input
+ */
+bool vector_fill_ctx(
+    linear_context_t* context, vector_t* vector, const float value
+);
+
+/**
+ * @brief Shallow copy a vector using the allocator of the given context
+ *
+ * @note The copy shares the elements of the source vector, so it must be
+ *       released with linear_context_release() rather than vector_free_ctx().
+ */
+vector_t* vector_shallow_copy_ctx(
+    linear_context_t* context, const vector_t* vector
+);
+
+/**
+ * @brief Executor for element-wise vector-to-scalar functions
+ *
+ * The vector is split into chunks according to the tuning profile of the
+ * context and each chunk is executed on the pool of the context.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a First input vector
+ * @param b Second input scalar of the same type as a
+ * @param operation A pointer to the function performing the element-wise
+ *                  operation
+ *
+ * @return A pointer to the resulting vector
+ */
+vector_t* vector_scalar_operation_ctx(
+    linear_context_t*  context,
+    const vector_t*    a,
+    const void*        b,
+    scalar_operation_t operation
+);
+
+vector_t* vector_scalar_add_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+);
+vector_t* vector_scalar_subtract_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+);
+vector_t* vector_scalar_multiply_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+);
+vector_t* vector_scalar_divide_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+);
+
+/**
+ * @brief Executor for element-wise vector-to-vector functions
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a First input vector
+ * @param b Second input vector
+ * @param operation A pointer to the function performing the element-wise
+ *                  operation
+ *
+ * @return A pointer to the resulting vector
+ */
+vector_t* vector_vector_operation_ctx(
+    linear_context_t*  context,
+    const vector_t*    a,
+    const vector_t*    b,
+    scalar_operation_t operation
+);
+
+vector_t* vector_vector_add_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+vector_t* vector_vector_subtract_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+vector_t* vector_vector_multiply_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+vector_t* vector_vector_divide_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+
+/**
+ * @brief Parallel reductions over NUMERIC_FLOAT32 vectors
+ *
+ * Each chunk accumulates a partial result which is combined on the calling
+ * thread. NAN is returned for invalid input.
+ */
+float vector_magnitude_ctx(linear_context_t* context, const vector_t* vector);
+float vector_distance_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+float vector_mean_ctx(linear_context_t* context, const vector_t* vector);
+float vector_dot_product_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+
+/**
+ * @brief Scale a NUMERIC_FLOAT32 vector in parallel
+ *
+ * @return A pointer to the scaled vector
+ */
+vector_t* vector_scale_ctx(
+    linear_context_t* context, vector_t* vector, float scalar, bool inplace
+);
+
+/**
+ * @brief Normalize a NUMERIC_FLOAT32 vector to unit length in parallel
+ *
+ * @return A pointer to the unit vector, or NULL for a zero-length vector
+ */
+vector_t* vector_normalize_ctx(
+    linear_context_t* context, vector_t* vector, bool inplace
+);
+
+/**
+ * @brief Clip a NUMERIC_FLOAT32 vector to [min, max] in parallel
+ *
+ * @return A pointer to the clipped vector
+ */
+vector_t* vector_clip_ctx(
+    linear_context_t* context,
+    vector_t*         vector,
+    float             min,
+    float             max,
+    bool              inplace
+);
+
+/**
+ * @brief Fixed size NUMERIC_FLOAT32 operations allocated by the context
+ *
+ * These are computed on the calling thread since there is nothing to split.
+ */
+vector_t* vector_cross_product_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+);
+vector_t* vector_polar_to_cartesian_ctx(
+    linear_context_t* context, const vector_t* polar_vector
+);
+vector_t* vector_cartesian_to_polar_ctx(
+    linear_context_t* context, const vector_t* cartesian_vector
+);
+
+// Comparison, masks and selection
+
+/**
+ * @brief Element-wise comparisons producing a mask
+ *
+ * Comparisons follow IEEE 754, so every comparison with a NaN is false except
+ * VECTOR_COMPARE_NE.
+ *
+ * @param VECTOR_COMPARE_EQ    a == b
+ * @param VECTOR_COMPARE_NE    a != b
+ * @param VECTOR_COMPARE_LT    a < b
+ * @param VECTOR_COMPARE_LE    a <= b
+ * @param VECTOR_COMPARE_GT    a > b
+ * @param VECTOR_COMPARE_GE    a >= b
+ * @param VECTOR_COMPARE_COUNT Number of comparisons
+ */
+typedef enum VectorCompare {
+    VECTOR_COMPARE_EQ,   // a == b
+    VECTOR_COMPARE_NE,   // a != b
+    VECTOR_COMPARE_LT,   // a < b
+    VECTOR_COMPARE_LE,   // a <= b
+    VECTOR_COMPARE_GT,   // a > b
+    VECTOR_COMPARE_GE,   // a >= b
+    VECTOR_COMPARE_COUNT // Number of comparisons
+} vector_compare_t;
+
+/**
+ * @brief A packed bitmask over the elements of a vector
+ *
+ * Element i is selected if bit i % 64 of bits[i / 64] is set. Bits past
+ * columns in the last word are ignored, and are clear in every mask the
+ * library produces.
+ *
+ * @param bits    One bit per element, in 64-bit words
+ * @param columns The number of elements covered by the mask
+ */
+typedef struct VectorMask {
+    uint64_t* bits;    // One bit per element, in 64-bit words
+    uint32_t  columns; // Number of elements covered by the mask
+} vector_mask_t;
+
+/**
+ * @brief Create a cleared mask over the given number of elements
+ *
+ * @note Masks created by a context must be freed with vector_mask_free_ctx().
+ */
+vector_mask_t*
+vector_mask_create_ctx(linear_context_t* context, uint32_t columns);
+
+/**
+ * @brief Free a mask created by the given context
+ */
+void vector_mask_free_ctx(linear_context_t* context, vector_mask_t* mask);
+
+/**
+ * @brief Compare two NUMERIC_FLOAT32 vectors element-wise into a mask
+ *
+ * Every bit of the mask is written, 64 elements at a time without branches.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param a       First input vector
+ * @param b       Second input vector of the same size
+ * @param compare The comparison applied to each pair of elements
+ * @param mask    Receives the outcomes; must cover as many elements as a
+ *
+ * @return true on success, false otherwise
+ */
+bool vector_compare_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    const vector_t*   b,
+    vector_compare_t  compare,
+    vector_mask_t*    mask
+);
+
+/**
+ * @brief Compare each element of a NUMERIC_FLOAT32 vector against a scalar
+ *
+ * @see vector_compare_ctx()
+ */
+bool vector_compare_scalar_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    float             b,
+    vector_compare_t  compare,
+    vector_mask_t*    mask
+);
+
+/**
+ * @brief Combine masks of the same size a word at a time
+ *
+ * The result may alias either input.
+ *
+ * @return true on success, false otherwise
+ */
+bool vector_mask_and_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* a,
+    const vector_mask_t* b,
+    vector_mask_t*       result
+);
+bool vector_mask_or_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* a,
+    const vector_mask_t* b,
+    vector_mask_t*       result
+);
+bool vector_mask_not_ctx(
+    linear_context_t* context, const vector_mask_t* a, vector_mask_t* result
+);
+
+/**
+ * @brief Count the selected elements of a mask
+ *
+ * @return The number of set bits, or 0 for invalid input
+ */
+uint32_t
+vector_mask_count_ctx(linear_context_t* context, const vector_mask_t* mask);
+
+/**
+ * @brief Count the non-zero elements of a NUMERIC_FLOAT32 vector
+ *
+ * NaN elements are counted as non-zero.
+ *
+ * @return The number of non-zero elements, or 0 for invalid input
+ */
+uint32_t
+vector_count_nonzero_ctx(linear_context_t* context, const vector_t* vector);
+
+/**
+ * @brief Expand a mask into a boolean vector holding 1.0f or 0.0f
+ *
+ * @return A pointer to the resulting NUMERIC_FLOAT32 vector
+ */
+vector_t*
+vector_mask_expand_ctx(linear_context_t* context, const vector_mask_t* mask);
+
+/**
+ * @brief Select elements from a where the mask is set and from b elsewhere
+ *
+ * @return A pointer to the resulting vector
+ */
+vector_t* vector_select_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+);
+
+/**
+ * @brief Masked element-wise arithmetic on NUMERIC_FLOAT32 vectors
+ *
+ * Elements where the mask is set hold the operation on a and b, the others
+ * are copied from a.
+ *
+ * @return A pointer to the resulting vector
+ */
+vector_t* vector_masked_add_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+);
+vector_t* vector_masked_subtract_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+);
+vector_t* vector_masked_multiply_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+);
+vector_t* vector_masked_divide_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+);
+
+/**
+ * @brief Compact the elements selected by a mask, preserving their order
+ *
+ * Each task counts the selected elements of its words, and after a prefix sum
+ * over the counts writes them at its own offset, so the compaction is
+ * parallel and needs no atomics.
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param mask    The elements to keep
+ * @param a       The NUMERIC_FLOAT32 input vector
+ * @param indices Receives the position in a of each kept element, or NULL.
+ *                Must hold vector_mask_count_ctx() entries.
+ *
+ * @return A vector holding the kept elements, possibly with zero columns, or
+ *         NULL upon failure
+ */
+vector_t* vector_compress_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    uint32_t*            indices
+);
+
+/**
+ * @brief Keep the elements of a satisfying the comparison with the scalar b
+ *
+ * Fuses vector_compare_scalar_ctx() and vector_compress_ctx(), holding the
+ * intermediate mask in scratch memory.
+ *
+ * @param indices Receives the position in a of each kept element, or NULL.
+ *                Must hold up to a->columns entries.
+ */
+vector_t* vector_filter_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    vector_compare_t  compare,
+    float             b,
+    uint32_t*         indices
+);
+
+// Non-finite detection and sanitization
+
+/**
+ * @brief Check that no element of a NUMERIC_FLOAT32 vector is NaN or infinite
+ *
+ * Elements are classified by their exponent bits, a block at a time without
+ * branches, and every task stops at the first block holding a non-finite
+ * element found by any task.
+ *
+ * @return true if every element is finite, false otherwise or upon failure
+ */
+bool vector_all_finite_ctx(linear_context_t* context, const vector_t* vector);
+
+/**
+ * @brief Count the NaN and infinite elements of a NUMERIC_FLOAT32 vector
+ *
+ * @return The number of non-finite elements, or 0 for invalid input
+ */
+uint32_t
+vector_count_nonfinite_ctx(linear_context_t* context, const vector_t* vector);
+
+/**
+ * @brief Replace the non-finite elements of a NUMERIC_FLOAT32 vector in place
+ *
+ * @param context The execution context, or NULL for the default context
+ * @param vector  The vector to sanitize
+ * @param nan     Replacement for NaN
+ * @param posinf  Replacement for positive infinity
+ * @param neginf  Replacement for negative infinity
+ *
+ * @return true on success, false otherwise
+ */
+bool vector_nan_to_num_ctx(
+    linear_context_t* context,
+    vector_t*         vector,
+    float             nan,
+    float             posinf,
+    float             neginf
+);
+
+/**
+ * @brief Validate a vector entering the library per the context's policy
+ *
+ * Free under VALIDATION_NONE, see linear_validation_t.
+ *
+ * @return true if the vector may be used, false otherwise
+ */
+bool vector_ingest_ctx(linear_context_t* context, vector_t* vector);
+
+// Approximate comparison
+
+/**
+ * @brief Tolerances under which two elements are considered close
+ *
+ * Elements x and y are close if they are equal, if
+ * |x - y| <= max(relative * max(|x|, |y|), absolute), or if at most ulps
+ * representable floats lie between them. NaN is never close to anything,
+ * and an infinity is only close to an infinity of the same sign.
+ *
+ * @param absolute Largest absolute difference
+ * @param relative Largest difference relative to the larger magnitude
+ * @param ulps     Largest distance in units in the last place
+ */
+typedef struct VectorTolerance {
+    float    absolute; // Largest absolute difference
+    float    relative; // Largest difference relative to the larger magnitude
+    uint32_t ulps;     // Largest distance in units in the last place
+} vector_tolerance_t;
+
+/**
+ * @brief Outcome of an approximate comparison
+ *
+ * @param mismatch  Index of the first element that is not close, or
+ *                  UINT32_MAX if every element is close
+ * @param max_error Largest absolute difference among the compared elements,
+ *                  which covers every element only if all of them are close
+ */
+typedef struct VectorCloseness {
+    uint32_t mismatch;  // First element not close, UINT32_MAX if none
+    float    max_error; // Largest absolute difference compared
+} vector_closeness_t;
+
+/**
+ * @brief The tolerances of float_is_close(), a relative tolerance of 1e-3
+ */
+vector_tolerance_t vector_tolerance_default(void);
+
+/**
+ * @brief Check that every pair of elements of two NUMERIC_FLOAT32 vectors is
+ *        close
+ *
+ * Elements are compared a block at a time without branches. Tasks stop at the
+ * first block holding a mismatch, and skip blocks past the first mismatch
+ * found by any task, so the reported mismatch is the first one.
+ *
+ * @param context   The execution context, or NULL for the default context
+ * @param a         First input vector
+ * @param b         Second input vector of the same size
+ * @param tolerance The tolerances, or NULL for vector_tolerance_default()
+ * @param report    Receives the mismatch and the error, or NULL
+ *
+ * @return true if every pair is close, false otherwise or upon failure
+ */
+bool vector_is_close_ctx(
+    linear_context_t*         context,
+    const vector_t*           a,
+    const vector_t*           b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+);
+
+/**
+ * @brief Check that every element of a NUMERIC_FLOAT32 vector is close to b
+ *
+ * @see vector_is_close_ctx()
+ */
+bool vector_is_close_scalar_ctx(
+    linear_context_t*         context,
+    const vector_t*           a,
+    float                     b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+);
+
+// Asynchronous operations
+
+/**
+ * @brief Non-blocking variants of the parallel reductions
+ *
+ * Return immediately with a handle whose linear_async_value() holds the
+ * reduction once it completes. The vectors must remain valid until then.
+ *
+ * @param options Completion notification, or NULL to poll the handle
+ */
+linear_async_t* vector_magnitude_async(
+    linear_context_t*             context,
+    const vector_t*               vector,
+    const linear_async_options_t* options
+);
+linear_async_t* vector_distance_async(
+    linear_context_t*             context,
+    const vector_t*               a,
+    const vector_t*               b,
+    const linear_async_options_t* options
+);
+linear_async_t* vector_mean_async(
+    linear_context_t*             context,
+    const vector_t*               vector,
+    const linear_async_options_t* options
+);
+linear_async_t* vector_dot_product_async(
+    linear_context_t*             context,
+    const vector_t*               a,
+    const vector_t*               b,
+    const linear_async_options_t* options
+);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
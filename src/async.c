@@ -0,0 +1,172 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/async.c
+ *
+ * @brief Non-blocking operations for event-driven callers
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "async.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+linear_async_options_t linear_async_options_default(void) {
+    linear_async_options_t options = {
+        .callback = NULL,
+        .user     = NULL,
+        .event_fd = -1,
+    };
+    return options;
+}
+
+// Execute the body of an op and notify its owner
+static void linear_async_routine(thread_data_t* task) {
+    linear_async_t* op        = (linear_async_t*) task->a;
+    bool            succeeded = op->routine(op);
+
+    atomic_store(&op->status, (succeeded) ? ASYNC_SUCCEEDED : ASYNC_FAILED);
+
+    if (op->options.event_fd >= 0) {
+        uint64_t increment = 1;
+        if ((ssize_t) sizeof(increment)
+            != write(op->options.event_fd, &increment, sizeof(increment))) {
+            LOG_ERROR("Failed to notify eventfd %d.\n", op->options.event_fd);
+        }
+    }
+
+    if (op->options.callback) {
+        op->options.callback(op, op->options.user);
+    }
+
+    // The op must not be touched once finished, it may be freed immediately
+    pthread_mutex_lock(&op->mutex);
+    op->finished = true;
+    pthread_cond_broadcast(&op->released);
+    pthread_mutex_unlock(&op->mutex);
+}
+
+linear_async_t* linear_async_submit(
+    linear_context_t*             context,
+    linear_async_routine_t        routine,
+    const void*                   arguments,
+    size_t                        size,
+    const linear_async_options_t* options
+) {
+    context = linear_context_resolve(context);
+
+    if (NULL == routine) {
+        LOG_ERROR("A routine is required for an asynchronous op.\n");
+        return NULL;
+    }
+
+    linear_async_t* op = malloc(sizeof(linear_async_t));
+    if (NULL == op) {
+        LOG_ERROR("Failed to allocate memory for linear_async_t.\n");
+        return NULL;
+    }
+
+    op->arguments = NULL;
+    if (size > 0) {
+        op->arguments = malloc(size);
+        if (NULL == op->arguments) {
+            LOG_ERROR("Failed to allocate memory for op arguments.\n");
+            free(op);
+            return NULL;
+        }
+        memcpy(op->arguments, arguments, size);
+    }
+
+    op->context  = context;
+    op->routine  = routine;
+    op->result   = NULL;
+    op->value    = NAN;
+    op->options  = (options) ? *options : linear_async_options_default();
+    op->finished = false;
+    atomic_init(&op->status, ASYNC_PENDING);
+    pthread_mutex_init(&op->mutex, NULL);
+    pthread_cond_init(&op->released, NULL);
+
+    thread_data_t task = {
+        .a       = op,
+        .routine = linear_async_routine,
+    };
+
+    if (NULL == context->pool) {
+        thread_task_execute(&task);
+    } else {
+        thread_pool_submit_priority(context->pool, task, context->priority);
+    }
+
+    return op;
+}
+
+linear_async_status_t linear_async_status(linear_async_t* op) {
+    return (linear_async_status_t) atomic_load(&op->status);
+}
+
+bool linear_async_wait(linear_async_t* op) {
+    pthread_mutex_lock(&op->mutex);
+    while (!op->finished) {
+        pthread_cond_wait(&op->released, &op->mutex);
+    }
+    pthread_mutex_unlock(&op->mutex);
+
+    return ASYNC_SUCCEEDED == linear_async_status(op);
+}
+
+void* linear_async_result(linear_async_t* op) {
+    if (ASYNC_SUCCEEDED != linear_async_status(op)) {
+        return NULL;
+    }
+
+    void* result = op->result;
+    op->result   = NULL; // ownership passes to the caller
+    return result;
+}
+
+float linear_async_value(linear_async_t* op) {
+    if (ASYNC_SUCCEEDED != linear_async_status(op)) {
+        return NAN;
+    }
+
+    return op->value;
+}
+
+void linear_async_free(linear_async_t* op) {
+    if (NULL == op) {
+        return;
+    }
+
+    linear_async_wait(op);
+
+    pthread_mutex_destroy(&op->mutex);
+    pthread_cond_destroy(&op->released);
+    free(op->arguments);
+    free(op);
+}
+
+// Event notification
+
+int linear_async_eventfd(void) {
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd < 0) {
+        LOG_ERROR("Failed to create eventfd: %s\n", strerror(errno));
+    }
+    return event_fd;
+}
+
+uint64_t linear_async_eventfd_drain(int event_fd) {
+    uint64_t count = 0;
+    if ((ssize_t) sizeof(count) != read(event_fd, &count, sizeof(count))) {
+        return 0; // nothing pending, EAGAIN
+    }
+    return count;
+}
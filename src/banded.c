@@ -0,0 +1,751 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/banded.c
+ *
+ * @brief Banded and batched tridiagonal matrices
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "banded.h"
+#include "logger.h"
+
+#include <math.h>
+#include <stdatomic.h>
+
+// Elements stored per row of a band
+static inline uint32_t banded_width(const banded_t* banded) {
+    return banded->lower + banded->upper + 1;
+}
+
+// Band elements of row i of a band with the given width and subdiagonals,
+// such that row[j] is the element (i, j) of every column j of the band
+static inline float*
+banded_row(float* data, uint32_t width, uint32_t lower, uint32_t i) {
+    return data + (size_t) i * width + lower - i;
+}
+
+// Columns [*first, *last) of row i within both the band and the matrix
+static inline void banded_span(
+    uint32_t  i,
+    uint32_t  lower,
+    uint32_t  upper,
+    uint32_t  columns,
+    uint32_t* first,
+    uint32_t* last
+) {
+    uint64_t end = (uint64_t) i + upper + 1;
+    *first       = (i > lower) ? i - lower : 0;
+    *last        = (end < columns) ? (uint32_t) end : columns;
+}
+
+// Lifecycle management
+
+banded_t* banded_create_ctx(
+    linear_context_t* context,
+    uint32_t          rows,
+    uint32_t          columns,
+    uint32_t          lower,
+    uint32_t          upper
+) {
+    context = linear_context_resolve(context);
+
+    // Diagonals beyond the matrix are empty
+    lower = (rows > 0 && lower >= rows) ? rows - 1 : lower;
+    upper = (columns > 0 && upper >= columns) ? columns - 1 : upper;
+
+    banded_t* banded = linear_context_allocate(context, sizeof(banded_t));
+    if (NULL == banded) {
+        LOG_ERROR("Failed to allocate memory for banded_t.\n");
+        return NULL;
+    }
+
+    banded->rows    = rows;
+    banded->columns = columns;
+    banded->lower   = lower;
+    banded->upper   = upper;
+
+    // At least one element, so an empty matrix still holds valid data
+    size_t elements = banded_element_count(banded);
+    size_t size     = ((elements) ? elements : 1) * sizeof(float);
+    banded->data    = linear_context_allocate(context, size);
+    if (NULL == banded->data) {
+        LOG_ERROR("Failed to allocate memory for banded elements.\n");
+        linear_context_release(context, banded);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < elements; i++) {
+        banded->data[i] = 0.0f;
+    }
+
+    return banded;
+}
+
+void banded_free_ctx(linear_context_t* context, banded_t* banded) {
+    if (NULL == banded) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, banded->data);
+    linear_context_release(context, banded);
+}
+
+tridiagonal_t* tridiagonal_create_ctx(
+    linear_context_t* context, uint32_t order, uint32_t batch
+) {
+    context = linear_context_resolve(context);
+
+    tridiagonal_t* tridiagonal = linear_context_allocate(
+        context, sizeof(tridiagonal_t)
+    );
+    if (NULL == tridiagonal) {
+        LOG_ERROR("Failed to allocate memory for tridiagonal_t.\n");
+        return NULL;
+    }
+
+    size_t elements       = (size_t) order * batch;
+    size_t size           = ((elements) ? elements : 1) * sizeof(float);
+    tridiagonal->lower    = linear_context_allocate(context, size);
+    tridiagonal->diagonal = linear_context_allocate(context, size);
+    tridiagonal->upper    = linear_context_allocate(context, size);
+    tridiagonal->order    = order;
+    tridiagonal->batch    = batch;
+    if (NULL == tridiagonal->lower || NULL == tridiagonal->diagonal
+        || NULL == tridiagonal->upper) {
+        LOG_ERROR("Failed to allocate memory for tridiagonal elements.\n");
+        tridiagonal_free_ctx(context, tridiagonal);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < elements; i++) {
+        tridiagonal->lower[i]    = 0.0f;
+        tridiagonal->diagonal[i] = 0.0f;
+        tridiagonal->upper[i]    = 0.0f;
+    }
+
+    return tridiagonal;
+}
+
+void tridiagonal_free_ctx(linear_context_t* context, tridiagonal_t* batch) {
+    if (NULL == batch) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, batch->lower);
+    linear_context_release(context, batch->diagonal);
+    linear_context_release(context, batch->upper);
+    linear_context_release(context, batch);
+}
+
+// Element Access
+
+size_t banded_element_count(const banded_t* banded) {
+    return (size_t) banded->rows * banded_width(banded);
+}
+
+// Resolve (row, column) to its stored element, or NULL outside the band
+static float* banded_element(
+    const banded_t* banded, uint32_t row, uint32_t column
+) {
+    uint32_t first, last;
+    banded_span(
+        row, banded->lower, banded->upper, banded->columns, &first, &last
+    );
+    if (column < first || column >= last) {
+        return NULL;
+    }
+
+    return banded_row(banded->data, banded_width(banded), banded->lower, row)
+           + column;
+}
+
+float banded_element_get(
+    const banded_t* banded, uint32_t row, uint32_t column
+) {
+    if (row >= banded->rows || column >= banded->columns) {
+        LOG_ERROR("Index out of bounds.\n");
+        return NAN;
+    }
+
+    const float* element = banded_element(banded, row, column);
+    return (element) ? *element : 0.0f;
+}
+
+bool banded_element_set(
+    banded_t* banded, uint32_t row, uint32_t column, float value
+) {
+    if (row >= banded->rows || column >= banded->columns) {
+        LOG_ERROR("Index out of bounds.\n");
+        return false;
+    }
+
+    float* element = banded_element(banded, row, column);
+    if (NULL == element) {
+        LOG_ERROR("Element (%u, %u) is outside the band.\n", row, column);
+        return false;
+    }
+
+    *element = value;
+    return true;
+}
+
+// Parallel Execution
+
+// Operands of a banded op, shared by the tasks splitting it
+typedef struct BandedOp {
+    const banded_t* a;       // The banded matrix
+    const float*    x;       // Vector, or rows of a matrix, read by the op
+    float*          y;       // Vector, or rows of a matrix, written by the op
+    float*          w;       // Band of the LU factors, or NULL
+    uint32_t*       pivots;  // Row swapped with row k at step k, or NULL
+    uint32_t        columns; // Columns of the dense matrices, if any
+    uint32_t        upper;   // Superdiagonals of the LU factors
+    float           alpha;
+    float           beta;
+} banded_op_t;
+
+// Run a row kernel over every row of a banded matrix, costing width per
+// stored element
+static bool banded_run(
+    linear_context_t* context,
+    banded_op_t*      op,
+    thread_routine_t  routine,
+    uint64_t          width
+) {
+    thread_data_t task = {
+        .a       = op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    uint64_t work = banded_element_count(op->a) * width;
+    return linear_context_parallel_work(context, task, op->a->rows, work);
+}
+
+// Conversion
+
+// Row kernel copying the band of rows [begin, end) of x into a
+static void banded_pack_routine(thread_data_t* task) {
+    const banded_op_t* op    = (const banded_op_t*) task->a;
+    const banded_t*    a     = op->a;
+    const uint32_t     width = banded_width(a);
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* x   = op->x + (size_t) i * a->columns;
+        float*       row = banded_row(a->data, width, a->lower, i);
+        uint32_t     first, last;
+        banded_span(i, a->lower, a->upper, a->columns, &first, &last);
+        for (uint32_t j = first; j < last; j++) {
+            row[j] = x[j];
+        }
+    }
+}
+
+// Row kernel expanding the band of rows [begin, end) of a into the zeroed y
+static void banded_unpack_routine(thread_data_t* task) {
+    const banded_op_t* op    = (const banded_op_t*) task->a;
+    const banded_t*    a     = op->a;
+    const uint32_t     width = banded_width(a);
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = banded_row(a->data, width, a->lower, i);
+        float*       y   = op->y + (size_t) i * a->columns;
+        uint32_t     first, last;
+        banded_span(i, a->lower, a->upper, a->columns, &first, &last);
+        for (uint32_t j = first; j < last; j++) {
+            y[j] = row[j];
+        }
+    }
+}
+
+banded_t* banded_from_matrix_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          lower,
+    uint32_t          upper
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    banded_t* banded = banded_create_ctx(
+        context, matrix->rows, matrix->columns, lower, upper
+    );
+    if (NULL == banded) {
+        return NULL; // Error is logged by default
+    }
+
+    banded_op_t op = {
+        .a = banded,
+        .x = matrix->data,
+    };
+
+    if (!banded_run(context, &op, banded_pack_routine, 1)) {
+        banded_free_ctx(context, banded);
+        return NULL;
+    }
+
+    return banded;
+}
+
+matrix_t*
+banded_to_matrix_ctx(linear_context_t* context, const banded_t* banded) {
+    context = linear_context_resolve(context);
+    if (NULL == banded || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    matrix_t* matrix = matrix_create_ctx(
+        context, banded->rows, banded->columns
+    );
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    banded_op_t op = {
+        .a = banded,
+        .y = matrix->data,
+    };
+
+    if (!banded_run(context, &op, banded_unpack_routine, 1)) {
+        matrix_free_ctx(context, matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
+
+// Products
+
+// Verify a NUMERIC_FLOAT32 vector holds count elements
+static bool banded_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// Row kernel computing elements [begin, end) of y = alpha * a * x + beta * y
+static void banded_gbmv_routine(thread_data_t* task) {
+    const banded_op_t* op    = (const banded_op_t*) task->a;
+    const banded_t*    a     = op->a;
+    const uint32_t     width = banded_width(a);
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = banded_row(a->data, width, a->lower, i);
+        uint32_t     first, last;
+        banded_span(i, a->lower, a->upper, a->columns, &first, &last);
+
+        float sum = 0.0f;
+        for (uint32_t j = first; j < last; j++) {
+            sum += row[j] * op->x[j];
+        }
+
+        // beta == 0 overwrites, so uninitialized NaNs do not propagate
+        float y  = (0.0f == op->beta) ? 0.0f : op->beta * op->y[i];
+        op->y[i] = y + op->alpha * sum;
+    }
+}
+
+bool banded_gbmv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const banded_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !banded_vector_is_valid(x, a->columns)
+        || !banded_vector_is_valid(y, a->rows)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("GBMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    banded_op_t op = {
+        .a     = a,
+        .x     = (const float*) x->data,
+        .y     = (float*) y->data,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+
+    return banded_run(context, &op, banded_gbmv_routine, 1);
+}
+
+// Solvers
+
+// Factor the band w of the square a as p * l * u in place, with partial
+// pivoting restricted to the lower band. Multipliers stay in the rows that
+// computed them, while u widens to op->upper = lower + upper superdiagonals.
+static bool banded_lu(banded_op_t* op) {
+    const uint32_t n     = op->a->rows;
+    const uint32_t lower = op->a->lower;
+    const uint32_t width = lower + op->upper + 1;
+
+    for (uint32_t k = 0; k < n; k++) {
+        float*   pivot = banded_row(op->w, width, lower, k);
+        uint64_t below = (uint64_t) k + lower + 1;
+        uint64_t end   = (uint64_t) k + op->upper + 1;
+        uint32_t rows  = (below < n) ? (uint32_t) below : n;
+        uint32_t last  = (end < n) ? (uint32_t) end : n;
+
+        // The largest magnitude in column k on or below the diagonal
+        uint32_t p    = k;
+        float    best = fabsf(pivot[k]);
+        for (uint32_t i = k + 1; i < rows; i++) {
+            float magnitude = fabsf(banded_row(op->w, width, lower, i)[k]);
+            if (magnitude > best) {
+                best = magnitude;
+                p    = i;
+            }
+        }
+
+        if (!(best > 0.0f)) {
+            LOG_ERROR("Matrix is singular at column %u.\n", k);
+            return false;
+        }
+
+        op->pivots[k] = p;
+        if (p != k) {
+            float* row = banded_row(op->w, width, lower, p);
+            for (uint32_t j = k; j < last; j++) {
+                float swap = pivot[j];
+                pivot[j]   = row[j];
+                row[j]     = swap;
+            }
+        }
+
+        for (uint32_t i = k + 1; i < rows; i++) {
+            float* row = banded_row(op->w, width, lower, i);
+            float  l   = row[k] / pivot[k];
+            row[k]     = l;
+            for (uint32_t j = k + 1; j < last; j++) {
+                row[j] -= l * pivot[j];
+            }
+        }
+    }
+
+    return true;
+}
+
+// Range kernel solving columns [begin, end) of y against the factors in w,
+// applying l with its interleaved row swaps and then back substituting u
+static void banded_substitute_routine(thread_data_t* task) {
+    const banded_op_t* op    = (const banded_op_t*) task->a;
+    const uint32_t     n     = op->a->rows;
+    const uint32_t     m     = op->columns;
+    const uint32_t     lower = op->a->lower;
+    const uint32_t     width = lower + op->upper + 1;
+
+    for (uint32_t k = 0; k < n; k++) {
+        float* z = op->y + (size_t) k * m;
+        if (op->pivots[k] != k) {
+            float* y = op->y + (size_t) op->pivots[k] * m;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                float swap = z[j];
+                z[j]       = y[j];
+                y[j]       = swap;
+            }
+        }
+
+        uint64_t below = (uint64_t) k + lower + 1;
+        uint32_t rows  = (below < n) ? (uint32_t) below : n;
+        for (uint32_t i = k + 1; i < rows; i++) {
+            const float l = banded_row(op->w, width, lower, i)[k];
+            float*      y = op->y + (size_t) i * m;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                y[j] -= l * z[j];
+            }
+        }
+    }
+
+    for (uint32_t i = n; i-- > 0;) {
+        const float* row  = banded_row(op->w, width, lower, i);
+        float*       z    = op->y + (size_t) i * m;
+        uint64_t     end  = (uint64_t) i + op->upper + 1;
+        uint32_t     last = (end < n) ? (uint32_t) end : n;
+        for (uint32_t k = i + 1; k < last; k++) {
+            const float  u = row[k];
+            const float* y = op->y + (size_t) k * m;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                z[j] -= u * y[j];
+            }
+        }
+
+        const float d = row[i];
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            z[j] /= d;
+        }
+    }
+}
+
+// Range kernel copying elements [begin, end) of x into y
+static void banded_copy_routine(thread_data_t* task) {
+    const banded_op_t* op = (const banded_op_t*) task->a;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        op->y[i] = op->x[i];
+    }
+}
+
+// Verify the right-hand sides and solutions of an order n system, copying b
+// into x unless they are the same matrix
+static bool banded_prepare_solution(
+    linear_context_t* context, uint32_t n, const matrix_t* b, matrix_t* x
+) {
+    if (NULL == b || NULL == x) {
+        return false;
+    }
+
+    if (n != b->rows || b->rows != x->rows || b->columns != x->columns) {
+        LOG_ERROR(
+            "Dimensions do not match. Cannot solve a system of order %u for "
+            "%ux%u into %ux%u.\n",
+            n,
+            b->rows,
+            b->columns,
+            x->rows,
+            x->columns
+        );
+        return false;
+    }
+
+    matrix_invalidate(x);
+    if (x->data == b->data) {
+        return true;
+    }
+
+    banded_op_t op = {
+        .x = b->data,
+        .y = x->data,
+    };
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = banded_copy_routine,
+    };
+
+    return linear_context_parallel(context, task, matrix_element_count(b));
+}
+
+bool banded_solve_ctx(
+    linear_context_t* context,
+    const banded_t*   a,
+    const matrix_t*   b,
+    matrix_t*         x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (a->rows != a->columns) {
+        LOG_ERROR(
+            "Cannot solve a non-square banded matrix of size %ux%u.\n",
+            a->rows,
+            a->columns
+        );
+        return false;
+    }
+
+    if (!banded_prepare_solution(context, a->rows, b, x)) {
+        return false;
+    }
+
+    // Row swaps fill in up to lower more superdiagonals
+    const uint32_t n     = a->rows;
+    uint64_t       upper = (uint64_t) a->upper + a->lower;
+    banded_op_t    op    = {
+        .a       = a,
+        .y       = x->data,
+        .columns = x->columns,
+        .upper   = (upper < n) ? (uint32_t) upper : n,
+    };
+
+    const uint32_t width = a->lower + op.upper + 1;
+    const uint32_t band  = banded_width(a);
+    size_t         mark  = linear_context_scratch_mark(context);
+    op.w = linear_context_scratch_alloc(context, sizeof(float) * n * width);
+    op.pivots = linear_context_scratch_alloc(context, sizeof(uint32_t) * n);
+    if (NULL == op.w || NULL == op.pivots) {
+        LOG_ERROR("Failed to allocate memory for the LU factors.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const float* row = a->data + (size_t) i * band;
+        float*       w   = op.w + (size_t) i * width;
+        for (uint32_t j = 0; j < width; j++) {
+            w[j] = (j < band) ? row[j] : 0.0f;
+        }
+    }
+
+    bool solved = banded_lu(&op);
+    if (solved) {
+        thread_data_t task = {
+            .a       = &op,
+            .type    = NUMERIC_FLOAT32,
+            .routine = banded_substitute_routine,
+        };
+
+        uint64_t work = (uint64_t) n * x->columns * (width + 1);
+        solved = linear_context_parallel_work(context, task, x->columns, work);
+    }
+
+    linear_context_scratch_release(context, mark);
+    return solved;
+}
+
+// Operands of a batched tridiagonal solve, shared by the tasks splitting the
+// systems
+typedef struct TridiagonalOp {
+    const tridiagonal_t* a;        // The batch of systems
+    float*               x;        // Right-hand sides, solved in place
+    float*               c;        // Scaled superdiagonals of the sweep
+    atomic_uint          failures; // Number of tasks meeting a bad pivot
+} tridiagonal_op_t;
+
+// Range kernel solving systems [begin, end) of the batch. The forward sweep
+// eliminates the subdiagonal, keeping the scaled superdiagonals in c, and the
+// backward sweep substitutes them. Every loop runs over contiguous systems.
+static void tridiagonal_solve_routine(thread_data_t* task) {
+    tridiagonal_op_t*    op   = (tridiagonal_op_t*) task->a;
+    const tridiagonal_t* a    = op->a;
+    const size_t         m    = a->batch;
+    uint32_t             zero = 0;
+
+    // Row 0 has no subdiagonal to eliminate
+    for (uint32_t s = task->begin; s < task->end; s++) {
+        float d   = a->diagonal[s];
+        float r   = 1.0f / d;
+        zero     |= -(uint32_t) (0.0f == d || !isfinite(d));
+        op->c[s]  = a->upper[s] * r;
+        op->x[s] *= r;
+    }
+
+    for (uint32_t i = 1; i < a->order; i++) {
+        const float* lower    = a->lower + i * m;
+        const float* diagonal = a->diagonal + i * m;
+        const float* upper    = a->upper + i * m;
+        float*       c        = op->c + i * m;
+        float*       x        = op->x + i * m;
+        const float* cp       = c - m;
+        const float* xp       = x - m;
+
+        // Two passes keep the runtime alias checks few enough to vectorize,
+        // the first leaving the reciprocal pivots in c
+        for (uint32_t s = task->begin; s < task->end; s++) {
+            float d = diagonal[s] - lower[s] * cp[s];
+            zero   |= -(uint32_t) (0.0f == d || !isfinite(d));
+            c[s]    = 1.0f / d;
+        }
+
+        for (uint32_t s = task->begin; s < task->end; s++) {
+            float r = c[s];
+            x[s]    = (x[s] - lower[s] * xp[s]) * r;
+            c[s]    = upper[s] * r;
+        }
+    }
+
+    for (uint32_t i = a->order - 1; i-- > 0;) {
+        const float* c  = op->c + i * m;
+        float*       x  = op->x + i * m;
+        const float* xn = x + m;
+        for (uint32_t s = task->begin; s < task->end; s++) {
+            x[s] -= c[s] * xn[s];
+        }
+    }
+
+    if (zero) {
+        atomic_fetch_add(&op->failures, 1);
+    }
+}
+
+bool tridiagonal_solve_ctx(
+    linear_context_t*    context,
+    const tridiagonal_t* a,
+    const matrix_t*      b,
+    matrix_t*            x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NULL != b && a->batch != b->columns) {
+        LOG_ERROR(
+            "Expected %u right-hand sides, one per system, got %u.\n",
+            a->batch,
+            b->columns
+        );
+        return false;
+    }
+
+    if (!banded_prepare_solution(context, a->order, b, x)) {
+        return false;
+    }
+
+    if (0 == a->order || 0 == a->batch) {
+        return true;
+    }
+
+    tridiagonal_op_t op = {
+        .a = a,
+        .x = x->data,
+    };
+    atomic_init(&op.failures, 0);
+
+    size_t mark = linear_context_scratch_mark(context);
+    op.c        = linear_context_scratch_alloc(
+        context, sizeof(float) * a->order * a->batch
+    );
+    if (NULL == op.c) {
+        LOG_ERROR("Failed to allocate memory for the forward sweep.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = tridiagonal_solve_routine,
+    };
+
+    // Each unknown costs about eight flops across both sweeps
+    uint64_t work   = 8 * (uint64_t) a->order * a->batch;
+    bool     solved = linear_context_parallel_work(
+        context, task, a->batch, work
+    );
+
+    linear_context_scratch_release(context, mark);
+    if (solved && atomic_load(&op.failures)) {
+        LOG_ERROR("A tridiagonal system met a zero or non-finite pivot.\n");
+        return false;
+    }
+
+    return solved;
+}
@@ -0,0 +1,532 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/bsr.c
+ *
+ * @brief Block-sparse row (BSR) matrices
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "bsr.h"
+#include "logger.h"
+
+#include <math.h>
+
+// Verify a block size is supported and tiles the given dimensions
+static bool bsr_shape_is_valid(
+    uint32_t rows, uint32_t columns, uint32_t size
+) {
+    if (4 != size && 8 != size && 16 != size) {
+        LOG_ERROR("Invalid block size %u, expected 4, 8 or 16.\n", size);
+        return false;
+    }
+
+    if (rows % size || columns % size) {
+        LOG_ERROR(
+            "Cannot tile a %ux%u matrix with %ux%u blocks.\n",
+            rows,
+            columns,
+            size,
+            size
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// Lifecycle management
+
+bsr_t* bsr_create_ctx(
+    linear_context_t* context,
+    uint32_t          rows,
+    uint32_t          columns,
+    uint32_t          size,
+    uint32_t          blocks
+) {
+    context = linear_context_resolve(context);
+    if (!bsr_shape_is_valid(rows, columns, size)) {
+        return NULL;
+    }
+
+    bsr_t* bsr = linear_context_allocate(context, sizeof(bsr_t));
+    if (NULL == bsr) {
+        LOG_ERROR("Failed to allocate memory for bsr_t.\n");
+        return NULL;
+    }
+
+    // At least one block, so an empty matrix still holds valid data
+    size_t count = (blocks) ? blocks : 1;
+    bsr->values  = linear_context_allocate(
+        context, count * size * size * sizeof(float)
+    );
+    bsr->indices = linear_context_allocate(context, count * sizeof(uint32_t));
+    bsr->offsets = linear_context_allocate(
+        context, ((size_t) rows / size + 1) * sizeof(uint32_t)
+    );
+    bsr->rows    = rows;
+    bsr->columns = columns;
+    bsr->size    = size;
+    bsr->blocks  = blocks;
+    if (NULL == bsr->values || NULL == bsr->indices || NULL == bsr->offsets) {
+        LOG_ERROR("Failed to allocate memory for BSR blocks.\n");
+        bsr_free_ctx(context, bsr);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i <= rows / size; i++) {
+        bsr->offsets[i] = 0;
+    }
+
+    return bsr;
+}
+
+void bsr_free_ctx(linear_context_t* context, bsr_t* bsr) {
+    if (NULL == bsr) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, bsr->values);
+    linear_context_release(context, bsr->indices);
+    linear_context_release(context, bsr->offsets);
+    linear_context_release(context, bsr);
+}
+
+float bsr_density(const bsr_t* bsr) {
+    uint64_t total = ((uint64_t) bsr->rows / bsr->size)
+                     * (bsr->columns / bsr->size);
+    return (total) ? (float) bsr->blocks / (float) total : 0.0f;
+}
+
+// Operands of a BSR op, shared by the tasks splitting its block rows
+typedef struct BsrOp {
+    bsr_t*       a;         // The BSR matrix
+    const float* x;         // Vector, or rows of a matrix, read by the op
+    float*       y;         // Vector, or rows of a matrix, written by the op
+    uint8_t*     keep;      // Whether each block of a dense matrix is stored
+    uint32_t*    counts;    // Blocks kept per block row of a dense matrix
+    uint32_t     columns;   // Columns of the dense matrices, if any
+    float        threshold; // Squared magnitude of the largest dropped block
+    float        alpha;
+    float        beta;
+} bsr_op_t;
+
+// Run a block row kernel over the block rows of a, costing work in total
+static bool bsr_run(
+    linear_context_t* context,
+    bsr_op_t*         op,
+    thread_routine_t  routine,
+    uint64_t          work
+) {
+    thread_data_t task = {
+        .a       = op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    uint32_t count = op->a->rows / op->a->size;
+    return linear_context_parallel_work(context, task, count, work);
+}
+
+// Conversion
+
+// Block row kernel flagging the blocks of rows [begin, end) of the dense x
+// whose squared magnitude exceeds the threshold, and counting them
+static void bsr_count_routine(thread_data_t* task) {
+    const bsr_op_t* op     = (const bsr_op_t*) task->a;
+    const uint32_t  size   = op->a->size;
+    const uint32_t  blocks = op->columns / size;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint8_t* keep  = op->keep + (size_t) i * blocks;
+        uint32_t count = 0;
+
+        for (uint32_t k = 0; k < blocks; k++) {
+            float sum = 0.0f;
+            for (uint32_t r = 0; r < size; r++) {
+                const float* x = op->x + ((size_t) i * size + r) * op->columns
+                                 + (size_t) k * size;
+                for (uint32_t q = 0; q < size; q++) {
+                    sum += x[q] * x[q];
+                }
+            }
+
+            // NaN magnitudes are kept, as they compare false
+            keep[k]  = !(sum <= op->threshold);
+            count   += keep[k];
+        }
+
+        op->counts[i] = count;
+    }
+}
+
+// Block row kernel copying the kept blocks of rows [begin, end) of x into a
+static void bsr_pack_routine(thread_data_t* task) {
+    const bsr_op_t* op     = (const bsr_op_t*) task->a;
+    const bsr_t*    a      = op->a;
+    const uint32_t  size   = a->size;
+    const uint32_t  blocks = op->columns / size;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const uint8_t* keep = op->keep + (size_t) i * blocks;
+        uint32_t       b    = a->offsets[i];
+
+        for (uint32_t k = 0; k < blocks; k++) {
+            if (!keep[k]) {
+                continue;
+            }
+
+            float* block = a->values + (size_t) b * size * size;
+            for (uint32_t r = 0; r < size; r++) {
+                const float* x = op->x + ((size_t) i * size + r) * op->columns
+                                 + (size_t) k * size;
+                for (uint32_t q = 0; q < size; q++) {
+                    block[r * size + q] = x[q];
+                }
+            }
+
+            a->indices[b++] = k;
+        }
+    }
+}
+
+// Block row kernel expanding the blocks of rows [begin, end) of a into the
+// zeroed y
+static void bsr_unpack_routine(thread_data_t* task) {
+    const bsr_op_t* op   = (const bsr_op_t*) task->a;
+    const bsr_t*    a    = op->a;
+    const uint32_t  size = a->size;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        for (uint32_t b = a->offsets[i]; b < a->offsets[i + 1]; b++) {
+            const float* block = a->values + (size_t) b * size * size;
+            for (uint32_t r = 0; r < size; r++) {
+                float* y = op->y + ((size_t) i * size + r) * a->columns
+                           + (size_t) a->indices[b] * size;
+                for (uint32_t q = 0; q < size; q++) {
+                    y[q] = block[r * size + q];
+                }
+            }
+        }
+    }
+}
+
+bsr_t* bsr_from_matrix_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          size,
+    float             threshold
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)
+        || !bsr_shape_is_valid(matrix->rows, matrix->columns, size)) {
+        return NULL;
+    }
+
+    uint32_t rows   = matrix->rows / size;
+    size_t   blocks = (size_t) rows * (matrix->columns / size);
+
+    // Find the kept blocks first, so the matrix is allocated once
+    bsr_t shape = {.rows = matrix->rows, .size = size};
+
+    bsr_op_t op = {
+        .a         = &shape,
+        .x         = matrix->data,
+        .columns   = matrix->columns,
+        .threshold = threshold * threshold,
+    };
+
+    size_t mark = linear_context_scratch_mark(context);
+    op.keep     = linear_context_scratch_alloc(context, (blocks) ? blocks : 1);
+    op.counts   = linear_context_scratch_alloc(
+        context, ((size_t) rows + 1) * sizeof(uint32_t)
+    );
+    if (NULL == op.keep || NULL == op.counts) {
+        LOG_ERROR("Failed to allocate memory for the block flags.\n");
+        linear_context_scratch_release(context, mark);
+        return NULL;
+    }
+
+    uint64_t work = (uint64_t) matrix_element_count(matrix);
+    if (!bsr_run(context, &op, bsr_count_routine, work)) {
+        linear_context_scratch_release(context, mark);
+        return NULL;
+    }
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < rows; i++) {
+        total += op.counts[i];
+    }
+
+    bsr_t* bsr = bsr_create_ctx(
+        context, matrix->rows, matrix->columns, size, total
+    );
+    if (NULL == bsr) {
+        linear_context_scratch_release(context, mark);
+        return NULL; // Error is logged by default
+    }
+
+    for (uint32_t i = 0; i < rows; i++) {
+        bsr->offsets[i + 1] = bsr->offsets[i] + op.counts[i];
+    }
+
+    op.a = bsr;
+    work = (uint64_t) total * size * size + blocks;
+    if (!bsr_run(context, &op, bsr_pack_routine, work)) {
+        bsr_free_ctx(context, bsr);
+        bsr = NULL;
+    }
+
+    linear_context_scratch_release(context, mark);
+    return bsr;
+}
+
+matrix_t* bsr_to_matrix_ctx(linear_context_t* context, const bsr_t* bsr) {
+    context = linear_context_resolve(context);
+    if (NULL == bsr || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    matrix_t* matrix = matrix_create_ctx(context, bsr->rows, bsr->columns);
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    bsr_op_t op = {
+        .a = (bsr_t*) bsr,
+        .y = matrix->data,
+    };
+
+    uint64_t work = (uint64_t) bsr->blocks * bsr->size * bsr->size;
+    if (!bsr_run(context, &op, bsr_unpack_routine, work)) {
+        matrix_free_ctx(context, matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
+
+// Products
+
+// Multiply a size x size block into columns [first, last) of the size rows
+// of z, reading the size rows of x. Called with a constant size, so the
+// block loops unroll and the column loop vectorizes.
+static inline void bsr_block_kernel(
+    const float* block,
+    uint32_t     size,
+    float        alpha,
+    const float* x,
+    float*       z,
+    size_t       n,
+    uint32_t     first,
+    uint32_t     last
+) {
+    for (uint32_t r = 0; r < size; r++) {
+        float* zr = z + r * n;
+        for (uint32_t q = 0; q < size; q++) {
+            const float  scale = alpha * block[r * size + q];
+            const float* xq    = x + q * n;
+            for (uint32_t j = first; j < last; j++) {
+                zr[j] += scale * xq[j];
+            }
+        }
+    }
+}
+
+// Block row kernel computing rows [begin, end) * size of
+// c = alpha * a * b + beta * c, one column tile at a time
+static void bsr_gemm_routine(thread_data_t* task) {
+    const bsr_op_t* op   = (const bsr_op_t*) task->a;
+    const bsr_t*    a    = op->a;
+    const uint32_t  size = a->size;
+    const size_t    n    = op->columns;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float* z = op->y + (size_t) i * size * n;
+
+        // beta == 0 overwrites, so uninitialized NaNs do not propagate
+        for (size_t j = 0; j < size * n; j++) {
+            z[j] = (0.0f == op->beta) ? 0.0f : op->beta * z[j];
+        }
+
+        for (uint32_t first = 0; first < n; first += LINEAR_BSR_TILE) {
+            uint32_t last = (n - first > LINEAR_BSR_TILE)
+                                ? first + LINEAR_BSR_TILE
+                                : (uint32_t) n;
+
+            for (uint32_t b = a->offsets[i]; b < a->offsets[i + 1]; b++) {
+                const float* block = a->values + (size_t) b * size * size;
+                const float* x     = op->x + (size_t) a->indices[b] * size * n;
+                switch (size) {
+                    case 4:
+                        bsr_block_kernel(
+                            block, 4, op->alpha, x, z, n, first, last
+                        );
+                        break;
+                    case 8:
+                        bsr_block_kernel(
+                            block, 8, op->alpha, x, z, n, first, last
+                        );
+                        break;
+                    default:
+                        bsr_block_kernel(
+                            block, 16, op->alpha, x, z, n, first, last
+                        );
+                        break;
+                }
+            }
+        }
+    }
+}
+
+bool bsr_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const bsr_t*      a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || NULL == c
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (a->columns != b->rows || a->rows != c->rows
+        || b->columns != c->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot multiply a BSR matrix of "
+            "size %ux%u by %ux%u into %ux%u.\n",
+            a->rows,
+            a->columns,
+            b->rows,
+            b->columns,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    if (b->data == c->data) {
+        LOG_ERROR("BSR GEMM input and output matrices must not overlap.\n");
+        return false;
+    }
+
+    bsr_op_t op = {
+        .a       = (bsr_t*) a,
+        .x       = b->data,
+        .y       = c->data,
+        .columns = c->columns,
+        .alpha   = alpha,
+        .beta    = beta,
+    };
+
+    matrix_invalidate(c);
+
+    // Each stored element costs a multiply-add per column, and each row of
+    // c is scaled by beta
+    uint64_t work = ((uint64_t) a->blocks * a->size + a->rows) * a->size;
+    return bsr_run(context, &op, bsr_gemm_routine, work * c->columns);
+}
+
+// Multiply a size x size block by the size elements of x into those of z.
+// Called with a constant size, so the dot products unroll and vectorize.
+static inline void bsr_block_gemv_kernel(
+    const float* block, uint32_t size, const float* x, float* z
+) {
+    for (uint32_t r = 0; r < size; r++) {
+        float sum = 0.0f;
+        for (uint32_t q = 0; q < size; q++) {
+            sum += block[r * size + q] * x[q];
+        }
+        z[r] += sum;
+    }
+}
+
+// Block row kernel computing elements [begin, end) * size of
+// y = alpha * a * x + beta * y
+static void bsr_gemv_routine(thread_data_t* task) {
+    const bsr_op_t* op   = (const bsr_op_t*) task->a;
+    const bsr_t*    a    = op->a;
+    const uint32_t  size = a->size;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float z[16] = {0};
+        for (uint32_t b = a->offsets[i]; b < a->offsets[i + 1]; b++) {
+            const float* block = a->values + (size_t) b * size * size;
+            const float* x     = op->x + (size_t) a->indices[b] * size;
+            switch (size) {
+                case 4:
+                    bsr_block_gemv_kernel(block, 4, x, z);
+                    break;
+                case 8:
+                    bsr_block_gemv_kernel(block, 8, x, z);
+                    break;
+                default:
+                    bsr_block_gemv_kernel(block, 16, x, z);
+                    break;
+            }
+        }
+
+        // beta == 0 overwrites, so uninitialized NaNs do not propagate
+        float* y = op->y + (size_t) i * size;
+        for (uint32_t r = 0; r < size; r++) {
+            float scaled = (0.0f == op->beta) ? 0.0f : op->beta * y[r];
+            y[r]         = scaled + op->alpha * z[r];
+        }
+    }
+}
+
+// Verify a NUMERIC_FLOAT32 vector holds count elements
+static bool bsr_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+bool bsr_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const bsr_t*      a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !bsr_vector_is_valid(x, a->columns)
+        || !bsr_vector_is_valid(y, a->rows)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("BSR GEMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    bsr_op_t op = {
+        .a     = (bsr_t*) a,
+        .x     = (const float*) x->data,
+        .y     = (float*) y->data,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+
+    uint64_t work = ((uint64_t) a->blocks * a->size + a->rows) * a->size;
+    return bsr_run(context, &op, bsr_gemv_routine, work);
+}
@@ -0,0 +1,530 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/context.c
+ *
+ * @brief An explicit execution context for the Linear API
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "context.h"
+#include "logger.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Default allocator
+
+static void* linear_default_allocate(size_t size, void* user) {
+    (void) user;
+    return malloc(size);
+}
+
+static void linear_default_release(void* pointer, void* user) {
+    (void) user;
+    free(pointer);
+}
+
+static const linear_allocator_t linear_default_allocator = {
+    .allocate = linear_default_allocate,
+    .release  = linear_default_release,
+    .user     = NULL,
+};
+
+// Tuning profiles
+
+linear_tuning_profile_t linear_tuning_profile(linear_tuning_t mode) {
+    linear_tuning_profile_t profile = {
+        .mode             = TUNING_BALANCED,
+        .grain_size       = 4096,
+        .tasks_per_thread = 1,
+    };
+
+    switch (mode) {
+        case TUNING_LATENCY:
+            profile.mode       = TUNING_LATENCY;
+            profile.grain_size = 16384;
+            break;
+        case TUNING_THROUGHPUT:
+            profile.mode             = TUNING_THROUGHPUT;
+            profile.grain_size       = 1024;
+            profile.tasks_per_thread = 4;
+            break;
+        default:
+            break;
+    }
+
+    return profile;
+}
+
+// Context lifecycle management
+
+// Create a context whose pool is optionally spawned upon first use
+static linear_context_t*
+linear_context_construct(uint32_t num_threads, bool deferred) {
+    linear_context_t* context = malloc(sizeof(linear_context_t));
+    if (NULL == context) {
+        LOG_ERROR("Failed to allocate memory for linear_context_t.\n");
+        return NULL;
+    }
+
+    context->pool       = NULL;
+    context->allocator  = linear_default_allocator;
+    context->backend    = BACKEND_CPU;
+    context->precision  = NUMERIC_FLOAT32;
+    context->tuning     = linear_tuning_profile(TUNING_BALANCED);
+    context->priority   = THREAD_PRIORITY_NORMAL;
+    context->schedule   = (linear_thread_is_hybrid()) ? SCHEDULE_GUIDED
+                                                      : SCHEDULE_STATIC;
+    context->validation = VALIDATION_NONE;
+    context->owns_pool  = false;
+
+    if (1 == num_threads) {
+        return context; // execute on the calling thread
+    }
+
+    context->pool = (deferred) ? thread_pool_create_deferred(num_threads)
+                               : thread_pool_create(num_threads);
+    if (NULL == context->pool) {
+        LOG_ERROR("Failed to create the thread pool for the context.\n");
+        free(context);
+        return NULL;
+    }
+    context->owns_pool = true;
+
+    return context;
+}
+
+linear_context_t* linear_context_create(uint32_t num_threads) {
+    return linear_context_construct(num_threads, false);
+}
+
+linear_context_t* linear_context_create_deferred(uint32_t num_threads) {
+    return linear_context_construct(num_threads, true);
+}
+
+void linear_context_free(linear_context_t* context) {
+    if (NULL == context) {
+        return;
+    }
+
+    if (context->owns_pool) {
+        thread_pool_free(context->pool);
+    }
+
+    free(context);
+}
+
+static linear_context_t* linear_context_global = NULL;
+static pthread_once_t    linear_context_once   = PTHREAD_ONCE_INIT;
+
+static void linear_context_global_create(void) {
+#ifdef LINEAR_THREAD
+    // Deferred, so processes that fork before computing never spawn workers
+    linear_context_global = linear_context_create_deferred(0);
+#else
+    linear_context_global = linear_context_create(1);
+#endif // LINEAR_THREAD
+}
+
+linear_context_t* linear_context_default(void) {
+    pthread_once(&linear_context_once, linear_context_global_create);
+    return linear_context_global;
+}
+
+linear_context_t* linear_context_resolve(linear_context_t* context) {
+    return (context) ? context : linear_context_default();
+}
+
+// Context configuration
+
+void linear_context_set_pool(linear_context_t* context, thread_pool_t* pool) {
+    if (context->owns_pool && context->pool != pool) {
+        thread_pool_free(context->pool);
+    }
+
+    context->pool      = pool;
+    context->owns_pool = false;
+}
+
+void linear_context_set_allocator(
+    linear_context_t* context, linear_allocator_t allocator
+) {
+    if (NULL == allocator.allocate || NULL == allocator.release) {
+        LOG_ERROR("Allocator callbacks must not be NULL.\n");
+        return;
+    }
+
+    context->allocator = allocator;
+}
+
+bool linear_context_set_backend(
+    linear_context_t* context, thread_backend_t backend
+) {
+    switch (backend) {
+        case BACKEND_CPU:
+            context->backend = backend;
+            return true;
+#ifdef LINEAR_VULKAN
+        case BACKEND_VULKAN:
+            context->backend = backend;
+            return true;
+#endif // LINEAR_VULKAN
+        default:
+            LOG_ERROR("Unsupported backend %d.\n", backend);
+            return false;
+    }
+}
+
+bool linear_context_set_precision(
+    linear_context_t* context, numeric_data_t precision
+) {
+    if (0 == numeric_data_size(precision)) {
+        LOG_ERROR("Unsupported precision %d.\n", precision);
+        return false;
+    }
+
+    context->precision = precision;
+    return true;
+}
+
+void linear_context_set_tuning(
+    linear_context_t* context, linear_tuning_t mode
+) {
+    context->tuning = linear_tuning_profile(mode);
+}
+
+void linear_context_set_priority(
+    linear_context_t* context, thread_priority_t priority
+) {
+    if (priority >= THREAD_PRIORITY_COUNT) {
+        LOG_ERROR("Unsupported priority %d.\n", priority);
+        return;
+    }
+
+    context->priority = priority;
+}
+
+void linear_context_set_schedule(
+    linear_context_t* context, linear_schedule_t schedule
+) {
+    if (schedule >= SCHEDULE_COUNT) {
+        LOG_ERROR("Unsupported schedule %d.\n", schedule);
+        return;
+    }
+
+    context->schedule = schedule;
+}
+
+void linear_context_set_validation(
+    linear_context_t* context, linear_validation_t validation
+) {
+    if (validation >= VALIDATION_COUNT) {
+        LOG_ERROR("Unsupported validation %d.\n", validation);
+        return;
+    }
+
+    context->validation = validation;
+}
+
+bool linear_context_set_cores(linear_context_t* context, thread_core_t cores) {
+    if (NULL == context->pool) {
+        return true; // executes on the calling thread
+    }
+
+    return thread_pool_set_cores(context->pool, cores);
+}
+
+// Context memory management
+
+void* linear_context_allocate(linear_context_t* context, size_t size) {
+    context = linear_context_resolve(context);
+    return context->allocator.allocate(size, context->allocator.user);
+}
+
+void linear_context_release(linear_context_t* context, void* pointer) {
+    if (NULL == pointer) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    context->allocator.release(pointer, context->allocator.user);
+}
+
+// Context execution
+
+uint32_t linear_context_thread_count(const linear_context_t* context) {
+    if (NULL == context || NULL == context->pool) {
+        return 1;
+    }
+
+    return (context->pool->thread_count) ? context->pool->thread_count : 1;
+}
+
+uint32_t linear_context_task_count(
+    const linear_context_t* context, uint32_t count
+) {
+    uint32_t threads = linear_context_thread_count(context);
+    if (1 == threads || 0 == count) {
+        return 1;
+    }
+
+    uint32_t grain = (context->tuning.grain_size) ? context->tuning.grain_size
+                                                  : 1;
+    uint32_t tasks = threads * context->tuning.tasks_per_thread;
+    uint32_t limit = (count + grain - 1) / grain; // respect the grain size
+
+    if (tasks > limit) {
+        tasks = limit;
+    }
+
+    return (tasks) ? tasks : 1;
+}
+
+void linear_context_run(
+    linear_context_t* context, thread_data_t* tasks, uint32_t count
+) {
+    context = linear_context_resolve(context);
+
+    // The workers of a region led by the caller are spinning in its team,
+    // so ops issued from within the region execute on the caller alone
+    if (NULL == context->pool || count <= 1
+        || thread_pool_is_leader(context->pool)) {
+        for (uint32_t i = 0; i < count; i++) {
+            thread_task_execute(&tasks[i]);
+        }
+        return;
+    }
+
+    // Wait on our own tasks only, so runs nested within a task compose
+    thread_group_t group = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        tasks[i].group = &group;
+    }
+    thread_pool_submit_batch(context->pool, tasks, count, context->priority);
+    thread_group_wait(context->pool, &group);
+}
+
+// Shared cursor handing out chunks of [0, count) to the tasks of a schedule
+typedef struct LinearScheduleState {
+    atomic_uint       next;     // Start of the next unclaimed chunk
+    uint32_t          count;    // End of the range
+    uint32_t          n;        // Number of tasks
+    uint32_t          minimum;  // Smallest chunk handed out
+    linear_schedule_t schedule; // SCHEDULE_DYNAMIC or SCHEDULE_GUIDED
+    thread_data_t*    tasks;    // Tasks executing the claimed chunks
+} linear_schedule_state_t;
+
+// Claim the next chunk, returning false once the range is exhausted
+static bool linear_schedule_claim(
+    linear_schedule_state_t* state, uint32_t* begin, uint32_t* end
+) {
+    uint32_t current = atomic_load(&state->next);
+    while (current < state->count) {
+        uint32_t remaining = state->count - current;
+        uint32_t chunk     = state->minimum;
+        if (SCHEDULE_GUIDED == state->schedule) {
+            uint32_t guided = remaining / (2 * state->n);
+            chunk           = (guided > chunk) ? guided : chunk;
+        }
+        chunk = (chunk < remaining) ? chunk : remaining;
+
+        if (atomic_compare_exchange_weak(
+                &state->next, &current, current + chunk
+            )) {
+            *begin = current;
+            *end   = current + chunk;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Repeatedly claim chunks on behalf of the task indexed by begin
+static void linear_schedule_routine(thread_data_t* driver) {
+    linear_schedule_state_t* state = (linear_schedule_state_t*) driver->a;
+    thread_data_t*           task  = &state->tasks[driver->begin];
+
+    while (linear_schedule_claim(state, &task->begin, &task->end)) {
+        thread_task_execute(task);
+    }
+}
+
+void linear_context_schedule(
+    linear_context_t* context, thread_data_t* tasks, uint32_t n, uint32_t count
+) {
+    context = linear_context_resolve(context);
+
+    if (SCHEDULE_STATIC == context->schedule || n <= 1) {
+        linear_context_run(context, tasks, n);
+        return;
+    }
+
+    uint32_t divisor = n * LINEAR_SCHEDULE_CHUNKS;
+    if (SCHEDULE_GUIDED == context->schedule) {
+        divisor *= 4; // guided chunks shrink further towards the end
+    }
+
+    linear_schedule_state_t state = {
+        .count    = count,
+        .n        = n,
+        .minimum  = (count / divisor) ? count / divisor : 1,
+        .schedule = context->schedule,
+        .tasks    = tasks,
+    };
+    atomic_init(&state.next, 0);
+
+    size_t         mark    = linear_context_scratch_mark(context);
+    thread_data_t* drivers = linear_context_scratch_alloc(
+        context, sizeof(thread_data_t) * n
+    );
+    if (NULL == drivers) {
+        linear_context_run(context, tasks, n); // fall back to the static split
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        drivers[i] = (thread_data_t) {
+            .a       = &state,
+            .begin   = i,
+            .end     = i + 1,
+            .routine = linear_schedule_routine,
+        };
+    }
+
+    linear_context_run(context, drivers, n);
+    linear_context_scratch_release(context, mark);
+}
+
+// Scratch memory
+
+size_t linear_context_scratch_mark(linear_context_t* context) {
+    return thread_scratch_mark(linear_context_resolve(context)->pool);
+}
+
+void* linear_context_scratch_alloc(linear_context_t* context, size_t size) {
+    return thread_scratch_alloc(linear_context_resolve(context)->pool, size);
+}
+
+void linear_context_scratch_release(linear_context_t* context, size_t mark) {
+    thread_scratch_release(linear_context_resolve(context)->pool, mark);
+}
+
+bool linear_context_is_cpu(const linear_context_t* context) {
+    if (BACKEND_CPU != context->backend) {
+        LOG_ERROR("Backend %d has no kernel for this op.\n", context->backend);
+        return false;
+    }
+
+    return true;
+}
+
+// Copy the template task into n chunks covering [0, count)
+static void linear_context_partition(
+    thread_data_t task, uint32_t count, uint32_t n, thread_data_t* tasks
+) {
+    // Distribute the remainder so no task exceeds another by more than one
+    uint32_t chunk_size = count / n;
+    uint32_t remainder  = count % n;
+    uint32_t begin      = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        tasks[i]       = task;
+        tasks[i].begin = begin;
+        tasks[i].end   = begin + chunk_size + ((i < remainder) ? 1 : 0);
+        begin          = tasks[i].end;
+    }
+}
+
+thread_data_t* linear_context_split(
+    const linear_context_t* context,
+    thread_data_t           task,
+    uint32_t                count,
+    uint32_t*               task_count
+) {
+    uint32_t       n     = linear_context_task_count(context, count);
+    thread_data_t* tasks = malloc(sizeof(thread_data_t) * n);
+    if (NULL == tasks) {
+        LOG_ERROR("Failed to allocate memory for %u tasks.\n", n);
+        return NULL;
+    }
+
+    linear_context_partition(task, count, n, tasks);
+    *task_count = n;
+    return tasks;
+}
+
+thread_data_t* linear_context_split_scratch(
+    linear_context_t* context,
+    thread_data_t     task,
+    uint32_t          count,
+    uint32_t*         task_count
+) {
+    context              = linear_context_resolve(context);
+    uint32_t       n     = linear_context_task_count(context, count);
+    thread_data_t* tasks = linear_context_scratch_alloc(
+        context, sizeof(thread_data_t) * n
+    );
+    if (NULL == tasks) {
+        return NULL;
+    }
+
+    linear_context_partition(task, count, n, tasks);
+    *task_count = n;
+    return tasks;
+}
+
+bool linear_context_parallel(
+    linear_context_t* context, thread_data_t task, uint32_t count
+) {
+    return linear_context_parallel_work(context, task, count, count);
+}
+
+bool linear_context_parallel_work(
+    linear_context_t* context,
+    thread_data_t     task,
+    uint32_t          count,
+    uint64_t          work
+) {
+    context = linear_context_resolve(context);
+
+    if (NULL == task.routine) {
+        LOG_ERROR("A range routine is required for parallel execution.\n");
+        return false;
+    }
+
+    work       = (work > UINT32_MAX) ? UINT32_MAX : work;
+    uint32_t n = linear_context_task_count(context, (uint32_t) work);
+    n          = (n > count) ? count : n;
+
+    if (n <= 1) {
+        task.begin = 0;
+        task.end   = count;
+        thread_task_execute(&task);
+        return true;
+    }
+
+    size_t         mark  = linear_context_scratch_mark(context);
+    thread_data_t* tasks = linear_context_scratch_alloc(
+        context, sizeof(thread_data_t) * n
+    );
+    if (NULL == tasks) {
+        return false;
+    }
+
+    linear_context_partition(task, count, n, tasks);
+    linear_context_schedule(context, tasks, n, count);
+    linear_context_scratch_release(context, mark);
+
+    return true;
+}
+
+uint32_t linear_context_region(
+    linear_context_t* context, thread_region_t region, void* arg
+) {
+    context = linear_context_resolve(context);
+    return thread_pool_region(context->pool, 0, region, arg);
+}
@@ -0,0 +1,755 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/covariance.c
+ *
+ * @brief Streaming covariance and incremental PCA over blocks of rows
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "covariance.h"
+#include "logger.h"
+#include "lowrank.h"
+
+#include <math.h>
+#include <stdatomic.h>
+
+// Rows whose products a scatter tile sums in single precision before adding
+// them to the double precision scatter
+#define COVARIANCE_FLUSH 256
+
+// Lifecycle management
+
+covariance_t*
+covariance_create_ctx(linear_context_t* context, uint32_t dimension) {
+    context = linear_context_resolve(context);
+    if (0 == dimension) {
+        LOG_ERROR("Expected at least one column.\n");
+        return NULL;
+    }
+
+    covariance_t* covariance = linear_context_allocate(
+        context, sizeof(covariance_t)
+    );
+    if (NULL == covariance) {
+        LOG_ERROR("Failed to allocate memory for covariance_t.\n");
+        return NULL;
+    }
+
+    size_t elements       = (size_t) dimension * dimension;
+    covariance->mean      = linear_context_allocate(
+        context, sizeof(double) * dimension
+    );
+    covariance->scatter   = linear_context_allocate(
+        context, sizeof(double) * elements
+    );
+    covariance->count     = 0;
+    covariance->dimension = dimension;
+    if (NULL == covariance->mean || NULL == covariance->scatter) {
+        LOG_ERROR("Failed to allocate memory for the accumulator.\n");
+        covariance_free_ctx(context, covariance);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < dimension; i++) {
+        covariance->mean[i] = 0.0;
+    }
+    for (size_t i = 0; i < elements; i++) {
+        covariance->scatter[i] = 0.0;
+    }
+
+    return covariance;
+}
+
+void covariance_free_ctx(linear_context_t* context, covariance_t* covariance) {
+    if (NULL == covariance) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, covariance->mean);
+    linear_context_release(context, covariance->scatter);
+    linear_context_release(context, covariance);
+}
+
+pca_t* pca_create_ctx(
+    linear_context_t* context, uint32_t dimension, uint32_t rank
+) {
+    context = linear_context_resolve(context);
+    if (0 == rank || rank > dimension) {
+        LOG_ERROR(
+            "Cannot keep %u components of %u columns.\n", rank, dimension
+        );
+        return NULL;
+    }
+
+    pca_t* pca = linear_context_allocate(context, sizeof(pca_t));
+    if (NULL == pca) {
+        LOG_ERROR("Failed to allocate memory for pca_t.\n");
+        return NULL;
+    }
+
+    pca->components = matrix_create_ctx(context, rank, dimension);
+    pca->singular   = linear_context_allocate(context, sizeof(float) * rank);
+    pca->mean       = linear_context_allocate(
+        context, sizeof(double) * dimension
+    );
+    pca->count      = 0;
+    pca->dimension  = dimension;
+    pca->rank       = rank;
+    pca->size       = 0;
+    if (NULL == pca->components || NULL == pca->singular
+        || NULL == pca->mean) {
+        LOG_ERROR("Failed to allocate memory for the components.\n");
+        pca_free_ctx(context, pca);
+        return NULL;
+    }
+
+    for (uint32_t t = 0; t < rank; t++) {
+        pca->singular[t] = 0.0f;
+    }
+    for (uint32_t i = 0; i < dimension; i++) {
+        pca->mean[i] = 0.0;
+    }
+
+    return pca;
+}
+
+void pca_free_ctx(linear_context_t* context, pca_t* pca) {
+    if (NULL == pca) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    matrix_free_ctx(context, pca->components);
+    linear_context_release(context, pca->singular);
+    linear_context_release(context, pca->mean);
+    linear_context_release(context, pca);
+}
+
+// Shared helpers
+
+// Verify a block of rows has the given number of columns
+static bool covariance_rows_are_valid(const matrix_t* rows, uint32_t d) {
+    if (NULL == rows) {
+        return false;
+    }
+
+    if (d != rows->columns) {
+        LOG_ERROR("Expected rows of %u columns, got %u.\n", d, rows->columns);
+        return false;
+    }
+
+    return true;
+}
+
+// Column means of a block of rows, in double precision
+static void covariance_column_mean(const matrix_t* rows, double* mean) {
+    const uint32_t d = rows->columns;
+
+    for (uint32_t j = 0; j < d; j++) {
+        mean[j] = 0.0;
+    }
+    for (uint32_t r = 0; r < rows->rows; r++) {
+        const float* row = rows->data + (size_t) r * d;
+        for (uint32_t j = 0; j < d; j++) {
+            mean[j] += row[j];
+        }
+    }
+    for (uint32_t j = 0; j < d; j++) {
+        mean[j] /= rows->rows;
+    }
+}
+
+// Subtract mean from each row of a block into centered
+static void covariance_subtract(
+    const matrix_t* rows, const double* mean, float* centered
+) {
+    const uint32_t d = rows->columns;
+
+    for (uint32_t r = 0; r < rows->rows; r++) {
+        const float* row = rows->data + (size_t) r * d;
+        float*       z   = centered + (size_t) r * d;
+        for (uint32_t j = 0; j < d; j++) {
+            z[j] = (float) (row[j] - mean[j]);
+        }
+    }
+}
+
+// Weight n * m / (n + m) of the outer product of the difference of two
+// means when merging partial accumulators of n and m rows
+static double covariance_weight(uint64_t n, uint64_t m) {
+    return (n + m > 0) ? (double) n * m / (double) (n + m) : 0.0;
+}
+
+// Move a running mean of n rows to that of n + m rows, the m rows having
+// the mean other
+static void covariance_shift(
+    double*       mean,
+    uint64_t*     count,
+    const double* other,
+    uint64_t      m,
+    uint32_t      d
+) {
+    if (0 == m) {
+        return;
+    }
+
+    double share = (double) m / (double) (*count + m);
+    for (uint32_t j = 0; j < d; j++) {
+        mean[j] += (other[j] - mean[j]) * share;
+    }
+    *count += m;
+}
+
+// Covariance
+
+// Operands of a scatter update, one task per tile on or above the diagonal
+typedef struct CovarianceOp {
+    linear_context_t* context;   // Context whose scratch the tasks allocate
+    const float*      x;         // The b x d centered rows, or NULL
+    const double*     other;     // Scatter merged in, or NULL
+    const double*     delta;     // Difference of the means merged
+    double*           scatter;   // The d x d scatter accumulated into
+    double            weight;    // Weight of delta * delta'
+    uint32_t          rows;      // Number of centered rows b
+    uint32_t          dimension; // Number of columns d
+    uint32_t          tiles;     // Tiles along each side of the scatter
+    atomic_uint       failures;  // Tasks that failed to allocate
+} covariance_op_t;
+
+// Accumulate the elements on or above the diagonal of the scatter tile of
+// rows [i0, i1) and columns [j0, j1)
+static void covariance_tile(
+    const covariance_op_t* op,
+    float*                 acc,
+    uint32_t               i0,
+    uint32_t               i1,
+    uint32_t               j0,
+    uint32_t               j1
+) {
+    const uint32_t d     = op->dimension;
+    const uint32_t width = j1 - j0;
+
+    for (uint32_t i = i0; i < i1; i++) {
+        double*        s     = op->scatter + (size_t) i * d;
+        const double   scale = op->weight * op->delta[i];
+        const uint32_t first = (i > j0) ? i : j0;
+        for (uint32_t j = first; j < j1; j++) {
+            s[j] += scale * op->delta[j];
+        }
+        if (op->other) {
+            const double* t = op->other + (size_t) i * d;
+            for (uint32_t j = first; j < j1; j++) {
+                s[j] += t[j];
+            }
+        }
+    }
+
+    if (NULL == op->x) {
+        return;
+    }
+
+    // Rank-1 updates of a single precision tile by each row, flushed to the
+    // scatter every COVARIANCE_FLUSH rows
+    for (uint32_t r0 = 0; r0 < op->rows; r0 += COVARIANCE_FLUSH) {
+        uint32_t r1 = (op->rows - r0 > COVARIANCE_FLUSH)
+                          ? r0 + COVARIANCE_FLUSH
+                          : op->rows;
+
+        for (uint32_t k = 0; k < (i1 - i0) * width; k++) {
+            acc[k] = 0.0f;
+        }
+
+        for (uint32_t r = r0; r < r1; r++) {
+            const float* row = op->x + (size_t) r * d;
+            const float* y   = row + j0;
+            for (uint32_t i = i0; i < i1; i++) {
+                const float xi = row[i];
+                float*      a  = acc + (size_t) (i - i0) * width;
+                for (uint32_t j = 0; j < width; j++) {
+                    a[j] += xi * y[j];
+                }
+            }
+        }
+
+        for (uint32_t i = i0; i < i1; i++) {
+            double*        s     = op->scatter + (size_t) i * d + j0;
+            const float*   a     = acc + (size_t) (i - i0) * width;
+            const uint32_t first = (i > j0) ? i - j0 : 0;
+            for (uint32_t j = first; j < width; j++) {
+                s[j] += a[j];
+            }
+        }
+    }
+}
+
+// Range kernel accumulating tiles [begin, end) of the upper triangle,
+// numbered along each tile row from the diagonal
+static void covariance_tile_routine(thread_data_t* task) {
+    covariance_op_t* op    = (covariance_op_t*) task->a;
+    const uint32_t   d     = op->dimension;
+    const uint32_t   tiles = op->tiles;
+
+    size_t mark = linear_context_scratch_mark(op->context);
+    float* acc  = NULL;
+    if (op->x) {
+        acc = linear_context_scratch_alloc(
+            op->context,
+            sizeof(float) * LINEAR_COVARIANCE_TILE * LINEAR_COVARIANCE_TILE
+        );
+        if (NULL == acc) {
+            LOG_ERROR("Failed to allocate memory for the tile.\n");
+            atomic_fetch_add(&op->failures, 1);
+            linear_context_scratch_release(op->context, mark);
+            return;
+        }
+    }
+
+    // Tile row ti holds tiles - ti tiles, from column ti on
+    uint32_t ti = 0;
+    uint32_t tj = task->begin;
+    while (tj >= tiles - ti) {
+        tj -= tiles - ti;
+        ti++;
+    }
+    tj += ti;
+
+    for (uint32_t t = task->begin; t < task->end; t++) {
+        uint32_t i0 = ti * LINEAR_COVARIANCE_TILE;
+        uint32_t j0 = tj * LINEAR_COVARIANCE_TILE;
+        uint32_t i1 = (d - i0 > LINEAR_COVARIANCE_TILE)
+                          ? i0 + LINEAR_COVARIANCE_TILE
+                          : d;
+        uint32_t j1 = (d - j0 > LINEAR_COVARIANCE_TILE)
+                          ? j0 + LINEAR_COVARIANCE_TILE
+                          : d;
+        covariance_tile(op, acc, i0, i1, j0, j1);
+
+        if (++tj == tiles) {
+            ti++;
+            tj = ti;
+        }
+    }
+
+    linear_context_scratch_release(op->context, mark);
+}
+
+// Accumulate the upper triangle of the scatter, one task per tile
+static bool
+covariance_accumulate(linear_context_t* context, covariance_op_t* op) {
+    const uint32_t d     = op->dimension;
+    op->tiles            = (d + LINEAR_COVARIANCE_TILE - 1)
+                / LINEAR_COVARIANCE_TILE;
+    const uint32_t pairs = op->tiles * (op->tiles + 1) / 2;
+    atomic_init(&op->failures, 0);
+
+    thread_data_t task = {
+        .a       = op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = covariance_tile_routine,
+    };
+
+    uint64_t tile = (uint64_t) LINEAR_COVARIANCE_TILE * LINEAR_COVARIANCE_TILE;
+    uint64_t work = (uint64_t) pairs * tile * (op->rows + 1);
+    return linear_context_parallel_work(context, task, pairs, work)
+           && 0 == atomic_load(&op->failures);
+}
+
+bool covariance_update_ctx(
+    linear_context_t* context, covariance_t* covariance, const matrix_t* rows
+) {
+    context = linear_context_resolve(context);
+    if (NULL == covariance || !linear_context_is_cpu(context)
+        || !covariance_rows_are_valid(rows, covariance->dimension)) {
+        return false;
+    }
+
+    const uint32_t d = covariance->dimension;
+    const uint32_t b = rows->rows;
+    if (0 == b) {
+        return true;
+    }
+
+    size_t  mark     = linear_context_scratch_mark(context);
+    float*  centered = linear_context_scratch_alloc(
+        context, sizeof(float) * b * d
+    );
+    double* mean     = linear_context_scratch_alloc(
+        context, sizeof(double) * d
+    );
+    double* delta    = linear_context_scratch_alloc(
+        context, sizeof(double) * d
+    );
+    if (NULL == centered || NULL == mean || NULL == delta) {
+        LOG_ERROR("Failed to allocate memory for the block.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // The block is a partial accumulator of its own, centered on its mean
+    covariance_column_mean(rows, mean);
+    covariance_subtract(rows, mean, centered);
+    for (uint32_t j = 0; j < d; j++) {
+        delta[j] = mean[j] - covariance->mean[j];
+    }
+
+    covariance_op_t op = {
+        .context   = context,
+        .x         = centered,
+        .delta     = delta,
+        .scatter   = covariance->scatter,
+        .weight    = covariance_weight(covariance->count, b),
+        .rows      = b,
+        .dimension = d,
+    };
+
+    bool done = covariance_accumulate(context, &op);
+    if (done) {
+        covariance_shift(covariance->mean, &covariance->count, mean, b, d);
+    }
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool covariance_merge_ctx(
+    linear_context_t*   context,
+    covariance_t*       covariance,
+    const covariance_t* other
+) {
+    context = linear_context_resolve(context);
+    if (NULL == covariance || NULL == other
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    const uint32_t d = covariance->dimension;
+    if (d != other->dimension) {
+        LOG_ERROR(
+            "Cannot merge accumulators of %u and %u columns.\n",
+            d,
+            other->dimension
+        );
+        return false;
+    }
+
+    if (covariance == other) {
+        LOG_ERROR("Cannot merge an accumulator into itself.\n");
+        return false;
+    }
+
+    size_t  mark  = linear_context_scratch_mark(context);
+    double* delta = linear_context_scratch_alloc(
+        context, sizeof(double) * d
+    );
+    if (NULL == delta) {
+        LOG_ERROR("Failed to allocate memory for the means.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    for (uint32_t j = 0; j < d; j++) {
+        delta[j] = other->mean[j] - covariance->mean[j];
+    }
+
+    covariance_op_t op = {
+        .context   = context,
+        .other     = other->scatter,
+        .delta     = delta,
+        .scatter   = covariance->scatter,
+        .weight    = covariance_weight(covariance->count, other->count),
+        .dimension = d,
+    };
+
+    bool done = covariance_accumulate(context, &op);
+    if (done) {
+        covariance_shift(
+            covariance->mean, &covariance->count, other->mean, other->count, d
+        );
+    }
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+vector_t* covariance_mean_ctx(
+    linear_context_t* context, const covariance_t* covariance
+) {
+    if (NULL == covariance) {
+        return NULL;
+    }
+
+    vector_t* mean = vector_create_ctx(context, covariance->dimension);
+    if (NULL == mean) {
+        LOG_ERROR("Failed to allocate memory to resulting vector.\n");
+        return NULL;
+    }
+
+    float* data = (float*) mean->data;
+    for (uint32_t j = 0; j < covariance->dimension; j++) {
+        data[j] = (float) covariance->mean[j];
+    }
+
+    return mean;
+}
+
+matrix_t* covariance_to_matrix_ctx(
+    linear_context_t*   context,
+    const covariance_t* covariance,
+    bool                unbiased
+) {
+    if (NULL == covariance) {
+        return NULL;
+    }
+
+    uint64_t correction = (unbiased) ? 1 : 0;
+    if (covariance->count <= correction) {
+        LOG_ERROR(
+            "Cannot estimate a covariance from %llu rows.\n",
+            (unsigned long long) covariance->count
+        );
+        return NULL;
+    }
+    double divisor = (double) (covariance->count - correction);
+
+    const uint32_t d      = covariance->dimension;
+    matrix_t*      matrix = matrix_create_ctx(context, d, d);
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    // Mirror the upper triangle
+    for (uint32_t i = 0; i < d; i++) {
+        const double* s = covariance->scatter + (size_t) i * d;
+        for (uint32_t j = i; j < d; j++) {
+            float value                      = (float) (s[j] / divisor);
+            matrix->data[(size_t) i * d + j] = value;
+            matrix->data[(size_t) j * d + i] = value;
+        }
+    }
+
+    return matrix;
+}
+
+// Incremental PCA
+
+// Replace the components of a PCA with the top singular vectors of the
+// stacked rows, whose scatter equals that of the data they summarize
+static bool pca_absorb(
+    linear_context_t* context, pca_t* pca, const matrix_t* stacked
+) {
+    lowrank_t* lowrank = lowrank_from_matrix_ctx(context, stacked, pca->rank);
+    if (NULL == lowrank) {
+        return false;
+    }
+
+    // u holds the left singular vectors scaled by the singular values
+    const uint32_t d = pca->dimension;
+    const uint32_t k = lowrank->u->columns;
+    for (uint32_t t = 0; t < k; t++) {
+        double norm = 0.0;
+        for (uint32_t r = 0; r < lowrank->u->rows; r++) {
+            const float e  = lowrank->u->data[(size_t) r * k + t];
+            norm          += (double) e * e;
+        }
+        pca->singular[t] = (float) sqrt(norm);
+
+        float* component = pca->components->data + (size_t) t * d;
+        for (uint32_t j = 0; j < d; j++) {
+            component[j] = lowrank->v->data[(size_t) j * k + t];
+        }
+    }
+
+    pca->size = k;
+    matrix_invalidate(pca->components);
+    lowrank_free_ctx(context, lowrank);
+    return true;
+}
+
+// Write the components of a PCA scaled by their singular values into the
+// first size rows of stacked
+static void pca_stack(const pca_t* pca, float* stacked) {
+    const uint32_t d = pca->dimension;
+
+    for (uint32_t t = 0; t < pca->size; t++) {
+        const float* component = pca->components->data + (size_t) t * d;
+        float*       z         = stacked + (size_t) t * d;
+        for (uint32_t j = 0; j < d; j++) {
+            z[j] = pca->singular[t] * component[j];
+        }
+    }
+}
+
+// Write the row correcting the stack for merging the mean other of m rows
+// into the running mean of a PCA
+static void pca_correction(
+    const pca_t* pca, const double* other, uint64_t m, float* z
+) {
+    double scale = sqrt(covariance_weight(pca->count, m));
+    for (uint32_t j = 0; j < pca->dimension; j++) {
+        z[j] = (float) (scale * (other[j] - pca->mean[j]));
+    }
+}
+
+bool pca_update_ctx(
+    linear_context_t* context, pca_t* pca, const matrix_t* rows
+) {
+    context = linear_context_resolve(context);
+    if (NULL == pca || !linear_context_is_cpu(context)
+        || !covariance_rows_are_valid(rows, pca->dimension)) {
+        return false;
+    }
+
+    const uint32_t d = pca->dimension;
+    const uint32_t b = rows->rows;
+    if (0 == b) {
+        return true;
+    }
+
+    size_t   mark    = linear_context_scratch_mark(context);
+    uint32_t m       = pca->size + b + 1;
+    double*  mean    = linear_context_scratch_alloc(
+        context, sizeof(double) * d
+    );
+    matrix_t stacked = {
+        .data    = linear_context_scratch_alloc(
+            context, sizeof(float) * m * d
+        ),
+        .rows    = m,
+        .columns = d,
+        .state   = MATRIX_NONE,
+    };
+    if (NULL == mean || NULL == stacked.data) {
+        LOG_ERROR("Failed to allocate memory for the stacked rows.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // Components, the block centered on its own mean, then the correction
+    float* block = stacked.data + (size_t) pca->size * d;
+    pca_stack(pca, stacked.data);
+    covariance_column_mean(rows, mean);
+    covariance_subtract(rows, mean, block);
+    pca_correction(pca, mean, b, block + (size_t) b * d);
+
+    bool done = pca_absorb(context, pca, &stacked);
+    if (done) {
+        covariance_shift(pca->mean, &pca->count, mean, b, d);
+    }
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool pca_merge_ctx(
+    linear_context_t* context, pca_t* pca, const pca_t* other
+) {
+    context = linear_context_resolve(context);
+    if (NULL == pca || NULL == other || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    const uint32_t d = pca->dimension;
+    if (d != other->dimension || pca == other) {
+        LOG_ERROR(
+            "Cannot merge a PCA of %u columns into one of %u.\n",
+            other->dimension,
+            d
+        );
+        return false;
+    }
+
+    if (0 == other->count) {
+        return true;
+    }
+
+    size_t   mark    = linear_context_scratch_mark(context);
+    uint32_t m       = pca->size + other->size + 1;
+    matrix_t stacked = {
+        .data    = linear_context_scratch_alloc(
+            context, sizeof(float) * m * d
+        ),
+        .rows    = m,
+        .columns = d,
+        .state   = MATRIX_NONE,
+    };
+    if (NULL == stacked.data) {
+        LOG_ERROR("Failed to allocate memory for the stacked rows.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // Both sets of components, then the correction
+    float* tail = stacked.data + (size_t) pca->size * d;
+    pca_stack(pca, stacked.data);
+    pca_stack(other, tail);
+    pca_correction(
+        pca, other->mean, other->count, tail + (size_t) other->size * d
+    );
+
+    bool done = pca_absorb(context, pca, &stacked);
+    if (done) {
+        covariance_shift(pca->mean, &pca->count, other->mean, other->count, d);
+    }
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool pca_transform_ctx(
+    linear_context_t* context,
+    const pca_t*      pca,
+    const matrix_t*   rows,
+    matrix_t*         scores
+) {
+    context = linear_context_resolve(context);
+    if (NULL == pca || NULL == scores || !linear_context_is_cpu(context)
+        || !covariance_rows_are_valid(rows, pca->dimension)) {
+        return false;
+    }
+
+    if (0 == pca->size || rows->rows != scores->rows
+        || pca->size != scores->columns) {
+        LOG_ERROR(
+            "Cannot project %u rows onto %u components into %ux%u.\n",
+            rows->rows,
+            pca->size,
+            scores->rows,
+            scores->columns
+        );
+        return false;
+    }
+
+    size_t   mark     = linear_context_scratch_mark(context);
+    matrix_t centered = {
+        .data    = linear_context_scratch_alloc(
+            context, sizeof(float) * rows->rows * pca->dimension
+        ),
+        .rows    = rows->rows,
+        .columns = pca->dimension,
+        .state   = MATRIX_NONE,
+    };
+    if (NULL == centered.data && rows->rows > 0) {
+        LOG_ERROR("Failed to allocate memory for the centered rows.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+    covariance_subtract(rows, pca->mean, centered.data);
+
+    // Only the first size components are set
+    matrix_t components = *pca->components;
+    components.rows     = pca->size;
+    matrix_t* transpose = matrix_transpose_ctx(context, &components);
+
+    bool done = NULL != transpose
+                && matrix_gemm_ctx(
+                    context, 1.0f, &centered, transpose, 0.0f, scores
+                );
+
+    matrix_free_ctx(context, transpose);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
@@ -0,0 +1,713 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/eigen.c
+ *
+ * @brief Iterative eigensolvers over abstract linear operators
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "eigen.h"
+#include "bsr.h"
+#include "logger.h"
+
+#include <math.h>
+#include <string.h>
+
+// Sweeps of the Jacobi eigensolver of the small projected matrices
+#define EIGEN_JACOBI_SWEEPS 64
+
+// Norm of a vector orthogonalized against a basis, relative to its norm
+// before, below which it is taken to lie in the span of the basis
+#define EIGEN_BREAKDOWN 1e-5f
+
+// Operators
+
+bool eigen_matrix_matvec(
+    linear_context_t* context,
+    const void*       operand,
+    const vector_t*   x,
+    vector_t*         y
+) {
+    return matrix_gemv_ctx(
+        context, 1.0f, (const matrix_t*) operand, x, 0.0f, y
+    );
+}
+
+bool eigen_bsr_matvec(
+    linear_context_t* context,
+    const void*       operand,
+    const vector_t*   x,
+    vector_t*         y
+) {
+    return bsr_gemv_ctx(context, 1.0f, (const bsr_t*) operand, x, 0.0f, y);
+}
+
+// Shared helpers
+
+// Verify an operator can be applied
+static bool eigen_operator_is_valid(const eigen_operator_t* op) {
+    if (NULL == op || NULL == op->matvec || 0 == op->order) {
+        LOG_ERROR("Expected an operator with a matvec and a nonzero order.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Verify a vector holds count NUMERIC_FLOAT32 elements
+static bool eigen_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector || NULL == vector->data) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected a NUMERIC_FLOAT32 vector of %u elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// View of row t of a matrix as a vector
+static vector_t eigen_row(const matrix_t* matrix, uint32_t t) {
+    vector_t row = {
+        .data    = matrix->data + (size_t) t * matrix->columns,
+        .columns = matrix->columns,
+        .type    = NUMERIC_FLOAT32,
+    };
+    return row;
+}
+
+// Diagonalize the symmetric m x m matrix a in place by cyclic Jacobi
+// rotations, accumulating the eigenvectors into the columns of z
+static void eigen_jacobi(double* a, double* z, uint32_t m) {
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < m; j++) {
+            z[(size_t) i * m + j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (uint32_t sweep = 0; sweep < EIGEN_JACOBI_SWEEPS; sweep++) {
+        double off  = 0.0;
+        double norm = 0.0;
+        for (uint32_t i = 0; i < m; i++) {
+            for (uint32_t j = 0; j < m; j++) {
+                double e  = a[(size_t) i * m + j];
+                norm     += e * e;
+                off      += (i != j) ? e * e : 0.0;
+            }
+        }
+        if (off <= 1e-28 * norm) {
+            return;
+        }
+
+        for (uint32_t p = 0; p + 1 < m; p++) {
+            for (uint32_t q = p + 1; q < m; q++) {
+                double apq = a[(size_t) p * m + q];
+                if (0.0 == apq) {
+                    continue;
+                }
+
+                // The smaller rotation annihilating a[p][q]
+                double app   = a[(size_t) p * m + p];
+                double aqq   = a[(size_t) q * m + q];
+                double theta = (aqq - app) / (2.0 * apq);
+                double t     = ((theta < 0.0) ? -1.0 : 1.0)
+                           / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c     = 1.0 / sqrt(t * t + 1.0);
+                double s     = t * c;
+
+                // Columns p and q of a and z, then rows p and q of a
+                for (uint32_t k = 0; k < m; k++) {
+                    double* ak  = a + (size_t) k * m;
+                    double* zk  = z + (size_t) k * m;
+                    double  akp = ak[p];
+                    double  zkp = zk[p];
+                    ak[p]       = c * akp - s * ak[q];
+                    ak[q]       = s * akp + c * ak[q];
+                    zk[p]       = c * zkp - s * zk[q];
+                    zk[q]       = s * zkp + c * zk[q];
+                }
+
+                double* ap = a + (size_t) p * m;
+                double* aq = a + (size_t) q * m;
+                for (uint32_t k = 0; k < m; k++) {
+                    double apk = ap[k];
+                    ap[k]      = c * apk - s * aq[k];
+                    aq[k]      = s * apk + c * aq[k];
+                }
+            }
+        }
+    }
+}
+
+// Order the eigenvalues on the diagonal of the m x m matrix a by decreasing
+// magnitude, writing their indices into order
+static void eigen_order(const double* a, uint32_t m, uint32_t* order) {
+    for (uint32_t i = 0; i < m; i++) {
+        double   e = fabs(a[(size_t) i * m + i]);
+        uint32_t t = i;
+        while (t > 0 && fabs(a[(size_t) order[t - 1] * (m + 1)]) < e) {
+            order[t] = order[t - 1];
+            t--;
+        }
+        order[t] = i;
+    }
+}
+
+// Write the top k eigenpairs of a diagonalized m x m matrix a, whose
+// eigenvectors are the columns of z, as the k x m rows of rotation and the
+// k values
+static void eigen_select(
+    const double* a,
+    const double* z,
+    uint32_t      m,
+    uint32_t*     order,
+    uint32_t      k,
+    float*        rotation,
+    float*        values
+) {
+    eigen_order(a, m, order);
+    for (uint32_t t = 0; t < k; t++) {
+        uint32_t e = order[t];
+        values[t]  = (float) a[(size_t) e * m + e];
+        for (uint32_t s = 0; s < m; s++) {
+            rotation[(size_t) t * m + s] = (float) z[(size_t) s * m + e];
+        }
+    }
+}
+
+// Power iteration
+
+// Vector phase of a power iteration, executed by every member of a region
+typedef struct EigenPower {
+    float*       x;        // The unit iterate, replaced by the next one
+    const float* y;        // The operator applied to x
+    uint32_t     n;        // Number of elements
+    float        value;    // Rayleigh quotient x' * y
+    float        norm;     // ||y||
+    float        residual; // ||y - value * x||
+} eigen_power_t;
+
+static void eigen_power_region(thread_team_t* team, uint32_t id, void* arg) {
+    eigen_power_t* power = (eigen_power_t*) arg;
+    uint32_t       begin = 0;
+    uint32_t       end   = 0;
+    thread_team_range(team, id, power->n, &begin, &end);
+
+    float xy = 0.0f;
+    float yy = 0.0f;
+    for (uint32_t i = begin; i < end; i++) {
+        xy += power->x[i] * power->y[i];
+        yy += power->y[i] * power->y[i];
+    }
+    xy = thread_team_reduce_sum(team, id, xy);
+    yy = thread_team_reduce_sum(team, id, yy);
+
+    // Each member reads x only over its own range before replacing it
+    float norm  = sqrtf(yy);
+    float scale = (norm > 0.0f) ? 1.0f / norm : 0.0f;
+    float rr    = 0.0f;
+    for (uint32_t i = begin; i < end; i++) {
+        float r      = power->y[i] - xy * power->x[i];
+        rr          += r * r;
+        power->x[i]  = power->y[i] * scale;
+    }
+    rr = thread_team_reduce_sum(team, id, rr);
+
+    if (0 == id) {
+        power->value    = xy;
+        power->norm     = norm;
+        power->residual = sqrtf(rr);
+    }
+}
+
+// Normalize x in place, returning false if it is zero
+static bool eigen_normalize(linear_context_t* context, vector_t* x) {
+    float norm = vector_magnitude_ctx(context, x);
+    if (!(norm > 0.0f) || isinf(norm)) {
+        LOG_ERROR("Expected a nonzero, finite starting vector.\n");
+        return false;
+    }
+
+    return NULL != vector_scale_ctx(context, x, 1.0f / norm, true);
+}
+
+bool eigen_power_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    vector_t*               x,
+    float                   tolerance,
+    uint32_t                iterations,
+    float*                  value
+) {
+    context = linear_context_resolve(context);
+    if (NULL == value || !linear_context_is_cpu(context)
+        || !eigen_operator_is_valid(op)
+        || !eigen_vector_is_valid(x, op->order)
+        || !eigen_normalize(context, x)) {
+        return false;
+    }
+
+    vector_t* y = vector_create_ctx(context, op->order);
+    if (NULL == y) {
+        LOG_ERROR("Failed to allocate memory for the iterate.\n");
+        return false;
+    }
+
+    eigen_power_t power = {
+        .x = (float*) x->data,
+        .y = (const float*) y->data,
+        .n = op->order,
+    };
+
+    bool converged = false;
+    for (uint32_t k = 0; !converged && k < iterations; k++) {
+        if (!op->matvec(context, op->operand, x, y)
+            || 0 == linear_context_region(
+                context, eigen_power_region, &power
+            )) {
+            break;
+        }
+
+        if (!(power.norm > 0.0f)) {
+            LOG_ERROR("The operator maps the iterate to zero.\n");
+            break;
+        }
+
+        *value    = power.value;
+        converged = power.residual <= tolerance * fabsf(power.value);
+    }
+
+    vector_free_ctx(context, y);
+    return converged;
+}
+
+// Orthonormalization
+
+// Vector phase of a block iteration, executed by every member of a region:
+// the residuals of the Ritz pairs, then modified Gram-Schmidt of the block
+typedef struct EigenBlock {
+    float*       q;         // k x n block, orthonormalized in place
+    const float* x;         // k x n Ritz vectors, or NULL
+    const float* values;    // k Ritz values, or NULL
+    uint32_t     k;         // Number of vectors
+    uint32_t     n;         // Number of elements
+    float        residual;  // Largest ||q - value * x|| over the pairs
+    bool         deficient; // The block lost rank
+} eigen_block_t;
+
+static void eigen_block_region(thread_team_t* team, uint32_t id, void* arg) {
+    eigen_block_t* block = (eigen_block_t*) arg;
+    const uint32_t n     = block->n;
+    uint32_t       begin = 0;
+    uint32_t       end   = 0;
+    thread_team_range(team, id, n, &begin, &end);
+
+    // q holds a * x, so its rows are the residuals once values * x is gone
+    float residual = 0.0f;
+    for (uint32_t t = 0; block->x && t < block->k; t++) {
+        const float* ax = block->q + (size_t) t * n;
+        const float* x  = block->x + (size_t) t * n;
+        float        rr = 0.0f;
+        for (uint32_t i = begin; i < end; i++) {
+            float r  = ax[i] - block->values[t] * x[i];
+            rr      += r * r;
+        }
+        rr       = thread_team_reduce_sum(team, id, rr);
+        residual = fmaxf(residual, sqrtf(rr));
+    }
+
+    for (uint32_t t = 0; t < block->k; t++) {
+        float* w    = block->q + (size_t) t * n;
+        float  norm = 0.0f;
+        for (uint32_t i = begin; i < end; i++) {
+            norm += w[i] * w[i];
+        }
+        norm = sqrtf(thread_team_reduce_sum(team, id, norm));
+
+        for (uint32_t s = 0; s < t; s++) {
+            const float* v = block->q + (size_t) s * n;
+            float        c = 0.0f;
+            for (uint32_t i = begin; i < end; i++) {
+                c += v[i] * w[i];
+            }
+            c = thread_team_reduce_sum(team, id, c);
+            for (uint32_t i = begin; i < end; i++) {
+                w[i] -= c * v[i];
+            }
+        }
+
+        float ww = 0.0f;
+        for (uint32_t i = begin; i < end; i++) {
+            ww += w[i] * w[i];
+        }
+        ww = thread_team_reduce_sum(team, id, ww);
+
+        // Every member sees the same sums, so all of them leave together
+        float remaining = sqrtf(ww);
+        if (!(remaining > EIGEN_BREAKDOWN * norm) || isinf(ww)) {
+            if (0 == id) {
+                block->deficient = true;
+            }
+            return;
+        }
+
+        float scale = 1.0f / remaining;
+        for (uint32_t i = begin; i < end; i++) {
+            w[i] *= scale;
+        }
+    }
+
+    if (0 == id) {
+        block->residual = residual;
+    }
+}
+
+// Orthonormalize the rows of q in a region, measuring the residuals of the
+// Ritz pairs x first when given
+static bool eigen_orthonormalize(
+    linear_context_t* context, eigen_block_t* block
+) {
+    block->deficient = false;
+    if (0 == linear_context_region(context, eigen_block_region, block)) {
+        return false;
+    }
+
+    if (block->deficient) {
+        LOG_ERROR("The block of vectors lost rank.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Block power iteration
+
+bool eigen_block_power_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    matrix_t*               vectors,
+    vector_t*               values,
+    float                   tolerance,
+    uint32_t                iterations
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vectors || !linear_context_is_cpu(context)
+        || !eigen_operator_is_valid(op)) {
+        return false;
+    }
+
+    const uint32_t n = op->order;
+    const uint32_t k = vectors->rows;
+    if (0 == k || k > n || n != vectors->columns) {
+        LOG_ERROR(
+            "Cannot iterate a block of size %ux%u for an operator of order "
+            "%u.\n",
+            vectors->rows,
+            vectors->columns,
+            n
+        );
+        return false;
+    }
+
+    if (!eigen_vector_is_valid(values, k)) {
+        return false;
+    }
+
+    // q holds the orthonormal block, then a * x, y holds a * q
+    matrix_t* q = matrix_deep_copy_ctx(context, vectors);
+    matrix_t* y = matrix_create_ctx(context, k, n);
+    matrix_t* x = matrix_create_ctx(context, k, n);
+    matrix_t* h = matrix_create_ctx(context, k, k);
+    matrix_t* z = matrix_create_ctx(context, k, k);
+
+    size_t    mark  = linear_context_scratch_mark(context);
+    double*   a     = linear_context_scratch_alloc(
+        context, sizeof(double) * k * k
+    );
+    double*   e     = linear_context_scratch_alloc(
+        context, sizeof(double) * k * k
+    );
+    uint32_t* order = linear_context_scratch_alloc(
+        context, sizeof(uint32_t) * k
+    );
+
+    eigen_block_t block = {
+        .k = k,
+        .n = n,
+    };
+
+    bool done = NULL != q && NULL != y && NULL != x && NULL != h && NULL != z
+                && NULL != a && NULL != e && NULL != order;
+    if (!done) {
+        LOG_ERROR("Failed to allocate memory for the block.\n");
+    }
+
+    block.q   = (done) ? q->data : NULL;
+    done      = done && eigen_orthonormalize(context, &block);
+    bool fits = false;
+    for (uint32_t it = 0; done && !fits && it < iterations; it++) {
+        for (uint32_t t = 0; done && t < k; t++) {
+            vector_t from = eigen_row(q, t);
+            vector_t into = eigen_row(y, t);
+            done          = op->matvec(context, op->operand, &from, &into);
+        }
+
+        // h = q * a * q', symmetric up to rounding
+        matrix_t* qt = (done) ? matrix_transpose_ctx(context, q) : NULL;
+        done = NULL != qt && matrix_gemm_ctx(context, 1.0f, y, qt, 0.0f, h);
+        matrix_free_ctx(context, qt);
+        if (!done) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < k; i++) {
+            for (uint32_t j = 0; j < k; j++) {
+                float hij             = h->data[(size_t) i * k + j];
+                float hji             = h->data[(size_t) j * k + i];
+                a[(size_t) i * k + j] = 0.5 * ((double) hij + hji);
+            }
+        }
+        eigen_jacobi(a, e, k);
+        eigen_select(a, e, k, order, k, z->data, (float*) values->data);
+
+        // Ritz vectors x = z * q, and q = z * a * q = a * x
+        done = matrix_gemm_ctx(context, 1.0f, z, q, 0.0f, x)
+               && matrix_gemm_ctx(context, 1.0f, z, y, 0.0f, q);
+
+        block.x      = x->data;
+        block.values = (const float*) values->data;
+        done         = done && eigen_orthonormalize(context, &block);
+
+        float largest = fabsf(((const float*) values->data)[0]);
+        fits          = done && block.residual <= tolerance * largest;
+    }
+
+    if (done && NULL != block.x) {
+        memcpy(vectors->data, x->data, sizeof(float) * k * n);
+        matrix_invalidate(vectors);
+    }
+
+    linear_context_scratch_release(context, mark);
+    matrix_free_ctx(context, z);
+    matrix_free_ctx(context, h);
+    matrix_free_ctx(context, x);
+    matrix_free_ctx(context, y);
+    matrix_free_ctx(context, q);
+    return done && fits;
+}
+
+// Lanczos iteration
+
+// Vector phase of a Lanczos step, executed by every member of a region
+typedef struct EigenLanczos {
+    float*   basis; // steps x n Lanczos vectors by rows
+    float*   w;     // a * v[j], orthogonalized into v[j + 1]
+    double*  alpha; // Diagonal of the tridiagonal projection
+    double*  beta;  // Off-diagonal of the tridiagonal projection
+    float    norm;  // ||a * v[j]||
+    uint32_t n;     // Number of elements
+    uint32_t j;     // Current step
+    uint32_t steps; // Number of steps
+} eigen_lanczos_t;
+
+static void eigen_lanczos_region(thread_team_t* team, uint32_t id, void* arg) {
+    eigen_lanczos_t* lanczos = (eigen_lanczos_t*) arg;
+    const uint32_t   n       = lanczos->n;
+    const uint32_t   j       = lanczos->j;
+    float*           w       = lanczos->w;
+    uint32_t         begin   = 0;
+    uint32_t         end     = 0;
+    thread_team_range(team, id, n, &begin, &end);
+
+    float ww = 0.0f;
+    for (uint32_t i = begin; i < end; i++) {
+        ww += w[i] * w[i];
+    }
+    ww = thread_team_reduce_sum(team, id, ww);
+
+    // The three-term recurrence, w -= beta[j - 1] * v[j - 1]
+    if (j > 0) {
+        const float  b = (float) lanczos->beta[j - 1];
+        const float* v = lanczos->basis + (size_t) (j - 1) * n;
+        for (uint32_t i = begin; i < end; i++) {
+            w[i] -= b * v[i];
+        }
+    }
+
+    // Then against v[j], and again against the whole basis, whose
+    // orthogonality the recurrence alone loses to rounding
+    double alpha = 0.0;
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t s = (0 == pass) ? j : 0; s <= j; s++) {
+            const float* v = lanczos->basis + (size_t) s * n;
+            float        c = 0.0f;
+            for (uint32_t i = begin; i < end; i++) {
+                c += v[i] * w[i];
+            }
+            c = thread_team_reduce_sum(team, id, c);
+            for (uint32_t i = begin; i < end; i++) {
+                w[i] -= c * v[i];
+            }
+            alpha += (s == j) ? c : 0.0;
+        }
+    }
+
+    float bb = 0.0f;
+    for (uint32_t i = begin; i < end; i++) {
+        bb += w[i] * w[i];
+    }
+    bb = thread_team_reduce_sum(team, id, bb);
+
+    float beta = sqrtf(bb);
+    if (j + 1 < lanczos->steps && beta > 0.0f) {
+        float* v = lanczos->basis + (size_t) (j + 1) * n;
+        for (uint32_t i = begin; i < end; i++) {
+            v[i] = w[i] / beta;
+        }
+    }
+
+    if (0 == id) {
+        lanczos->alpha[j] = alpha;
+        lanczos->beta[j]  = beta;
+        lanczos->norm     = sqrtf(ww);
+    }
+}
+
+bool eigen_lanczos_ctx(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    const vector_t*         start,
+    uint32_t                steps,
+    matrix_t*               vectors,
+    vector_t*               values
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vectors || !linear_context_is_cpu(context)
+        || !eigen_operator_is_valid(op)) {
+        return false;
+    }
+
+    const uint32_t n = op->order;
+    const uint32_t k = vectors->rows;
+    if (0 == k || k > steps || steps > n || n != vectors->columns) {
+        LOG_ERROR(
+            "Cannot find %u Ritz vectors of %u elements in %u steps for an "
+            "operator of order %u.\n",
+            vectors->rows,
+            vectors->columns,
+            steps,
+            n
+        );
+        return false;
+    }
+
+    if (!eigen_vector_is_valid(values, k)
+        || (start && !eigen_vector_is_valid(start, n))) {
+        return false;
+    }
+
+    matrix_t* basis = matrix_create_ctx(context, steps, n);
+    vector_t* w     = vector_create_ctx(context, n);
+
+    size_t    mark     = linear_context_scratch_mark(context);
+    size_t    size     = sizeof(double) * steps * steps;
+    double*   alpha    = linear_context_scratch_alloc(
+        context, sizeof(double) * steps
+    );
+    double*   beta     = linear_context_scratch_alloc(
+        context, sizeof(double) * steps
+    );
+    double*   t        = linear_context_scratch_alloc(context, size);
+    double*   e        = linear_context_scratch_alloc(context, size);
+    uint32_t* order    = linear_context_scratch_alloc(
+        context, sizeof(uint32_t) * steps
+    );
+    float*    rotation = linear_context_scratch_alloc(
+        context, sizeof(float) * k * steps
+    );
+
+    bool done = NULL != basis && NULL != w && NULL != alpha && NULL != beta
+                && NULL != t && NULL != e && NULL != order && NULL != rotation;
+    if (!done) {
+        LOG_ERROR("Failed to allocate memory for the Krylov basis.\n");
+    }
+
+    // A fixed positive start overlaps the Perron vector of a graph
+    vector_t v0 = {0};
+    if (done) {
+        v0 = eigen_row(basis, 0);
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t hash = (i * 2654435761u) >> 24;
+            basis->data[i] = (start) ? ((const float*) start->data)[i]
+                                     : 1.0f + (float) hash / 512.0f;
+        }
+        done = eigen_normalize(context, &v0);
+    }
+
+    eigen_lanczos_t lanczos = {
+        .basis = (done) ? basis->data : NULL,
+        .w     = (done) ? (float*) w->data : NULL,
+        .alpha = alpha,
+        .beta  = beta,
+        .n     = n,
+        .steps = steps,
+    };
+
+    // Stop early once the Krylov space is invariant under the operator
+    uint32_t m = 0;
+    while (done && m < steps) {
+        vector_t v = eigen_row(basis, m);
+        lanczos.j  = m;
+        done       = op->matvec(context, op->operand, &v, w)
+               && 0 != linear_context_region(
+                   context, eigen_lanczos_region, &lanczos
+               );
+        m++;
+        if (done && beta[m - 1] <= EIGEN_BREAKDOWN * lanczos.norm) {
+            break;
+        }
+    }
+
+    if (done && m < k) {
+        LOG_ERROR("The Krylov space of the start has %u dimensions.\n", m);
+        done = false;
+    }
+
+    if (done) {
+        for (uint32_t i = 0; i < m; i++) {
+            for (uint32_t j = 0; j < m; j++) {
+                double tij = (i == j) ? alpha[i] : 0.0;
+                tij        = (i == j + 1) ? beta[j] : tij;
+                tij        = (j == i + 1) ? beta[i] : tij;
+
+                t[(size_t) i * m + j] = tij;
+            }
+        }
+        eigen_jacobi(t, e, m);
+        eigen_select(t, e, m, order, k, rotation, (float*) values->data);
+
+        // Ritz vectors, rotation * v over the first m basis vectors
+        matrix_t z = {
+            .data    = rotation,
+            .rows    = k,
+            .columns = m,
+            .state   = MATRIX_NONE,
+        };
+        matrix_t v = *basis;
+        v.rows     = m;
+        done       = matrix_gemm_ctx(context, 1.0f, &z, &v, 0.0f, vectors);
+    }
+
+    linear_context_scratch_release(context, mark);
+    vector_free_ctx(context, w);
+    matrix_free_ctx(context, basis);
+    return done;
+}
@@ -0,0 +1,594 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/lowrank.c
+ *
+ * @brief Low-rank matrices stored as a pair of factors
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "lowrank.h"
+#include "logger.h"
+
+#include <math.h>
+
+// Sweeps of one-sided Jacobi rotations before giving up on convergence
+#define LOWRANK_SWEEPS 32
+
+// Lifecycle management
+
+lowrank_t* lowrank_create_ctx(
+    linear_context_t* context, uint32_t rows, uint32_t columns, uint32_t rank
+) {
+    context = linear_context_resolve(context);
+
+    lowrank_t* lowrank = linear_context_allocate(context, sizeof(lowrank_t));
+    if (NULL == lowrank) {
+        LOG_ERROR("Failed to allocate memory for lowrank_t.\n");
+        return NULL;
+    }
+
+    lowrank->u = matrix_create_ctx(context, rows, rank);
+    lowrank->v = matrix_create_ctx(context, columns, rank);
+    if (NULL == lowrank->u || NULL == lowrank->v) {
+        LOG_ERROR("Failed to allocate memory for the low-rank factors.\n");
+        lowrank_free_ctx(context, lowrank);
+        return NULL;
+    }
+
+    return lowrank;
+}
+
+void lowrank_free_ctx(linear_context_t* context, lowrank_t* lowrank) {
+    if (NULL == lowrank) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    matrix_free_ctx(context, lowrank->u);
+    matrix_free_ctx(context, lowrank->v);
+    linear_context_release(context, lowrank);
+}
+
+// Products
+
+// Operands of a projection onto the right factor, v' * x
+typedef struct LowRankOp {
+    const matrix_t* v;       // The n x k right factor
+    const float*    x;       // Vector, or rows of a matrix, projected
+    float*          y;       // Vector, or rows of a matrix, receiving v' * x
+    uint32_t        columns; // Columns of the dense matrices, if any
+} lowrank_op_t;
+
+// Range kernel computing elements [begin, end) of y = v' * x, streaming the
+// rows of v
+static void lowrank_project_routine(thread_data_t* task) {
+    const lowrank_op_t* op = (const lowrank_op_t*) task->a;
+    const uint32_t      k  = op->v->columns;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        op->y[i] = 0.0f;
+    }
+
+    for (uint32_t r = 0; r < op->v->rows; r++) {
+        const float* row = op->v->data + (size_t) r * k;
+        const float  x   = op->x[r];
+        for (uint32_t i = task->begin; i < task->end; i++) {
+            op->y[i] += row[i] * x;
+        }
+    }
+}
+
+// Range kernel computing columns [begin, end) of y = v' * x for the n x p
+// rows of x, streaming the rows of v and x together
+static void lowrank_project_rows_routine(thread_data_t* task) {
+    const lowrank_op_t* op = (const lowrank_op_t*) task->a;
+    const uint32_t      k  = op->v->columns;
+    const uint32_t      p  = op->columns;
+
+    for (uint32_t i = 0; i < k; i++) {
+        float* z = op->y + (size_t) i * p;
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            z[j] = 0.0f;
+        }
+    }
+
+    for (uint32_t r = 0; r < op->v->rows; r++) {
+        const float* row = op->v->data + (size_t) r * k;
+        const float* x   = op->x + (size_t) r * p;
+        for (uint32_t i = 0; i < k; i++) {
+            const float scale = row[i];
+            float*      z     = op->y + (size_t) i * p;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                z[j] += scale * x[j];
+            }
+        }
+    }
+}
+
+// Verify a NUMERIC_FLOAT32 vector holds count elements
+static bool lowrank_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+bool lowrank_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const lowrank_t*  a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !lowrank_vector_is_valid(x, a->v->rows)
+        || !lowrank_vector_is_valid(y, a->u->rows)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("GEMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    const uint32_t k    = a->u->columns;
+    size_t         mark = linear_context_scratch_mark(context);
+    vector_t       t    = {
+        .data    = linear_context_scratch_alloc(context, sizeof(float) * k),
+        .columns = k,
+        .type    = NUMERIC_FLOAT32,
+    };
+    if (NULL == t.data) {
+        LOG_ERROR("Failed to allocate memory for the projection.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    lowrank_op_t op = {
+        .v = a->v,
+        .x = (const float*) x->data,
+        .y = (float*) t.data,
+    };
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = lowrank_project_routine,
+    };
+
+    // Project onto the k inner dimensions first, then expand by u
+    uint64_t work = (uint64_t) a->v->rows * k;
+    bool     done = linear_context_parallel_work(context, task, k, work)
+                && matrix_gemv_ctx(context, alpha, a->u, &t, beta, y);
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool lowrank_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const lowrank_t*  a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || NULL == c
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (a->v->rows != b->rows || a->u->rows != c->rows
+        || b->columns != c->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot multiply a low-rank "
+            "matrix of size %ux%u by %ux%u into %ux%u.\n",
+            a->u->rows,
+            a->v->rows,
+            b->rows,
+            b->columns,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    const uint32_t k    = a->u->columns;
+    const uint32_t p    = b->columns;
+    size_t         mark = linear_context_scratch_mark(context);
+    matrix_t       t    = {
+        .data    = linear_context_scratch_alloc(
+            context, sizeof(float) * k * p
+        ),
+        .rows    = k,
+        .columns = p,
+        .state   = MATRIX_NONE,
+    };
+    if (NULL == t.data) {
+        LOG_ERROR("Failed to allocate memory for the projection.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    lowrank_op_t op = {
+        .v       = a->v,
+        .x       = b->data,
+        .y       = t.data,
+        .columns = p,
+    };
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = lowrank_project_rows_routine,
+    };
+
+    // Project onto the k inner dimensions first, then expand by u
+    uint64_t work = (uint64_t) b->rows * k * p;
+    bool     done = linear_context_parallel_work(context, task, p, work)
+                && matrix_gemm_ctx(context, alpha, a->u, &t, beta, c);
+
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool lowrank_add_to_matrix_ctx(
+    linear_context_t* context, float alpha, const lowrank_t* a, matrix_t* c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == c || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (a->u->rows != c->rows || a->v->rows != c->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot add a low-rank matrix "
+            "of size %ux%u to %ux%u.\n",
+            a->u->rows,
+            a->v->rows,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    // v' is only n x k, and lets the GEMM stream its rows
+    matrix_t* vt = matrix_transpose_ctx(context, a->v);
+    if (NULL == vt) {
+        return false;
+    }
+
+    bool done = matrix_gemm_ctx(context, alpha, a->u, vt, 1.0f, c);
+    matrix_free_ctx(context, vt);
+    return done;
+}
+
+matrix_t*
+lowrank_to_matrix_ctx(linear_context_t* context, const lowrank_t* lowrank) {
+    if (NULL == lowrank) {
+        return NULL;
+    }
+
+    matrix_t* matrix = matrix_create_ctx(
+        context, lowrank->u->rows, lowrank->v->rows
+    );
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    if (!lowrank_add_to_matrix_ctx(context, 1.0f, lowrank, matrix)) {
+        matrix_free_ctx(context, matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
+
+// Compression
+
+// Dense workspaces of a compression, see lowrank_from_matrix_ctx()
+typedef struct LowRankSketch {
+    matrix_t* y; // m x l sketch of the range of a
+    matrix_t* q; // l x m orthonormal basis of the range, by rows
+    matrix_t* b; // l x n projection q * a
+    matrix_t* j; // l x l rotations orthogonalizing the rows of b
+} lowrank_sketch_t;
+
+static void
+lowrank_sketch_free(linear_context_t* context, lowrank_sketch_t* sketch) {
+    matrix_free_ctx(context, sketch->y);
+    matrix_free_ctx(context, sketch->q);
+    matrix_free_ctx(context, sketch->b);
+    matrix_free_ctx(context, sketch->j);
+}
+
+// Uniform value in [-1, 1) hashed from an index, so sketches are
+// reproducible and any range of elements can be filled independently
+static inline float lowrank_sketch_value(uint64_t i) {
+    uint64_t z = (i + 1) * UINT64_C(0x9e3779b97f4a7c15);
+    z          = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z          = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    z         ^= z >> 31;
+    return (float) (z >> 40) * 0x1.0p-23f - 1.0f;
+}
+
+// Range kernel filling elements [begin, end) of the random test matrix
+static void lowrank_sketch_routine(thread_data_t* task) {
+    float* z = ((matrix_t*) task->result)->data;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = lowrank_sketch_value(i);
+    }
+}
+
+// Dot product accumulated in double precision
+static double lowrank_dot(const float* x, const float* y, uint32_t n) {
+    double sum = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += (double) x[i] * y[i];
+    }
+    return sum;
+}
+
+// Orthonormalize the rows of a in place by modified Gram-Schmidt, twice over
+// so they stay orthogonal to working precision. Rows left without a
+// significant component of their own are zeroed.
+static void lowrank_orthonormalize(matrix_t* a) {
+    const uint32_t n = a->columns;
+
+    for (uint32_t i = 0; i < a->rows; i++) {
+        float* x      = a->data + (size_t) i * n;
+        double before = lowrank_dot(x, x, n);
+
+        for (uint32_t pass = 0; pass < 2; pass++) {
+            for (uint32_t j = 0; j < i; j++) {
+                const float* y = a->data + (size_t) j * n;
+                const float  d = (float) lowrank_dot(x, y, n);
+                for (uint32_t e = 0; e < n; e++) {
+                    x[e] -= d * y[e];
+                }
+            }
+        }
+
+        double after = lowrank_dot(x, x, n);
+        float  scale = (after > 1e-10 * before) ? 1.0f / sqrt(after) : 0.0f;
+        for (uint32_t e = 0; e < n; e++) {
+            x[e] *= scale;
+        }
+    }
+}
+
+// Rotate the pair of rows x and y by the angle whose cosine and sine are c
+// and s
+static void
+lowrank_rotate(float* x, float* y, uint32_t n, float c, float s) {
+    for (uint32_t e = 0; e < n; e++) {
+        const float xe = x[e];
+        const float ye = y[e];
+        x[e]           = c * xe - s * ye;
+        y[e]           = s * xe + c * ye;
+    }
+}
+
+// Orthogonalize the rows of b by one-sided Jacobi rotations, applying the
+// same rotations to the rows of j. The rows of b end up as the right
+// singular vectors scaled by the singular values.
+static void lowrank_jacobi(matrix_t* b, matrix_t* j) {
+    const uint32_t l = b->rows;
+    const uint32_t n = b->columns;
+
+    for (uint32_t sweep = 0; sweep < LOWRANK_SWEEPS; sweep++) {
+        bool rotated = false;
+
+        for (uint32_t p = 0; p < l; p++) {
+            for (uint32_t q = p + 1; q < l; q++) {
+                float* x  = b->data + (size_t) p * n;
+                float* y  = b->data + (size_t) q * n;
+                double xx = lowrank_dot(x, x, n);
+                double yy = lowrank_dot(y, y, n);
+                double xy = lowrank_dot(x, y, n);
+
+                // Also skips pairs holding a zero row
+                if (fabs(xy) <= 1e-6 * sqrt(xx * yy)) {
+                    continue;
+                }
+
+                double zeta = (yy - xx) / (2.0 * xy);
+                double t    = copysign(1.0, zeta)
+                           / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+                double c    = 1.0 / sqrt(1.0 + t * t);
+                double s    = c * t;
+
+                lowrank_rotate(x, y, n, (float) c, (float) s);
+                lowrank_rotate(
+                    j->data + (size_t) p * l,
+                    j->data + (size_t) q * l,
+                    l,
+                    (float) c,
+                    (float) s
+                );
+                rotated = true;
+            }
+        }
+
+        if (!rotated) {
+            break;
+        }
+    }
+}
+
+// Find an orthonormal basis q of the range of a, sketching l columns and
+// refining them by power iterations, then project b = q * a
+static bool lowrank_range(
+    linear_context_t* context,
+    const matrix_t*   a,
+    uint32_t          l,
+    lowrank_sketch_t* sketch
+) {
+    matrix_t* omega = matrix_create_ctx(context, a->columns, l);
+    sketch->y       = matrix_create_ctx(context, a->rows, l);
+    sketch->b       = matrix_create_ctx(context, l, a->columns);
+    if (NULL == omega || NULL == sketch->y || NULL == sketch->b) {
+        matrix_free_ctx(context, omega);
+        return false;
+    }
+
+    thread_data_t task = {
+        .result  = omega,
+        .type    = NUMERIC_FLOAT32,
+        .routine = lowrank_sketch_routine,
+    };
+
+    bool done = linear_context_parallel(
+                    context, task, matrix_element_count(omega)
+                )
+                && matrix_gemm_ctx(context, 1.0f, a, omega, 0.0f, sketch->y);
+    matrix_free_ctx(context, omega);
+
+    // Alternate between the ranges of a and a', orthonormalizing each
+    for (uint32_t i = 0; done && i <= LINEAR_LOWRANK_POWER; i++) {
+        matrix_free_ctx(context, sketch->q);
+        sketch->q = matrix_transpose_ctx(context, sketch->y);
+        if (NULL == sketch->q) {
+            return false;
+        }
+        lowrank_orthonormalize(sketch->q);
+
+        done = matrix_gemm_ctx(context, 1.0f, sketch->q, a, 0.0f, sketch->b);
+        if (!done || LINEAR_LOWRANK_POWER == i) {
+            break;
+        }
+
+        // y = a * z for the orthonormal basis z of the range of a'
+        lowrank_orthonormalize(sketch->b);
+        matrix_t* z = matrix_transpose_ctx(context, sketch->b);
+        done        = NULL != z
+               && matrix_gemm_ctx(context, 1.0f, a, z, 0.0f, sketch->y);
+        matrix_free_ctx(context, z);
+    }
+
+    return done;
+}
+
+lowrank_t* lowrank_from_matrix_ctx(
+    linear_context_t* context, const matrix_t* matrix, uint32_t rank
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    uint32_t order = (matrix->rows < matrix->columns) ? matrix->rows
+                                                      : matrix->columns;
+    if (0 == rank || 0 == order) {
+        LOG_ERROR(
+            "Cannot compress a %ux%u matrix to rank %u.\n",
+            matrix->rows,
+            matrix->columns,
+            rank
+        );
+        return NULL;
+    }
+
+    uint32_t k = (rank < order) ? rank : order;
+    uint64_t l = (uint64_t) k + LINEAR_LOWRANK_OVERSAMPLE;
+    l          = (l < order) ? l : order;
+
+    lowrank_sketch_t sketch = {0};
+    if (!lowrank_range(context, matrix, (uint32_t) l, &sketch)) {
+        lowrank_sketch_free(context, &sketch);
+        return NULL;
+    }
+
+    // The SVD of the small projection, b = j' * diag(sigma) * w'
+    sketch.j = matrix_create_ctx(context, (uint32_t) l, (uint32_t) l);
+    if (NULL == sketch.j) {
+        lowrank_sketch_free(context, &sketch);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < l; i++) {
+        sketch.j->data[i * l + i] = 1.0f;
+    }
+    lowrank_jacobi(sketch.b, sketch.j);
+
+    // Order the rows of b by decreasing singular value
+    const uint32_t n       = matrix->columns;
+    size_t         mark    = linear_context_scratch_mark(context);
+    float*         sigma   = linear_context_scratch_alloc(
+        context, sizeof(float) * l
+    );
+    uint32_t*      indices = linear_context_scratch_alloc(
+        context, sizeof(uint32_t) * l
+    );
+    lowrank_t*     lowrank = lowrank_create_ctx(context, matrix->rows, n, k);
+    matrix_t*      jk      = matrix_create_ctx(context, k, (uint32_t) l);
+    if (NULL == sigma || NULL == indices || NULL == lowrank || NULL == jk) {
+        linear_context_scratch_release(context, mark);
+        lowrank_sketch_free(context, &sketch);
+        lowrank_free_ctx(context, lowrank);
+        matrix_free_ctx(context, jk);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < l; i++) {
+        const float* row = sketch.b->data + (size_t) i * n;
+        sigma[i]         = (float) sqrt(lowrank_dot(row, row, n));
+        indices[i]       = i;
+    }
+
+    for (uint32_t t = 0; t < k; t++) {
+        uint32_t best = t;
+        for (uint32_t i = t + 1; i < l; i++) {
+            best = (sigma[indices[i]] > sigma[indices[best]]) ? i : best;
+        }
+        uint32_t swap = indices[t];
+        indices[t]    = indices[best];
+        indices[best] = swap;
+    }
+
+    // v holds the normalized rows of b, u = q' * j' scaled by sigma
+    for (uint32_t t = 0; t < k; t++) {
+        const uint32_t i     = indices[t];
+        const float*   row   = sketch.b->data + (size_t) i * n;
+        const float*   j     = sketch.j->data + (size_t) i * l;
+        const float    scale = (sigma[i] > 0.0f) ? 1.0f / sigma[i] : 0.0f;
+        for (uint32_t e = 0; e < n; e++) {
+            lowrank->v->data[(size_t) e * k + t] = row[e] * scale;
+        }
+        for (uint32_t e = 0; e < l; e++) {
+            jk->data[(size_t) t * l + e] = j[e] * sigma[i];
+        }
+    }
+
+    // The k x m left factor is formed by rows, then transposed
+    matrix_t* ut = matrix_product_ctx(context, jk, sketch.q);
+    matrix_t* u  = matrix_transpose_ctx(context, ut);
+    matrix_free_ctx(context, ut);
+    matrix_free_ctx(context, jk);
+    linear_context_scratch_release(context, mark);
+    lowrank_sketch_free(context, &sketch);
+
+    if (NULL == u) {
+        lowrank_free_ctx(context, lowrank);
+        return NULL;
+    }
+
+    matrix_free_ctx(context, lowrank->u);
+    lowrank->u = u;
+    return lowrank;
+}
@@ -19,6 +19,7 @@
 #include "logger.h"
 
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -53,6 +54,9 @@ matrix_t* matrix_create(const uint32_t rows, const uint32_t columns) {
 
     matrix->rows    = rows;
     matrix->columns = columns;
+    matrix->state   = MATRIX_NONE;
+    matrix->lower   = 0;
+    matrix->upper   = 0;
 
     return matrix;
 }
@@ -90,6 +94,7 @@ bool matrix_element_set(
         return false;
     }
     matrix->data[row * matrix->columns + column] = value;
+    matrix_invalidate(matrix);
     return true;
 }
 
@@ -104,6 +109,7 @@ void matrix_fill(matrix_t* matrix, const float value) {
     for (uint32_t i = 0; i < max_elements; i++) {
         matrix->data[i] = value;
     }
+    matrix_invalidate(matrix);
 }
 
 static void matrix_lehmer_initialize(
@@ -117,6 +123,7 @@ static void matrix_lehmer_initialize(
         float n         = (float) lehmer_callback(state);
         matrix->data[i] = n;
     }
+    matrix_invalidate(matrix);
 }
 
 void matrix_lehmer_modulo(lehmer_state_t* state, matrix_t* matrix) {
@@ -172,6 +179,10 @@ matrix_t* matrix_shallow_copy(const matrix_t* matrix) {
     // Copy all fields except elements (pointer to an array)
     new_matrix->columns = matrix->columns;
     new_matrix->rows    = matrix->rows;
+    // Writes through either matrix would leave a shared structure stale
+    new_matrix->state   = matrix->state & ~MATRIX_STRUCTURE;
+    new_matrix->lower   = 0;
+    new_matrix->upper   = 0;
 
     // Assign the existing pointer to the new Vector structure
     new_matrix->data = matrix->data;
@@ -182,12 +193,7 @@ matrix_t* matrix_shallow_copy(const matrix_t* matrix) {
 // Properties
 
 bool matrix_is_zero(const matrix_t* matrix) {
-    for (uint32_t i = 0; i < matrix->rows * matrix->columns; i++) {
-        if (matrix->data[i] != 0.0f) {
-            return false;
-        }
-    }
-    return true;
+    return matrix_is_zero_ctx(NULL, matrix);
 }
 
 bool matrix_is_square(const matrix_t* matrix) {
@@ -199,19 +205,7 @@ bool matrix_is_transposed(const matrix_t* matrix) {
 }
 
 bool matrix_is_identity(const matrix_t* matrix) {
-    if (!matrix_is_square(matrix)) {
-        return false;
-    }
-
-    for (uint32_t i = 0; i < matrix->rows; i++) {
-        for (uint32_t j = 0; j < matrix->columns; j++) {
-            float value = matrix->data[i * matrix->columns + j];
-            if ((i == j && value != 1.0f) || (i != j && value != 0.0f)) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return matrix_is_identity_ctx(NULL, matrix);
 }
 
 // Matrix-Scalar Operations
@@ -271,3 +265,3018 @@ matrix_t* matrix_scalar_multiply(const matrix_t* matrix, float scalar) {
 matrix_t* matrix_scalar_divide(const matrix_t* matrix, float scalar) {
     return matrix_scalar_operation(matrix, scalar, scalar_divide);
 }
+
+// Context Operations
+
+matrix_t* matrix_create_ctx(
+    linear_context_t* context, const uint32_t rows, const uint32_t columns
+) {
+    context = linear_context_resolve(context);
+
+    matrix_t* matrix = linear_context_allocate(context, sizeof(matrix_t));
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory for matrix_t.\n");
+        return NULL;
+    }
+
+    size_t elements = (size_t) rows * columns;
+    matrix->data = linear_context_allocate(context, elements * sizeof(float));
+    if (NULL == matrix->data) {
+        LOG_ERROR("Failed to allocate memory for matrix elements.\n");
+        linear_context_release(context, matrix);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < elements; i++) {
+        matrix->data[i] = 0.0f;
+    }
+
+    matrix->rows    = rows;
+    matrix->columns = columns;
+    matrix->state   = MATRIX_NONE;
+    matrix->lower   = 0;
+    matrix->upper   = 0;
+
+    return matrix;
+}
+
+void matrix_free_ctx(linear_context_t* context, matrix_t* matrix) {
+    if (NULL == matrix) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, matrix->data);
+    linear_context_release(context, matrix);
+}
+
+// Range kernel copying a into result
+static void matrix_copy_routine(thread_data_t* task) {
+    const float* x = ((const matrix_t*) task->a)->data;
+    float*       z = ((matrix_t*) task->result)->data;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = x[i];
+    }
+}
+
+matrix_t* matrix_deep_copy_ctx(
+    linear_context_t* context, const matrix_t* matrix
+) {
+    if (NULL == matrix) {
+        return NULL; // Nothing to copy
+    }
+
+    matrix_t* deep_copy
+        = matrix_create_ctx(context, matrix->rows, matrix->columns);
+    if (NULL == deep_copy) {
+        return NULL; // Error is logged by default
+    }
+
+    thread_data_t task = {
+        .a       = (void*) matrix,
+        .result  = deep_copy,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_copy_routine,
+    };
+
+    uint32_t count = matrix_element_count(matrix);
+    if (!linear_context_parallel(context, task, count)) {
+        matrix_free_ctx(context, deep_copy);
+        return NULL;
+    }
+
+    deep_copy->state = matrix->state;
+    deep_copy->lower = matrix->lower;
+    deep_copy->upper = matrix->upper;
+    return deep_copy;
+}
+
+// Range kernel writing rows [begin, end) of the transpose, a tile of source
+// rows at a time
+static void matrix_transpose_routine(thread_data_t* task) {
+    const matrix_t* a = (const matrix_t*) task->a;
+    float*          z = ((matrix_t*) task->result)->data;
+
+    for (uint32_t k = 0; k < a->rows; k += LINEAR_TRANSPOSE_TILE) {
+        uint32_t last = (a->rows - k > LINEAR_TRANSPOSE_TILE)
+                            ? k + LINEAR_TRANSPOSE_TILE
+                            : a->rows;
+        for (uint32_t i = task->begin; i < task->end; i++) {
+            float* row = z + (size_t) i * a->rows;
+            for (uint32_t j = k; j < last; j++) {
+                row[j] = a->data[(size_t) j * a->columns + i];
+            }
+        }
+    }
+}
+
+matrix_t*
+matrix_transpose_ctx(linear_context_t* context, const matrix_t* matrix) {
+    if (NULL == matrix) {
+        return NULL;
+    }
+
+    matrix_t* transpose
+        = matrix_create_ctx(context, matrix->columns, matrix->rows);
+    if (NULL == transpose) {
+        return NULL; // Error is logged by default
+    }
+
+    thread_data_t task = {
+        .a       = (void*) matrix,
+        .result  = transpose,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_transpose_routine,
+    };
+
+    uint64_t work = (uint64_t) matrix_element_count(matrix);
+    if (!linear_context_parallel_work(context, task, matrix->columns, work)) {
+        matrix_free_ctx(context, transpose);
+        return NULL;
+    }
+
+    return transpose;
+}
+
+// Range kernel assigning the value pointed to by b
+static void matrix_fill_routine(thread_data_t* task) {
+    float* z     = ((matrix_t*) task->result)->data;
+    float  value = *(const float*) task->b;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = value;
+    }
+}
+
+void matrix_fill_ctx(
+    linear_context_t* context, matrix_t* matrix, const float value
+) {
+    if (NULL == matrix) {
+        return;
+    }
+
+    thread_data_t task = {
+        .b       = (void*) &value,
+        .result  = matrix,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_fill_routine,
+    };
+
+    linear_context_parallel(context, task, matrix_element_count(matrix));
+    matrix_invalidate(matrix);
+}
+
+// Range kernel for matrix-scalar operations
+static void matrix_scalar_routine(thread_data_t* task) {
+    float* x = ((const matrix_t*) task->a)->data;
+    float* z = ((matrix_t*) task->result)->data;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        task->operation(&x[i], task->b, &z[i], NUMERIC_FLOAT32);
+    }
+}
+
+matrix_t* matrix_scalar_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    matrix,
+    float              scalar,
+    scalar_operation_t operation
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    matrix_t* result
+        = matrix_create_ctx(context, matrix->rows, matrix->columns);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a         = (void*) matrix,
+        .b         = &scalar,
+        .result    = result,
+        .type      = NUMERIC_FLOAT32,
+        .operation = operation,
+        .routine   = matrix_scalar_routine,
+    };
+
+    uint32_t count = matrix_element_count(matrix);
+    if (!linear_context_parallel(context, task, count)) {
+        matrix_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+matrix_t* matrix_scalar_add_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+) {
+    return matrix_scalar_operation_ctx(context, matrix, scalar, scalar_add);
+}
+
+matrix_t* matrix_scalar_subtract_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+) {
+    return matrix_scalar_operation_ctx(
+        context, matrix, scalar, scalar_subtract
+    );
+}
+
+matrix_t* matrix_scalar_multiply_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+) {
+    return matrix_scalar_operation_ctx(
+        context, matrix, scalar, scalar_multiply
+    );
+}
+
+matrix_t* matrix_scalar_divide_ctx(
+    linear_context_t* context, const matrix_t* matrix, float scalar
+) {
+    return matrix_scalar_operation_ctx(context, matrix, scalar, scalar_divide);
+}
+
+// Range kernel broadcasting the vector b across every row of a
+static void matrix_vector_routine(thread_data_t* task) {
+    const matrix_t* a       = (const matrix_t*) task->a;
+    float*          y       = (float*) ((const vector_t*) task->b)->data;
+    float*          z       = ((matrix_t*) task->result)->data;
+    uint32_t        columns = a->columns;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float* x = &a->data[i];
+        task->operation(x, &y[i % columns], &z[i], NUMERIC_FLOAT32);
+    }
+}
+
+// Range kernel for element-wise matrix-matrix operations
+static void matrix_matrix_routine(thread_data_t* task) {
+    float* x = ((const matrix_t*) task->a)->data;
+    float* y = ((const matrix_t*) task->b)->data;
+    float* z = ((matrix_t*) task->result)->data;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        task->operation(&x[i], &y[i], &z[i], NUMERIC_FLOAT32);
+    }
+}
+
+matrix_t* matrix_vector_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    matrix,
+    const vector_t*    vector,
+    scalar_operation_t operation
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || NULL == vector || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (matrix->columns != vector->columns
+        || NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR(
+            "Cannot broadcast a vector of size %u across %u columns.\n",
+            vector->columns,
+            matrix->columns
+        );
+        return NULL;
+    }
+
+    matrix_t* result
+        = matrix_create_ctx(context, matrix->rows, matrix->columns);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a         = (void*) matrix,
+        .b         = (void*) vector,
+        .result    = result,
+        .type      = NUMERIC_FLOAT32,
+        .operation = operation,
+        .routine   = matrix_vector_routine,
+    };
+
+    uint32_t count = matrix_element_count(matrix);
+    if (!linear_context_parallel(context, task, count)) {
+        matrix_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+matrix_t* matrix_vector_add_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+) {
+    return matrix_vector_operation_ctx(context, matrix, vector, scalar_add);
+}
+
+matrix_t* matrix_vector_subtract_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+) {
+    return matrix_vector_operation_ctx(
+        context, matrix, vector, scalar_subtract
+    );
+}
+
+matrix_t* matrix_vector_multiply_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+) {
+    return matrix_vector_operation_ctx(
+        context, matrix, vector, scalar_multiply
+    );
+}
+
+matrix_t* matrix_vector_divide_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* vector
+) {
+    return matrix_vector_operation_ctx(context, matrix, vector, scalar_divide);
+}
+
+matrix_t* matrix_matrix_operation_ctx(
+    linear_context_t*  context,
+    const matrix_t*    a,
+    const matrix_t*    b,
+    scalar_operation_t operation
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (a->rows != b->rows || a->columns != b->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot perform operation on "
+            "matrices of size %ux%u and %ux%u.\n",
+            a->rows,
+            a->columns,
+            b->rows,
+            b->columns
+        );
+        return NULL;
+    }
+
+    matrix_t* result = matrix_create_ctx(context, a->rows, a->columns);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a         = (void*) a,
+        .b         = (void*) b,
+        .result    = result,
+        .type      = NUMERIC_FLOAT32,
+        .operation = operation,
+        .routine   = matrix_matrix_routine,
+    };
+
+    if (!linear_context_parallel(context, task, matrix_element_count(a))) {
+        matrix_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+matrix_t* matrix_matrix_add_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+) {
+    return matrix_matrix_operation_ctx(context, a, b, scalar_add);
+}
+
+matrix_t* matrix_matrix_subtract_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+) {
+    return matrix_matrix_operation_ctx(context, a, b, scalar_subtract);
+}
+
+matrix_t* matrix_matrix_multiply_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+) {
+    return matrix_matrix_operation_ctx(context, a, b, scalar_multiply);
+}
+
+matrix_t* matrix_matrix_divide_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+) {
+    return matrix_matrix_operation_ctx(context, a, b, scalar_divide);
+}
+
+// Matrix Products
+
+// Columns [*first, *last) of row i that may hold nonzeros, which is the whole
+// row unless the structure of the matrix is cached
+static inline void matrix_band_span(
+    const matrix_t* matrix, uint32_t i, uint32_t* first, uint32_t* last
+) {
+    *first = 0;
+    *last  = matrix->columns;
+    if (!(matrix->state & MATRIX_ANALYZED)) {
+        return;
+    }
+
+    if (matrix->state & MATRIX_ZERO) {
+        *last = 0;
+        return;
+    }
+
+    uint64_t end = (uint64_t) i + matrix->upper + 1;
+    *last        = (end < *last) ? (uint32_t) end : *last;
+    *first       = (i > matrix->lower) ? i - matrix->lower : 0;
+    *first       = (*first > *last) ? *last : *first; // rows below the band
+}
+
+// Number of columns visited per row, an upper bound used to estimate work
+static inline uint32_t matrix_band_width(const matrix_t* matrix) {
+    if (!(matrix->state & MATRIX_ANALYZED)) {
+        return matrix->columns;
+    }
+
+    if (matrix->state & MATRIX_ZERO) {
+        return 0;
+    }
+
+    uint64_t width = (uint64_t) matrix->lower + matrix->upper + 1;
+    return (width < matrix->columns) ? (uint32_t) width : matrix->columns;
+}
+
+// Operands of a single GEMM, shared by the tasks splitting its rows
+typedef struct MatrixGemm {
+    const matrix_t* a;
+    const matrix_t* b;
+    matrix_t*       c;
+    float           alpha;
+    float           beta;
+} matrix_gemm_t;
+
+// Range kernel computing rows [begin, end) of c = alpha * a * b + beta * c
+static void matrix_gemm_routine(thread_data_t* task) {
+    const matrix_gemm_t* gemm  = (const matrix_gemm_t*) task->a;
+    const uint32_t       inner = gemm->a->columns;
+    const uint32_t       n     = gemm->c->columns;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float*       z = gemm->c->data + (size_t) i * n;
+        const float* x = gemm->a->data + (size_t) i * inner;
+
+        // beta == 0 overwrites, so uninitialized NaNs do not propagate
+        for (uint32_t j = 0; j < n; j++) {
+            z[j] = (0.0f == gemm->beta) ? 0.0f : gemm->beta * z[j];
+        }
+
+        // i-k-j order streams rows of b and c contiguously, and only the
+        // band of a contributes
+        uint32_t first, last;
+        matrix_band_span(gemm->a, i, &first, &last);
+        for (uint32_t k = first; k < last; k++) {
+            const float  scale = gemm->alpha * x[k];
+            const float* y     = gemm->b->data + (size_t) k * n;
+            for (uint32_t j = 0; j < n; j++) {
+                z[j] += scale * y[j];
+            }
+        }
+    }
+}
+
+// Verify the shapes of a GEMM, c(m x n) = a(m x k) * b(k x n)
+static bool matrix_gemm_is_valid(
+    const matrix_t* a, const matrix_t* b, const matrix_t* c
+) {
+    if (NULL == a || NULL == b || NULL == c) {
+        LOG_ERROR("GEMM operands must not be NULL.\n");
+        return false;
+    }
+
+    if (a->columns != b->rows || a->rows != c->rows
+        || b->columns != c->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot multiply matrices of "
+            "size %ux%u and %ux%u into %ux%u.\n",
+            a->rows,
+            a->columns,
+            b->rows,
+            b->columns,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+bool matrix_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context) || !matrix_gemm_is_valid(a, b, c)) {
+        return false;
+    }
+
+    matrix_gemm_t gemm = {
+        .a     = a,
+        .b     = b,
+        .c     = c,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+
+    thread_data_t task = {
+        .a       = &gemm,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_gemm_routine,
+    };
+
+    // Each row costs columns * band multiply-adds
+    uint64_t band = matrix_band_width(a);
+    uint64_t work = (uint64_t) c->rows * c->columns * (band + 1);
+    matrix_invalidate(c);
+    return linear_context_parallel_work(context, task, c->rows, work);
+}
+
+matrix_t* matrix_product_ctx(
+    linear_context_t* context, const matrix_t* a, const matrix_t* b
+) {
+    if (NULL == a || NULL == b) {
+        return NULL;
+    }
+
+    matrix_t* result = matrix_create_ctx(context, a->rows, b->columns);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    if (!matrix_gemm_ctx(context, 1.0f, a, b, 0.0f, result)) {
+        matrix_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+// Operands of a batch of GEMMs, one item per index
+typedef struct MatrixGemmBatch {
+    linear_context_t*      context;
+    const matrix_t* const* a;
+    const matrix_t* const* b;
+    matrix_t* const*       c;
+    float                  alpha;
+    float                  beta;
+    atomic_uint            failures;
+} matrix_gemm_batch_t;
+
+// Range kernel computing items [begin, end), each GEMM nested in parallel
+static void matrix_gemm_batch_routine(thread_data_t* task) {
+    matrix_gemm_batch_t* batch = (matrix_gemm_batch_t*) task->a;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        if (!matrix_gemm_ctx(
+                batch->context,
+                batch->alpha,
+                batch->a[i],
+                batch->b[i],
+                batch->beta,
+                batch->c[i]
+            )) {
+            atomic_fetch_add(&batch->failures, 1);
+        }
+    }
+}
+
+bool matrix_gemm_batched_ctx(
+    linear_context_t*      context,
+    uint32_t               count,
+    float                  alpha,
+    const matrix_t* const* a,
+    const matrix_t* const* b,
+    float                  beta,
+    matrix_t* const*       c
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NULL == a || NULL == b || NULL == c) {
+        LOG_ERROR("GEMM batch operands must not be NULL.\n");
+        return false;
+    }
+
+    // Reject the batch up front rather than leave it partially computed
+    uint64_t work = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!matrix_gemm_is_valid(a[i], b[i], c[i])) {
+            LOG_ERROR("Invalid GEMM at batch index %u.\n", i);
+            return false;
+        }
+        uint64_t band  = matrix_band_width(a[i]);
+        work          += (uint64_t) c[i]->rows * c[i]->columns * (band + 1);
+    }
+
+    matrix_gemm_batch_t batch = {
+        .context = context,
+        .a       = a,
+        .b       = b,
+        .c       = c,
+        .alpha   = alpha,
+        .beta    = beta,
+    };
+    atomic_init(&batch.failures, 0);
+
+    thread_data_t task = {
+        .a       = &batch,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_gemm_batch_routine,
+    };
+
+    if (!linear_context_parallel_work(context, task, count, work)) {
+        return false;
+    }
+
+    return 0 == atomic_load(&batch.failures);
+}
+
+// Range kernel computing the distance of rows [begin, end) to the query
+static void matrix_row_distance_routine(thread_data_t* task) {
+    const matrix_t* matrix = (const matrix_t*) task->a;
+    const float*    y      = (const float*) ((const vector_t*) task->b)->data;
+    float*          z      = (float*) ((vector_t*) task->result)->data;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* x   = matrix->data + (size_t) i * matrix->columns;
+        float        sum = 0.0f;
+        for (uint32_t j = 0; j < matrix->columns; j++) {
+            float delta  = x[j] - y[j];
+            sum         += delta * delta;
+        }
+        z[i] = sqrtf(sum);
+    }
+}
+
+vector_t* matrix_row_distance_ctx(
+    linear_context_t* context, const matrix_t* matrix, const vector_t* query
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || NULL == query || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (NUMERIC_FLOAT32 != query->type
+        || NUMERIC_FLOAT32 != context->precision) {
+        LOG_ERROR("Distance scans require NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    if (matrix->columns != query->columns) {
+        LOG_ERROR(
+            "Matrix columns %u do not match query columns %u.\n",
+            matrix->columns,
+            query->columns
+        );
+        return NULL;
+    }
+
+    vector_t* result = vector_create_ctx(context, matrix->rows);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting vector.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a       = (void*) matrix,
+        .b       = (void*) query,
+        .result  = result,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_row_distance_routine,
+    };
+
+    uint64_t work = (uint64_t) matrix->rows * matrix->columns;
+    if (!linear_context_parallel_work(context, task, matrix->rows, work)) {
+        vector_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+// Bulk Access and Indexing
+
+// Strided copy of count elements, shared by the tasks splitting them
+typedef struct MatrixStride {
+    const float* source;
+    float*       destination;
+    size_t       source_stride;
+    size_t       destination_stride;
+} matrix_stride_t;
+
+// Range kernel copying elements [begin, end) of a strided sequence
+static void matrix_stride_routine(thread_data_t* task) {
+    const matrix_stride_t* stride = (const matrix_stride_t*) task->a;
+    const float*           x      = stride->source;
+    float*                 z      = stride->destination;
+
+    if (1 == stride->source_stride && 1 == stride->destination_stride) {
+        size_t size = (size_t) (task->end - task->begin) * sizeof(float);
+        memcpy(z + task->begin, x + task->begin, size);
+        return;
+    }
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i * stride->destination_stride] = x[i * stride->source_stride];
+    }
+}
+
+// Verify a vector holds count NUMERIC_FLOAT32 elements
+static bool matrix_values_are_valid(const vector_t* values, uint32_t count) {
+    if (NULL == values || NULL == values->data) {
+        LOG_ERROR("Values must not be NULL.\n");
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != values->type || count != values->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 values, got %u.\n",
+            count,
+            values->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// Copy a row or column between a matrix and a vector
+static bool matrix_stride_copy(
+    linear_context_t* context, matrix_stride_t stride, uint32_t count
+) {
+    thread_data_t task = {
+        .a       = &stride,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_stride_routine,
+    };
+
+    return linear_context_parallel(context, task, count);
+}
+
+bool matrix_row_get_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          row,
+    vector_t*         values
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)
+        || !matrix_values_are_valid(values, matrix->columns)) {
+        return false;
+    }
+
+    if (row >= matrix->rows) {
+        LOG_ERROR("Row %u is out of bounds of %u rows.\n", row, matrix->rows);
+        return false;
+    }
+
+    matrix_stride_t stride = {
+        .source             = matrix->data + (size_t) row * matrix->columns,
+        .destination        = (float*) values->data,
+        .source_stride      = 1,
+        .destination_stride = 1,
+    };
+
+    return matrix_stride_copy(context, stride, matrix->columns);
+}
+
+bool matrix_row_set_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    uint32_t          row,
+    const vector_t*   values
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)
+        || !matrix_values_are_valid(values, matrix->columns)) {
+        return false;
+    }
+
+    if (row >= matrix->rows) {
+        LOG_ERROR("Row %u is out of bounds of %u rows.\n", row, matrix->rows);
+        return false;
+    }
+
+    matrix_stride_t stride = {
+        .source             = (const float*) values->data,
+        .destination        = matrix->data + (size_t) row * matrix->columns,
+        .source_stride      = 1,
+        .destination_stride = 1,
+    };
+
+    matrix_invalidate(matrix);
+    return matrix_stride_copy(context, stride, matrix->columns);
+}
+
+bool matrix_column_get_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    uint32_t          column,
+    vector_t*         values
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)
+        || !matrix_values_are_valid(values, matrix->rows)) {
+        return false;
+    }
+
+    if (column >= matrix->columns) {
+        LOG_ERROR(
+            "Column %u is out of bounds of %u columns.\n",
+            column,
+            matrix->columns
+        );
+        return false;
+    }
+
+    matrix_stride_t stride = {
+        .source             = matrix->data + column,
+        .destination        = (float*) values->data,
+        .source_stride      = matrix->columns,
+        .destination_stride = 1,
+    };
+
+    return matrix_stride_copy(context, stride, matrix->rows);
+}
+
+bool matrix_column_set_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    uint32_t          column,
+    const vector_t*   values
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)
+        || !matrix_values_are_valid(values, matrix->rows)) {
+        return false;
+    }
+
+    if (column >= matrix->columns) {
+        LOG_ERROR(
+            "Column %u is out of bounds of %u columns.\n",
+            column,
+            matrix->columns
+        );
+        return false;
+    }
+
+    matrix_stride_t stride = {
+        .source             = (const float*) values->data,
+        .destination        = matrix->data + column,
+        .source_stride      = 1,
+        .destination_stride = matrix->columns,
+    };
+
+    matrix_invalidate(matrix);
+    return matrix_stride_copy(context, stride, matrix->rows);
+}
+
+// Operands of an indexed access, shared by the tasks splitting the indices
+typedef struct MatrixIndex {
+    matrix_t*       matrix;  // The indexed matrix
+    const uint32_t* indices; // Flat element or row indices
+    float*          values;  // One value, or row, per index
+    atomic_uint     invalid; // Number of indices out of bounds
+} matrix_index_t;
+
+// Add to an element that other tasks may add to concurrently
+static inline void matrix_atomic_add(float* element, float value) {
+    _Atomic(float)* target   = (_Atomic(float)*) element;
+    float           expected = atomic_load_explicit(
+        target, memory_order_relaxed
+    );
+    while (!atomic_compare_exchange_weak_explicit(
+        target,
+        &expected,
+        expected + value,
+        memory_order_relaxed,
+        memory_order_relaxed
+    )) {
+        // expected was reloaded by the failed exchange
+    }
+}
+
+// Range kernel reading the elements at indices [begin, end)
+static void matrix_gather_routine(thread_data_t* task) {
+    matrix_index_t* index = (matrix_index_t*) task->a;
+    const float*    x     = index->matrix->data;
+    uint32_t        count = matrix_element_count(index->matrix);
+    uint32_t        stray = 0;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint32_t k = index->indices[i];
+        if (k < count) {
+            index->values[i] = x[k];
+        } else {
+            index->values[i] = NAN;
+            stray++;
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&index->invalid, stray);
+    }
+}
+
+// Range kernel writing the elements at indices [begin, end)
+static void matrix_scatter_routine(thread_data_t* task) {
+    matrix_index_t* index = (matrix_index_t*) task->a;
+    float*          z     = index->matrix->data;
+    uint32_t        count = matrix_element_count(index->matrix);
+    uint32_t        stray = 0;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint32_t k = index->indices[i];
+        if (k < count) {
+            z[k] = index->values[i];
+        } else {
+            stray++;
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&index->invalid, stray);
+    }
+}
+
+// Range kernel accumulating into the elements at indices [begin, end)
+static void matrix_scatter_add_routine(thread_data_t* task) {
+    matrix_index_t* index = (matrix_index_t*) task->a;
+    float*          z     = index->matrix->data;
+    uint32_t        count = matrix_element_count(index->matrix);
+    uint32_t        stray = 0;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint32_t k = index->indices[i];
+        if (k < count) {
+            matrix_atomic_add(&z[k], index->values[i]);
+        } else {
+            stray++;
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&index->invalid, stray);
+    }
+}
+
+// Range kernel copying the rows at indices [begin, end) into values
+static void matrix_gather_rows_routine(thread_data_t* task) {
+    matrix_index_t* index   = (matrix_index_t*) task->a;
+    const matrix_t* matrix  = index->matrix;
+    size_t          columns = matrix->columns;
+    uint32_t        stray   = 0;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint32_t r = index->indices[i];
+        float*   z = index->values + i * columns;
+        if (r < matrix->rows) {
+            memcpy(z, matrix->data + r * columns, columns * sizeof(float));
+        } else {
+            for (size_t j = 0; j < columns; j++) {
+                z[j] = NAN;
+            }
+            stray++;
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&index->invalid, stray);
+    }
+}
+
+// Range kernel accumulating rows [begin, end) of values into indexed rows
+static void matrix_scatter_add_rows_routine(thread_data_t* task) {
+    matrix_index_t* index   = (matrix_index_t*) task->a;
+    matrix_t*       matrix  = index->matrix;
+    size_t          columns = matrix->columns;
+    uint32_t        stray   = 0;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        uint32_t r = index->indices[i];
+        if (r >= matrix->rows) {
+            stray++;
+            continue;
+        }
+
+        const float* x = index->values + i * columns;
+        float*       z = matrix->data + r * columns;
+        for (size_t j = 0; j < columns; j++) {
+            matrix_atomic_add(&z[j], x[j]);
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&index->invalid, stray);
+    }
+}
+
+// Run an indexed access over count indices, each touching width elements
+static bool matrix_index_run(
+    linear_context_t* context,
+    matrix_index_t*   index,
+    uint32_t          count,
+    uint32_t          width,
+    thread_routine_t  routine
+) {
+    atomic_init(&index->invalid, 0);
+
+    thread_data_t task = {
+        .a       = index,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    uint64_t work = (uint64_t) count * width;
+    if (!linear_context_parallel_work(context, task, count, work)) {
+        return false;
+    }
+
+    uint32_t invalid = atomic_load(&index->invalid);
+    if (invalid) {
+        LOG_ERROR("%u of %u indices are out of bounds.\n", invalid, count);
+        return false;
+    }
+
+    return true;
+}
+
+// Verify the operands of an element-wise indexed access
+static bool matrix_index_is_valid(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   indices,
+    const vector_t*   values
+) {
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NULL == indices && values && values->columns > 0) {
+        LOG_ERROR("Indices must not be NULL.\n");
+        return false;
+    }
+
+    return matrix_values_are_valid(values, (values) ? values->columns : 0);
+}
+
+bool matrix_gather_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   indices,
+    vector_t*         values
+) {
+    context = linear_context_resolve(context);
+    if (!matrix_index_is_valid(context, matrix, indices, values)) {
+        return false;
+    }
+
+    matrix_index_t index = {
+        .matrix  = (matrix_t*) matrix,
+        .indices = indices,
+        .values  = (float*) values->data,
+    };
+
+    return matrix_index_run(
+        context, &index, values->columns, 1, matrix_gather_routine
+    );
+}
+
+bool matrix_scatter_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   indices,
+    const vector_t*   values
+) {
+    context = linear_context_resolve(context);
+    if (!matrix_index_is_valid(context, matrix, indices, values)) {
+        return false;
+    }
+
+    matrix_index_t index = {
+        .matrix  = matrix,
+        .indices = indices,
+        .values  = (float*) values->data,
+    };
+
+    matrix_invalidate(matrix);
+    return matrix_index_run(
+        context, &index, values->columns, 1, matrix_scatter_routine
+    );
+}
+
+bool matrix_scatter_add_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   indices,
+    const vector_t*   values
+) {
+    context = linear_context_resolve(context);
+    if (!matrix_index_is_valid(context, matrix, indices, values)) {
+        return false;
+    }
+
+    matrix_index_t index = {
+        .matrix  = matrix,
+        .indices = indices,
+        .values  = (float*) values->data,
+    };
+
+    matrix_invalidate(matrix);
+    return matrix_index_run(
+        context, &index, values->columns, 1, matrix_scatter_add_routine
+    );
+}
+
+// Verify the operands of a row-wise indexed access
+static bool matrix_row_index_is_valid(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   rows,
+    const matrix_t*   values
+) {
+    if (NULL == matrix || NULL == values || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NULL == rows && values->rows > 0) {
+        LOG_ERROR("Row indices must not be NULL.\n");
+        return false;
+    }
+
+    if (matrix->columns != values->columns) {
+        LOG_ERROR(
+            "Matrix columns %u do not match value columns %u.\n",
+            matrix->columns,
+            values->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+bool matrix_gather_rows_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   rows,
+    matrix_t*         result
+) {
+    context = linear_context_resolve(context);
+    if (!matrix_row_index_is_valid(context, matrix, rows, result)) {
+        return false;
+    }
+
+    matrix_index_t index = {
+        .matrix  = (matrix_t*) matrix,
+        .indices = rows,
+        .values  = result->data,
+    };
+
+    matrix_invalidate(result);
+    return matrix_index_run(
+        context,
+        &index,
+        result->rows,
+        matrix->columns,
+        matrix_gather_rows_routine
+    );
+}
+
+matrix_t* matrix_index_select_ctx(
+    linear_context_t* context,
+    const matrix_t*   matrix,
+    const uint32_t*   rows,
+    uint32_t          count
+) {
+    if (NULL == matrix) {
+        return NULL;
+    }
+
+    matrix_t* result = matrix_create_ctx(context, count, matrix->columns);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    if (!matrix_gather_rows_ctx(context, matrix, rows, result)) {
+        matrix_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+bool matrix_scatter_add_rows_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    const uint32_t*   rows,
+    const matrix_t*   values
+) {
+    context = linear_context_resolve(context);
+    if (!matrix_row_index_is_valid(context, matrix, rows, values)) {
+        return false;
+    }
+
+    matrix_index_t index = {
+        .matrix  = matrix,
+        .indices = rows,
+        .values  = values->data,
+    };
+
+    matrix_invalidate(matrix);
+    return matrix_index_run(
+        context,
+        &index,
+        values->rows,
+        matrix->columns,
+        matrix_scatter_add_rows_routine
+    );
+}
+
+// Embedding Bags
+
+// Operands of an embedding-bag lookup, shared by the tasks splitting the bags
+typedef struct MatrixBag {
+    const matrix_t*  table;   // Rows to look up
+    const uint32_t*  indices; // Row indices of every bag, concatenated
+    const uint32_t*  offsets; // Bag b spans indices [offsets[b], offsets[b+1])
+    const float*     weights; // Per-index weights, or NULL
+    matrix_pooling_t pooling; // Reduction over the rows of a bag
+    matrix_t*        result;  // One pooled row per bag
+    atomic_uint      invalid; // Number of indices out of bounds
+} matrix_bag_t;
+
+// Hint the row looked up LINEAR_EMBEDDING_PREFETCH indices ahead into cache
+static inline void
+matrix_embedding_prefetch(const matrix_bag_t* bag, uint32_t k, uint32_t end) {
+#if defined(__GNUC__) && LINEAR_EMBEDDING_PREFETCH > 0
+    k += LINEAR_EMBEDDING_PREFETCH;
+    if (k >= end || bag->indices[k] >= bag->table->rows) {
+        return;
+    }
+
+    size_t      size = bag->table->columns * sizeof(float);
+    const char* row  = (const char*) bag->table->data;
+    row             += bag->indices[k] * size;
+    for (size_t offset = 0; offset < size; offset += LINEAR_CACHE_LINE_SIZE) {
+        __builtin_prefetch(row + offset, 0, 1);
+    }
+#else
+    (void) bag;
+    (void) k;
+    (void) end;
+#endif
+}
+
+// Range kernel pooling bags [begin, end) in a single pass over their rows
+static void matrix_embedding_bag_routine(thread_data_t* task) {
+    matrix_bag_t*   bag     = (matrix_bag_t*) task->a;
+    const matrix_t* table   = bag->table;
+    size_t          columns = table->columns;
+    uint32_t        last    = bag->offsets[bag->result->rows];
+    uint32_t        stray   = 0;
+
+    for (uint32_t b = task->begin; b < task->end; b++) {
+        float*   z    = bag->result->data + b * columns;
+        float    init = (MATRIX_POOL_MAX == bag->pooling) ? -INFINITY : 0.0f;
+        uint32_t used = 0;
+
+        for (size_t j = 0; j < columns; j++) {
+            z[j] = init;
+        }
+
+        for (uint32_t k = bag->offsets[b]; k < bag->offsets[b + 1]; k++) {
+            matrix_embedding_prefetch(bag, k, last);
+
+            uint32_t r = bag->indices[k];
+            if (r >= table->rows) {
+                stray++;
+                continue;
+            }
+
+            const float* x = table->data + r * columns;
+            used++;
+
+            // Keep each inner loop free of branches so it vectorizes, and
+            // take x when it is NaN so that NaN propagates like the sums
+            if (MATRIX_POOL_MAX == bag->pooling) {
+                for (size_t j = 0; j < columns; j++) {
+                    z[j] = (x[j] > z[j] || x[j] != x[j]) ? x[j] : z[j];
+                }
+            } else {
+                float weight = (bag->weights) ? bag->weights[k] : 1.0f;
+                for (size_t j = 0; j < columns; j++) {
+                    z[j] += weight * x[j];
+                }
+            }
+        }
+
+        // Empty bags pool to zero, means divide by the rows looked up
+        if (0 == used) {
+            for (size_t j = 0; j < columns; j++) {
+                z[j] = 0.0f;
+            }
+        } else if (MATRIX_POOL_MEAN == bag->pooling) {
+            float scale = 1.0f / (float) used;
+            for (size_t j = 0; j < columns; j++) {
+                z[j] *= scale;
+            }
+        }
+    }
+
+    if (stray) {
+        atomic_fetch_add(&bag->invalid, stray);
+    }
+}
+
+bool matrix_embedding_bag_ctx(
+    linear_context_t* context,
+    const matrix_t*   table,
+    const uint32_t*   indices,
+    const uint32_t*   offsets,
+    const float*      weights,
+    matrix_pooling_t  pooling,
+    matrix_t*         result
+) {
+    context = linear_context_resolve(context);
+    if (NULL == table || NULL == offsets || NULL == result
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (pooling >= MATRIX_POOL_COUNT) {
+        LOG_ERROR("Invalid pooling %d.\n", pooling);
+        return false;
+    }
+
+    if (weights && MATRIX_POOL_MAX == pooling) {
+        LOG_ERROR("Per-index weights do not apply to max pooling.\n");
+        return false;
+    }
+
+    if (table->columns != result->columns) {
+        LOG_ERROR(
+            "Table columns %u do not match result columns %u.\n",
+            table->columns,
+            result->columns
+        );
+        return false;
+    }
+
+    // Offsets must be non-decreasing, so every bag is a valid span
+    uint32_t bags = result->rows;
+    for (uint32_t b = 0; b < bags; b++) {
+        if (offsets[b] > offsets[b + 1]) {
+            LOG_ERROR("Offsets decrease at bag %u.\n", b);
+            return false;
+        }
+    }
+
+    if (NULL == indices && offsets[bags] > offsets[0]) {
+        LOG_ERROR("Indices must not be NULL.\n");
+        return false;
+    }
+
+    matrix_bag_t bag = {
+        .table   = table,
+        .indices = indices,
+        .offsets = offsets,
+        .weights = weights,
+        .pooling = pooling,
+        .result  = result,
+    };
+    atomic_init(&bag.invalid, 0);
+
+    thread_data_t task = {
+        .a       = &bag,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_embedding_bag_routine,
+    };
+
+    matrix_invalidate(result);
+
+    // Bags vary in size, the work counts the rows actually looked up
+    uint64_t lookups = offsets[bags] - offsets[0];
+    uint64_t work    = (lookups + bags) * table->columns;
+    if (!linear_context_parallel_work(context, task, bags, work)) {
+        return false;
+    }
+
+    uint32_t invalid = atomic_load(&bag.invalid);
+    if (invalid) {
+        LOG_ERROR("%u indices are out of bounds of the table.\n", invalid);
+        return false;
+    }
+
+    return true;
+}
+
+// Non-finite Detection and Sanitization
+
+// View the elements of a matrix as a flat vector, sharing its data
+static vector_t matrix_flat_view(const matrix_t* matrix) {
+    vector_t view = {
+        .data    = matrix->data,
+        .columns = matrix_element_count(matrix),
+        .type    = NUMERIC_FLOAT32,
+    };
+    return view;
+}
+
+bool matrix_all_finite_ctx(linear_context_t* context, const matrix_t* matrix) {
+    if (NULL == matrix) {
+        return false;
+    }
+
+    vector_t view = matrix_flat_view(matrix);
+    return vector_all_finite_ctx(context, &view);
+}
+
+uint32_t
+matrix_count_nonfinite_ctx(linear_context_t* context, const matrix_t* matrix) {
+    if (NULL == matrix) {
+        return 0;
+    }
+
+    vector_t view = matrix_flat_view(matrix);
+    return vector_count_nonfinite_ctx(context, &view);
+}
+
+bool matrix_nan_to_num_ctx(
+    linear_context_t* context,
+    matrix_t*         matrix,
+    float             nan,
+    float             posinf,
+    float             neginf
+) {
+    if (NULL == matrix) {
+        return false;
+    }
+
+    vector_t view = matrix_flat_view(matrix);
+    matrix_invalidate(matrix);
+    return vector_nan_to_num_ctx(context, &view, nan, posinf, neginf);
+}
+
+bool matrix_ingest_ctx(linear_context_t* context, matrix_t* matrix) {
+    if (NULL == matrix) {
+        return false;
+    }
+
+    vector_t view = matrix_flat_view(matrix);
+    matrix_invalidate(matrix);
+    return vector_ingest_ctx(context, &view);
+}
+
+// Approximate Comparison
+
+bool matrix_is_close_ctx(
+    linear_context_t*         context,
+    const matrix_t*           a,
+    const matrix_t*           b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+) {
+    if (NULL == a || NULL == b) {
+        return false;
+    }
+
+    if (a->rows != b->rows || a->columns != b->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot compare matrices of size "
+            "%ux%u and %ux%u.\n",
+            a->rows,
+            a->columns,
+            b->rows,
+            b->columns
+        );
+        return false;
+    }
+
+    vector_t x = matrix_flat_view(a);
+    vector_t y = matrix_flat_view(b);
+    return vector_is_close_ctx(context, &x, &y, tolerance, report);
+}
+
+bool matrix_is_zero_ctx(linear_context_t* context, const matrix_t* matrix) {
+    if (NULL == matrix) {
+        return false;
+    }
+
+    if (matrix->state & MATRIX_ANALYZED) {
+        return matrix->state & MATRIX_ZERO;
+    }
+
+    vector_t           view  = matrix_flat_view(matrix);
+    vector_tolerance_t exact = {0};
+    return vector_is_close_scalar_ctx(context, &view, 0.0f, &exact, NULL);
+}
+
+// Range kernel over rows raising the flag pointed to by result upon the first
+// row that differs from the identity, and returning early once it is raised
+static void matrix_identity_routine(thread_data_t* task) {
+    const matrix_t* matrix = (const matrix_t*) task->a;
+    atomic_bool*    found  = (atomic_bool*) task->result;
+    uint32_t        n      = matrix->columns;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        if (atomic_load_explicit(found, memory_order_relaxed)) {
+            return;
+        }
+
+        const float* row     = matrix->data + (size_t) i * n;
+        uint32_t     differs = 0;
+        for (uint32_t j = 0; j < n; j++) {
+            differs |= row[j] != (float) (i == j);
+        }
+
+        if (differs) {
+            atomic_store_explicit(found, true, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+bool matrix_is_identity_ctx(
+    linear_context_t* context, const matrix_t* matrix
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || NULL == matrix->data
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (!matrix_is_square(matrix)) {
+        return false;
+    }
+
+    if (matrix->state & MATRIX_ANALYZED) {
+        return matrix->state & MATRIX_IDENTITY;
+    }
+
+    atomic_bool found = false;
+
+    thread_data_t task = {
+        .a       = (void*) matrix,
+        .result  = &found,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_identity_routine,
+    };
+
+    uint64_t work = (uint64_t) matrix->rows * matrix->columns;
+    if (!linear_context_parallel_work(context, task, matrix->rows, work)) {
+        return false;
+    }
+
+    return !atomic_load(&found);
+}
+
+// Structure Detection and Dispatch
+
+// Structure of a single row, merged by matrix_analyze_ctx()
+typedef struct MatrixProfile {
+    uint32_t first;     // First nonzero column, columns if there is none
+    uint32_t last;      // One past the last nonzero column, 0 if none
+    uint32_t nonzeros;  // Number of nonzero elements
+    bool     unit;      // The diagonal element, if any, is one
+    bool     symmetric; // The row equals the matching column
+} matrix_profile_t;
+
+// Range kernel profiling rows [begin, end) into the array pointed to by
+// result, one profile per row
+static void matrix_analyze_routine(thread_data_t* task) {
+    const matrix_t*   matrix   = (const matrix_t*) task->a;
+    matrix_profile_t* profiles = (matrix_profile_t*) task->result;
+    const uint32_t    n        = matrix->columns;
+    const bool        square   = matrix->rows == n;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row   = matrix->data + (size_t) i * n;
+        uint32_t     first = n;
+        uint32_t     last  = 0;
+        uint32_t     count = 0;
+
+        // Masks rather than branches, so the scan vectorizes. NaN counts as
+        // nonzero.
+        for (uint32_t j = 0; j < n; j++) {
+            uint32_t nonzero = -(uint32_t) (row[j] != 0.0f);
+            uint32_t begin   = (j & nonzero) | (n & ~nonzero);
+            uint32_t end     = (j + 1) & nonzero;
+            first            = (begin < first) ? begin : first;
+            last             = (end > last) ? end : last;
+            count           -= nonzero; // all ones is -1
+        }
+
+        // Compare the part right of the diagonal with the part below it
+        uint32_t differs = !square;
+        for (uint32_t j = i + 1; square && j < n; j++) {
+            differs |= row[j] != matrix->data[(size_t) j * n + i];
+        }
+
+        profiles[i].first     = first;
+        profiles[i].last      = last;
+        profiles[i].nonzeros  = count;
+        profiles[i].unit      = i >= n || 1.0f == row[i];
+        profiles[i].symmetric = !differs;
+    }
+}
+
+bool matrix_analyze_ctx(
+    linear_context_t*   context,
+    matrix_t*           matrix,
+    matrix_structure_t* structure
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    size_t            mark     = linear_context_scratch_mark(context);
+    matrix_profile_t* profiles = linear_context_scratch_alloc(
+        context, sizeof(matrix_profile_t) * matrix->rows
+    );
+    if (NULL == profiles && matrix->rows > 0) {
+        LOG_ERROR("Failed to allocate memory for the row profiles.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    thread_data_t task = {
+        .a       = matrix,
+        .result  = profiles,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_analyze_routine,
+    };
+
+    // Square matrices also read the transpose for symmetry
+    uint64_t work = (uint64_t) matrix->rows * matrix->columns;
+    work          = matrix_is_square(matrix) ? work + work / 2 : work;
+    if (!linear_context_parallel_work(context, task, matrix->rows, work)) {
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    matrix_structure_t found     = {0};
+    bool               unit      = true;
+    bool               symmetric = matrix_is_square(matrix);
+    for (uint32_t i = 0; i < matrix->rows; i++) {
+        const matrix_profile_t* row = &profiles[i];
+        unit                        &= row->unit;
+        symmetric                   &= row->symmetric;
+        if (0 == row->nonzeros) {
+            continue;
+        }
+
+        found.nonzeros += row->nonzeros;
+        if (i > row->first && i - row->first > found.lower) {
+            found.lower = i - row->first;
+        }
+        if (row->last - 1 > i && row->last - 1 - i > found.upper) {
+            found.upper = row->last - 1 - i;
+        }
+    }
+    linear_context_scratch_release(context, mark);
+
+    uint64_t elements = (uint64_t) matrix->rows * matrix->columns;
+    uint64_t band     = (uint64_t) found.lower + found.upper + 1;
+    found.sparsity    = 1.0f;
+    if (elements > 0) {
+        found.sparsity -= (float) ((double) found.nonzeros / elements);
+    }
+
+    found.flags |= (0 == found.nonzeros) ? MATRIX_ZERO : 0;
+    found.flags |= (0 == found.lower) ? MATRIX_UPPER : 0;
+    found.flags |= (0 == found.upper) ? MATRIX_LOWER : 0;
+    found.flags |= (0 == found.lower + found.upper) ? MATRIX_DIAGONAL : 0;
+    found.flags |= (symmetric) ? MATRIX_SYMMETRIC : 0;
+    found.flags |= (band < matrix->columns) ? MATRIX_BANDED : 0;
+    if ((found.flags & MATRIX_DIAGONAL) && unit
+        && matrix_is_square(matrix)) {
+        found.flags |= MATRIX_IDENTITY;
+    }
+
+    matrix->state = (matrix->state & ~MATRIX_STRUCTURE) | MATRIX_ANALYZED
+                    | found.flags;
+    matrix->lower = found.lower;
+    matrix->upper = found.upper;
+
+    if (structure) {
+        *structure = found;
+    }
+
+    return true;
+}
+
+void matrix_invalidate(matrix_t* matrix) {
+    if (NULL == matrix) {
+        return;
+    }
+
+    matrix->state &= ~MATRIX_STRUCTURE;
+    matrix->lower  = 0;
+    matrix->upper  = 0;
+}
+
+// Operands of a GEMV, shared by the tasks splitting the rows of a
+typedef struct MatrixGemv {
+    const matrix_t* a;
+    const float*    x;
+    float*          y;
+    float           alpha;
+    float           beta;
+} matrix_gemv_t;
+
+// Range kernel computing elements [begin, end) of y = alpha * a * x + beta * y
+static void matrix_gemv_routine(thread_data_t* task) {
+    const matrix_gemv_t* gemv = (const matrix_gemv_t*) task->a;
+    const uint32_t       n    = gemv->a->columns;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = gemv->a->data + (size_t) i * n;
+        uint32_t     first, last;
+        matrix_band_span(gemv->a, i, &first, &last);
+
+        float sum = 0.0f;
+        for (uint32_t k = first; k < last; k++) {
+            sum += row[k] * gemv->x[k];
+        }
+
+        // beta == 0 overwrites, so uninitialized NaNs do not propagate
+        float scaled = (0.0f == gemv->beta) ? 0.0f : gemv->beta * gemv->y[i];
+        gemv->y[i]   = scaled + gemv->alpha * sum;
+    }
+}
+
+bool matrix_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const matrix_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == x || NULL == y
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != x->type || NUMERIC_FLOAT32 != y->type) {
+        LOG_ERROR("GEMV requires NUMERIC_FLOAT32 vectors.\n");
+        return false;
+    }
+
+    if (a->columns != x->columns || a->rows != y->columns) {
+        LOG_ERROR(
+            "Dimensions do not match. Cannot multiply a matrix of size %ux%u "
+            "by %u elements into %u elements.\n",
+            a->rows,
+            a->columns,
+            x->columns,
+            y->columns
+        );
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("GEMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    matrix_gemv_t gemv = {
+        .a     = a,
+        .x     = (const float*) x->data,
+        .y     = (float*) y->data,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+
+    thread_data_t task = {
+        .a       = &gemv,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_gemv_routine,
+    };
+
+    uint64_t work = (uint64_t) a->rows * (matrix_band_width(a) + 1);
+    return linear_context_parallel_work(context, task, a->rows, work);
+}
+
+// A factorization, or triangular matrix, and the right-hand sides it solves,
+// shared by the tasks splitting a trailing update or the right-hand sides
+typedef struct MatrixFactor {
+    float*    w;      // n x n factor, updated in place while factoring
+    float*    x;      // n x r right-hand sides, solved in place
+    uint32_t* pivots; // Row swapped with row k at step k of an LU, or NULL
+    uint32_t  n;      // Order of the factor
+    uint32_t  r;      // Number of right-hand sides
+    uint32_t  lower;  // Lower bandwidth of the factor
+    uint32_t  upper;  // Upper bandwidth of the factor
+    uint32_t  k;      // Current step of the factorization
+} matrix_factor_t;
+
+// Range kernel eliminating column k from rows k + 1 + [begin, end) of an LU
+// factorization, keeping the multipliers in place of the eliminated elements
+static void matrix_lu_routine(thread_data_t* task) {
+    const matrix_factor_t* f     = (const matrix_factor_t*) task->a;
+    const uint32_t         k     = f->k;
+    const float*           pivot = f->w + (size_t) k * f->n;
+    uint64_t               end   = (uint64_t) k + f->upper + 1;
+    uint32_t               last  = (end < f->n) ? (uint32_t) end : f->n;
+
+    for (uint32_t t = task->begin; t < task->end; t++) {
+        float* row = f->w + (size_t) (k + 1 + t) * f->n;
+        float  l   = row[k] / pivot[k];
+        row[k]     = l;
+        for (uint32_t j = k + 1; j < last; j++) {
+            row[j] -= l * pivot[j];
+        }
+    }
+}
+
+// Range kernel updating rows k + 1 + [begin, end) of the upper triangle of a
+// Cholesky factorization, a = r' * r, whose row k of r is complete
+static void matrix_cholesky_routine(thread_data_t* task) {
+    const matrix_factor_t* f     = (const matrix_factor_t*) task->a;
+    const uint32_t         k     = f->k;
+    const float*           pivot = f->w + (size_t) k * f->n;
+    uint64_t               end   = (uint64_t) k + f->upper + 1;
+    uint32_t               last  = (end < f->n) ? (uint32_t) end : f->n;
+
+    for (uint32_t t = task->begin; t < task->end; t++) {
+        uint32_t i   = k + 1 + t;
+        float*   row = f->w + (size_t) i * f->n;
+        float    l   = pivot[i];
+        for (uint32_t j = i; j < last; j++) {
+            row[j] -= l * pivot[j];
+        }
+    }
+}
+
+// Range kernel solving columns [begin, end) of x against the lower triangle
+// of w by forward substitution
+static void matrix_forward_routine(thread_data_t* task) {
+    const matrix_factor_t* f = (const matrix_factor_t*) task->a;
+
+    for (uint32_t i = 0; i < f->n; i++) {
+        const float* row   = f->w + (size_t) i * f->n;
+        float*       z     = f->x + (size_t) i * f->r;
+        uint32_t     first = (i > f->lower) ? i - f->lower : 0;
+        for (uint32_t k = first; k < i; k++) {
+            const float  l = row[k];
+            const float* y = f->x + (size_t) k * f->r;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                z[j] -= l * y[j];
+            }
+        }
+
+        const float d = row[i];
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            z[j] /= d;
+        }
+    }
+}
+
+// Range kernel applying the unit lower factor of an LU to columns
+// [begin, end) of x, interleaving the row swaps as the factorization did
+static void matrix_forward_pivoted_routine(thread_data_t* task) {
+    const matrix_factor_t* f = (const matrix_factor_t*) task->a;
+
+    for (uint32_t k = 0; k < f->n; k++) {
+        float* z = f->x + (size_t) k * f->r;
+        if (f->pivots[k] != k) {
+            float* y = f->x + (size_t) f->pivots[k] * f->r;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                float swap = z[j];
+                z[j]       = y[j];
+                y[j]       = swap;
+            }
+        }
+
+        // Multipliers of column k stay in the rows that computed them
+        uint64_t end  = (uint64_t) k + f->lower + 1;
+        uint32_t last = (end < f->n) ? (uint32_t) end : f->n;
+        for (uint32_t i = k + 1; i < last; i++) {
+            const float l = f->w[(size_t) i * f->n + k];
+            float*      y = f->x + (size_t) i * f->r;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                y[j] -= l * z[j];
+            }
+        }
+    }
+}
+
+// Range kernel solving columns [begin, end) of x against the transpose of
+// the upper triangle of w, reading w by rows
+static void matrix_forward_transposed_routine(thread_data_t* task) {
+    const matrix_factor_t* f = (const matrix_factor_t*) task->a;
+
+    for (uint32_t k = 0; k < f->n; k++) {
+        const float* row = f->w + (size_t) k * f->n;
+        float*       z   = f->x + (size_t) k * f->r;
+        const float  d   = row[k];
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            z[j] /= d;
+        }
+
+        uint64_t end  = (uint64_t) k + f->upper + 1;
+        uint32_t last = (end < f->n) ? (uint32_t) end : f->n;
+        for (uint32_t i = k + 1; i < last; i++) {
+            const float l = row[i];
+            float*      y = f->x + (size_t) i * f->r;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                y[j] -= l * z[j];
+            }
+        }
+    }
+}
+
+// Range kernel solving columns [begin, end) of x against the upper triangle
+// of w by back substitution
+static void matrix_backward_routine(thread_data_t* task) {
+    const matrix_factor_t* f = (const matrix_factor_t*) task->a;
+
+    for (uint32_t i = f->n; i-- > 0;) {
+        const float* row  = f->w + (size_t) i * f->n;
+        float*       z    = f->x + (size_t) i * f->r;
+        uint64_t     end  = (uint64_t) i + f->upper + 1;
+        uint32_t     last = (end < f->n) ? (uint32_t) end : f->n;
+        for (uint32_t k = i + 1; k < last; k++) {
+            const float  u = row[k];
+            const float* y = f->x + (size_t) k * f->r;
+            for (uint32_t j = task->begin; j < task->end; j++) {
+                z[j] -= u * y[j];
+            }
+        }
+
+        const float d = row[i];
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            z[j] /= d;
+        }
+    }
+}
+
+// Run a substitution splitting the right-hand sides, each row of the factor
+// visiting band elements
+static bool matrix_substitute(
+    linear_context_t* context,
+    matrix_factor_t*  factor,
+    thread_routine_t  routine,
+    uint32_t          band
+) {
+    thread_data_t task = {
+        .a       = factor,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    uint64_t work = (uint64_t) factor->n * factor->r * (band + 1);
+    return linear_context_parallel_work(context, task, factor->r, work);
+}
+
+// Run the trailing update of the current step over the count rows below it
+static bool matrix_eliminate(
+    linear_context_t* context,
+    matrix_factor_t*  factor,
+    thread_routine_t  routine,
+    uint32_t          count
+) {
+    thread_data_t task = {
+        .a       = factor,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    uint64_t work = (uint64_t) count * (factor->upper + 1);
+    return linear_context_parallel_work(context, task, count, work);
+}
+
+// Factor the symmetric w = r' * r in place, r keeping the bandwidth of w,
+// returning false if w is not positive definite
+static bool matrix_cholesky(linear_context_t* context, matrix_factor_t* f) {
+    for (uint32_t k = 0; k < f->n; k++) {
+        float*   pivot = f->w + (size_t) k * f->n;
+        uint64_t end   = (uint64_t) k + f->upper + 1;
+        uint32_t last  = (end < f->n) ? (uint32_t) end : f->n;
+
+        if (!(pivot[k] > 0.0f)) {
+            return false; // also rejects NaN
+        }
+
+        pivot[k] = sqrtf(pivot[k]);
+        for (uint32_t j = k + 1; j < last; j++) {
+            pivot[j] /= pivot[k];
+        }
+
+        f->k = k;
+        if (!matrix_eliminate(
+                context, f, matrix_cholesky_routine, last - k - 1
+            )) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Factor w = p * l * u in place with partial pivoting. Rows only swap within
+// the lower band, so l keeps the lower bandwidth of w while u widens by it.
+static bool matrix_lu(linear_context_t* context, matrix_factor_t* f) {
+    uint64_t upper = (uint64_t) f->upper + f->lower;
+    f->upper       = (upper < f->n) ? (uint32_t) upper : f->n;
+
+    for (uint32_t k = 0; k < f->n; k++) {
+        uint64_t below = (uint64_t) k + f->lower + 1;
+        uint32_t rows  = (below < f->n) ? (uint32_t) below : f->n;
+
+        // The largest magnitude in column k on or below the diagonal
+        uint32_t pivot = k;
+        float    best  = fabsf(f->w[(size_t) k * f->n + k]);
+        for (uint32_t i = k + 1; i < rows; i++) {
+            float magnitude = fabsf(f->w[(size_t) i * f->n + k]);
+            if (magnitude > best) {
+                best  = magnitude;
+                pivot = i;
+            }
+        }
+
+        if (!(best > 0.0f)) {
+            LOG_ERROR("Matrix is singular at column %u.\n", k);
+            return false;
+        }
+
+        // Multipliers left of column k stay put, see the forward substitution
+        f->pivots[k] = pivot;
+        if (pivot != k) {
+            uint64_t end  = (uint64_t) k + f->upper + 1;
+            uint32_t last = (end < f->n) ? (uint32_t) end : f->n;
+            float*   x    = f->w + (size_t) k * f->n;
+            float*   y    = f->w + (size_t) pivot * f->n;
+            for (uint32_t j = k; j < last; j++) {
+                float swap = x[j];
+                x[j]       = y[j];
+                y[j]       = swap;
+            }
+        }
+
+        f->k = k;
+        if (!matrix_eliminate(context, f, matrix_lu_routine, rows - k - 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Copy the elements of source into destination of the same size
+static bool matrix_copy_elements(
+    linear_context_t* context, const matrix_t* source, matrix_t* destination
+) {
+    thread_data_t task = {
+        .a       = (void*) source,
+        .result  = destination,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_copy_routine,
+    };
+
+    uint32_t count = matrix_element_count(source);
+    return linear_context_parallel(context, task, count);
+}
+
+// Solve the right-hand sides in f->x against the analyzed a by factoring a
+static bool matrix_solve_factored(
+    linear_context_t* context, const matrix_t* a, matrix_factor_t* f
+) {
+    matrix_t* w = matrix_create_ctx(context, a->rows, a->columns);
+    if (NULL == w || !matrix_copy_elements(context, a, w)) {
+        matrix_free_ctx(context, w);
+        return false;
+    }
+    f->w = w->data;
+
+    // Cholesky halves the cost of LU, but only applies to positive definite
+    bool solved = false;
+    if ((a->state & MATRIX_SYMMETRIC) && matrix_cholesky(context, f)) {
+        solved = matrix_substitute(
+            context, f, matrix_forward_transposed_routine, f->upper
+        );
+        solved = solved
+                 && matrix_substitute(
+                     context, f, matrix_backward_routine, f->upper
+                 );
+        matrix_free_ctx(context, w);
+        return solved;
+    }
+
+    // Start over from the original elements if Cholesky gave up midway
+    if ((a->state & MATRIX_SYMMETRIC)
+        && !matrix_copy_elements(context, a, w)) {
+        matrix_free_ctx(context, w);
+        return false;
+    }
+
+    size_t mark = linear_context_scratch_mark(context);
+    f->pivots   = linear_context_scratch_alloc(
+        context, sizeof(uint32_t) * f->n
+    );
+    f->lower    = a->lower;
+    f->upper    = a->upper;
+    if (NULL == f->pivots) {
+        LOG_ERROR("Failed to allocate memory for the pivots.\n");
+    } else if (matrix_lu(context, f)) {
+        solved = matrix_substitute(
+            context, f, matrix_forward_pivoted_routine, f->lower
+        );
+        solved = solved
+                 && matrix_substitute(
+                     context, f, matrix_backward_routine, f->upper
+                 );
+    }
+
+    linear_context_scratch_release(context, mark);
+    matrix_free_ctx(context, w);
+    return solved;
+}
+
+bool matrix_solve_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    matrix_t*         x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || NULL == x
+        || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (!matrix_is_square(a) || a->rows != b->rows || b->rows != x->rows
+        || b->columns != x->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot solve a matrix of size "
+            "%ux%u for %ux%u into %ux%u.\n",
+            a->rows,
+            a->columns,
+            b->rows,
+            b->columns,
+            x->rows,
+            x->columns
+        );
+        return false;
+    }
+
+    if (x->data == a->data) {
+        LOG_ERROR("The solution must not overlap the matrix.\n");
+        return false;
+    }
+
+    // a is read only, so analyze a view of it unless its structure is cached
+    matrix_t view = *a;
+    if (!(view.state & MATRIX_ANALYZED)
+        && !matrix_analyze_ctx(context, &view, NULL)) {
+        return false;
+    }
+
+    // Solve in place on a copy of the right-hand sides
+    if (x->data != b->data && !matrix_copy_elements(context, b, x)) {
+        return false;
+    }
+    matrix_invalidate(x);
+
+    if (view.state & MATRIX_IDENTITY) {
+        return true;
+    }
+
+    matrix_factor_t factor = {
+        .w     = view.data,
+        .x     = x->data,
+        .n     = view.rows,
+        .r     = x->columns,
+        .lower = view.lower,
+        .upper = view.upper,
+    };
+
+    if (!(view.state & (MATRIX_LOWER | MATRIX_UPPER))) {
+        return matrix_solve_factored(context, &view, &factor);
+    }
+
+    // Triangular matrices, diagonal ones included, substitute directly
+    for (uint32_t i = 0; i < view.rows; i++) {
+        if (0.0f == view.data[(size_t) i * view.columns + i]) {
+            LOG_ERROR("Matrix is singular at column %u.\n", i);
+            return false;
+        }
+    }
+
+    if (view.state & MATRIX_UPPER) {
+        return matrix_substitute(
+            context, &factor, matrix_backward_routine, view.upper
+        );
+    }
+    return matrix_substitute(
+        context, &factor, matrix_forward_routine, view.lower
+    );
+}
+
+// Factorization updates
+
+bool matrix_cholesky_ctx(
+    linear_context_t* context, const matrix_t* a, matrix_t* r
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == r || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (!matrix_is_square(a) || a->rows != r->rows
+        || a->columns != r->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot factor a matrix of size "
+            "%ux%u into %ux%u.\n",
+            a->rows,
+            a->columns,
+            r->rows,
+            r->columns
+        );
+        return false;
+    }
+
+    // The factor keeps the upper bandwidth of an analyzed matrix
+    const uint32_t n     = a->rows;
+    uint32_t       upper = (n > 0) ? n - 1 : 0;
+    upper                = (a->state & MATRIX_ANALYZED) ? a->upper : upper;
+
+    if (r->data != a->data && !matrix_copy_elements(context, a, r)) {
+        return false;
+    }
+    matrix_invalidate(r);
+
+    matrix_factor_t factor = {
+        .w     = r->data,
+        .n     = n,
+        .lower = upper,
+        .upper = upper,
+    };
+
+    if (!matrix_cholesky(context, &factor)) {
+        LOG_ERROR("Matrix is not positive definite.\n");
+        return false;
+    }
+
+    // The lower triangle still holds the elements of a
+    for (uint32_t i = 1; i < n; i++) {
+        float* row = r->data + (size_t) i * n;
+        for (uint32_t j = 0; j < i; j++) {
+            row[j] = 0.0f;
+        }
+    }
+
+    return true;
+}
+
+// A plane rotation of columns [first, n) of a row of a Cholesky factor
+// against a work vector
+typedef struct MatrixRotation {
+    float*   row;   // Row of the factor
+    float*   w;     // Work vector
+    uint32_t first; // First column rotated
+    float    c;     // Cosine of the rotation
+    float    s;     // Sine of the rotation
+} matrix_rotation_t;
+
+// Range kernel rotating columns first + [begin, end), row = c * row + s * w
+// and w = c * w - s * row
+static void matrix_rotation_routine(thread_data_t* task) {
+    const matrix_rotation_t* g   = (const matrix_rotation_t*) task->a;
+    float*                   row = g->row + g->first;
+    float*                   w   = g->w + g->first;
+
+    for (uint32_t j = task->begin; j < task->end; j++) {
+        const float t = row[j];
+        const float u = w[j];
+        row[j]        = g->c * t + g->s * u;
+        w[j]          = g->c * u - g->s * t;
+    }
+}
+
+// Apply a rotation to the count columns from g->first on
+static bool matrix_rotate(
+    linear_context_t* context, matrix_rotation_t* g, uint32_t count
+) {
+    thread_data_t task = {
+        .a       = g,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_rotation_routine,
+    };
+
+    return linear_context_parallel_work(context, task, count, count);
+}
+
+// Verify r is a square upper triangular factor with a positive diagonal, and
+// x a NUMERIC_FLOAT32 vector of its order
+static bool matrix_cholesky_factor_is_valid(
+    const matrix_t* r, const vector_t* x
+) {
+    if (NULL == r || NULL == x) {
+        return false;
+    }
+
+    if (!matrix_is_square(r) || NUMERIC_FLOAT32 != x->type
+        || r->rows != x->columns) {
+        LOG_ERROR(
+            "Dimensions do not match. Cannot update a factor of size %ux%u "
+            "with %u elements.\n",
+            r->rows,
+            r->columns,
+            x->columns
+        );
+        return false;
+    }
+
+    for (uint32_t k = 0; k < r->rows; k++) {
+        if (!(r->data[(size_t) k * r->columns + k] > 0.0f)) {
+            LOG_ERROR("Cholesky factor is singular at row %u.\n", k);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool matrix_cholesky_update_ctx(
+    linear_context_t* context, matrix_t* r, const vector_t* x
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context)
+        || !matrix_cholesky_factor_is_valid(r, x)) {
+        return false;
+    }
+
+    const uint32_t n    = r->rows;
+    size_t         mark = linear_context_scratch_mark(context);
+    float*         w    = linear_context_scratch_alloc(
+        context, sizeof(float) * n
+    );
+    if (NULL == w && n > 0) {
+        LOG_ERROR("Failed to allocate memory for the update.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    const float* z = (const float*) x->data;
+    for (uint32_t j = 0; j < n; j++) {
+        w[j] = z[j];
+    }
+
+    // Each rotation zeros the leading element of w against row k of r
+    bool done = true;
+    for (uint32_t k = 0; done && k < n; k++) {
+        float*      row = r->data + (size_t) k * n;
+        const float rho = hypotf(row[k], w[k]);
+
+        matrix_rotation_t g = {
+            .row   = row,
+            .w     = w,
+            .first = k + 1,
+            .c     = row[k] / rho,
+            .s     = w[k] / rho,
+        };
+
+        row[k] = rho;
+        done   = matrix_rotate(context, &g, n - k - 1);
+    }
+
+    matrix_invalidate(r);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool matrix_cholesky_downdate_ctx(
+    linear_context_t* context, matrix_t* r, const vector_t* x
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context)
+        || !matrix_cholesky_factor_is_valid(r, x)) {
+        return false;
+    }
+
+    const uint32_t n    = r->rows;
+    size_t         mark = linear_context_scratch_mark(context);
+    float*         p    = linear_context_scratch_alloc(
+        context, sizeof(float) * n
+    );
+    float*         w    = linear_context_scratch_alloc(
+        context, sizeof(float) * n
+    );
+    if ((NULL == p || NULL == w) && n > 0) {
+        LOG_ERROR("Failed to allocate memory for the downdate.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // Solve r' * p = x by forward substitution, reading r by rows
+    const float* z = (const float*) x->data;
+    for (uint32_t j = 0; j < n; j++) {
+        p[j] = z[j];
+        w[j] = 0.0f;
+    }
+
+    double norm = 0.0;
+    for (uint32_t k = 0; k < n; k++) {
+        const float* row = r->data + (size_t) k * n;
+        p[k]            /= row[k];
+        norm            += (double) p[k] * p[k];
+        for (uint32_t j = k + 1; j < n; j++) {
+            p[j] -= row[j] * p[k];
+        }
+    }
+
+    // a - x * x' = r' * (i - p * p') * r, so ||p|| < 1 exactly when the
+    // downdated matrix stays positive definite
+    if (!(norm < 1.0)) {
+        LOG_ERROR("Downdated matrix is not positive definite.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // Rotate each p[k] into alpha, from the last, carrying the same rotations
+    // from the rows of r into w, which ends up as x
+    float alpha = (float) sqrt(1.0 - norm);
+    bool  done  = true;
+    for (uint32_t k = n; done && k-- > 0;) {
+        const float rho = hypotf(alpha, p[k]);
+
+        matrix_rotation_t g = {
+            .row   = r->data + (size_t) k * n,
+            .w     = w,
+            .first = k,
+            .c     = alpha / rho,
+            .s     = -p[k] / rho,
+        };
+
+        alpha = rho;
+        done  = matrix_rotate(context, &g, n - k);
+    }
+
+    matrix_invalidate(r);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool matrix_inverse_update_ctx(
+    linear_context_t* context,
+    matrix_t*         inverse,
+    const matrix_t*   u,
+    const matrix_t*   v
+) {
+    context = linear_context_resolve(context);
+    if (NULL == inverse || NULL == u || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    v = (NULL == v) ? u : v;
+    if (!matrix_is_square(inverse) || inverse->rows != u->rows
+        || inverse->rows != v->rows || u->columns != v->columns
+        || 0 == u->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot update an inverse of "
+            "size %ux%u by %ux%u and %ux%u.\n",
+            inverse->rows,
+            inverse->columns,
+            u->rows,
+            u->columns,
+            v->rows,
+            v->columns
+        );
+        return false;
+    }
+
+    // b u, v' and v' b, each n x k or k x n
+    const uint32_t k   = u->columns;
+    matrix_t*      bu  = matrix_product_ctx(context, inverse, u);
+    matrix_t*      vt  = matrix_transpose_ctx(context, v);
+    matrix_t*      vtb = matrix_product_ctx(context, vt, inverse);
+    matrix_t*      s   = matrix_create_ctx(context, k, k);
+
+    bool done = NULL != bu && NULL != vtb && NULL != s;
+    for (uint32_t i = 0; done && i < k; i++) {
+        s->data[(size_t) i * k + i] = 1.0f;
+    }
+
+    // The capacitance matrix i + v' b u is singular exactly when a + u v' is
+    done = done && matrix_gemm_ctx(context, 1.0f, vt, bu, 1.0f, s)
+           && matrix_solve_ctx(context, s, vtb, vtb)
+           && matrix_gemm_ctx(context, -1.0f, bu, vtb, 1.0f, inverse);
+
+    matrix_free_ctx(context, s);
+    matrix_free_ctx(context, vtb);
+    matrix_free_ctx(context, vt);
+    matrix_free_ctx(context, bu);
+    return done;
+}
+
+// Least Squares
+
+// Verify the shapes of a regression, x(n x r) fitting b(m x r) against a(m
+// x n), and its ridge penalty
+static bool matrix_lstsq_is_valid(
+    const matrix_t* a, const matrix_t* b, float lambda, const matrix_t* x
+) {
+    if (NULL == a || NULL == b || NULL == x) {
+        LOG_ERROR("Regression operands must not be NULL.\n");
+        return false;
+    }
+
+    if (0 == a->columns || a->rows != b->rows || a->columns != x->rows
+        || b->columns != x->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot fit %ux%u against a "
+            "design of size %ux%u into %ux%u.\n",
+            b->rows,
+            b->columns,
+            a->rows,
+            a->columns,
+            x->rows,
+            x->columns
+        );
+        return false;
+    }
+
+    if (!(lambda >= 0.0f) || isinf(lambda)) {
+        LOG_ERROR("Expected a finite, non-negative ridge, got %f.\n", lambda);
+        return false;
+    }
+
+    return true;
+}
+
+// A Householder reflection, i - tau * v * v', of rows [k, m) of an
+// augmented matrix, shared by the tasks splitting its columns to project
+// them onto v, then its rows to reflect them
+typedef struct MatrixReflector {
+    float*   w;      // m x stride augmented matrix [a | b], reduced in place
+    float*   p;      // tau * v' * w over columns [k + 1, stride)
+    float*   v;      // Householder vector of rows [k, m)
+    float    tau;    // Scale of the reflection
+    uint32_t m;      // Number of rows
+    uint32_t stride; // Number of columns
+    uint32_t k;      // Column eliminated
+} matrix_reflector_t;
+
+// Range kernel projecting columns k + 1 + [begin, end) onto v, reading the
+// rows of w contiguously
+static void matrix_project_routine(thread_data_t* task) {
+    const matrix_reflector_t* h     = (const matrix_reflector_t*) task->a;
+    const uint32_t            first = h->k + 1 + task->begin;
+    const uint32_t            last  = h->k + 1 + task->end;
+
+    for (uint32_t j = first; j < last; j++) {
+        h->p[j] = 0.0f;
+    }
+
+    for (uint32_t i = h->k; i < h->m; i++) {
+        const float* row = h->w + (size_t) i * h->stride;
+        const float  v   = h->v[i - h->k];
+        for (uint32_t j = first; j < last; j++) {
+            h->p[j] += v * row[j];
+        }
+    }
+
+    for (uint32_t j = first; j < last; j++) {
+        h->p[j] *= h->tau;
+    }
+}
+
+// Range kernel reflecting rows k + [begin, end), row -= v[i] * p
+static void matrix_reflect_routine(thread_data_t* task) {
+    const matrix_reflector_t* h = (const matrix_reflector_t*) task->a;
+
+    for (uint32_t t = task->begin; t < task->end; t++) {
+        float*      row = h->w + (size_t) (h->k + t) * h->stride;
+        const float v   = h->v[t];
+        for (uint32_t j = h->k + 1; j < h->stride; j++) {
+            row[j] -= v * h->p[j];
+        }
+    }
+}
+
+// Reduce column k of the augmented matrix to r[k][k] with a reflection of
+// the rows below it, returning false if the column is already zero
+static bool matrix_householder(
+    linear_context_t* context, matrix_reflector_t* h
+) {
+    const uint32_t k     = h->k;
+    float*         pivot = h->w + (size_t) k * h->stride + k;
+
+    double norm = 0.0;
+    for (uint32_t i = k; i < h->m; i++) {
+        const double e  = h->w[(size_t) i * h->stride + k];
+        norm           += e * e;
+        h->v[i - k]     = (float) e;
+    }
+
+    if (!(norm > 0.0)) {
+        LOG_ERROR("Design matrix is rank deficient at column %u.\n", k);
+        return false;
+    }
+
+    // Reflect onto the axis away from x0 so that v0 does not cancel
+    const double x0    = *pivot;
+    const double alpha = (x0 < 0.0) ? sqrt(norm) : -sqrt(norm);
+    h->v[0]            = (float) (x0 - alpha);
+    h->tau             = (float) (1.0 / (norm - x0 * alpha));
+    *pivot             = (float) alpha;
+
+    uint32_t      columns = h->stride - k - 1;
+    uint32_t      rows    = h->m - k;
+    uint64_t      work    = (uint64_t) rows * columns;
+    thread_data_t task    = {
+        .a       = h,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_project_routine,
+    };
+
+    if (!linear_context_parallel_work(context, task, columns, work)) {
+        return false;
+    }
+
+    task.routine = matrix_reflect_routine;
+    return linear_context_parallel_work(context, task, rows, work);
+}
+
+bool matrix_lstsq_qr_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             lambda,
+    matrix_t*         x
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context)
+        || !matrix_lstsq_is_valid(a, b, lambda, x)) {
+        return false;
+    }
+
+    // A ridge appends n rows, so it also regularizes wide designs
+    const uint32_t n = a->columns;
+    const uint32_t r = b->columns;
+    const uint32_t m = a->rows + ((lambda > 0.0f) ? n : 0);
+    if (m < n) {
+        LOG_ERROR("Cannot fit %u coefficients to %u rows.\n", n, m);
+        return false;
+    }
+
+    size_t   mark   = linear_context_scratch_mark(context);
+    uint32_t stride = n + r;
+    float*   w      = linear_context_scratch_alloc(
+        context, sizeof(float) * m * stride
+    );
+    float*   p      = linear_context_scratch_alloc(
+        context, sizeof(float) * stride
+    );
+    float*   v      = linear_context_scratch_alloc(context, sizeof(float) * m);
+    float*   upper  = linear_context_scratch_alloc(
+        context, sizeof(float) * n * n
+    );
+
+    matrix_reflector_t h = {
+        .w      = w,
+        .p      = p,
+        .v      = v,
+        .m      = m,
+        .stride = stride,
+    };
+    if (NULL == w || NULL == p || NULL == v || NULL == upper) {
+        LOG_ERROR("Failed to allocate memory for the factorization.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // [a | b] over [sqrt(lambda) * i | 0]
+    for (uint32_t i = 0; i < m; i++) {
+        float* row = h.w + (size_t) i * stride;
+        if (i < a->rows) {
+            memcpy(row, a->data + (size_t) i * n, sizeof(float) * n);
+            memcpy(row + n, b->data + (size_t) i * r, sizeof(float) * r);
+            continue;
+        }
+        for (uint32_t j = 0; j < stride; j++) {
+            row[j] = 0.0f;
+        }
+        row[i - a->rows] = sqrtf(lambda);
+    }
+
+    bool done = true;
+    for (uint32_t k = 0; done && k < n; k++) {
+        h.k  = k;
+        done = matrix_householder(context, &h);
+    }
+
+    // r * x = q' * b over the first n rows
+    for (uint32_t i = 0; done && i < n; i++) {
+        const float* row = h.w + (size_t) i * stride;
+        memcpy(upper + (size_t) i * n, row, sizeof(float) * n);
+        memcpy(x->data + (size_t) i * r, row + n, sizeof(float) * r);
+    }
+
+    matrix_factor_t factor = {
+        .w     = upper,
+        .x     = x->data,
+        .n     = n,
+        .r     = r,
+        .upper = n - 1,
+    };
+
+    done = done
+           && matrix_substitute(
+               context, &factor, matrix_backward_routine, factor.upper
+           );
+
+    matrix_invalidate(x);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+// Overwrite g with the upper Cholesky factor of a' * a + lambda * i, given
+// the transpose at of a
+static bool matrix_normal_factor(
+    linear_context_t* context,
+    const matrix_t*   at,
+    const matrix_t*   a,
+    float             lambda,
+    matrix_t*         g
+) {
+    if (!matrix_gemm_ctx(context, 1.0f, at, a, 0.0f, g)) {
+        return false;
+    }
+
+    const uint32_t n = g->rows;
+    for (uint32_t i = 0; i < n; i++) {
+        g->data[(size_t) i * n + i] += lambda;
+    }
+
+    matrix_factor_t factor = {
+        .w     = g->data,
+        .n     = n,
+        .lower = n - 1,
+        .upper = n - 1,
+    };
+
+    if (!matrix_cholesky(context, &factor)) {
+        LOG_ERROR("Normal equations are not positive definite.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Solve r' * r * x = at * b given the upper factor r of the normal equations
+static bool matrix_normal_solve(
+    linear_context_t* context,
+    const matrix_t*   at,
+    const matrix_t*   r,
+    const matrix_t*   b,
+    matrix_t*         x
+) {
+    if (x->data == b->data) {
+        LOG_ERROR("The coefficients must not overlap the targets.\n");
+        return false;
+    }
+
+    if (!matrix_gemm_ctx(context, 1.0f, at, b, 0.0f, x)) {
+        return false;
+    }
+
+    matrix_factor_t factor = {
+        .w     = r->data,
+        .x     = x->data,
+        .n     = r->rows,
+        .r     = x->columns,
+        .lower = r->rows - 1,
+        .upper = r->rows - 1,
+    };
+
+    thread_routine_t forward = matrix_forward_transposed_routine;
+    return matrix_substitute(context, &factor, forward, factor.upper)
+           && matrix_substitute(
+               context, &factor, matrix_backward_routine, factor.upper
+           );
+}
+
+bool matrix_lstsq_normal_ctx(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             lambda,
+    matrix_t*         x
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context)
+        || !matrix_lstsq_is_valid(a, b, lambda, x)) {
+        return false;
+    }
+
+    matrix_t* at = matrix_transpose_ctx(context, a);
+    matrix_t* g  = matrix_create_ctx(context, a->columns, a->columns);
+
+    bool done = NULL != at && NULL != g
+                && matrix_normal_factor(context, at, a, lambda, g)
+                && matrix_normal_solve(context, at, g, b, x);
+
+    matrix_free_ctx(context, g);
+    matrix_free_ctx(context, at);
+    return done;
+}
+
+// Operands of a batch of regressions against a shared factored design
+typedef struct MatrixLstsqBatch {
+    linear_context_t*      context;
+    const matrix_t*        at;
+    const matrix_t*        r;
+    const matrix_t* const* b;
+    matrix_t* const*       x;
+    atomic_uint            failures;
+} matrix_lstsq_batch_t;
+
+// Range kernel solving items [begin, end), each GEMM and substitution
+// nested in parallel
+static void matrix_lstsq_batch_routine(thread_data_t* task) {
+    matrix_lstsq_batch_t* batch = (matrix_lstsq_batch_t*) task->a;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        if (!matrix_normal_solve(
+                batch->context, batch->at, batch->r, batch->b[i], batch->x[i]
+            )) {
+            atomic_fetch_add(&batch->failures, 1);
+        }
+    }
+}
+
+bool matrix_lstsq_batched_ctx(
+    linear_context_t*      context,
+    const matrix_t*        a,
+    float                  lambda,
+    uint32_t               count,
+    const matrix_t* const* b,
+    matrix_t* const*       x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NULL == b || NULL == x) {
+        LOG_ERROR("Regression batch operands must not be NULL.\n");
+        return false;
+    }
+
+    // Reject the batch up front rather than leave it partially solved
+    uint64_t work = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!matrix_lstsq_is_valid(a, b[i], lambda, x[i])) {
+            LOG_ERROR("Invalid regression at batch index %u.\n", i);
+            return false;
+        }
+        uint64_t size  = (uint64_t) a->rows + a->columns;
+        work          += size * a->columns * x[i]->columns;
+    }
+
+    matrix_t* at = matrix_transpose_ctx(context, a);
+    matrix_t* g  = matrix_create_ctx(context, a->columns, a->columns);
+    if (NULL == at || NULL == g
+        || !matrix_normal_factor(context, at, a, lambda, g)) {
+        matrix_free_ctx(context, g);
+        matrix_free_ctx(context, at);
+        return false;
+    }
+
+    matrix_lstsq_batch_t batch = {
+        .context = context,
+        .at      = at,
+        .r       = g,
+        .b       = b,
+        .x       = x,
+    };
+    atomic_init(&batch.failures, 0);
+
+    thread_data_t task = {
+        .a       = &batch,
+        .type    = NUMERIC_FLOAT32,
+        .routine = matrix_lstsq_batch_routine,
+    };
+
+    bool done = linear_context_parallel_work(context, task, count, work)
+                && 0 == atomic_load(&batch.failures);
+
+    matrix_free_ctx(context, g);
+    matrix_free_ctx(context, at);
+    return done;
+}
+
+// Asynchronous Operations
+
+// Operands of an asynchronous matrix op
+typedef struct MatrixAsync {
+    const matrix_t* a;
+    const matrix_t* b;
+    const vector_t* query;
+    matrix_t*       c;
+    float           alpha;
+    float           beta;
+} matrix_async_t;
+
+static bool matrix_gemm_async_routine(linear_async_t* op) {
+    const matrix_async_t* arguments = (const matrix_async_t*) op->arguments;
+    return matrix_gemm_ctx(
+        op->context,
+        arguments->alpha,
+        arguments->a,
+        arguments->b,
+        arguments->beta,
+        arguments->c
+    );
+}
+
+static bool matrix_product_async_routine(linear_async_t* op) {
+    const matrix_async_t* arguments = (const matrix_async_t*) op->arguments;
+    op->result = matrix_product_ctx(op->context, arguments->a, arguments->b);
+    return NULL != op->result;
+}
+
+static bool matrix_row_distance_async_routine(linear_async_t* op) {
+    const matrix_async_t* arguments = (const matrix_async_t*) op->arguments;
+    op->result = matrix_row_distance_ctx(
+        op->context, arguments->a, arguments->query
+    );
+    return NULL != op->result;
+}
+
+linear_async_t* matrix_gemm_async(
+    linear_context_t*             context,
+    float                         alpha,
+    const matrix_t*               a,
+    const matrix_t*               b,
+    float                         beta,
+    matrix_t*                     c,
+    const linear_async_options_t* options
+) {
+    matrix_async_t arguments = {
+        .a     = a,
+        .b     = b,
+        .c     = c,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+    return linear_async_submit(
+        context,
+        matrix_gemm_async_routine,
+        &arguments,
+        sizeof(arguments),
+        options
+    );
+}
+
+linear_async_t* matrix_product_async(
+    linear_context_t*             context,
+    const matrix_t*               a,
+    const matrix_t*               b,
+    const linear_async_options_t* options
+) {
+    matrix_async_t arguments = {.a = a, .b = b};
+    return linear_async_submit(
+        context,
+        matrix_product_async_routine,
+        &arguments,
+        sizeof(arguments),
+        options
+    );
+}
+
+linear_async_t* matrix_row_distance_async(
+    linear_context_t*             context,
+    const matrix_t*               matrix,
+    const vector_t*               query,
+    const linear_async_options_t* options
+) {
+    matrix_async_t arguments = {.a = matrix, .query = query};
+    return linear_async_submit(
+        context,
+        matrix_row_distance_async_routine,
+        &arguments,
+        sizeof(arguments),
+        options
+    );
+}
@@ -21,6 +21,17 @@
 #include <stdint.h>
 #include <stdio.h>
 
+size_t numeric_data_size(numeric_data_t type) {
+    switch (type) {
+        case NUMERIC_FLOAT32:
+            return sizeof(float);
+        case NUMERIC_INT32:
+            return sizeof(int32_t);
+        default:
+            return 0;
+    }
+}
+
 int32_t numeric_encode_float32(float value) {
     numeric_union_t data;
     data.value = value;
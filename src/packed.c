@@ -0,0 +1,606 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/packed.c
+ *
+ * @brief Packed storage for symmetric and triangular matrices
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "packed.h"
+#include "logger.h"
+
+#include <math.h>
+
+// Stored elements of row i, such that row[j] is the element (i, j) of every
+// stored column j, i.e. j <= i of a lower triangle and j >= i of an upper one
+static inline float* packed_row(const packed_t* packed, uint32_t i) {
+    size_t row = i;
+    if (PACKED_UPPER == packed->kind) {
+        return packed->data + row * packed->order - row * (row + 1) / 2;
+    }
+    return packed->data + row * (row + 1) / 2;
+}
+
+// Columns [*first, *last) of row i stored by the packed matrix
+static inline void packed_span(
+    const packed_t* packed, uint32_t i, uint32_t* first, uint32_t* last
+) {
+    *first = (PACKED_UPPER == packed->kind) ? i : 0;
+    *last  = (PACKED_UPPER == packed->kind) ? packed->order : i + 1;
+}
+
+// Lifecycle management
+
+packed_t* packed_create_ctx(
+    linear_context_t* context, uint32_t order, packed_kind_t kind
+) {
+    context = linear_context_resolve(context);
+
+    if (kind >= PACKED_COUNT) {
+        LOG_ERROR("Invalid packed kind %d.\n", kind);
+        return NULL;
+    }
+
+    packed_t* packed = linear_context_allocate(context, sizeof(packed_t));
+    if (NULL == packed) {
+        LOG_ERROR("Failed to allocate memory for packed_t.\n");
+        return NULL;
+    }
+
+    // At least one element, so an empty matrix still holds valid data
+    size_t elements = (size_t) order * (order + 1) / 2;
+    size_t size     = ((elements) ? elements : 1) * sizeof(float);
+    packed->data    = linear_context_allocate(context, size);
+    if (NULL == packed->data) {
+        LOG_ERROR("Failed to allocate memory for packed elements.\n");
+        linear_context_release(context, packed);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < elements; i++) {
+        packed->data[i] = 0.0f;
+    }
+
+    packed->order = order;
+    packed->kind  = kind;
+
+    return packed;
+}
+
+void packed_free_ctx(linear_context_t* context, packed_t* packed) {
+    if (NULL == packed) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, packed->data);
+    linear_context_release(context, packed);
+}
+
+// Element Access
+
+size_t packed_element_count(const packed_t* packed) {
+    return (size_t) packed->order * (packed->order + 1) / 2;
+}
+
+// Resolve (row, column) to its stored element, or NULL outside the triangle
+static float* packed_element(
+    const packed_t* packed, uint32_t row, uint32_t column
+) {
+    if (PACKED_SYMMETRIC == packed->kind && column > row) {
+        uint32_t swap = row;
+        row           = column;
+        column        = swap;
+    }
+
+    uint32_t first, last;
+    packed_span(packed, row, &first, &last);
+    if (column < first || column >= last) {
+        return NULL;
+    }
+
+    return packed_row(packed, row) + column;
+}
+
+float packed_element_get(
+    const packed_t* packed, uint32_t row, uint32_t column
+) {
+    if (row >= packed->order || column >= packed->order) {
+        LOG_ERROR("Index out of bounds.\n");
+        return NAN;
+    }
+
+    const float* element = packed_element(packed, row, column);
+    return (element) ? *element : 0.0f;
+}
+
+bool packed_element_set(
+    packed_t* packed, uint32_t row, uint32_t column, float value
+) {
+    if (row >= packed->order || column >= packed->order) {
+        LOG_ERROR("Index out of bounds.\n");
+        return false;
+    }
+
+    float* element = packed_element(packed, row, column);
+    if (NULL == element) {
+        LOG_ERROR(
+            "Element (%u, %u) is outside the stored triangle.\n", row, column
+        );
+        return false;
+    }
+
+    *element = value;
+    return true;
+}
+
+// Parallel Execution
+
+// Operands of a packed op, shared by the tasks splitting it
+typedef struct PackedOp {
+    packed_t*    a;        // The packed matrix
+    const float* x;        // Vector, or rows of a matrix, read by the op
+    float*       y;        // Vector, or rows of a matrix, written by the op
+    float*       partials; // One vector of order elements per task, or NULL
+    uint32_t     columns;  // Columns of the dense matrices, if any
+    uint32_t     tasks;    // Number of partial vectors
+    float        alpha;
+    float        beta;
+} packed_op_t;
+
+// Split the rows of a packed matrix into tasks storing about as many elements
+// each, rows of a lower triangle growing and rows of an upper one shrinking.
+// The tasks are held by scratch memory, see linear_context_split_scratch().
+static thread_data_t* packed_split(
+    linear_context_t* context,
+    const packed_t*   packed,
+    thread_data_t     task,
+    uint64_t          work,
+    uint32_t*         task_count
+) {
+    work       = (work > UINT32_MAX) ? UINT32_MAX : work;
+    uint32_t n = linear_context_task_count(context, (uint32_t) work);
+    n          = (n > packed->order && packed->order > 0) ? packed->order : n;
+
+    thread_data_t* tasks = linear_context_scratch_alloc(
+        context, sizeof(thread_data_t) * n
+    );
+    if (NULL == tasks) {
+        LOG_ERROR("Failed to allocate memory for %u tasks.\n", n);
+        return NULL;
+    }
+
+    // The first r rows of a lower triangle hold about r * r / 2 elements, so
+    // equal shares end at order * sqrt(t / n), mirrored for upper triangles
+    double order = (double) packed->order;
+    for (uint32_t t = 0; t < n; t++) {
+        double begin = order * sqrt((double) t / n);
+        double end   = order * sqrt((double) (t + 1) / n);
+        if (PACKED_UPPER == packed->kind) {
+            begin = order - order * sqrt((double) (n - t) / n);
+            end   = order - order * sqrt((double) (n - t - 1) / n);
+        }
+
+        tasks[t]       = task;
+        tasks[t].begin = (uint32_t) lround(begin);
+        tasks[t].end   = (t + 1 == n) ? packed->order : (uint32_t) lround(end);
+    }
+
+    *task_count = n;
+    return tasks;
+}
+
+// Run a row kernel over every row of a packed matrix, costing width per
+// stored element
+static bool packed_run(
+    linear_context_t* context,
+    packed_op_t*      op,
+    thread_routine_t  routine,
+    uint64_t          width
+) {
+    thread_data_t task = {
+        .a       = op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    size_t         mark  = linear_context_scratch_mark(context);
+    uint32_t       count = 0;
+    uint64_t       work  = packed_element_count(op->a) * width;
+    thread_data_t* tasks = packed_split(context, op->a, task, work, &count);
+    if (NULL == tasks) {
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    linear_context_run(context, tasks, count);
+    linear_context_scratch_release(context, mark);
+    return true;
+}
+
+// Conversion
+
+// Row kernel copying the stored triangle of rows [begin, end) of x into a
+static void packed_pack_routine(thread_data_t* task) {
+    const packed_op_t* op = (const packed_op_t*) task->a;
+    const uint32_t     n  = op->a->order;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* x   = op->x + (size_t) i * n;
+        float*       row = packed_row(op->a, i);
+        uint32_t     first, last;
+        packed_span(op->a, i, &first, &last);
+        for (uint32_t j = first; j < last; j++) {
+            row[j] = x[j];
+        }
+    }
+}
+
+// Row kernel expanding rows [begin, end) of a into the zeroed y, writing the
+// mirrored column of each row of a symmetric matrix
+static void packed_unpack_routine(thread_data_t* task) {
+    const packed_op_t* op        = (const packed_op_t*) task->a;
+    const uint32_t     n         = op->a->order;
+    const bool         symmetric = PACKED_SYMMETRIC == op->a->kind;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = packed_row(op->a, i);
+        float*       y   = op->y + (size_t) i * n;
+        uint32_t     first, last;
+        packed_span(op->a, i, &first, &last);
+
+        for (uint32_t j = first; j < last; j++) {
+            y[j] = row[j];
+        }
+
+        // Row i below the diagonal is column i above it
+        for (uint32_t j = 0; symmetric && j < i; j++) {
+            op->y[(size_t) j * n + i] = row[j];
+        }
+    }
+}
+
+packed_t* packed_from_matrix_ctx(
+    linear_context_t* context, const matrix_t* matrix, packed_kind_t kind
+) {
+    context = linear_context_resolve(context);
+    if (NULL == matrix || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (!matrix_is_square(matrix)) {
+        LOG_ERROR(
+            "Cannot pack a non-square matrix of size %ux%u.\n",
+            matrix->rows,
+            matrix->columns
+        );
+        return NULL;
+    }
+
+    packed_t* packed = packed_create_ctx(context, matrix->rows, kind);
+    if (NULL == packed) {
+        return NULL; // Error is logged by default
+    }
+
+    packed_op_t op = {
+        .a = packed,
+        .x = matrix->data,
+    };
+
+    if (!packed_run(context, &op, packed_pack_routine, 1)) {
+        packed_free_ctx(context, packed);
+        return NULL;
+    }
+
+    return packed;
+}
+
+matrix_t*
+packed_to_matrix_ctx(linear_context_t* context, const packed_t* packed) {
+    context = linear_context_resolve(context);
+    if (NULL == packed || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    uint32_t  n      = packed->order;
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    packed_op_t op = {
+        .a = (packed_t*) packed,
+        .y = matrix->data,
+    };
+
+    // Symmetric rows also write their mirrored column
+    uint64_t width = (PACKED_SYMMETRIC == packed->kind) ? 2 : 1;
+    if (!packed_run(context, &op, packed_unpack_routine, width)) {
+        matrix_free_ctx(context, matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
+
+// Products
+
+// Verify a NUMERIC_FLOAT32 vector holds count elements
+static bool packed_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// Verify the kind of a packed operand
+static bool packed_kind_is_valid(const packed_t* packed, bool symmetric) {
+    if (NULL == packed) {
+        return false;
+    }
+
+    if (symmetric != (PACKED_SYMMETRIC == packed->kind)) {
+        LOG_ERROR(
+            "Expected a %s packed matrix.\n",
+            (symmetric) ? "symmetric" : "triangular"
+        );
+        return false;
+    }
+
+    return true;
+}
+
+// Row kernel accumulating the products of rows [begin, end) of a symmetric a
+// with x into the partial vector pointed to by result
+static void packed_symv_routine(thread_data_t* task) {
+    const packed_op_t* op      = (const packed_op_t*) task->a;
+    float*             partial = (float*) task->result;
+
+    for (uint32_t j = 0; j < op->a->order; j++) {
+        partial[j] = 0.0f;
+    }
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = packed_row(op->a, i);
+        const float  xi  = op->x[i];
+
+        // Row i below the diagonal also stands for column i above it
+        for (uint32_t j = 0; j < i; j++) {
+            partial[j] += row[j] * xi;
+        }
+
+        float sum = row[i] * xi;
+        for (uint32_t j = 0; j < i; j++) {
+            sum += row[j] * op->x[j];
+        }
+        partial[i] += sum;
+    }
+}
+
+// Range kernel reducing elements [begin, end) of the partial vectors into y
+static void packed_reduce_routine(thread_data_t* task) {
+    const packed_op_t* op = (const packed_op_t*) task->a;
+    const uint32_t     n  = op->a->order;
+
+    // beta == 0 overwrites, so uninitialized NaNs do not propagate
+    for (uint32_t j = task->begin; j < task->end; j++) {
+        op->y[j] = (0.0f == op->beta) ? 0.0f : op->beta * op->y[j];
+    }
+
+    for (uint32_t t = 0; t < op->tasks; t++) {
+        const float* partial = op->partials + (size_t) t * n;
+        for (uint32_t j = task->begin; j < task->end; j++) {
+            op->y[j] += op->alpha * partial[j];
+        }
+    }
+}
+
+bool packed_symv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const packed_t*   a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context) || !packed_kind_is_valid(a, true)
+        || !packed_vector_is_valid(x, a->order)
+        || !packed_vector_is_valid(y, a->order)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("SYMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    packed_op_t op = {
+        .a     = (packed_t*) a,
+        .x     = (const float*) x->data,
+        .y     = (float*) y->data,
+        .alpha = alpha,
+        .beta  = beta,
+    };
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = packed_symv_routine,
+    };
+
+    // Each task accumulates into a vector of its own, as mirrored columns of
+    // different tasks overlap
+    size_t         mark  = linear_context_scratch_mark(context);
+    uint64_t       work  = 2 * packed_element_count(a);
+    thread_data_t* tasks = packed_split(context, a, task, work, &op.tasks);
+    if (tasks) {
+        size_t size = sizeof(float) * op.tasks * a->order;
+        op.partials = linear_context_scratch_alloc(context, size);
+    }
+    if (NULL == tasks || NULL == op.partials) {
+        LOG_ERROR("Failed to allocate memory for the partial vectors.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    for (uint32_t t = 0; t < op.tasks; t++) {
+        tasks[t].result = op.partials + (size_t) t * a->order;
+    }
+    linear_context_run(context, tasks, op.tasks);
+
+    task.routine = packed_reduce_routine;
+    work         = (uint64_t) op.tasks * a->order;
+    bool reduced = linear_context_parallel_work(context, task, a->order, work);
+
+    linear_context_scratch_release(context, mark);
+    return reduced;
+}
+
+// Range kernel computing columns [begin, end) of c = alpha * a * b + beta * c
+// for a symmetric a, streaming the packed triangle once
+static void packed_symm_routine(thread_data_t* task) {
+    const packed_op_t* op = (const packed_op_t*) task->a;
+    const uint32_t     m  = op->columns;
+
+    for (uint32_t i = 0; i < op->a->order; i++) {
+        float* z = op->y + (size_t) i * m;
+        for (uint32_t k = task->begin; k < task->end; k++) {
+            z[k] = (0.0f == op->beta) ? 0.0f : op->beta * z[k];
+        }
+    }
+
+    for (uint32_t i = 0; i < op->a->order; i++) {
+        const float* row = packed_row(op->a, i);
+        const float* xi  = op->x + (size_t) i * m;
+        float*       zi  = op->y + (size_t) i * m;
+
+        // Element (i, j) below the diagonal is also (j, i) above it
+        for (uint32_t j = 0; j < i; j++) {
+            const float  scale = op->alpha * row[j];
+            const float* xj    = op->x + (size_t) j * m;
+            float*       zj    = op->y + (size_t) j * m;
+            for (uint32_t k = task->begin; k < task->end; k++) {
+                zi[k] += scale * xj[k];
+                zj[k] += scale * xi[k];
+            }
+        }
+
+        const float scale = op->alpha * row[i];
+        for (uint32_t k = task->begin; k < task->end; k++) {
+            zi[k] += scale * xi[k];
+        }
+    }
+}
+
+bool packed_symm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const packed_t*   a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == b || NULL == c || !linear_context_is_cpu(context)
+        || !packed_kind_is_valid(a, true)) {
+        return false;
+    }
+
+    if (a->order != b->rows || b->rows != c->rows
+        || b->columns != c->columns) {
+        LOG_ERROR(
+            "Dimensions do not match. Cannot multiply a packed matrix of "
+            "order %u by %ux%u into %ux%u.\n",
+            a->order,
+            b->rows,
+            b->columns,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    if (b->data == c->data) {
+        LOG_ERROR("SYMM input and output matrices must not overlap.\n");
+        return false;
+    }
+
+    packed_op_t op = {
+        .a       = (packed_t*) a,
+        .x       = b->data,
+        .y       = c->data,
+        .columns = b->columns,
+        .alpha   = alpha,
+        .beta    = beta,
+    };
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = packed_symm_routine,
+    };
+
+    matrix_invalidate(c);
+
+    // Each column costs two multiply-adds per stored element
+    uint64_t work = 2 * packed_element_count(a) * b->columns;
+    return linear_context_parallel_work(context, task, b->columns, work);
+}
+
+// Row kernel computing elements [begin, end) of y = a * x for a triangular a
+static void packed_trmv_routine(thread_data_t* task) {
+    const packed_op_t* op = (const packed_op_t*) task->a;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        const float* row = packed_row(op->a, i);
+        uint32_t     first, last;
+        packed_span(op->a, i, &first, &last);
+
+        float sum = 0.0f;
+        for (uint32_t j = first; j < last; j++) {
+            sum += row[j] * op->x[j];
+        }
+        op->y[i] = sum;
+    }
+}
+
+bool packed_trmv_ctx(
+    linear_context_t* context,
+    const packed_t*   a,
+    const vector_t*   x,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (!linear_context_is_cpu(context) || !packed_kind_is_valid(a, false)
+        || !packed_vector_is_valid(x, a->order)
+        || !packed_vector_is_valid(y, a->order)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("TRMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    packed_op_t op = {
+        .a = (packed_t*) a,
+        .x = (const float*) x->data,
+        .y = (float*) y->data,
+    };
+
+    return packed_run(context, &op, packed_trmv_routine, 1);
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/tensor.c
+ *
+ * @brief A simple and easy to use Tensor API
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "tensor.h"
+#include "logger.h"
+
+#include <stdint.h>
+
+// Non-finite detection and sanitization
+
+// View the elements of a tensor as a flat vector, sharing its data
+static bool tensor_flat_view(const tensor_t* tensor, vector_t* view) {
+    if (NULL == tensor || NULL == tensor->data) {
+        return false;
+    }
+
+    size_t elements = tensor->rows * tensor->columns * tensor->layers;
+    if (elements > UINT32_MAX) {
+        LOG_ERROR("Tensor of %zu elements is too large to scan.\n", elements);
+        return false;
+    }
+
+    view->data    = tensor->data;
+    view->columns = (uint32_t) elements;
+    view->type    = NUMERIC_FLOAT32;
+    return true;
+}
+
+bool tensor_all_finite_ctx(linear_context_t* context, const tensor_t* tensor) {
+    vector_t view;
+    if (!tensor_flat_view(tensor, &view)) {
+        return false;
+    }
+    return vector_all_finite_ctx(context, &view);
+}
+
+uint32_t
+tensor_count_nonfinite_ctx(linear_context_t* context, const tensor_t* tensor) {
+    vector_t view;
+    if (!tensor_flat_view(tensor, &view)) {
+        return 0;
+    }
+    return vector_count_nonfinite_ctx(context, &view);
+}
+
+bool tensor_nan_to_num_ctx(
+    linear_context_t* context,
+    tensor_t*         tensor,
+    float             nan,
+    float             posinf,
+    float             neginf
+) {
+    vector_t view;
+    if (!tensor_flat_view(tensor, &view)) {
+        return false;
+    }
+    return vector_nan_to_num_ctx(context, &view, nan, posinf, neginf);
+}
+
+bool tensor_ingest_ctx(linear_context_t* context, tensor_t* tensor) {
+    vector_t view;
+    if (!tensor_flat_view(tensor, &view)) {
+        return false;
+    }
+    return vector_ingest_ctx(context, &view);
+}
@@ -12,55 +12,1002 @@
  * Only pure C is used with minimal dependencies on external libraries.
  */
 
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE // sched_getaffinity() and CPU_COUNT()
+#endif // _GNU_SOURCE
+
 #include "thread.h"
 #include "logger.h"
 
-#include <fcntl.h>
-#include <mqueue.h>
-#include <stdlib.h>
-#include <sys/stat.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Worker thread function
+void* worker_thread(void* arg);
+
+// Pool served by the calling thread, NULL unless it is a worker
+static _Thread_local const thread_pool_t* thread_worker_pool = NULL;
+
+// Index of the calling worker within its pool
+static _Thread_local uint32_t thread_worker_index = 0;
+
+// Region led by the calling thread, linked to the regions enclosing it
+typedef struct ThreadRegionFrame {
+    const thread_pool_t*            pool;  // Pool providing the team
+    const thread_team_t*            team;  // Team executing the region
+    const struct ThreadRegionFrame* outer; // Enclosing region, or NULL
+} thread_region_frame_t;
+
+// Innermost region the calling thread leads as member 0, NULL if none
+static _Thread_local const thread_region_frame_t* thread_region_frames = NULL;
+
+// Thread count detection
+
+// Cached default thread count, 0 until first resolved
+static atomic_uint linear_thread_count_cache = 0;
+
+uint32_t linear_thread_affinity_count(void) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (0 == sched_getaffinity(0, sizeof(cpu_set_t), &set)) {
+        int count = CPU_COUNT(&set);
+        if (count > 0) {
+            return (uint32_t) count;
+        }
+    }
+#endif // __linux__
+
+#ifdef _SC_NPROCESSORS_ONLN
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0) {
+        return (uint32_t) online;
+    }
+#endif // _SC_NPROCESSORS_ONLN
+
+    return LINEAR_THREAD_COUNT_FALLBACK;
+}
+
+// Read a cgroup v2 "cpu.max" file, e.g. "max 100000" or "400000 100000"
+static uint32_t linear_thread_quota_v2(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (NULL == file) {
+        return 0;
+    }
+
+    char      quota[32] = {0};
+    long long period    = 0;
+    int       matched   = fscanf(file, "%31s %lld", quota, &period);
+    fclose(file);
+
+    if (2 != matched || 0 == strcmp(quota, "max") || period <= 0) {
+        return 0; // unlimited or unreadable
+    }
+
+    long long limit = strtoll(quota, NULL, 10);
+    if (limit <= 0) {
+        return 0;
+    }
+
+    return (uint32_t) ((limit + period - 1) / period); // round up
+}
+
+// Smallest cgroup v2 quota from the given cgroup, e.g. "/user.slice/a",
+// up to the root of the hierarchy, since the quota of a parent caps every
+// descendant, e.g. a systemd slice or a Kubernetes pod around a container
+static uint32_t linear_thread_quota_tree(const char* cgroup) {
+    const char* root     = "/sys/fs/cgroup";
+    size_t      length   = strlen(root);
+    uint32_t    smallest = 0;
+    char        directory[512];
+    char        path[576];
+
+    snprintf(directory, sizeof(directory), "%s%s", root, cgroup);
+    for (size_t end = strlen(directory); end > length; end--) {
+        if ('/' != directory[end - 1]) {
+            break;
+        }
+        directory[end - 1] = '\0'; // e.g. the root cgroup "/"
+    }
+
+    for (;;) {
+        snprintf(path, sizeof(path), "%s/cpu.max", directory);
+        uint32_t quota = linear_thread_quota_v2(path);
+        if (quota > 0 && (0 == smallest || quota < smallest)) {
+            smallest = quota;
+        }
+
+        // Ascend to the parent, stopping once the root was read
+        char* slash = strrchr(directory, '/');
+        if (NULL == slash || (size_t) (slash - directory) < length) {
+            return smallest;
+        }
+        *slash = '\0';
+    }
+}
+
+// Read a cgroup v1 "cpu.cfs_quota_us" and "cpu.cfs_period_us" pair
+static uint32_t linear_thread_quota_v1(const char* directory) {
+    char      path[512];
+    long long quota  = -1;
+    long long period = 0;
+
+    snprintf(path, sizeof(path), "%s/cpu.cfs_quota_us", directory);
+    FILE* file = fopen(path, "r");
+    if (NULL == file) {
+        return 0;
+    }
+    int matched = fscanf(file, "%lld", &quota);
+    fclose(file);
+    if (1 != matched || quota <= 0) {
+        return 0; // -1 means unlimited
+    }
+
+    snprintf(path, sizeof(path), "%s/cpu.cfs_period_us", directory);
+    file = fopen(path, "r");
+    if (NULL == file) {
+        return 0;
+    }
+    matched = fscanf(file, "%lld", &period);
+    fclose(file);
+    if (1 != matched || period <= 0) {
+        return 0;
+    }
+
+    return (uint32_t) ((quota + period - 1) / period); // round up
+}
+
+uint32_t linear_thread_quota_count(void) {
+#ifdef __linux__
+    char line[256];
+
+    // Resolve the cgroup v2 path of this process, e.g. "0::/user.slice"
+    FILE* file = fopen("/proc/self/cgroup", "r");
+    if (NULL != file) {
+        while (fgets(line, sizeof(line), file)) {
+            if (0 != strncmp(line, "0::", 3)) {
+                continue;
+            }
+            line[strcspn(line, "\n")] = '\0';
+            fclose(file);
+
+            // Namespaced containers see their own cgroup at the mount root,
+            // which the walk reaches last
+            return linear_thread_quota_tree(line + 3);
+        }
+        fclose(file);
+    }
+
+    uint32_t quota = linear_thread_quota_tree("");
+    if (quota > 0) {
+        return quota;
+    }
+
+    quota = linear_thread_quota_v1("/sys/fs/cgroup/cpu,cpuacct");
+    if (quota > 0) {
+        return quota;
+    }
+
+    return linear_thread_quota_v1("/sys/fs/cgroup/cpu");
+#else
+    return 0;
+#endif // __linux__
+}
+
+uint32_t linear_thread_count_refresh(void) {
+    uint32_t count = 0;
+
+    const char* env = getenv(LINEAR_THREAD_COUNT_ENV);
+    if (NULL != env && '\0' != *env) {
+        // Digits only, strtoull() would accept signs and wrap negatives
+        char*              end      = NULL;
+        unsigned long long override = 0;
+        errno                       = 0;
+        if (isdigit((unsigned char) *env)) {
+            override = strtoull(env, &end, 10);
+        }
+        if (NULL != end && '\0' == *end && 0 == errno && override > 0
+            && override <= UINT32_MAX) {
+            count = (uint32_t) override;
+        } else {
+            LOG_ERROR(
+                "Ignoring invalid %s value '%s'.\n",
+                LINEAR_THREAD_COUNT_ENV,
+                env
+            );
+        }
+    }
+
+    if (0 == count) {
+        count          = linear_thread_affinity_count();
+        uint32_t quota = linear_thread_quota_count();
+        if (quota > 0 && quota < count) {
+            count = quota;
+        }
+    }
+
+    if (0 == count) {
+        count = 1;
+    }
+
+    atomic_store(&linear_thread_count_cache, count);
+    return count;
+}
+
+uint32_t linear_thread_count(void) {
+    uint32_t count = atomic_load(&linear_thread_count_cache);
+    return (count) ? count : linear_thread_count_refresh();
+}
+
+// Hybrid core detection
+
+// Core type of every logical CPU, resolved once
+static thread_core_t  linear_thread_core_types[CPU_SETSIZE];
+static bool           linear_thread_hybrid    = false;
+static pthread_once_t linear_thread_core_once = PTHREAD_ONCE_INIT;
+
+// Mark every CPU of a sysfs cpulist, e.g. "0-7,16", as the given type
+static bool linear_thread_core_list(const char* path, thread_core_t type) {
+    FILE* file = fopen(path, "r");
+    if (NULL == file) {
+        return false;
+    }
+
+    char line[1024] = {0};
+    bool parsed     = false;
+    if (fgets(line, sizeof(line), file)) {
+        char* cursor = line;
+        while ('\0' != *cursor && '\n' != *cursor) {
+            char*         end   = NULL;
+            unsigned long first = strtoul(cursor, &end, 10);
+            unsigned long last  = first;
+            if (end == cursor) {
+                break;
+            }
+            if ('-' == *end) {
+                cursor = end + 1;
+                last   = strtoul(cursor, &end, 10);
+            }
+            for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE;
+                 ++cpu) {
+                linear_thread_core_types[cpu] = type;
+                parsed                        = true;
+            }
+            cursor = (',' == *end) ? end + 1 : end;
+        }
+    }
+    fclose(file);
+
+    return parsed;
+}
+
+// Read a per-CPU sysfs attribute, e.g. "cpu_capacity", or -1 if unavailable
+static long long linear_thread_core_read(uint32_t cpu, const char* attribute) {
+    char path[128];
+    snprintf(
+        path, sizeof(path), "/sys/devices/system/cpu/cpu%u/%s", cpu, attribute
+    );
+
+    FILE* file = fopen(path, "r");
+    if (NULL == file) {
+        return -1;
+    }
+
+    long long value   = -1;
+    int       matched = fscanf(file, "%lld", &value);
+    fclose(file);
+
+    return (1 == matched) ? value : -1;
+}
+
+// Number of configured CPUs to inspect, bounded by the size of a CPU set
+static uint32_t linear_thread_core_limit(void) {
+    long configured = -1;
+#ifdef _SC_NPROCESSORS_CONF
+    configured = sysconf(_SC_NPROCESSORS_CONF);
+#endif // _SC_NPROCESSORS_CONF
+    if (configured <= 0 || configured > CPU_SETSIZE) {
+        return CPU_SETSIZE;
+    }
+    return (uint32_t) configured;
+}
+
+// Classify CPUs by a per-CPU metric, the highest being performance cores
+static bool linear_thread_core_rank(const char* attribute) {
+    static long long metric[CPU_SETSIZE];
+    uint32_t         limit   = linear_thread_core_limit();
+    long long        lowest  = -1;
+    long long        highest = -1;
+
+    for (uint32_t cpu = 0; cpu < limit; ++cpu) {
+        metric[cpu] = linear_thread_core_read(cpu, attribute);
+        if (metric[cpu] < 0) {
+            continue;
+        }
+        lowest  = (lowest < 0 || metric[cpu] < lowest) ? metric[cpu] : lowest;
+        highest = (metric[cpu] > highest) ? metric[cpu] : highest;
+    }
+
+    if (lowest < 0 || lowest == highest) {
+        return false; // unavailable or homogeneous
+    }
+
+    for (uint32_t cpu = 0; cpu < limit; ++cpu) {
+        if (metric[cpu] >= 0) {
+            linear_thread_core_types[cpu] = (metric[cpu] == highest)
+                                                ? THREAD_CORE_PERFORMANCE
+                                                : THREAD_CORE_EFFICIENCY;
+        }
+    }
+
+    return true;
+}
+
+// CPUs of the given type within the affinity mask of the process
+static uint32_t linear_thread_core_set(thread_core_t type, cpu_set_t* set) {
+    CPU_ZERO(set);
+#ifdef __linux__
+    cpu_set_t usable;
+    CPU_ZERO(&usable);
+    if (0 != sched_getaffinity(0, sizeof(cpu_set_t), &usable)) {
+        return 0;
+    }
+
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &usable)
+            && (THREAD_CORE_ANY == type
+                || type == linear_thread_core_types[cpu])) {
+            CPU_SET(cpu, set);
+        }
+    }
+#endif // __linux__
+
+    return (uint32_t) CPU_COUNT(set);
+}
+
+static void linear_thread_core_detect(void) {
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        linear_thread_core_types[cpu] = THREAD_CORE_ANY;
+    }
+
+#ifdef __linux__
+    // Intel hybrid processors expose a PMU per core type
+    bool listed = linear_thread_core_list(
+        "/sys/devices/cpu_core/cpus", THREAD_CORE_PERFORMANCE
+    );
+    listed = linear_thread_core_list(
+                 "/sys/devices/cpu_atom/cpus", THREAD_CORE_EFFICIENCY
+             )
+             && listed;
+
+    if (!listed) {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            linear_thread_core_types[cpu] = THREAD_CORE_ANY;
+        }
+        if (!linear_thread_core_rank("cpu_capacity")) {
+            linear_thread_core_rank("cpufreq/cpuinfo_max_freq");
+        }
+    }
+#endif // __linux__
+
+    // Hybrid only if both types are usable by this process
+    cpu_set_t performance;
+    cpu_set_t efficiency;
+    linear_thread_hybrid
+        = linear_thread_core_set(THREAD_CORE_PERFORMANCE, &performance) > 0
+          && linear_thread_core_set(THREAD_CORE_EFFICIENCY, &efficiency) > 0;
+}
+
+thread_core_t linear_thread_core_type(uint32_t cpu) {
+    pthread_once(&linear_thread_core_once, linear_thread_core_detect);
+    return (cpu < CPU_SETSIZE) ? linear_thread_core_types[cpu]
+                               : THREAD_CORE_ANY;
+}
+
+bool linear_thread_is_hybrid(void) {
+    pthread_once(&linear_thread_core_once, linear_thread_core_detect);
+    return linear_thread_hybrid;
+}
+
+uint32_t linear_thread_core_count(thread_core_t type) {
+    if (THREAD_CORE_ANY == type) {
+        return linear_thread_affinity_count();
+    }
+
+    // Every core of a processor with a single core type is a performance core
+    if (!linear_thread_is_hybrid()) {
+        return (THREAD_CORE_PERFORMANCE == type)
+                   ? linear_thread_affinity_count()
+                   : 0;
+    }
+
+    cpu_set_t set;
+    return linear_thread_core_set(type, &set);
+}
+
+// Thread pool lifecycle
+
+// Restrict every worker to the core type of the pool
+static bool thread_pool_pin(thread_pool_t* pool) {
+#ifdef __linux__
+    if (!linear_thread_is_hybrid()) {
+        return true; // a single core type, nothing to restrict
+    }
+
+    cpu_set_t set;
+    linear_thread_core_set(pool->cores, &set);
+    for (uint32_t i = 0; i < pool->thread_count; ++i) {
+        pthread_t thread = pool->threads[i];
+        if (0 != pthread_setaffinity_np(thread, sizeof(set), &set)) {
+            LOG_ERROR("Failed to restrict the cores of thread %u.\n", i);
+            return false;
+        }
+    }
+#endif // __linux__
+
+    return true;
+}
+
+// Spawn thread_count workers, joining any partial set upon failure
+static bool thread_pool_spawn(thread_pool_t* pool) {
+    atomic_store(&pool->spawned_count, 0);
+    for (uint32_t i = 0; i < pool->thread_count; ++i) {
+        int thread_status = pthread_create(
+            &pool->threads[i], NULL, worker_thread, (void*) pool
+        );
+
+        if (0 != thread_status) {
+            LOG_ERROR("Failed to create thread %u.\n", i);
+            pthread_mutex_lock(&pool->queue_mutex);
+            pool->stop = 1;
+            pthread_cond_broadcast(&pool->task_available);
+            pthread_mutex_unlock(&pool->queue_mutex);
+            for (uint32_t j = 0; j < i; ++j) {
+                pthread_join(pool->threads[j], NULL);
+            }
+            pool->thread_count = 0;
+            return false;
+        }
+    }
+
+    atomic_store(&pool->started, true);
+    if (THREAD_CORE_ANY != pool->cores) {
+        thread_pool_pin(pool);
+    }
+    return true;
+}
+
+// Signal every worker to stop and wait for them to exit
+static void thread_pool_join(thread_pool_t* pool) {
+    if (!atomic_load(&pool->started)) {
+        return; // deferred, or inherited across fork, without workers
+    }
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->queue_mutex);
+
+    for (uint32_t i = 0; i < pool->thread_count; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    atomic_store(&pool->started, false);
+}
+
+// Spawn the workers of a deferred or forked pool upon first use
+static bool thread_pool_start(thread_pool_t* pool) {
+    if (atomic_load(&pool->started)) {
+        return true;
+    }
+
+    pthread_mutex_lock(&pool->start_mutex);
+    bool started = atomic_load(&pool->started);
+    if (!started) {
+        pool->stop = 0;
+        started    = thread_pool_spawn(pool);
+    }
+    pthread_mutex_unlock(&pool->start_mutex);
+
+    return started;
+}
+
+// Scratch workspaces
+
+// Header of a scratch block, the data follows at the next aligned offset
+struct ThreadScratchBlock {
+    thread_scratch_block_t* previous; // Block chained behind this one
+    size_t                  base;     // Mark of the first byte of the block
+    size_t                  size;     // Capacity of the block in bytes
+};
+
+// Workspace of threads that are not workers of the pool they pass
+static _Thread_local thread_scratch_t thread_scratch_local;
+static pthread_key_t                  thread_scratch_key;
+static pthread_once_t                 thread_scratch_once = PTHREAD_ONCE_INIT;
+
+static inline size_t thread_scratch_round(size_t size) {
+    size_t alignment = LINEAR_THREAD_SCRATCH_ALIGNMENT;
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static inline unsigned char* thread_scratch_data(thread_scratch_block_t* b) {
+    return (unsigned char*) b + thread_scratch_round(sizeof(*b));
+}
+
+static thread_scratch_block_t* thread_scratch_block_create(
+    thread_scratch_block_t* previous, size_t base, size_t size
+) {
+    void*  memory = NULL;
+    size_t header = thread_scratch_round(sizeof(thread_scratch_block_t));
+    if (0 != posix_memalign(
+            &memory, LINEAR_THREAD_SCRATCH_ALIGNMENT, header + size
+        )) {
+        LOG_ERROR("Failed to allocate %zu bytes of scratch memory.\n", size);
+        return NULL;
+    }
+
+    thread_scratch_block_t* block = (thread_scratch_block_t*) memory;
+    block->previous               = previous;
+    block->base                   = base;
+    block->size                   = size;
+    return block;
+}
+
+// Free the current block, exposing the one chained behind it
+static void thread_scratch_pop(thread_scratch_t* scratch) {
+    thread_scratch_block_t* block = scratch->block;
+    scratch->block                = block->previous;
+    atomic_fetch_sub(&scratch->capacity, block->size);
+    free(block);
+}
+
+// Free every block of a workspace
+static void thread_scratch_clear(thread_scratch_t* scratch) {
+    while (scratch->block) {
+        thread_scratch_pop(scratch);
+    }
+    scratch->used = 0;
+    scratch->peak = 0;
+    scratch->trim = false;
+}
+
+static void thread_scratch_destroy(void* scratch) {
+    thread_scratch_clear((thread_scratch_t*) scratch);
+}
+
+static void thread_scratch_key_create(void) {
+    if (0 != pthread_key_create(&thread_scratch_key, thread_scratch_destroy)) {
+        LOG_ERROR("Failed to create the scratch workspace key.\n");
+    }
+}
+
+// Workspace of the calling thread
+static thread_scratch_t* thread_scratch_current(thread_pool_t* pool) {
+    if (NULL != pool && thread_worker_pool == pool) {
+        return &pool->scratch[thread_worker_index];
+    }
+    return &thread_scratch_local;
+}
+
+// Whether the workspace must be trimmed once it is empty
+static bool thread_scratch_stale(thread_pool_t* pool, thread_scratch_t* s) {
+    return s->trim
+           || (s != &thread_scratch_local
+               && s->epoch != atomic_load(&pool->trim_epoch));
+}
+
+// Trim an empty workspace if requested, otherwise replace a chain of blocks
+// with a single block covering the peak
+static void thread_scratch_settle(thread_pool_t* pool, thread_scratch_t* s) {
+    if (thread_scratch_stale(pool, s)) {
+        thread_scratch_clear(s);
+        s->epoch = (s != &thread_scratch_local)
+                       ? atomic_load(&pool->trim_epoch)
+                       : s->epoch;
+        return;
+    }
+
+    if (NULL == s->block || s->block->size >= s->peak) {
+        return;
+    }
+
+    size_t peak = thread_scratch_round(s->peak);
+    thread_scratch_pop(s);
+    s->block = thread_scratch_block_create(NULL, 0, peak);
+    if (s->block) {
+        atomic_fetch_add(&s->capacity, peak);
+    }
+}
+
+size_t thread_scratch_mark(thread_pool_t* pool) {
+    return thread_scratch_current(pool)->used;
+}
+
+void* thread_scratch_alloc(thread_pool_t* pool, size_t size) {
+    thread_scratch_t*       scratch = thread_scratch_current(pool);
+    thread_scratch_block_t* block   = scratch->block;
+
+    size = thread_scratch_round((size) ? size : 1);
+
+    if (NULL == block || scratch->used + size > block->base + block->size) {
+        // Grow geometrically so a workspace settles within a few calls
+        size_t capacity = (block) ? 2 * block->size
+                                  : LINEAR_THREAD_SCRATCH_SIZE;
+        capacity        = (capacity > size) ? capacity : size;
+
+        block = thread_scratch_block_create(block, scratch->used, capacity);
+        if (NULL == block) {
+            return NULL;
+        }
+
+        // Free the thread-local workspace once its thread exits
+        if (NULL == scratch->block && scratch == &thread_scratch_local) {
+            pthread_once(&thread_scratch_once, thread_scratch_key_create);
+            pthread_setspecific(thread_scratch_key, scratch);
+        }
+
+        scratch->block = block;
+        atomic_fetch_add(&scratch->capacity, capacity);
+    }
+
+    void* data    = thread_scratch_data(block) + (scratch->used - block->base);
+    scratch->used += size;
+    scratch->peak  = (scratch->used > scratch->peak) ? scratch->used
+                                                     : scratch->peak;
+    return data;
+}
+
+void thread_scratch_release(thread_pool_t* pool, size_t mark) {
+    thread_scratch_t* scratch = thread_scratch_current(pool);
+    if (mark > scratch->used) {
+        LOG_ERROR("Scratch mark %zu is beyond %zu.\n", mark, scratch->used);
+        return;
+    }
+
+    // Blocks chained past the mark hold nothing anymore
+    while (scratch->block && scratch->block->previous
+           && scratch->block->base >= mark) {
+        thread_scratch_pop(scratch);
+    }
+
+    scratch->used = mark;
+    if (0 == mark) {
+        thread_scratch_settle(pool, scratch);
+    }
+}
+
+void thread_pool_trim(thread_pool_t* pool) {
+    thread_scratch_t* scratch = thread_scratch_current(pool);
+    scratch->trim             = true;
+    if (0 == scratch->used) {
+        thread_scratch_settle(pool, scratch);
+    }
+
+    if (NULL == pool) {
+        return;
+    }
+
+    // Wake idle workers so they trim before going back to sleep
+    atomic_fetch_add(&pool->trim_epoch, 1);
+    pthread_mutex_lock(&pool->queue_mutex);
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->queue_mutex);
+}
+
+size_t thread_pool_scratch_size(thread_pool_t* pool) {
+    size_t size = 0;
+    for (uint32_t i = 0; NULL != pool && i < pool->thread_count; ++i) {
+        size += atomic_load(&pool->scratch[i].capacity);
+    }
+    return size;
+}
+
+// Task queues
+
+// Mark every slot free for the first lap
+static void thread_queue_reset(thread_queue_t* queue, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->skipped, 0);
+}
+
+// Signed distance of a slot sequence from the given ring position
+static inline intptr_t thread_slot_lag(thread_slot_t* slot, size_t position) {
+    size_t sequence = atomic_load_explicit(
+        &slot->sequence, memory_order_acquire
+    );
+    return (intptr_t) (sequence - position);
+}
+
+// Enqueue up to count tasks into consecutive slots reserved by a single
+// compare-and-swap, returning the number enqueued, 0 if the queue is full
+static uint32_t thread_queue_push(
+    thread_queue_t*      queue,
+    uint32_t             size,
+    const thread_data_t* tasks,
+    uint32_t             count
+) {
+    size_t   mask     = size - 1;
+    size_t   tail     = atomic_load(&queue->tail);
+    uint32_t reserved = 0;
+
+    while (1) {
+        // A slot is free once the consumer of the previous lap released it
+        intptr_t lag = 0;
+        for (reserved = 0; reserved < count; ++reserved) {
+            size_t position = tail + reserved;
+            lag = thread_slot_lag(&queue->slots[position & mask], position);
+            if (0 != lag) {
+                break;
+            }
+        }
+
+        if (0 == reserved) {
+            if (lag < 0) {
+                return 0; // the consumer of the previous lap is behind
+            }
+            // Another producer reserved the tail first
+            tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(
+                &queue->tail,
+                &tail,
+                tail + reserved,
+                memory_order_relaxed,
+                memory_order_relaxed
+            )) {
+            break;
+        }
+    }
+
+    // Publish each task by advancing the sequence of its slot
+    for (uint32_t i = 0; i < reserved; ++i) {
+        thread_slot_t* slot = &queue->slots[(tail + i) & mask];
+        slot->task          = tasks[i];
+        atomic_store_explicit(
+            &slot->sequence, tail + i + 1, memory_order_release
+        );
+    }
+
+    return reserved;
+}
+
+// Dequeue the task at the head, returning false if the queue is empty
+static bool
+thread_queue_pop(thread_queue_t* queue, uint32_t size, thread_data_t* task) {
+    size_t mask = size - 1;
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    while (1) {
+        thread_slot_t* slot = &queue->slots[head & mask];
+        intptr_t       lag  = thread_slot_lag(slot, head + 1);
+
+        if (lag < 0) {
+            return false; // the slot was not published yet
+        }
+
+        if (lag > 0) {
+            // Another consumer claimed the head first
+            head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        } else if (atomic_compare_exchange_weak_explicit(
+                       &queue->head,
+                       &head,
+                       head + 1,
+                       memory_order_relaxed,
+                       memory_order_relaxed
+                   )) {
+            *task = slot->task;
+            atomic_store_explicit(
+                &slot->sequence, head + size, memory_order_release
+            );
+            return true;
+        }
+    }
+}
+
+// Whether the queue holds published or reserved tasks
+static inline bool thread_queue_pending(thread_queue_t* queue) {
+    return atomic_load(&queue->tail) != atomic_load(&queue->head);
+}
+
+// Whether the slot at the tail is still held by the previous lap
+static bool thread_queue_full(thread_queue_t* queue, uint32_t size) {
+    size_t tail = atomic_load(&queue->tail);
+    return thread_slot_lag(&queue->slots[tail & (size - 1)], tail) < 0;
+}
+
+// Fork safety
+
+// Every live pool, so fork handlers can quiesce and reset them
+static pthread_mutex_t thread_pool_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static thread_pool_t*  thread_pool_registry       = NULL;
+static pthread_once_t  thread_pool_atfork_once    = PTHREAD_ONCE_INIT;
+
+// Hold every pool so no thread is mid-sleep or mid-spawn when the address
+// space is copied; the lock-free queues are reset in the child regardless
+static void thread_pool_atfork_prepare(void) {
+    pthread_mutex_lock(&thread_pool_registry_mutex);
+    for (thread_pool_t* pool = thread_pool_registry; pool; pool = pool->next) {
+        pthread_mutex_lock(&pool->start_mutex);
+        pthread_mutex_lock(&pool->queue_mutex);
+    }
+}
+
+static void thread_pool_atfork_parent(void) {
+    for (thread_pool_t* pool = thread_pool_registry; pool; pool = pool->next) {
+        pthread_mutex_unlock(&pool->queue_mutex);
+        pthread_mutex_unlock(&pool->start_mutex);
+    }
+    pthread_mutex_unlock(&thread_pool_registry_mutex);
+}
+
+// Only the forking thread exists in the child; reset every pool to a deferred
+// state so its workers are spawned again upon first use
+static void thread_pool_atfork_child(void) {
+    thread_worker_pool = NULL;
 
-// Function to initialize the thread pool
-thread_pool_t* thread_pool_create(uint32_t num_threads) {
+    for (thread_pool_t* pool = thread_pool_registry; pool; pool = pool->next) {
+        for (uint32_t p = 0; p < THREAD_PRIORITY_COUNT; ++p) {
+            thread_queue_reset(&pool->queues[p], pool->queue_size);
+        }
+
+        // Tasks queued or running in the parent do not carry over
+        pool->task_count    = 0;
+        pool->active_count  = 0;
+        pool->waiting_count = 0;
+        pool->nested_count  = 0;
+        pool->idle_count    = 0;
+        pool->blocked_count = 0;
+        pool->spawned_count = 0;
+        pool->stop          = 0;
+        atomic_store(&pool->started, false);
+
+        // Workspaces of workers interrupted mid-task are discarded
+        for (uint32_t i = 0; i < pool->thread_count; ++i) {
+            thread_scratch_clear(&pool->scratch[i]);
+        }
+
+        pthread_mutex_init(&pool->queue_mutex, NULL);
+        pthread_mutex_init(&pool->region_mutex, NULL);
+        pthread_mutex_init(&pool->start_mutex, NULL);
+        pthread_cond_init(&pool->task_available, NULL);
+        pthread_cond_init(&pool->task_done, NULL);
+    }
+
+    pthread_mutex_init(&thread_pool_registry_mutex, NULL);
+}
+
+static void thread_pool_atfork_register(void) {
+    if (0 != pthread_atfork(
+            thread_pool_atfork_prepare,
+            thread_pool_atfork_parent,
+            thread_pool_atfork_child
+        )) {
+        LOG_ERROR("Failed to register the thread pool fork handlers.\n");
+    }
+}
+
+static void thread_pool_register(thread_pool_t* pool) {
+    pthread_once(&thread_pool_atfork_once, thread_pool_atfork_register);
+
+    pthread_mutex_lock(&thread_pool_registry_mutex);
+    pool->next           = thread_pool_registry;
+    thread_pool_registry = pool;
+    pthread_mutex_unlock(&thread_pool_registry_mutex);
+}
+
+static void thread_pool_unregister(thread_pool_t* pool) {
+    pthread_mutex_lock(&thread_pool_registry_mutex);
+    thread_pool_t** link = &thread_pool_registry;
+    while (*link && *link != pool) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = pool->next;
+    }
+    pthread_mutex_unlock(&thread_pool_registry_mutex);
+}
+
+// Allocate the cleared, cache line aligned state of count team members
+static thread_team_member_t* thread_team_members_alloc(uint32_t count) {
+    size_t                bytes   = sizeof(thread_team_member_t) * count;
+    thread_team_member_t* members = aligned_alloc(
+        _Alignof(thread_team_member_t), bytes
+    );
+    if (NULL != members) {
+        memset(members, 0, bytes);
+    }
+    return members;
+}
+
+// Function to initialize the thread pool without spawning its workers
+thread_pool_t* thread_pool_create_deferred(uint32_t num_threads) {
     thread_pool_t* pool = malloc(sizeof(thread_pool_t));
     if (!pool) {
         LOG_ERROR("Failed to allocate memory for thread pool.\n");
         return NULL;
     }
 
-    pool->thread_count = (num_threads) ? num_threads : LINEAR_THREAD_COUNT;
-    pool->queue_size   = LINEAR_THREAD_COUNT;
-    pool->task_count   = 0;
-    pool->head         = 0;
-    pool->tail         = 0;
-    pool->stop         = 0;
+    pool->thread_count  = (num_threads) ? num_threads : LINEAR_THREAD_COUNT;
+    pool->queue_size    = LINEAR_THREAD_QUEUE_SIZE;
+    pool->task_count    = 0;
+    pool->active_count  = 0;
+    pool->waiting_count = 0;
+    pool->nested_count  = 0;
+    pool->idle_count    = 0;
+    pool->blocked_count = 0;
+    pool->expired_count = 0;
+    pool->spawned_count = 0;
+    pool->trim_epoch    = 0;
+    pool->stop          = 0;
+    pool->fixed         = (0 != num_threads);
+    pool->cores         = THREAD_CORE_ANY;
+    pool->next          = NULL;
+    atomic_init(&pool->started, false);
+
+    bool allocated = true;
+    for (uint32_t p = 0; p < THREAD_PRIORITY_COUNT; ++p) {
+        thread_queue_t* queue = &pool->queues[p];
+        queue->slots = malloc(sizeof(thread_slot_t) * pool->queue_size);
+        if (NULL != queue->slots) {
+            thread_queue_reset(queue, pool->queue_size);
+        }
+        allocated = allocated && (NULL != queue->slots);
+    }
 
-    pool->threads    = malloc(sizeof(pthread_t) * pool->thread_count);
-    pool->task_queue = malloc(sizeof(thread_data_t) * pool->queue_size);
+    pool->threads = malloc(sizeof(pthread_t) * pool->thread_count);
+    pool->scratch = calloc(pool->thread_count, sizeof(thread_scratch_t));
+    pool->members = thread_team_members_alloc(pool->thread_count + 1);
 
-    if (!pool->threads || !pool->task_queue) {
+    if (!pool->threads || !pool->scratch || !pool->members || !allocated) {
         LOG_ERROR("Failed to allocate memory for threads or task queue.\n");
         free(pool->threads);
-        free(pool->task_queue);
+        free(pool->scratch);
+        free(pool->members);
+        for (uint32_t p = 0; p < THREAD_PRIORITY_COUNT; ++p) {
+            free(pool->queues[p].slots);
+        }
         free(pool);
         return NULL;
     }
 
     pthread_mutex_init(&pool->queue_mutex, NULL);
+    pthread_mutex_init(&pool->region_mutex, NULL);
+    pthread_mutex_init(&pool->start_mutex, NULL);
     pthread_cond_init(&pool->task_available, NULL);
     pthread_cond_init(&pool->task_done, NULL);
 
-    // Create worker threads
-    for (uint32_t i = 0; i < pool->thread_count; ++i) {
-        int thread_status = pthread_create(
-            &pool->threads[i], NULL, worker_thread, (void*) pool
-        );
+    thread_pool_register(pool);
 
-        if (0 != thread_status) {
-            LOG_ERROR("Failed to create thread %u.\n", i);
-            thread_pool_free(pool);
-            return NULL;
-        }
+    return pool;
+}
+
+// Function to initialize the thread pool
+thread_pool_t* thread_pool_create(uint32_t num_threads) {
+    thread_pool_t* pool = thread_pool_create_deferred(num_threads);
+    if (NULL == pool) {
+        return NULL;
+    }
+
+    // Create worker threads
+    if (!thread_pool_start(pool)) {
+        thread_pool_free(pool);
+        return NULL;
     }
 
     return pool;
@@ -72,71 +1019,646 @@ void thread_pool_free(thread_pool_t* pool) {
         return;
     }
 
-    pthread_mutex_lock(&pool->queue_mutex);
-    pool->stop = 1;
-    pthread_cond_broadcast(&pool->task_available);
-    pthread_mutex_unlock(&pool->queue_mutex);
+    thread_pool_unregister(pool);
+    thread_pool_join(pool);
 
+    free(pool->threads);
+    for (uint32_t p = 0; p < THREAD_PRIORITY_COUNT; ++p) {
+        free(pool->queues[p].slots);
+    }
     for (uint32_t i = 0; i < pool->thread_count; ++i) {
-        pthread_join(pool->threads[i], NULL);
+        thread_scratch_clear(&pool->scratch[i]);
     }
-
-    free(pool->threads);
-    free(pool->task_queue);
+    free(pool->scratch);
+    free(pool->members);
     pthread_mutex_destroy(&pool->queue_mutex);
+    pthread_mutex_destroy(&pool->region_mutex);
+    pthread_mutex_destroy(&pool->start_mutex);
     pthread_cond_destroy(&pool->task_available);
     pthread_cond_destroy(&pool->task_done);
     free(pool);
 }
 
+// Resize the pool by replacing its workers
+bool thread_pool_resize(thread_pool_t* pool, uint32_t num_threads) {
+    if (NULL == pool) {
+        return false;
+    }
+
+    uint32_t thread_count = (num_threads) ? num_threads : LINEAR_THREAD_COUNT;
+    if (thread_count == pool->thread_count) {
+        return true; // nothing to do
+    }
+
+    // A deferred pool stays deferred, only the thread count changes
+    bool started = atomic_load(&pool->started);
+
+    thread_pool_wait(pool);
+    thread_pool_join(pool);
+
+    bool                  resized = true;
+    pthread_t*            threads = NULL;
+    thread_scratch_t*     scratch = calloc(thread_count, sizeof(*scratch));
+    thread_team_member_t* members = thread_team_members_alloc(
+        thread_count + 1
+    );
+    if (NULL != scratch && NULL != members) {
+        threads = realloc(pool->threads, sizeof(pthread_t) * thread_count);
+    }
+    if (NULL == threads) {
+        LOG_ERROR("Failed to allocate memory for %u threads.\n", thread_count);
+        // Restore the previous workers rather than leave the pool idle
+        free(scratch);
+        free(members);
+        resized      = false;
+        thread_count = pool->thread_count;
+        threads      = pool->threads;
+        scratch      = pool->scratch;
+        members      = pool->members;
+    }
+
+    // Workers keep their workspaces, those of removed workers are freed
+    if (scratch != pool->scratch) {
+        for (uint32_t i = 0; i < pool->thread_count; ++i) {
+            if (i < thread_count) {
+                memcpy(&scratch[i], &pool->scratch[i], sizeof(*scratch));
+            } else {
+                thread_scratch_clear(&pool->scratch[i]);
+            }
+        }
+        free(pool->scratch);
+    }
+
+    if (members != pool->members) {
+        free(pool->members);
+    }
+
+    pool->threads      = threads;
+    pool->scratch      = scratch;
+    pool->members      = members;
+    pool->thread_count = thread_count;
+    pool->fixed        = (resized) ? (0 != num_threads) : pool->fixed;
+    pool->stop         = 0;
+
+    return ((started) ? thread_pool_spawn(pool) : true) && resized;
+}
+
+// Resize the pool if the default thread count changed
+bool thread_pool_refresh(thread_pool_t* pool) {
+    if (NULL == pool || pool->fixed) {
+        return false;
+    }
+
+    uint32_t thread_count = linear_thread_count_refresh();
+    if (thread_count == pool->thread_count) {
+        return false;
+    }
+
+    return thread_pool_resize(pool, 0);
+}
+
+// Restrict the workers to a core type, now or once they are spawned
+bool thread_pool_set_cores(thread_pool_t* pool, thread_core_t cores) {
+    if (NULL == pool || cores >= THREAD_CORE_COUNT) {
+        LOG_ERROR("Invalid core type %d.\n", cores);
+        return false;
+    }
+
+    if (!linear_thread_is_hybrid()) {
+        pool->cores = cores;
+        return true; // every core is of the same type
+    }
+
+    cpu_set_t set;
+    if (0 == linear_thread_core_set(cores, &set)) {
+        LOG_ERROR("No usable CPU is of core type %d.\n", cores);
+        return false;
+    }
+
+    pthread_mutex_lock(&pool->start_mutex);
+    pool->cores = cores;
+    bool pinned = !atomic_load(&pool->started) || thread_pool_pin(pool);
+    pthread_mutex_unlock(&pool->start_mutex);
+
+    return pinned;
+}
+
+bool thread_pool_is_worker(const thread_pool_t* pool) {
+    return NULL != pool && thread_worker_pool == pool;
+}
+
+// Hint to the core that the caller is spinning
+static inline void thread_spin_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Innermost region the calling thread leads over pool, NULL if none
+static const thread_region_frame_t*
+thread_region_frame_find(const thread_pool_t* pool) {
+    for (const thread_region_frame_t* frame = thread_region_frames;
+         NULL != frame;
+         frame = frame->outer) {
+        if (frame->pool == pool) {
+            return frame;
+        }
+    }
+    return NULL;
+}
+
+bool thread_pool_is_leader(const thread_pool_t* pool) {
+    return NULL != pool && NULL != thread_region_frame_find(pool);
+}
+
+// Whether the calling thread may execute queued tasks while it waits. A
+// region leader first waits for every member to take its task, so it never
+// dequeues a member of its own team, which would spin on the leader forever.
+static bool thread_pool_can_help(const thread_pool_t* pool) {
+    if (thread_pool_is_worker(pool)) {
+        return true;
+    }
+
+    const thread_region_frame_t* frame = thread_region_frame_find(pool);
+    if (NULL == frame) {
+        return false;
+    }
+
+    const thread_team_t* team = frame->team;
+    for (uint32_t spins = 0; atomic_load(&team->joined) + 1 < team->size;
+         ++spins) {
+        if (spins < LINEAR_THREAD_SPIN_LIMIT) {
+            thread_spin_pause();
+        } else {
+            sched_yield();
+        }
+    }
+    return true;
+}
+
+// Whether nothing is pending and every executing task is waiting itself
+static bool thread_pool_idle(thread_pool_t* pool) {
+    return 0 == atomic_load(&pool->task_count)
+           && atomic_load(&pool->active_count)
+                  <= atomic_load(&pool->nested_count);
+}
+
+// Wake every thread sleeping on task_done
+static void thread_pool_broadcast_done(thread_pool_t* pool) {
+    pthread_mutex_lock(&pool->queue_mutex);
+    pthread_cond_broadcast(&pool->task_done);
+    pthread_mutex_unlock(&pool->queue_mutex);
+}
+
+// Dequeue the next task without blocking. A starved lower priority queue is
+// served before anything else, otherwise the highest priority is preferred
+// and every queue bypassed while pending ages.
+static bool thread_pool_take(thread_pool_t* pool, thread_data_t* task) {
+    if (0 == atomic_load(&pool->task_count)) {
+        return false;
+    }
+
+    bool taken = false;
+    for (uint32_t p = THREAD_PRIORITY_COUNT; p-- > 1 && !taken;) {
+        thread_queue_t* queue = &pool->queues[p];
+        if (atomic_load(&queue->skipped) >= LINEAR_THREAD_STARVATION_LIMIT
+            && thread_queue_pop(queue, pool->queue_size, task)) {
+            atomic_store(&queue->skipped, 0);
+            taken = true;
+        }
+    }
+
+    for (uint32_t p = 0; p < THREAD_PRIORITY_COUNT && !taken; ++p) {
+        thread_queue_t* queue = &pool->queues[p];
+        if (!thread_queue_pop(queue, pool->queue_size, task)) {
+            continue;
+        }
+        atomic_store(&queue->skipped, 0);
+        for (uint32_t q = p + 1; q < THREAD_PRIORITY_COUNT; ++q) {
+            if (thread_queue_pending(&pool->queues[q])) {
+                atomic_fetch_add(&pool->queues[q].skipped, 1);
+            }
+        }
+        taken = true;
+    }
+
+    if (!taken) {
+        return false; // counted tasks are still being published
+    }
+
+    // Count the task as active before it stops counting as pending, so the
+    // pool never appears idle in between
+    atomic_fetch_add(&pool->active_count, 1);
+    atomic_fetch_sub(&pool->task_count, 1);
+
+    // Wake submitters blocked on a full queue
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&pool->blocked_count) > 0) {
+        thread_pool_broadcast_done(pool);
+    }
+    return true;
+}
+
+// Execute a dequeued task and account for its completion
+static void thread_pool_run(thread_pool_t* pool, thread_data_t* task) {
+    // Perform the task unless it expired while queued
+    bool expired = task->deadline && thread_clock_now() > task->deadline;
+    if (expired) {
+        if (task->cancel) {
+            task->cancel(task);
+        }
+        atomic_fetch_add(&pool->expired_count, 1);
+    } else {
+        thread_task_execute(task);
+    }
+
+    // The group may be released by its waiter as soon as pending reaches 0
+    bool completed = task->group
+                     && 1 == atomic_fetch_sub(&task->group->pending, 1);
+    atomic_fetch_sub(&pool->active_count, 1);
+
+    if (completed || thread_pool_idle(pool)) {
+        thread_pool_broadcast_done(pool);
+    }
+}
+
+// Wake up to count sleeping workers, and every worker helping while it waits
+static void thread_pool_notify(thread_pool_t* pool, uint32_t count) {
+    bool helping = atomic_load(&pool->waiting_count) > 0;
+    if (0 == atomic_load(&pool->idle_count) && !helping) {
+        return; // every worker is busy and will find the tasks
+    }
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    if (count >= atomic_load(&pool->idle_count)) {
+        pthread_cond_broadcast(&pool->task_available);
+    } else {
+        for (uint32_t i = 0; i < count; ++i) {
+            pthread_cond_signal(&pool->task_available);
+        }
+    }
+    if (helping) {
+        pthread_cond_broadcast(&pool->task_done);
+    }
+    pthread_mutex_unlock(&pool->queue_mutex);
+}
+
 // Worker thread function
 void* worker_thread(void* arg) {
     thread_pool_t* pool = (thread_pool_t*) arg;
+    thread_worker_pool  = pool;
+    thread_worker_index = atomic_fetch_add(&pool->spawned_count, 1);
+
+    thread_scratch_t* scratch = &pool->scratch[thread_worker_index];
 
     while (1) {
+        thread_data_t task;
+        if (thread_pool_take(pool, &task)) {
+            thread_pool_run(pool, &task);
+            continue;
+        }
+
+        // Honor trim requests before going to sleep
+        thread_scratch_settle(pool, scratch);
+
+        // Announce the worker is idle before checking for tasks, so a
+        // submitter either sees it asleep or the worker sees the task
         pthread_mutex_lock(&pool->queue_mutex);
-        while (pool->task_count == 0 && !pool->stop) {
+        atomic_fetch_add(&pool->idle_count, 1);
+        bool slept = false;
+        while (0 == atomic_load(&pool->task_count) && !pool->stop
+               && !thread_scratch_stale(pool, scratch)) {
             pthread_cond_wait(&pool->task_available, &pool->queue_mutex);
+            slept = true;
         }
+        atomic_fetch_sub(&pool->idle_count, 1);
+        bool stop = pool->stop;
+        pthread_mutex_unlock(&pool->queue_mutex);
 
-        if (pool->stop) {
-            pthread_mutex_unlock(&pool->queue_mutex);
+        if (stop) {
             break;
         }
+        if (!slept) {
+            sched_yield(); // let the submitter finish publishing
+        }
+    }
+
+    return NULL;
+}
+
+// Execute a task on the calling thread
+void thread_task_execute(thread_data_t* task) {
+    if (task->routine) {
+        task->routine(task);
+    } else if (task->operation) {
+        task->operation(task->a, task->b, task->result, task->type);
+    }
+}
 
-        thread_data_t task = pool->task_queue[pool->head];
-        pool->head         = (pool->head + 1) % pool->queue_size;
-        pool->task_count--;
+// Enqueue counted tasks, helping or sleeping while the queue is full
+static void thread_pool_enqueue(
+    thread_pool_t*       pool,
+    thread_queue_t*      queue,
+    const thread_data_t* tasks,
+    uint32_t             count
+) {
+    uint32_t total = count;
 
-        pthread_cond_signal(&pool->task_done);
+    while (count > 0) {
+        uint32_t pushed = thread_queue_push(
+            queue, pool->queue_size, tasks, count
+        );
+        tasks += pushed;
+        count -= pushed;
+        if (pushed > 0) {
+            continue;
+        }
+
+        // Wait for a slot rather than overwrite pending tasks. Workers drain
+        // the queues themselves, since every worker may be submitting at once,
+        // and so do region leaders, whose team is busy spinning.
+        thread_pool_notify(pool, total);
+
+        thread_data_t pending;
+        if (thread_pool_can_help(pool) && thread_pool_take(pool, &pending)) {
+            thread_pool_run(pool, &pending);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->queue_mutex);
+        atomic_fetch_add(&pool->blocked_count, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        while (thread_queue_full(queue, pool->queue_size)) {
+            pthread_cond_wait(&pool->task_done, &pool->queue_mutex);
+        }
+        atomic_fetch_sub(&pool->blocked_count, 1);
         pthread_mutex_unlock(&pool->queue_mutex);
+    }
+}
 
-        // Perform the task
-        task.operation(task.a, task.b, task.result, task.type);
+// Submit a batch of tasks to the queue of the given priority class
+void thread_pool_submit_batch(
+    thread_pool_t*       pool,
+    const thread_data_t* tasks,
+    uint32_t             count,
+    thread_priority_t    priority
+) {
+    if (priority >= THREAD_PRIORITY_COUNT) {
+        LOG_ERROR("Invalid priority %d, using normal.\n", priority);
+        priority = THREAD_PRIORITY_NORMAL;
     }
 
-    return NULL;
+    if (0 == count) {
+        return;
+    }
+
+    if (!thread_pool_start(pool)) {
+        LOG_ERROR("Failed to start the workers of the pool.\n");
+        return;
+    }
+
+    // Count the tasks before they are visible, so completing one never
+    // releases a group or a waiter early
+    for (uint32_t i = 0; i < count; ++i) {
+        if (tasks[i].group) {
+            atomic_fetch_add(&tasks[i].group->pending, 1);
+        }
+    }
+    atomic_fetch_add(&pool->task_count, count);
+
+    thread_pool_enqueue(pool, &pool->queues[priority], tasks, count);
+    thread_pool_notify(pool, count);
+}
+
+// Submit a task to the queue of the given priority class
+void thread_pool_submit_priority(
+    thread_pool_t* pool, thread_data_t task, thread_priority_t priority
+) {
+    thread_pool_submit_batch(pool, &task, 1, priority);
 }
 
 // Submit a task to the thread pool
 void thread_pool_submit(thread_pool_t* pool, thread_data_t task) {
-    pthread_mutex_lock(&pool->queue_mutex);
-
-    pool->task_queue[pool->tail] = task;
-    pool->tail                   = (pool->tail + 1) % pool->queue_size;
-    pool->task_count++;
+    thread_pool_submit_priority(pool, task, THREAD_PRIORITY_NORMAL);
+}
 
-    pthread_cond_signal(&pool->task_available);
-    pthread_mutex_unlock(&pool->queue_mutex);
+// Whether the tasks a caller of thread_pool_wait waits for have completed;
+// workers only wait for tasks that are not themselves waiting
+static bool thread_pool_settled(thread_pool_t* pool, bool worker) {
+    uint32_t waiting = (worker) ? atomic_load(&pool->nested_count) : 0;
+    return 0 == atomic_load(&pool->task_count)
+           && atomic_load(&pool->active_count) <= waiting;
 }
 
 // Wait for all tasks to complete
 void thread_pool_wait(thread_pool_t* pool) {
-    pthread_mutex_lock(&pool->queue_mutex);
-    while (pool->task_count > 0) {
-        pthread_cond_wait(&pool->task_done, &pool->queue_mutex);
+    bool     worker = thread_pool_is_worker(pool);
+    uint32_t nested = (worker) ? 1 : 0;
+
+    atomic_fetch_add(&pool->waiting_count, nested);
+    atomic_fetch_add(&pool->nested_count, nested);
+    if (worker && thread_pool_idle(pool)) {
+        thread_pool_broadcast_done(pool); // release other waiters
     }
-    pthread_mutex_unlock(&pool->queue_mutex);
+
+    while (!thread_pool_settled(pool, worker)) {
+        thread_data_t task;
+        if (worker && thread_pool_take(pool, &task)) {
+            thread_pool_run(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->queue_mutex);
+        while (!thread_pool_settled(pool, worker)
+               && (!worker || 0 == atomic_load(&pool->task_count))) {
+            pthread_cond_wait(&pool->task_done, &pool->queue_mutex);
+        }
+        pthread_mutex_unlock(&pool->queue_mutex);
+    }
+
+    atomic_fetch_sub(&pool->waiting_count, nested);
+    atomic_fetch_sub(&pool->nested_count, nested);
+}
+
+// Wait for the tasks of a group to complete. Region leaders help like
+// workers do, since the workers of their team never return to the queues.
+void thread_group_wait(thread_pool_t* pool, thread_group_t* group) {
+    bool     worker = thread_pool_is_worker(pool);
+    bool     helper = worker || thread_pool_can_help(pool);
+    uint32_t nested = (worker) ? 1 : 0;
+
+    atomic_fetch_add(&pool->waiting_count, nested);
+
+    while (atomic_load(&group->pending) > 0) {
+        thread_data_t task;
+        if (helper && thread_pool_take(pool, &task)) {
+            thread_pool_run(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->queue_mutex);
+        while (atomic_load(&group->pending) > 0
+               && (!helper || 0 == atomic_load(&pool->task_count))) {
+            pthread_cond_wait(&pool->task_done, &pool->queue_mutex);
+        }
+        pthread_mutex_unlock(&pool->queue_mutex);
+    }
+
+    atomic_fetch_sub(&pool->waiting_count, nested);
+}
+
+// Parallel regions
+
+void thread_team_barrier(thread_team_t* team, uint32_t id) {
+    thread_barrier_t* barrier = &team->barrier;
+    bool              sense   = !team->members[id].sense;
+    team->members[id].sense   = sense;
+
+    // The last arrival releases the others by publishing the new sense
+    if (1 == atomic_fetch_sub(&barrier->remaining, 1)) {
+        atomic_store(&barrier->remaining, barrier->size);
+        atomic_store(&barrier->sense, sense);
+        return;
+    }
+
+    for (uint32_t spins = 0; atomic_load(&barrier->sense) != sense; ++spins) {
+        if (spins < LINEAR_THREAD_SPIN_LIMIT) {
+            thread_spin_pause();
+        } else {
+            sched_yield(); // oversubscribed, let the stragglers run
+        }
+    }
+}
+
+// Publish a value into the current reduction slot and wait for the team
+static uint32_t
+thread_team_publish(thread_team_t* team, uint32_t id, float value) {
+    // Alternating slots lets the next reduction begin while others still read
+    thread_team_member_t* member = &team->members[id];
+    uint32_t              slot   = member->reductions++ & 1;
+    member->partials[slot]       = value;
+    thread_team_barrier(team, id);
+    return slot;
+}
+
+float thread_team_reduce_sum(thread_team_t* team, uint32_t id, float value) {
+    uint32_t slot = thread_team_publish(team, id, value);
+    float    sum  = 0.0f;
+    for (uint32_t i = 0; i < team->size; i++) {
+        sum += team->members[i].partials[slot];
+    }
+    return sum;
+}
+
+float thread_team_reduce_max(thread_team_t* team, uint32_t id, float value) {
+    uint32_t slot    = thread_team_publish(team, id, value);
+    float    maximum = team->members[0].partials[slot];
+    for (uint32_t i = 1; i < team->size; i++) {
+        float partial = team->members[i].partials[slot];
+        maximum       = (partial > maximum) ? partial : maximum;
+    }
+    return maximum;
+}
+
+void thread_team_range(
+    const thread_team_t* team,
+    uint32_t             id,
+    uint32_t             count,
+    uint32_t*            begin,
+    uint32_t*            end
+) {
+    // Distribute the remainder so no member exceeds another by more than one
+    uint32_t chunk_size = count / team->size;
+    uint32_t remainder  = count % team->size;
+    *begin = id * chunk_size + ((id < remainder) ? id : remainder);
+    *end   = *begin + chunk_size + ((id < remainder) ? 1 : 0);
+}
+
+// Member routine executed by the workers of a team
+static void thread_team_routine(thread_data_t* task) {
+    thread_team_t* team = (thread_team_t*) task->a;
+    atomic_fetch_add(&team->joined, 1);
+    team->region(team, task->begin, team->arg);
+}
+
+uint32_t thread_pool_region(
+    thread_pool_t* pool, uint32_t team_size, thread_region_t region, void* arg
+) {
+    if (NULL == region) {
+        LOG_ERROR("A region function is required.\n");
+        return 0;
+    }
+
+    // The caller joins the team, so every worker plus the caller may take
+    // part. Workers and the leader of an enclosing region over the pool run
+    // alone: the workers are held, and region_mutex is not recursive.
+    uint32_t limit = (NULL == pool || thread_pool_is_worker(pool)
+                      || thread_pool_is_leader(pool))
+                         ? 1
+                         : pool->thread_count + 1;
+    uint32_t size  = (0 == team_size || team_size > limit) ? limit : team_size;
+
+    thread_team_member_t single = {0};
+    thread_team_t        team   = {
+        .members = &single,
+        .size    = size,
+        .region  = region,
+        .arg     = arg,
+    };
+    atomic_init(&team.barrier.remaining, size);
+    atomic_init(&team.barrier.sense, false);
+    atomic_init(&team.joined, 0);
+    team.barrier.size = size;
+
+    if (1 == size) {
+        region(&team, 0, arg);
+        return 1;
+    }
+
+    // Regions hold workers for their whole duration; one region at a time,
+    // so the members allocated with the pool serve every region
+    pthread_mutex_lock(&pool->region_mutex);
+    team.members = pool->members;
+    memset(team.members, 0, sizeof(thread_team_member_t) * size);
+
+    thread_group_t group = {0};
+    for (uint32_t id = 1; id < size; id++) {
+        thread_data_t task = {
+            .a       = &team,
+            .begin   = id,
+            .end     = id + 1,
+            .routine = thread_team_routine,
+            .group   = &group,
+        };
+        thread_pool_submit_priority(pool, task, THREAD_PRIORITY_HIGH);
+    }
+
+    // Only once every member was submitted, as a leader helping with a full
+    // queue first waits for all of them to join
+    thread_region_frame_t frame = {pool, &team, thread_region_frames};
+    thread_region_frames        = &frame;
+
+    region(&team, 0, arg);
+    thread_region_frames = frame.outer;
+    thread_group_wait(pool, &group);
+
+    pthread_mutex_unlock(&pool->region_mutex);
+
+    return size;
+}
+
+// Deadlines
+
+uint64_t thread_clock_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+uint64_t thread_deadline_after(uint64_t nanoseconds) {
+    return thread_clock_now() + nanoseconds;
 }
 
 // @note These may be API specific, though, in most cases, there are only a few
@@ -0,0 +1,944 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file src/toeplitz.c
+ *
+ * @brief Toeplitz and circulant matrices stored by their defining vectors
+ *
+ * Only pure C is used with minimal dependencies on external libraries.
+ */
+
+#include "toeplitz.h"
+#include "logger.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdatomic.h>
+
+#define TOEPLITZ_PI 3.14159265358979323846
+
+// Number of diagonals of a Toeplitz matrix of the given order
+static inline size_t toeplitz_diagonals(uint32_t order) {
+    return (order) ? 2 * (size_t) order - 1 : 0;
+}
+
+// Lifecycle management
+
+// Allocate count zero initialized elements, at least one so an empty matrix
+// still holds valid data
+static float* toeplitz_elements(linear_context_t* context, size_t count) {
+    float* data = linear_context_allocate(
+        context, ((count) ? count : 1) * sizeof(float)
+    );
+    if (NULL == data) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        data[i] = 0.0f;
+    }
+
+    return data;
+}
+
+toeplitz_t* toeplitz_create_ctx(linear_context_t* context, uint32_t order) {
+    context = linear_context_resolve(context);
+
+    toeplitz_t* toeplitz = linear_context_allocate(
+        context, sizeof(toeplitz_t)
+    );
+    if (NULL == toeplitz) {
+        LOG_ERROR("Failed to allocate memory for toeplitz_t.\n");
+        return NULL;
+    }
+
+    toeplitz->data  = toeplitz_elements(context, toeplitz_diagonals(order));
+    toeplitz->order = order;
+    if (NULL == toeplitz->data) {
+        LOG_ERROR("Failed to allocate memory for Toeplitz elements.\n");
+        linear_context_release(context, toeplitz);
+        return NULL;
+    }
+
+    return toeplitz;
+}
+
+void toeplitz_free_ctx(linear_context_t* context, toeplitz_t* toeplitz) {
+    if (NULL == toeplitz) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, toeplitz->data);
+    linear_context_release(context, toeplitz);
+}
+
+circulant_t* circulant_create_ctx(linear_context_t* context, uint32_t order) {
+    context = linear_context_resolve(context);
+
+    circulant_t* circulant = linear_context_allocate(
+        context, sizeof(circulant_t)
+    );
+    if (NULL == circulant) {
+        LOG_ERROR("Failed to allocate memory for circulant_t.\n");
+        return NULL;
+    }
+
+    circulant->data  = toeplitz_elements(context, order);
+    circulant->order = order;
+    if (NULL == circulant->data) {
+        LOG_ERROR("Failed to allocate memory for circulant elements.\n");
+        linear_context_release(context, circulant);
+        return NULL;
+    }
+
+    return circulant;
+}
+
+void circulant_free_ctx(linear_context_t* context, circulant_t* circulant) {
+    if (NULL == circulant) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, circulant->data);
+    linear_context_release(context, circulant);
+}
+
+// Conversion
+
+// Verify a NUMERIC_FLOAT32 vector holds count elements
+static bool toeplitz_vector_is_valid(const vector_t* vector, uint32_t count) {
+    if (NULL == vector) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type || count != vector->columns) {
+        LOG_ERROR(
+            "Expected %u NUMERIC_FLOAT32 elements, got %u.\n",
+            count,
+            vector->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+toeplitz_t* toeplitz_from_vectors_ctx(
+    linear_context_t* context, const vector_t* column, const vector_t* row
+) {
+    if (NULL == column) {
+        return NULL;
+    }
+
+    // A symmetric matrix shares its first row and column
+    const uint32_t n = column->columns;
+    row              = (NULL == row) ? column : row;
+    if (!toeplitz_vector_is_valid(column, n)
+        || !toeplitz_vector_is_valid(row, n)) {
+        return NULL;
+    }
+
+    const float* c = (const float*) column->data;
+    const float* r = (const float*) row->data;
+    if (n > 0 && c[0] != r[0]) {
+        LOG_ERROR(
+            "The first row and column must share their first element, got "
+            "%f and %f.\n",
+            (double) r[0],
+            (double) c[0]
+        );
+        return NULL;
+    }
+
+    toeplitz_t* toeplitz = toeplitz_create_ctx(context, n);
+    if (NULL == toeplitz) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        toeplitz->data[n - 1 + i] = c[i];
+        toeplitz->data[n - 1 - i] = r[i];
+    }
+
+    return toeplitz;
+}
+
+circulant_t*
+circulant_from_vector_ctx(linear_context_t* context, const vector_t* column) {
+    if (NULL == column || !toeplitz_vector_is_valid(column, column->columns)) {
+        return NULL;
+    }
+
+    circulant_t* circulant = circulant_create_ctx(context, column->columns);
+    if (NULL == circulant) {
+        return NULL;
+    }
+
+    const float* c = (const float*) column->data;
+    for (uint32_t i = 0; i < circulant->order; i++) {
+        circulant->data[i] = c[i];
+    }
+
+    return circulant;
+}
+
+// Spread the first column of a circulant matrix of order n over the 2n - 1
+// diagonals of the same matrix seen as Toeplitz
+static void circulant_diagonals(const float* c, uint32_t n, float* h) {
+    for (uint32_t i = 0; i < n; i++) {
+        h[n - 1 + i] = c[i];
+    }
+    for (uint32_t i = 1; i < n; i++) {
+        h[n - 1 - i] = c[n - i];
+    }
+}
+
+// Expand the diagonals of a Toeplitz matrix of order n into a dense matrix
+static matrix_t*
+toeplitz_expand(linear_context_t* context, const float* h, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to allocate memory to resulting matrix.\n");
+        return NULL;
+    }
+
+    // Row i is the diagonals from n - 1 + i down, read backwards
+    for (uint32_t i = 0; i < n; i++) {
+        const float* d   = h + n - 1 + i;
+        float*       row = matrix->data + (size_t) i * n;
+        for (uint32_t j = 0; j < n; j++) {
+            row[j] = *(d - j);
+        }
+    }
+
+    return matrix;
+}
+
+matrix_t*
+toeplitz_to_matrix_ctx(linear_context_t* context, const toeplitz_t* toeplitz) {
+    if (NULL == toeplitz) {
+        return NULL;
+    }
+
+    return toeplitz_expand(context, toeplitz->data, toeplitz->order);
+}
+
+matrix_t* circulant_to_matrix_ctx(
+    linear_context_t* context, const circulant_t* circulant
+) {
+    if (NULL == circulant) {
+        return NULL;
+    }
+
+    context     = linear_context_resolve(context);
+    size_t mark = linear_context_scratch_mark(context);
+    float* h    = linear_context_scratch_alloc(
+        context, sizeof(float) * toeplitz_diagonals(circulant->order)
+    );
+    if (NULL == h && circulant->order > 0) {
+        LOG_ERROR("Failed to allocate memory for the diagonals.\n");
+        linear_context_scratch_release(context, mark);
+        return NULL;
+    }
+
+    circulant_diagonals(circulant->data, circulant->order, h);
+    matrix_t* matrix = toeplitz_expand(context, h, circulant->order);
+    linear_context_scratch_release(context, mark);
+    return matrix;
+}
+
+// Transforms
+
+// Twiddle factors of a radix-2 FFT whose size is a power of two
+typedef struct ToeplitzFft {
+    float*   cosines; // Real parts of exp(-2 pi i k / size), k < size / 2
+    float*   sines;   // Imaginary parts of the same
+    uint32_t size;    // Number of elements transformed
+} toeplitz_fft_t;
+
+// A DFT of any order, taken by Bluestein's algorithm unless the order is a
+// power of two, see toeplitz_dft()
+typedef struct ToeplitzDft {
+    toeplitz_fft_t fft;       // Power of two transform of the convolution
+    float*         chirp_re;  // Real parts of exp(-pi i j^2 / order)
+    float*         chirp_im;  // Imaginary parts of the same
+    float*         kernel_re; // Transform of the conjugate chirp
+    float*         kernel_im; // Imaginary parts of the same
+    uint32_t       order;     // Number of elements transformed
+} toeplitz_dft_t;
+
+// Smallest power of two at least count, or 0 if it exceeds 2^31
+static uint32_t toeplitz_fft_size(uint64_t count) {
+    uint64_t size = 1;
+    while (size < count) {
+        size <<= 1;
+    }
+    return (size <= (UINT64_C(1) << 31)) ? (uint32_t) size : 0;
+}
+
+// Allocate and fill the twiddle factors of a transform of the given size
+static bool toeplitz_fft_create(
+    linear_context_t* context, uint32_t size, toeplitz_fft_t* fft
+) {
+    size_t bytes = sizeof(float) * ((size > 1) ? size / 2 : 1);
+    fft->cosines = linear_context_scratch_alloc(context, bytes);
+    fft->sines   = linear_context_scratch_alloc(context, bytes);
+    fft->size    = size;
+    if (NULL == fft->cosines || NULL == fft->sines) {
+        LOG_ERROR("Failed to allocate memory for the twiddle factors.\n");
+        return false;
+    }
+
+    for (uint32_t k = 0; k < size / 2; k++) {
+        double angle    = -2.0 * TOEPLITZ_PI * k / size;
+        fft->cosines[k] = (float) cos(angle);
+        fft->sines[k]   = (float) sin(angle);
+    }
+
+    return true;
+}
+
+// In-place radix-2 FFT on split real and imaginary parts. The inverse
+// conjugates the twiddle factors and is left unscaled.
+static void
+toeplitz_fft(const toeplitz_fft_t* fft, float* re, float* im, bool inverse) {
+    const uint32_t size = fft->size;
+
+    // Bit-reversal permutation
+    for (uint32_t i = 1, j = 0; i < size; i++) {
+        uint32_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            float t = re[i];
+            re[i]   = re[j];
+            re[j]   = t;
+            t       = im[i];
+            im[i]   = im[j];
+            im[j]   = t;
+        }
+    }
+
+    // Butterflies combining transforms of half the span each stage
+    const float sign = (inverse) ? -1.0f : 1.0f;
+    for (uint32_t half = 1; half < size; half <<= 1) {
+        const uint32_t step = size / (2 * half);
+        for (uint32_t start = 0; start < size; start += 2 * half) {
+            for (uint32_t j = 0; j < half; j++) {
+                const float    wr = fft->cosines[j * step];
+                const float    wi = sign * fft->sines[j * step];
+                const uint32_t p  = start + j;
+                const uint32_t q  = p + half;
+                const float    tr = wr * re[q] - wi * im[q];
+                const float    ti = wr * im[q] + wi * re[q];
+                re[q]             = re[p] - tr;
+                im[q]             = im[p] - ti;
+                re[p]            += tr;
+                im[p]            += ti;
+            }
+        }
+    }
+}
+
+// Multiply the spectrum x by the spectrum h, elementwise
+static void toeplitz_convolve(
+    float*       re,
+    float*       im,
+    const float* h_re,
+    const float* h_im,
+    uint32_t     size
+) {
+    for (uint32_t k = 0; k < size; k++) {
+        const float r = re[k] * h_re[k] - im[k] * h_im[k];
+        const float i = re[k] * h_im[k] + im[k] * h_re[k];
+        re[k]         = r;
+        im[k]         = i;
+    }
+}
+
+// Prepare a DFT of the given order. Bluestein's algorithm writes the DFT as
+// the convolution of the input times a chirp with the conjugate chirp, which
+// a power of two transform covering 2 * order - 1 elements takes.
+static bool toeplitz_dft_create(
+    linear_context_t* context, uint32_t order, toeplitz_dft_t* dft
+) {
+    dft->order = order;
+    if (0 == (order & (order - 1))) {
+        return toeplitz_fft_create(context, order, &dft->fft);
+    }
+
+    uint32_t size = toeplitz_fft_size(toeplitz_diagonals(order));
+    if (0 == size || !toeplitz_fft_create(context, size, &dft->fft)) {
+        return false;
+    }
+
+    size_t chirp   = sizeof(float) * order;
+    size_t kernel  = sizeof(float) * size;
+    dft->chirp_re  = linear_context_scratch_alloc(context, chirp);
+    dft->chirp_im  = linear_context_scratch_alloc(context, chirp);
+    dft->kernel_re = linear_context_scratch_alloc(context, kernel);
+    dft->kernel_im = linear_context_scratch_alloc(context, kernel);
+    if (NULL == dft->chirp_re || NULL == dft->chirp_im
+        || NULL == dft->kernel_re || NULL == dft->kernel_im) {
+        LOG_ERROR("Failed to allocate memory for the chirp.\n");
+        return false;
+    }
+
+    // j^2 is reduced modulo 2 * order first, so the angle stays accurate
+    for (uint32_t j = 0; j < order; j++) {
+        uint64_t square  = (uint64_t) j * j % (2 * (uint64_t) order);
+        double   angle   = -TOEPLITZ_PI * (double) square / order;
+        dft->chirp_re[j] = (float) cos(angle);
+        dft->chirp_im[j] = (float) sin(angle);
+    }
+
+    // The conjugate chirp at offsets -(order - 1) to order - 1, wrapped
+    for (uint32_t k = 0; k < size; k++) {
+        dft->kernel_re[k] = 0.0f;
+        dft->kernel_im[k] = 0.0f;
+    }
+    for (uint32_t j = 0; j < order; j++) {
+        dft->kernel_re[j] = dft->chirp_re[j];
+        dft->kernel_im[j] = -dft->chirp_im[j];
+        if (j > 0) {
+            dft->kernel_re[size - j] = dft->chirp_re[j];
+            dft->kernel_im[size - j] = -dft->chirp_im[j];
+        }
+    }
+    toeplitz_fft(&dft->fft, dft->kernel_re, dft->kernel_im, false);
+
+    return true;
+}
+
+// In-place DFT of order elements. The inverse is left unscaled. work_re and
+// work_im hold dft->fft.size elements each, and are unused for powers of two.
+static void toeplitz_dft(
+    const toeplitz_dft_t* dft,
+    float*                re,
+    float*                im,
+    float*                work_re,
+    float*                work_im,
+    bool                  inverse
+) {
+    const uint32_t n    = dft->order;
+    const uint32_t size = dft->fft.size;
+    if (size == n) {
+        toeplitz_fft(&dft->fft, re, im, inverse);
+        return;
+    }
+
+    // The inverse DFT is the conjugate of the DFT of the conjugate
+    const float sign = (inverse) ? -1.0f : 1.0f;
+    for (uint32_t j = 0; j < n; j++) {
+        const float xr = re[j];
+        const float xi = sign * im[j];
+        work_re[j]     = xr * dft->chirp_re[j] - xi * dft->chirp_im[j];
+        work_im[j]     = xr * dft->chirp_im[j] + xi * dft->chirp_re[j];
+    }
+    for (uint32_t j = n; j < size; j++) {
+        work_re[j] = 0.0f;
+        work_im[j] = 0.0f;
+    }
+
+    toeplitz_fft(&dft->fft, work_re, work_im, false);
+    toeplitz_convolve(work_re, work_im, dft->kernel_re, dft->kernel_im, size);
+    toeplitz_fft(&dft->fft, work_re, work_im, true);
+
+    const float scale = 1.0f / size;
+    for (uint32_t k = 0; k < n; k++) {
+        const float yr = work_re[k] * scale;
+        const float yi = work_im[k] * scale;
+        const float zi = yr * dft->chirp_im[k] + yi * dft->chirp_re[k];
+        re[k]          = yr * dft->chirp_re[k] - yi * dft->chirp_im[k];
+        im[k]          = sign * zi;
+    }
+}
+
+// Products
+
+// Operands of a product by the diagonals of a Toeplitz matrix
+typedef struct ToeplitzOp {
+    linear_context_t* context;  // Context whose scratch the tasks allocate
+    toeplitz_fft_t    fft;      // Transform, of size 0 for direct sums
+    const float*      h;        // The 2n - 1 diagonals
+    const float*      h_re;     // Spectrum of the diagonals, if transformed
+    const float*      h_im;     // Imaginary parts of the same
+    const float*      x;        // The n x p operand
+    float*            y;        // The n x p result
+    uint32_t          order;    // Order n of the matrix
+    uint32_t          columns;  // Columns p of the operand and result
+    float             alpha;    // Scales the product
+    float             beta;     // Scales the result before accumulating
+    atomic_uint       failures; // Tasks that failed to allocate
+} toeplitz_op_t;
+
+// Range kernel multiplying columns [begin, end) of x into those of y, each
+// by direct sums or by the convolution theorem
+static void toeplitz_product_routine(thread_data_t* task) {
+    toeplitz_op_t* op   = (toeplitz_op_t*) task->a;
+    const uint32_t n    = op->order;
+    const uint32_t p    = op->columns;
+    const uint32_t size = op->fft.size;
+
+    size_t mark  = linear_context_scratch_mark(op->context);
+    size_t count = (size) ? size : n;
+    float* re    = linear_context_scratch_alloc(
+        op->context, sizeof(float) * count
+    );
+    float* im    = linear_context_scratch_alloc(
+        op->context, sizeof(float) * count
+    );
+    if (NULL == re || NULL == im) {
+        LOG_ERROR("Failed to allocate memory for the product.\n");
+        atomic_fetch_add(&op->failures, 1);
+        linear_context_scratch_release(op->context, mark);
+        return;
+    }
+
+    // The product is the middle n elements of the convolution h * x
+    const float* product = (size) ? re + n - 1 : im;
+    const float  scale   = (size) ? op->alpha / size : op->alpha;
+
+    for (uint32_t j = task->begin; j < task->end; j++) {
+        for (uint32_t i = 0; i < n; i++) {
+            re[i] = op->x[(size_t) i * p + j];
+        }
+
+        if (size) {
+            for (uint32_t i = n; i < size; i++) {
+                re[i] = 0.0f;
+            }
+            for (uint32_t i = 0; i < size; i++) {
+                im[i] = 0.0f;
+            }
+            toeplitz_fft(&op->fft, re, im, false);
+            toeplitz_convolve(re, im, op->h_re, op->h_im, size);
+            toeplitz_fft(&op->fft, re, im, true);
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                const float* d   = op->h + n - 1 + i;
+                float        sum = 0.0f;
+                for (uint32_t k = 0; k < n; k++) {
+                    sum += *(d - k) * re[k];
+                }
+                im[i] = sum;
+            }
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            float* y = op->y + (size_t) i * p + j;
+            *y       = (0.0f == op->beta) ? scale * product[i]
+                                          : scale * product[i] + op->beta * *y;
+        }
+    }
+
+    linear_context_scratch_release(op->context, mark);
+}
+
+// Multiply the n x p operand x by the Toeplitz matrix with diagonals h,
+// transforming h once when the order calls for FFT products
+static bool toeplitz_product(
+    linear_context_t* context,
+    const float*      h,
+    uint32_t          n,
+    float             alpha,
+    const float*      x,
+    float             beta,
+    float*            y,
+    uint32_t          p
+) {
+    size_t mark = linear_context_scratch_mark(context);
+
+    toeplitz_op_t op = {
+        .context = context,
+        .h       = h,
+        .x       = x,
+        .y       = y,
+        .order   = n,
+        .columns = p,
+        .alpha   = alpha,
+        .beta    = beta,
+    };
+    atomic_init(&op.failures, 0);
+
+    uint64_t work = (uint64_t) p * n * n;
+    if (n > LINEAR_TOEPLITZ_DIRECT) {
+        uint32_t size = toeplitz_fft_size(toeplitz_diagonals(n));
+        float*   re   = linear_context_scratch_alloc(
+            context, sizeof(float) * size
+        );
+        float*   im   = linear_context_scratch_alloc(
+            context, sizeof(float) * size
+        );
+        if (0 == size || NULL == re || NULL == im
+            || !toeplitz_fft_create(context, size, &op.fft)) {
+            LOG_ERROR("Failed to allocate memory for the spectrum.\n");
+            linear_context_scratch_release(context, mark);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < size; i++) {
+            re[i] = (i < 2 * n - 1) ? h[i] : 0.0f;
+            im[i] = 0.0f;
+        }
+        toeplitz_fft(&op.fft, re, im, false);
+        op.h_re = re;
+        op.h_im = im;
+
+        // Two transforms of log2(size) stages per column
+        uint32_t stages = 0;
+        for (uint32_t s = size; s > 1; s >>= 1) {
+            stages++;
+        }
+        work = (uint64_t) p * size * (2 * stages + 1);
+    }
+
+    thread_data_t task = {
+        .a       = &op,
+        .type    = NUMERIC_FLOAT32,
+        .routine = toeplitz_product_routine,
+    };
+
+    bool done = linear_context_parallel_work(context, task, p, work)
+                && 0 == atomic_load(&op.failures);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+// Verify the operands of a GEMV by a structured matrix of order n
+static bool
+toeplitz_gemv_is_valid(const vector_t* x, const vector_t* y, uint32_t n) {
+    if (!toeplitz_vector_is_valid(x, n) || !toeplitz_vector_is_valid(y, n)) {
+        return false;
+    }
+
+    if (x->data == y->data) {
+        LOG_ERROR("GEMV input and output vectors must not overlap.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Verify the operands of a GEMM by a structured matrix of order n
+static bool
+toeplitz_gemm_is_valid(const matrix_t* b, const matrix_t* c, uint32_t n) {
+    if (NULL == b || NULL == c) {
+        return false;
+    }
+
+    if (n != b->rows || n != c->rows || b->columns != c->columns) {
+        LOG_ERROR(
+            "Matrix dimensions do not match. Cannot multiply a matrix of "
+            "order %u by %ux%u into %ux%u.\n",
+            n,
+            b->rows,
+            b->columns,
+            c->rows,
+            c->columns
+        );
+        return false;
+    }
+
+    if (b->data == c->data) {
+        LOG_ERROR("GEMM input and output matrices must not overlap.\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool toeplitz_gemv_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const toeplitz_t* a,
+    const vector_t*   x,
+    float             beta,
+    vector_t*         y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_gemv_is_valid(x, y, a->order)) {
+        return false;
+    }
+
+    return toeplitz_product(
+        context, a->data, a->order, alpha, x->data, beta, y->data, 1
+    );
+}
+
+bool toeplitz_gemm_ctx(
+    linear_context_t* context,
+    float             alpha,
+    const toeplitz_t* a,
+    const matrix_t*   b,
+    float             beta,
+    matrix_t*         c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_gemm_is_valid(b, c, a->order)) {
+        return false;
+    }
+
+    matrix_invalidate(c);
+    return toeplitz_product(
+        context, a->data, a->order, alpha, b->data, beta, c->data, b->columns
+    );
+}
+
+// Multiply by a circulant matrix through its Toeplitz diagonals
+static bool circulant_product(
+    linear_context_t*  context,
+    const circulant_t* a,
+    float              alpha,
+    const float*       x,
+    float              beta,
+    float*             y,
+    uint32_t           p
+) {
+    size_t mark = linear_context_scratch_mark(context);
+    float* h    = linear_context_scratch_alloc(
+        context, sizeof(float) * toeplitz_diagonals(a->order)
+    );
+    if (NULL == h && a->order > 0) {
+        LOG_ERROR("Failed to allocate memory for the diagonals.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    circulant_diagonals(a->data, a->order, h);
+    bool done = toeplitz_product(context, h, a->order, alpha, x, beta, y, p);
+    linear_context_scratch_release(context, mark);
+    return done;
+}
+
+bool circulant_gemv_ctx(
+    linear_context_t*  context,
+    float              alpha,
+    const circulant_t* a,
+    const vector_t*    x,
+    float              beta,
+    vector_t*          y
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_gemv_is_valid(x, y, a->order)) {
+        return false;
+    }
+
+    return circulant_product(context, a, alpha, x->data, beta, y->data, 1);
+}
+
+bool circulant_gemm_ctx(
+    linear_context_t*  context,
+    float              alpha,
+    const circulant_t* a,
+    const matrix_t*    b,
+    float              beta,
+    matrix_t*          c
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_gemm_is_valid(b, c, a->order)) {
+        return false;
+    }
+
+    matrix_invalidate(c);
+    return circulant_product(
+        context, a, alpha, b->data, beta, c->data, b->columns
+    );
+}
+
+// Solvers
+
+bool toeplitz_solve_ctx(
+    linear_context_t* context,
+    const toeplitz_t* a,
+    const vector_t*   b,
+    vector_t*         x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_vector_is_valid(b, a->order)
+        || !toeplitz_vector_is_valid(x, a->order)) {
+        return false;
+    }
+
+    const uint32_t n = a->order;
+    if (0 == n) {
+        return true;
+    }
+
+    // t[d] is the element (i, j) of the matrix where d = i - j
+    const float* t   = a->data + n - 1;
+    const float* rhs = (const float*) b->data;
+
+    size_t  mark = linear_context_scratch_mark(context);
+    double* f    = linear_context_scratch_alloc(context, sizeof(double) * n);
+    double* g    = linear_context_scratch_alloc(context, sizeof(double) * n);
+    double* nf   = linear_context_scratch_alloc(context, sizeof(double) * n);
+    double* ng   = linear_context_scratch_alloc(context, sizeof(double) * n);
+    double* s    = linear_context_scratch_alloc(context, sizeof(double) * n);
+    if (NULL == f || NULL == g || NULL == nf || NULL == ng || NULL == s) {
+        LOG_ERROR("Failed to allocate memory for the recursion.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    if (0.0f == t[0]) {
+        LOG_ERROR("Leading principal submatrix of order 1 is singular.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    // f and g solve the leading m x m system for the first and last unit
+    // vectors, s for the first m elements of b
+    f[0] = 1.0 / t[0];
+    g[0] = f[0];
+    s[0] = rhs[0] / (double) t[0];
+
+    for (uint32_t m = 1; m < n; m++) {
+        // Residuals left by extending each solution with a zero
+        double ef = 0.0;
+        double eg = 0.0;
+        double es = 0.0;
+        for (uint32_t j = 0; j < m; j++) {
+            ef += (double) t[m - j] * f[j];
+            eg += (double) *(t - j - 1) * g[j];
+            es += (double) t[m - j] * s[j];
+        }
+
+        double denominator = 1.0 - ef * eg;
+        if (fabs(denominator) < DBL_EPSILON) {
+            LOG_ERROR(
+                "Leading principal submatrix of order %u is singular.\n", m + 1
+            );
+            linear_context_scratch_release(context, mark);
+            return false;
+        }
+
+        // [f, 0] and [0, g] combine to cancel each other's residual
+        double scale = 1.0 / denominator;
+        nf[0]        = f[0] * scale;
+        ng[0]        = -eg * f[0] * scale;
+        for (uint32_t j = 1; j < m; j++) {
+            nf[j] = (f[j] - ef * g[j - 1]) * scale;
+            ng[j] = (g[j - 1] - eg * f[j]) * scale;
+        }
+        nf[m] = -ef * g[m - 1] * scale;
+        ng[m] = g[m - 1] * scale;
+
+        double* swap = f;
+        f            = nf;
+        nf           = swap;
+        swap         = g;
+        g            = ng;
+        ng           = swap;
+
+        // [s, 0] misses the new element of b by rhs[m] - es along g
+        double d = rhs[m] - es;
+        for (uint32_t j = 0; j < m; j++) {
+            s[j] += d * g[j];
+        }
+        s[m] = d * g[m];
+    }
+
+    float* solution = (float*) x->data;
+    for (uint32_t i = 0; i < n; i++) {
+        solution[i] = (float) s[i];
+    }
+
+    linear_context_scratch_release(context, mark);
+    return true;
+}
+
+bool circulant_solve_ctx(
+    linear_context_t*  context,
+    const circulant_t* a,
+    const vector_t*    b,
+    vector_t*          x
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !toeplitz_vector_is_valid(b, a->order)
+        || !toeplitz_vector_is_valid(x, a->order)) {
+        return false;
+    }
+
+    const uint32_t n = a->order;
+    if (0 == n) {
+        return true;
+    }
+
+    size_t         mark = linear_context_scratch_mark(context);
+    toeplitz_dft_t dft  = {0};
+    if (!toeplitz_dft_create(context, n, &dft)) {
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    size_t count  = (size_t) n * 4 + (size_t) dft.fft.size * 2;
+    float* buffer = linear_context_scratch_alloc(
+        context, sizeof(float) * count
+    );
+    if (NULL == buffer) {
+        LOG_ERROR("Failed to allocate memory for the spectra.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    float* l_re    = buffer;
+    float* l_im    = l_re + n;
+    float* x_re    = l_im + n;
+    float* x_im    = x_re + n;
+    float* work_re = x_im + n;
+    float* work_im = work_re + dft.fft.size;
+
+    // The eigenvalues are the DFT of the first column
+    const float* rhs = (const float*) b->data;
+    for (uint32_t i = 0; i < n; i++) {
+        l_re[i] = a->data[i];
+        l_im[i] = 0.0f;
+        x_re[i] = rhs[i];
+        x_im[i] = 0.0f;
+    }
+    toeplitz_dft(&dft, l_re, l_im, work_re, work_im, false);
+    toeplitz_dft(&dft, x_re, x_im, work_re, work_im, false);
+
+    float largest = 0.0f;
+    for (uint32_t k = 0; k < n; k++) {
+        largest = fmaxf(largest, hypotf(l_re[k], l_im[k]));
+    }
+
+    // Eigenvalues lost in the rounding of the transform are taken as zero
+    const float tolerance = largest * FLT_EPSILON * n;
+    for (uint32_t k = 0; k < n; k++) {
+        const float norm = l_re[k] * l_re[k] + l_im[k] * l_im[k];
+        if (!(sqrtf(norm) > tolerance)) {
+            LOG_ERROR("Circulant matrix is singular.\n");
+            linear_context_scratch_release(context, mark);
+            return false;
+        }
+
+        // x / l = x * conj(l) / |l|^2
+        const float re = (x_re[k] * l_re[k] + x_im[k] * l_im[k]) / norm;
+        const float im = (x_im[k] * l_re[k] - x_re[k] * l_im[k]) / norm;
+        x_re[k]        = re;
+        x_im[k]        = im;
+    }
+    toeplitz_dft(&dft, x_re, x_im, work_re, work_im, true);
+
+    float* solution = (float*) x->data;
+    for (uint32_t i = 0; i < n; i++) {
+        solution[i] = x_re[i] / n;
+    }
+
+    linear_context_scratch_release(context, mark);
+    return true;
+}
@@ -18,7 +18,9 @@
 #include "logger.h"
 #include "thread.h"
 
+#include <float.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -385,14 +387,15 @@ float vector_mean(const vector_t* vector) {
 
     float sum = 0.0f;
     for (uint32_t i = 0; i < vector->columns; i++) {
-        if (isnan(vector->data[i])) {
-            // Log error and return NAN if any element is NaN
-            LOG_ERROR("NaN element found at index %zu.\n", i);
-            return NAN;
-        }
         sum += vector->data[i];
     }
 
+    // A NaN element or infinities of opposite sign both yield a NaN sum
+    if (isnan(sum)) {
+        LOG_ERROR("Non-finite sum of the vector elements.\n");
+        return NAN;
+    }
+
     return sum / vector->columns; // Return the mean
 }
 
@@ -599,3 +602,1898 @@ vector_t* vector_cartesian_to_polar(const vector_t* cartesian_vector) {
 
     return polar_vector;
 }
+
+// Context operations
+
+// Allocate a zero initialized vector of the given type using the context
+static vector_t* vector_allocate_ctx(
+    linear_context_t* context, const uint32_t columns, numeric_data_t type
+) {
+    size_t size = numeric_data_size(type);
+    if (0 == size) {
+        LOG_ERROR("Unsupported vector data type %d.\n", type);
+        return NULL;
+    }
+
+    vector_t* vector = linear_context_allocate(context, sizeof(vector_t));
+    if (NULL == vector) {
+        LOG_ERROR("Failed to allocate memory for struct Vector.\n");
+        return NULL;
+    }
+
+    vector->data = linear_context_allocate(context, columns * size);
+    if (NULL == vector->data) {
+        LOG_ERROR("Failed to allocate %u elements to vector->data.\n", columns
+        );
+        linear_context_release(context, vector);
+        return NULL;
+    }
+
+    // zero every byte; all supported types represent zero as all bits clear
+    uint8_t* bytes = (uint8_t*) vector->data;
+    for (size_t i = 0; i < columns * size; i++) {
+        bytes[i] = 0;
+    }
+
+    vector->columns = columns;
+    vector->type    = type;
+
+    return vector;
+}
+
+vector_t*
+vector_create_ctx(linear_context_t* context, const uint32_t columns) {
+    context = linear_context_resolve(context);
+    return vector_allocate_ctx(context, columns, context->precision);
+}
+
+void vector_free_ctx(linear_context_t* context, vector_t* vector) {
+    if (NULL == vector) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, vector->data);
+    linear_context_release(context, vector);
+}
+
+vector_t* vector_deep_copy_ctx(
+    linear_context_t* context, const vector_t* vector
+) {
+    if (NULL == vector) {
+        return NULL;
+    }
+
+    context = linear_context_resolve(context);
+    vector_t* deep_copy
+        = vector_allocate_ctx(context, vector->columns, vector->type);
+    if (NULL == deep_copy) {
+        return NULL;
+    }
+
+    size_t         bytes  = vector->columns * numeric_data_size(vector->type);
+    const uint8_t* source = (const uint8_t*) vector->data;
+    uint8_t*       target = (uint8_t*) deep_copy->data;
+    for (size_t i = 0; i < bytes; i++) {
+        target[i] = source[i];
+    }
+
+    return deep_copy;
+}
+
+// Range kernel writing the scalar pointed to by b into result
+static void vector_fill_routine(thread_data_t* task) {
+    float* z     = (float*) ((vector_t*) task->result)->data;
+    float  value = *(const float*) task->b;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = value;
+    }
+}
+
+bool vector_fill_ctx(
+    linear_context_t* context, vector_t* vector, const float value
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR("Vector fill requires NUMERIC_FLOAT32 elements.\n");
+        return false;
+    }
+
+    thread_data_t task = {
+        .b       = (void*) &value,
+        .result  = vector,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_fill_routine,
+    };
+
+    return linear_context_parallel(context, task, vector->columns);
+}
+
+vector_t* vector_shallow_copy_ctx(
+    linear_context_t* context, const vector_t* vector
+) {
+    if (NULL == vector) {
+        return NULL;
+    }
+
+    context = linear_context_resolve(context);
+    // Allocate the structure only, the elements remain owned by vector
+    vector_t* shallow_copy
+        = linear_context_allocate(context, sizeof(vector_t));
+    if (NULL == shallow_copy) {
+        LOG_ERROR("Failed to allocate memory for struct Vector.\n");
+        return NULL;
+    }
+
+    shallow_copy->data    = vector->data;
+    shallow_copy->columns = vector->columns;
+    shallow_copy->type    = vector->type;
+
+    return shallow_copy;
+}
+
+// Range kernel for vector-scalar operations
+static void vector_scalar_routine(thread_data_t* task) {
+    const vector_t* a      = (const vector_t*) task->a;
+    vector_t*       result = (vector_t*) task->result;
+    size_t          size   = numeric_data_size(task->type);
+    uint8_t*        x      = (uint8_t*) a->data;
+    uint8_t*        z      = (uint8_t*) result->data;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        task->operation(x + i * size, task->b, z + i * size, task->type);
+    }
+}
+
+vector_t* vector_scalar_operation_ctx(
+    linear_context_t*  context,
+    const vector_t*    a,
+    const void*        b,
+    scalar_operation_t operation
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    vector_t* result = vector_allocate_ctx(context, a->columns, a->type);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory for the resultant vector.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a         = (void*) a,
+        .b         = (void*) b,
+        .result    = result,
+        .type      = a->type,
+        .operation = operation,
+        .routine   = vector_scalar_routine,
+    };
+
+    if (!linear_context_parallel(context, task, a->columns)) {
+        vector_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+vector_t* vector_scalar_add_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+) {
+    return vector_scalar_operation_ctx(context, a, b, scalar_add);
+}
+
+vector_t* vector_scalar_subtract_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+) {
+    return vector_scalar_operation_ctx(context, a, b, scalar_subtract);
+}
+
+vector_t* vector_scalar_multiply_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+) {
+    return vector_scalar_operation_ctx(context, a, b, scalar_multiply);
+}
+
+vector_t* vector_scalar_divide_ctx(
+    linear_context_t* context, const vector_t* a, const void* b
+) {
+    return vector_scalar_operation_ctx(context, a, b, scalar_divide);
+}
+
+// Range kernel for vector-vector operations
+static void vector_vector_routine(thread_data_t* task) {
+    const vector_t* a      = (const vector_t*) task->a;
+    const vector_t* b      = (const vector_t*) task->b;
+    vector_t*       result = (vector_t*) task->result;
+    size_t          size   = numeric_data_size(task->type);
+    uint8_t*        x      = (uint8_t*) a->data;
+    uint8_t*        y      = (uint8_t*) b->data;
+    uint8_t*        z      = (uint8_t*) result->data;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        task->operation(x + i * size, y + i * size, z + i * size, task->type);
+    }
+}
+
+vector_t* vector_vector_operation_ctx(
+    linear_context_t*  context,
+    const vector_t*    a,
+    const vector_t*    b,
+    scalar_operation_t operation
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (a->columns != b->columns || a->type != b->type) {
+        LOG_ERROR(
+            "Vector dimensions do not match. Cannot perform operation on "
+            "vectors of size %u and %u.\n",
+            a->columns,
+            b->columns
+        );
+        return NULL;
+    }
+
+    vector_t* result = vector_allocate_ctx(context, a->columns, a->type);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory for the resultant vector.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a         = (void*) a,
+        .b         = (void*) b,
+        .result    = result,
+        .type      = a->type,
+        .operation = operation,
+        .routine   = vector_vector_routine,
+    };
+
+    if (!linear_context_parallel(context, task, a->columns)) {
+        vector_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+vector_t* vector_vector_add_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    return vector_vector_operation_ctx(context, a, b, scalar_add);
+}
+
+vector_t* vector_vector_subtract_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    return vector_vector_operation_ctx(context, a, b, scalar_subtract);
+}
+
+vector_t* vector_vector_multiply_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    return vector_vector_operation_ctx(context, a, b, scalar_multiply);
+}
+
+vector_t* vector_vector_divide_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    return vector_vector_operation_ctx(context, a, b, scalar_divide);
+}
+
+// Range kernels for float reductions, each accumulating a partial sum into
+// result since a scheduled task may execute several chunks
+
+static void vector_sum_routine(thread_data_t* task) {
+    const float* x   = (const float*) ((const vector_t*) task->a)->data;
+    float        sum = 0.0f;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        sum += x[i];
+    }
+    *(float*) task->result += sum;
+}
+
+static void vector_dot_routine(thread_data_t* task) {
+    const float* x   = (const float*) ((const vector_t*) task->a)->data;
+    const float* y   = (const float*) ((const vector_t*) task->b)->data;
+    float        sum = 0.0f;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        sum += x[i] * y[i];
+    }
+    *(float*) task->result += sum;
+}
+
+static void vector_distance_routine(thread_data_t* task) {
+    const float* x   = (const float*) ((const vector_t*) task->a)->data;
+    const float* y   = (const float*) ((const vector_t*) task->b)->data;
+    float        sum = 0.0f;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float d  = x[i] - y[i];
+        sum     += d * d;
+    }
+    *(float*) task->result += sum;
+}
+
+// Split a float reduction into chunks, execute them, and sum the partials
+static float vector_reduce_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    const vector_t*   b,
+    thread_routine_t  routine
+) {
+    if (NULL == a || NULL == a->data || !linear_context_is_cpu(context)) {
+        return NAN;
+    }
+
+    if (NUMERIC_FLOAT32 != a->type || (b && NUMERIC_FLOAT32 != b->type)) {
+        LOG_ERROR("Vector reductions require NUMERIC_FLOAT32 elements.\n");
+        return NAN;
+    }
+
+    if (b && a->columns != b->columns) {
+        LOG_ERROR(
+            "Vector dimensions do not match. Cannot perform operation on "
+            "vectors of size %u and %u.\n",
+            a->columns,
+            b->columns
+        );
+        return NAN;
+    }
+
+    thread_data_t task = {
+        .a       = (void*) a,
+        .b       = (void*) b,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    size_t         mark       = linear_context_scratch_mark(context);
+    uint32_t       task_count = 0;
+    float*         partials   = NULL;
+    thread_data_t* tasks      = linear_context_split_scratch(
+        context, task, a->columns, &task_count
+    );
+    if (tasks) {
+        size_t size = sizeof(float) * task_count;
+        partials    = linear_context_scratch_alloc(context, size);
+    }
+    if (NULL == tasks || NULL == partials) {
+        LOG_ERROR("Failed to allocate memory for the partial results.\n");
+        linear_context_scratch_release(context, mark);
+        return NAN;
+    }
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        partials[i]     = 0.0f; // routines accumulate, see the schedule
+        tasks[i].result = &partials[i];
+    }
+    linear_context_schedule(context, tasks, task_count, a->columns);
+
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < task_count; i++) {
+        sum += partials[i];
+    }
+
+    linear_context_scratch_release(context, mark);
+    return sum;
+}
+
+float vector_magnitude_ctx(linear_context_t* context, const vector_t* vector) {
+    context = linear_context_resolve(context);
+    float sum = vector_reduce_ctx(context, vector, vector, vector_dot_routine);
+    return sqrtf(sum);
+}
+
+float vector_distance_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    context = linear_context_resolve(context);
+    if (NULL == b) {
+        return NAN;
+    }
+    return sqrtf(vector_reduce_ctx(context, a, b, vector_distance_routine));
+}
+
+float vector_mean_ctx(linear_context_t* context, const vector_t* vector) {
+    if (NULL == vector || 0 == vector->columns) {
+        return NAN; // Return NAN for invalid input
+    }
+
+    context = linear_context_resolve(context);
+    float sum = vector_reduce_ctx(context, vector, NULL, vector_sum_routine);
+    return sum / vector->columns;
+}
+
+float vector_dot_product_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    context = linear_context_resolve(context);
+    if (NULL == b) {
+        return NAN;
+    }
+    return vector_reduce_ctx(context, a, b, vector_dot_routine);
+}
+
+// Range kernel scaling a into result by the scalar pointed to by b
+static void vector_scale_routine(thread_data_t* task) {
+    const float* x      = (const float*) ((const vector_t*) task->a)->data;
+    float*       z      = (float*) ((vector_t*) task->result)->data;
+    float        scalar = *(const float*) task->b;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = x[i] * scalar;
+    }
+}
+
+vector_t* vector_scale_ctx(
+    linear_context_t* context, vector_t* vector, float scalar, bool inplace
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR("Vector scaling requires NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    vector_t* result = vector;
+    if (!inplace) {
+        result = vector_allocate_ctx(context, vector->columns, vector->type);
+        if (NULL == result) {
+            LOG_ERROR("Failed to allocate memory for scaled vector.\n");
+            return NULL;
+        }
+    }
+
+    thread_data_t task = {
+        .a       = vector,
+        .b       = &scalar,
+        .result  = result,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_scale_routine,
+    };
+
+    if (!linear_context_parallel(context, task, vector->columns)) {
+        if (!inplace) {
+            vector_free_ctx(context, result);
+        }
+        return NULL;
+    }
+
+    return result;
+}
+
+// Range kernel dividing a into result by the magnitude pointed to by b
+static void vector_normalize_routine(thread_data_t* task) {
+    const float* x         = (const float*) ((const vector_t*) task->a)->data;
+    float*       z         = (float*) ((vector_t*) task->result)->data;
+    float        magnitude = *(const float*) task->b;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        z[i] = x[i] / magnitude;
+    }
+}
+
+vector_t* vector_normalize_ctx(
+    linear_context_t* context, vector_t* vector, bool inplace
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR("Vector normalization requires NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    float magnitude = vector_magnitude_ctx(context, vector);
+    if (0 == magnitude) {
+        LOG_ERROR("Cannot normalize a zero-length vector.\n");
+        return NULL;
+    }
+
+    vector_t* result = vector;
+    if (!inplace) {
+        result = vector_allocate_ctx(context, vector->columns, vector->type);
+        if (NULL == result) {
+            LOG_ERROR(
+                "Failed to allocate memory for the normalized unit vector.\n"
+            );
+            return NULL;
+        }
+    }
+
+    thread_data_t task = {
+        .a       = vector,
+        .b       = &magnitude,
+        .result  = result,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_normalize_routine,
+    };
+
+    if (!linear_context_parallel(context, task, vector->columns)) {
+        if (!inplace) {
+            vector_free_ctx(context, result);
+        }
+        return NULL;
+    }
+
+    return result;
+}
+
+// Range kernel clamping a into result by the bounds pointed to by b
+static void vector_clip_routine(thread_data_t* task) {
+    const float* x      = (const float*) ((const vector_t*) task->a)->data;
+    float*       z      = (float*) ((vector_t*) task->result)->data;
+    const float* bounds = (const float*) task->b;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float value = (x[i] < bounds[0]) ? bounds[0] : x[i];
+        z[i]        = (value > bounds[1]) ? bounds[1] : value;
+    }
+}
+
+vector_t* vector_clip_ctx(
+    linear_context_t* context,
+    vector_t*         vector,
+    float             min,
+    float             max,
+    bool              inplace
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || 0 == vector->columns
+        || !linear_context_is_cpu(context)) {
+        return NULL;
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR("Vector clipping requires NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    vector_t* result = vector;
+    if (!inplace) {
+        result = vector_allocate_ctx(context, vector->columns, vector->type);
+        if (NULL == result) {
+            return NULL; // vector_allocate_ctx logs the error for us
+        }
+    }
+
+    float         bounds[2] = {min, max};
+    thread_data_t task      = {
+        .a       = vector,
+        .b       = bounds,
+        .result  = result,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_clip_routine,
+    };
+
+    if (!linear_context_parallel(context, task, vector->columns)) {
+        if (!inplace) {
+            vector_free_ctx(context, result);
+        }
+        return NULL;
+    }
+
+    return result;
+}
+
+// Fixed size operations, computed on the calling thread since there is
+// nothing to split, with the result allocated by the context
+
+vector_t* vector_cross_product_ctx(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    if (NULL == a || NULL == b) {
+        return NULL;
+    }
+
+    // Ensure both vectors are 3-dimensional.
+    if (a->columns != 3 || b->columns != 3) {
+        LOG_ERROR("Cross product is only defined for 3-dimensional vectors.\n"
+        );
+        return NULL;
+    }
+
+    if (NUMERIC_FLOAT32 != a->type || NUMERIC_FLOAT32 != b->type) {
+        LOG_ERROR("Cross product requires NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    context          = linear_context_resolve(context);
+    vector_t* result = vector_allocate_ctx(context, 3, NUMERIC_FLOAT32);
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory for cross product vector.\n");
+        return NULL;
+    }
+
+    const float* x = (const float*) a->data;
+    const float* y = (const float*) b->data;
+    float*       z = (float*) result->data;
+
+    z[0] = x[1] * y[2] - x[2] * y[1];
+    z[1] = x[2] * y[0] - x[0] * y[2];
+    z[2] = x[0] * y[1] - x[1] * y[0];
+
+    return result;
+}
+
+// Validate a 2-dimensional coordinate and allocate its conversion
+static vector_t* vector_coordinate_ctx(
+    linear_context_t* context, const vector_t* vector
+) {
+    if (NULL == vector || vector->columns != 2) {
+        return NULL; // Return NULL if input is invalid
+    }
+
+    if (NUMERIC_FLOAT32 != vector->type) {
+        LOG_ERROR("Coordinates require NUMERIC_FLOAT32 elements.\n");
+        return NULL;
+    }
+
+    context = linear_context_resolve(context);
+    return vector_allocate_ctx(context, 2, NUMERIC_FLOAT32);
+}
+
+vector_t* vector_polar_to_cartesian_ctx(
+    linear_context_t* context, const vector_t* polar_vector
+) {
+    vector_t* cartesian_vector = vector_coordinate_ctx(context, polar_vector);
+    if (NULL == cartesian_vector) {
+        return NULL;
+    }
+
+    const float* polar     = (const float*) polar_vector->data;
+    float*       cartesian = (float*) cartesian_vector->data;
+
+    cartesian[0] = polar[0] * cosf(polar[1]); // x = r * cos(θ)
+    cartesian[1] = polar[0] * sinf(polar[1]); // y = r * sin(θ)
+
+    return cartesian_vector;
+}
+
+vector_t* vector_cartesian_to_polar_ctx(
+    linear_context_t* context, const vector_t* cartesian_vector
+) {
+    vector_t* polar_vector = vector_coordinate_ctx(context, cartesian_vector);
+    if (NULL == polar_vector) {
+        return NULL;
+    }
+
+    const float* cartesian = (const float*) cartesian_vector->data;
+    float*       polar     = (float*) polar_vector->data;
+    float        x         = cartesian[0];
+    float        y         = cartesian[1];
+
+    polar[0] = sqrtf(x * x + y * y); // r = √(x^2 + y^2)
+    polar[1] = atan2f(y, x);         // θ = atan (y, x)
+
+    return polar_vector;
+}
+
+// Comparison, masks and selection
+
+// Operands of the mask kernels, passed to each task through task->a
+typedef struct VectorLanes {
+    const uint64_t* bits;    // Input mask, if any
+    const uint64_t* other;   // Second input mask, if any
+    uint64_t*       mask;    // Output mask, if any
+    const float*    x;       // First operand
+    const float*    y;       // Second operand, or a scalar
+    float*          z;       // Result, if any
+    uint32_t*       indices; // Positions of compacted elements, if any
+    uint32_t        columns; // Number of elements
+    uint32_t        stride;  // Stride of y, 0 for a scalar
+    uint32_t        code;    // Comparison outcomes or arithmetic operation
+} vector_lanes_t;
+
+// Outcomes of x against y selected by each comparison, with the result
+// inverted for VECTOR_COMPARE_NE so that NaN compares unequal
+enum {
+    VECTOR_OUTCOME_LT     = 1,
+    VECTOR_OUTCOME_EQ     = 2,
+    VECTOR_OUTCOME_GT     = 4,
+    VECTOR_OUTCOME_INVERT = 8,
+};
+
+static const uint32_t vector_compare_outcomes[VECTOR_COMPARE_COUNT] = {
+    [VECTOR_COMPARE_EQ] = VECTOR_OUTCOME_EQ,
+    [VECTOR_COMPARE_NE] = VECTOR_OUTCOME_EQ | VECTOR_OUTCOME_INVERT,
+    [VECTOR_COMPARE_LT] = VECTOR_OUTCOME_LT,
+    [VECTOR_COMPARE_LE] = VECTOR_OUTCOME_LT | VECTOR_OUTCOME_EQ,
+    [VECTOR_COMPARE_GT] = VECTOR_OUTCOME_GT,
+    [VECTOR_COMPARE_GE] = VECTOR_OUTCOME_GT | VECTOR_OUTCOME_EQ,
+};
+
+// Arithmetic applied by the masked kernel
+typedef enum VectorMaskedOp {
+    VECTOR_MASKED_ADD,
+    VECTOR_MASKED_SUBTRACT,
+    VECTOR_MASKED_MULTIPLY,
+    VECTOR_MASKED_DIVIDE,
+} vector_masked_op_t;
+
+static inline uint32_t vector_mask_words(uint32_t columns) {
+    return (columns + 63) / 64;
+}
+
+// Valid bits of word w of a mask over the given number of elements
+static inline uint64_t vector_mask_tail(uint32_t columns, uint32_t w) {
+    uint32_t remaining = columns - w * 64;
+    return (remaining >= 64) ? ~UINT64_C(0)
+                             : (UINT64_C(1) << remaining) - 1;
+}
+
+static inline uint32_t vector_mask_bit(const uint64_t* bits, uint32_t i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+// Select a if bit is set and b otherwise, without branching
+static inline float vector_blend(float a, float b, uint32_t bit) {
+    uint32_t i, j;
+    uint32_t mask = -bit;
+    memcpy(&i, &a, sizeof(i));
+    memcpy(&j, &b, sizeof(j));
+    i = (i & mask) | (j & ~mask);
+    memcpy(&a, &i, sizeof(a));
+    return a;
+}
+
+static bool vector_lanes_are_valid(
+    const vector_mask_t* mask, const vector_t* a, const vector_t* b
+) {
+    if ((mask && NULL == mask->bits) || (a && NULL == a->data)
+        || (b && NULL == b->data)) {
+        LOG_ERROR("Masks and vectors must hold elements.\n");
+        return false;
+    }
+
+    if ((a && NUMERIC_FLOAT32 != a->type)
+        || (b && NUMERIC_FLOAT32 != b->type)) {
+        LOG_ERROR("Mask operations require NUMERIC_FLOAT32 elements.\n");
+        return false;
+    }
+
+    uint32_t columns = (mask) ? mask->columns : a->columns;
+    if ((a && a->columns != columns) || (b && b->columns != columns)) {
+        LOG_ERROR(
+            "Vector dimensions do not match. Cannot perform operation on "
+            "%u and %u elements.\n",
+            columns,
+            (a && a->columns != columns) ? a->columns : b->columns
+        );
+        return false;
+    }
+
+    return true;
+}
+
+vector_mask_t*
+vector_mask_create_ctx(linear_context_t* context, uint32_t columns) {
+    context = linear_context_resolve(context);
+
+    vector_mask_t* mask = linear_context_allocate(
+        context, sizeof(vector_mask_t)
+    );
+    if (NULL == mask) {
+        LOG_ERROR("Failed to allocate memory for struct VectorMask.\n");
+        return NULL;
+    }
+
+    uint32_t words = vector_mask_words(columns);
+    mask->bits     = linear_context_allocate(
+        context, sizeof(uint64_t) * ((words) ? words : 1)
+    );
+    if (NULL == mask->bits) {
+        LOG_ERROR("Failed to allocate %u words to mask->bits.\n", words);
+        linear_context_release(context, mask);
+        return NULL;
+    }
+
+    for (uint32_t w = 0; w < words; w++) {
+        mask->bits[w] = 0;
+    }
+    mask->columns = columns;
+
+    return mask;
+}
+
+void vector_mask_free_ctx(linear_context_t* context, vector_mask_t* mask) {
+    if (NULL == mask) {
+        return;
+    }
+
+    context = linear_context_resolve(context);
+    linear_context_release(context, mask->bits);
+    linear_context_release(context, mask);
+}
+
+// Pack up to 32 comparisons into the low bits of a word. The outcomes are
+// combined arithmetically, and in 32-bit lanes, so that the lanes vectorize.
+static inline uint32_t vector_compare_bits(
+    const float* x,
+    const float* y,
+    uint32_t     stride,
+    uint32_t     count,
+    uint32_t     code
+) {
+    uint32_t lt     = (code & VECTOR_OUTCOME_LT) != 0;
+    uint32_t eq     = (code & VECTOR_OUTCOME_EQ) != 0;
+    uint32_t gt     = (code & VECTOR_OUTCOME_GT) != 0;
+    uint32_t invert = (code & VECTOR_OUTCOME_INVERT) != 0;
+    uint32_t bits   = 0;
+
+    for (uint32_t k = 0; k < count; k++) {
+        float    xk  = x[k];
+        float    yk  = y[(size_t) k * stride];
+        uint32_t bit = ((xk < yk) & lt) | ((xk == yk) & eq) | ((xk > yk) & gt);
+        bits        |= (bit ^ invert) << k;
+    }
+
+    return bits;
+}
+
+// Range kernel over words, packing 64 comparisons into each word
+static void vector_compare_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes  = (const vector_lanes_t*) task->a;
+    uint32_t              stride = lanes->stride;
+
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        uint32_t     base  = w * 64;
+        uint32_t     count = lanes->columns - base;
+        const float* x     = lanes->x + base;
+        const float* y     = lanes->y + (size_t) base * stride;
+        uint32_t     high  = 0;
+
+        count        = (count < 64) ? count : 64;
+        uint32_t low = vector_compare_bits(
+            x, y, stride, (count < 32) ? count : 32, lanes->code
+        );
+        if (count > 32) {
+            high = vector_compare_bits(
+                x + 32, y + 32 * stride, stride, count - 32, lanes->code
+            );
+        }
+        lanes->mask[w] = low | (uint64_t) high << 32;
+    }
+}
+
+// Range kernels combining masks a word at a time. The bits past columns are
+// cleared, since the bits of a mask built by the caller may hold anything.
+
+static void vector_mask_and_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        lanes->mask[w] = lanes->bits[w] & lanes->other[w]
+                         & vector_mask_tail(lanes->columns, w);
+    }
+}
+
+static void vector_mask_or_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        lanes->mask[w] = (lanes->bits[w] | lanes->other[w])
+                         & vector_mask_tail(lanes->columns, w);
+    }
+}
+
+static void vector_mask_not_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        lanes->mask[w] = ~lanes->bits[w]
+                         & vector_mask_tail(lanes->columns, w);
+    }
+}
+
+// Range kernels for counts, each accumulating into the partial count pointed
+// to by result since a scheduled task may execute several chunks
+
+static void vector_mask_count_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    uint32_t              count = 0;
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        uint64_t word  = lanes->bits[w] & vector_mask_tail(lanes->columns, w);
+        count         += (uint32_t) __builtin_popcountll(word);
+    }
+    *(uint32_t*) task->result += count;
+}
+
+static void vector_nonzero_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    uint32_t              count = 0;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        count += (0.0f != lanes->x[i]);
+    }
+    *(uint32_t*) task->result += count;
+}
+
+// Execute a mask kernel over the words of a mask of the given size
+static bool vector_mask_run(
+    linear_context_t*     context,
+    const vector_lanes_t* lanes,
+    thread_routine_t      routine
+) {
+    thread_data_t task = {
+        .a       = (void*) lanes,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    // Tasks are sized by elements while each index covers a word of them
+    return linear_context_parallel_work(
+        context, task, vector_mask_words(lanes->columns), lanes->columns
+    );
+}
+
+// Split a count over tasks, execute them, and sum the partials
+static uint32_t vector_count_run(
+    linear_context_t*     context,
+    const vector_lanes_t* lanes,
+    thread_routine_t      routine,
+    uint32_t              count
+) {
+    thread_data_t task = {
+        .a       = (void*) lanes,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    size_t         mark       = linear_context_scratch_mark(context);
+    uint32_t       task_count = 0;
+    uint32_t*      partials   = NULL;
+    thread_data_t* tasks      = linear_context_split_scratch(
+        context, task, count, &task_count
+    );
+    if (tasks) {
+        size_t size = sizeof(uint32_t) * task_count;
+        partials    = linear_context_scratch_alloc(context, size);
+    }
+    if (NULL == tasks || NULL == partials) {
+        LOG_ERROR("Failed to allocate memory for the partial counts.\n");
+        linear_context_scratch_release(context, mark);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        partials[i]     = 0; // routines accumulate, see the schedule
+        tasks[i].result = &partials[i];
+    }
+    linear_context_schedule(context, tasks, task_count, count);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < task_count; i++) {
+        total += partials[i];
+    }
+
+    linear_context_scratch_release(context, mark);
+    return total;
+}
+
+static bool vector_compare_lanes_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    const float*      y,
+    uint32_t          stride,
+    vector_compare_t  compare,
+    vector_mask_t*    mask
+) {
+    if (compare >= VECTOR_COMPARE_COUNT) {
+        LOG_ERROR("Invalid comparison %d.\n", compare);
+        return false;
+    }
+
+    vector_lanes_t lanes = {
+        .mask    = mask->bits,
+        .x       = (const float*) a->data,
+        .y       = y,
+        .columns = mask->columns,
+        .stride  = stride,
+        .code    = vector_compare_outcomes[compare],
+    };
+
+    return vector_mask_run(context, &lanes, vector_compare_routine);
+}
+
+bool vector_compare_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    const vector_t*   b,
+    vector_compare_t  compare,
+    vector_mask_t*    mask
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || NULL == mask
+        || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(mask, a, b)) {
+        return false;
+    }
+
+    return vector_compare_lanes_ctx(
+        context, a, (const float*) b->data, 1, compare, mask
+    );
+}
+
+bool vector_compare_scalar_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    float             b,
+    vector_compare_t  compare,
+    vector_mask_t*    mask
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == mask || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(mask, a, NULL)) {
+        return false;
+    }
+
+    return vector_compare_lanes_ctx(context, a, &b, 0, compare, mask);
+}
+
+// Combine masks of the same size with the given word kernel
+static bool vector_mask_combine_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* a,
+    const vector_mask_t* b,
+    vector_mask_t*       result,
+    thread_routine_t     routine
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == result || !linear_context_is_cpu(context)) {
+        return false;
+    }
+
+    if (a->columns != result->columns || (b && b->columns != a->columns)) {
+        LOG_ERROR(
+            "Mask sizes do not match. Cannot combine masks of %u and %u "
+            "elements.\n",
+            a->columns,
+            (b && b->columns != a->columns) ? b->columns : result->columns
+        );
+        return false;
+    }
+
+    vector_lanes_t lanes = {
+        .bits    = a->bits,
+        .other   = (b) ? b->bits : NULL,
+        .mask    = result->bits,
+        .columns = a->columns,
+    };
+
+    return vector_mask_run(context, &lanes, routine);
+}
+
+bool vector_mask_and_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* a,
+    const vector_mask_t* b,
+    vector_mask_t*       result
+) {
+    if (NULL == b) {
+        return false;
+    }
+    return vector_mask_combine_ctx(
+        context, a, b, result, vector_mask_and_routine
+    );
+}
+
+bool vector_mask_or_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* a,
+    const vector_mask_t* b,
+    vector_mask_t*       result
+) {
+    if (NULL == b) {
+        return false;
+    }
+    return vector_mask_combine_ctx(
+        context, a, b, result, vector_mask_or_routine
+    );
+}
+
+bool vector_mask_not_ctx(
+    linear_context_t* context, const vector_mask_t* a, vector_mask_t* result
+) {
+    return vector_mask_combine_ctx(
+        context, a, NULL, result, vector_mask_not_routine
+    );
+}
+
+uint32_t
+vector_mask_count_ctx(linear_context_t* context, const vector_mask_t* mask) {
+    context = linear_context_resolve(context);
+    if (NULL == mask || NULL == mask->bits
+        || !linear_context_is_cpu(context)) {
+        return 0;
+    }
+
+    vector_lanes_t lanes = {.bits = mask->bits, .columns = mask->columns};
+    return vector_count_run(
+        context,
+        &lanes,
+        vector_mask_count_routine,
+        vector_mask_words(mask->columns)
+    );
+}
+
+uint32_t
+vector_count_nonzero_ctx(linear_context_t* context, const vector_t* vector) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, vector, NULL)) {
+        return 0;
+    }
+
+    vector_lanes_t lanes = {
+        .x       = (const float*) vector->data,
+        .columns = vector->columns,
+    };
+    return vector_count_run(
+        context, &lanes, vector_nonzero_routine, vector->columns
+    );
+}
+
+// Range kernels over elements, reading the mask without branching
+
+static void vector_expand_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        lanes->z[i] = (float) vector_mask_bit(lanes->bits, i);
+    }
+}
+
+static void vector_select_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    const float*          x     = lanes->x;
+    const float*          y     = lanes->y;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        lanes->z[i] = (vector_mask_bit(lanes->bits, i)) ? x[i] : y[i];
+    }
+}
+
+static void vector_masked_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    const uint64_t*       bits  = lanes->bits;
+    const float*          x     = lanes->x;
+    const float*          y     = lanes->y;
+    float*                z     = lanes->z;
+
+    // Branch once per chunk. Every lane is computed and blended bitwise, as
+    // a select would be turned back into conditional arithmetic.
+    switch ((vector_masked_op_t) lanes->code) {
+        case VECTOR_MASKED_ADD:
+            for (uint32_t i = task->begin; i < task->end; i++) {
+                uint32_t set = vector_mask_bit(bits, i);
+                z[i]         = vector_blend(x[i] + y[i], x[i], set);
+            }
+            break;
+        case VECTOR_MASKED_SUBTRACT:
+            for (uint32_t i = task->begin; i < task->end; i++) {
+                uint32_t set = vector_mask_bit(bits, i);
+                z[i]         = vector_blend(x[i] - y[i], x[i], set);
+            }
+            break;
+        case VECTOR_MASKED_MULTIPLY:
+            for (uint32_t i = task->begin; i < task->end; i++) {
+                uint32_t set = vector_mask_bit(bits, i);
+                z[i]         = vector_blend(x[i] * y[i], x[i], set);
+            }
+            break;
+        case VECTOR_MASKED_DIVIDE:
+            for (uint32_t i = task->begin; i < task->end; i++) {
+                uint32_t set = vector_mask_bit(bits, i);
+                z[i]         = vector_blend(x[i] / y[i], x[i], set);
+            }
+            break;
+    }
+}
+
+// Allocate the result of an element kernel over the lanes and execute it
+static vector_t* vector_lanes_ctx(
+    linear_context_t* context, vector_lanes_t* lanes, thread_routine_t routine
+) {
+    vector_t* result = vector_allocate_ctx(
+        context, lanes->columns, NUMERIC_FLOAT32
+    );
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory for the resultant vector.\n");
+        return NULL;
+    }
+
+    thread_data_t task = {
+        .a       = lanes,
+        .result  = result,
+        .type    = NUMERIC_FLOAT32,
+        .routine = routine,
+    };
+
+    lanes->z = (float*) result->data;
+    if (!linear_context_parallel(context, task, lanes->columns)) {
+        vector_free_ctx(context, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+vector_t*
+vector_mask_expand_ctx(linear_context_t* context, const vector_mask_t* mask) {
+    context = linear_context_resolve(context);
+    if (NULL == mask || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(mask, NULL, NULL)) {
+        return NULL;
+    }
+
+    vector_lanes_t lanes = {.bits = mask->bits, .columns = mask->columns};
+    return vector_lanes_ctx(context, &lanes, vector_expand_routine);
+}
+
+// Execute a binary element kernel under a mask
+static vector_t* vector_masked_lanes_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b,
+    thread_routine_t     routine,
+    vector_masked_op_t   op
+) {
+    context = linear_context_resolve(context);
+    if (NULL == mask || NULL == a || NULL == b
+        || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(mask, a, b)) {
+        return NULL;
+    }
+
+    vector_lanes_t lanes = {
+        .bits    = mask->bits,
+        .x       = (const float*) a->data,
+        .y       = (const float*) b->data,
+        .columns = mask->columns,
+        .code    = op,
+    };
+    return vector_lanes_ctx(context, &lanes, routine);
+}
+
+vector_t* vector_select_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+) {
+    return vector_masked_lanes_ctx(
+        context, mask, a, b, vector_select_routine, 0
+    );
+}
+
+vector_t* vector_masked_add_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+) {
+    return vector_masked_lanes_ctx(
+        context, mask, a, b, vector_masked_routine, VECTOR_MASKED_ADD
+    );
+}
+
+vector_t* vector_masked_subtract_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+) {
+    return vector_masked_lanes_ctx(
+        context, mask, a, b, vector_masked_routine, VECTOR_MASKED_SUBTRACT
+    );
+}
+
+vector_t* vector_masked_multiply_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+) {
+    return vector_masked_lanes_ctx(
+        context, mask, a, b, vector_masked_routine, VECTOR_MASKED_MULTIPLY
+    );
+}
+
+vector_t* vector_masked_divide_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    const vector_t*      b
+) {
+    return vector_masked_lanes_ctx(
+        context, mask, a, b, vector_masked_routine, VECTOR_MASKED_DIVIDE
+    );
+}
+
+// Range kernel over words writing the selected elements from the offset
+// pointed to by result, visiting only the set bits of each word
+static void vector_compress_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes  = (const vector_lanes_t*) task->a;
+    uint32_t              offset = *(const uint32_t*) task->result;
+
+    for (uint32_t w = task->begin; w < task->end; w++) {
+        uint64_t word = lanes->bits[w] & vector_mask_tail(lanes->columns, w);
+        for (; word; word &= word - 1) {
+            uint32_t i = w * 64 + (uint32_t) __builtin_ctzll(word);
+            lanes->z[offset] = lanes->x[i];
+            if (lanes->indices) {
+                lanes->indices[offset] = i;
+            }
+            offset++;
+        }
+    }
+}
+
+vector_t* vector_compress_ctx(
+    linear_context_t*    context,
+    const vector_mask_t* mask,
+    const vector_t*      a,
+    uint32_t*            indices
+) {
+    context = linear_context_resolve(context);
+    if (NULL == mask || NULL == a || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(mask, a, NULL)) {
+        return NULL;
+    }
+
+    vector_lanes_t lanes = {
+        .bits    = mask->bits,
+        .x       = (const float*) a->data,
+        .indices = indices,
+        .columns = mask->columns,
+    };
+    thread_data_t task = {
+        .a       = &lanes,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_mask_count_routine,
+    };
+
+    // Both passes must split the words identically, so no schedule is used
+    uint32_t       words      = vector_mask_words(mask->columns);
+    size_t         mark       = linear_context_scratch_mark(context);
+    uint32_t       task_count = 0;
+    uint32_t*      offsets    = NULL;
+    thread_data_t* tasks      = linear_context_split_scratch(
+        context, task, words, &task_count
+    );
+    if (tasks) {
+        size_t size = sizeof(uint32_t) * task_count;
+        offsets     = linear_context_scratch_alloc(context, size);
+    }
+    if (NULL == tasks || NULL == offsets) {
+        LOG_ERROR("Failed to allocate memory for the compaction offsets.\n");
+        linear_context_scratch_release(context, mark);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        offsets[i]      = 0;
+        tasks[i].result = &offsets[i];
+    }
+    linear_context_run(context, tasks, task_count);
+
+    // Exclusive prefix sum turning the counts into offsets
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < task_count; i++) {
+        uint32_t selected = offsets[i];
+        offsets[i]        = count;
+        count            += selected;
+    }
+
+    // Allocate at least one element so that an empty result is still valid
+    vector_t* result = vector_allocate_ctx(
+        context, (count) ? count : 1, NUMERIC_FLOAT32
+    );
+    if (NULL == result) {
+        LOG_ERROR("Failed to allocate memory for the compacted vector.\n");
+        linear_context_scratch_release(context, mark);
+        return NULL;
+    }
+    result->columns = count;
+
+    lanes.z = (float*) result->data;
+    for (uint32_t i = 0; i < task_count; i++) {
+        tasks[i].routine = vector_compress_routine;
+    }
+    linear_context_run(context, tasks, task_count);
+
+    linear_context_scratch_release(context, mark);
+    return result;
+}
+
+vector_t* vector_filter_ctx(
+    linear_context_t* context,
+    const vector_t*   a,
+    vector_compare_t  compare,
+    float             b,
+    uint32_t*         indices
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, a, NULL)) {
+        return NULL;
+    }
+
+    size_t        mark  = linear_context_scratch_mark(context);
+    uint32_t      words = vector_mask_words(a->columns);
+    vector_mask_t mask  = {.columns = a->columns};
+    mask.bits           = linear_context_scratch_alloc(
+        context, sizeof(uint64_t) * ((words) ? words : 1)
+    );
+
+    vector_t* result = NULL;
+    if (NULL == mask.bits) {
+        LOG_ERROR("Failed to allocate memory for the filter mask.\n");
+    } else if (vector_compare_scalar_ctx(context, a, b, compare, &mask)) {
+        result = vector_compress_ctx(context, &mask, a, indices);
+    }
+
+    linear_context_scratch_release(context, mark);
+    return result;
+}
+
+// Non-finite detection and sanitization
+
+// Number of elements classified between checks for an early exit
+#define VECTOR_FINITE_BLOCK 1024
+
+// NaN and infinities are the binary32 values with every exponent bit set
+static inline uint32_t vector_is_nonfinite(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return UINT32_C(0x7f800000) == (bits & UINT32_C(0x7f800000));
+}
+
+// Range kernel raising the flag pointed to by result upon the first block
+// holding a non-finite element, and returning early once it is raised
+static void vector_finite_routine(thread_data_t* task) {
+    const float* x     = ((const vector_lanes_t*) task->a)->x;
+    atomic_bool* found = (atomic_bool*) task->result;
+
+    for (uint32_t i = task->begin; i < task->end; i += VECTOR_FINITE_BLOCK) {
+        if (atomic_load_explicit(found, memory_order_relaxed)) {
+            return;
+        }
+
+        uint32_t count     = task->end - i;
+        uint32_t end       = i + VECTOR_FINITE_BLOCK;
+        uint32_t nonfinite = 0;
+        end                = (count < VECTOR_FINITE_BLOCK) ? task->end : end;
+        for (uint32_t j = i; j < end; j++) {
+            nonfinite |= vector_is_nonfinite(x[j]);
+        }
+
+        if (nonfinite) {
+            atomic_store_explicit(found, true, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+static void vector_nonfinite_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes = (const vector_lanes_t*) task->a;
+    uint32_t              count = 0;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        count += vector_is_nonfinite(lanes->x[i]);
+    }
+    *(uint32_t*) task->result += count;
+}
+
+// Range kernel replacing NaN, +inf and -inf with y[0], y[1] and y[2]
+static void vector_nan_to_num_routine(thread_data_t* task) {
+    const vector_lanes_t* lanes  = (const vector_lanes_t*) task->a;
+    float                 nan    = lanes->y[0];
+    float                 posinf = lanes->y[1];
+    float                 neginf = lanes->y[2];
+    float*                z      = lanes->z;
+
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        float x = z[i];
+        x       = (x != x) ? nan : x;
+        x       = (INFINITY == x) ? posinf : x;
+        z[i]    = (-INFINITY == x) ? neginf : x;
+    }
+}
+
+bool vector_all_finite_ctx(linear_context_t* context, const vector_t* vector) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, vector, NULL)) {
+        return false;
+    }
+
+    atomic_bool    found = false;
+    vector_lanes_t lanes = {
+        .x       = (const float*) vector->data,
+        .columns = vector->columns,
+    };
+    thread_data_t task = {
+        .a       = &lanes,
+        .result  = &found,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_finite_routine,
+    };
+
+    if (!linear_context_parallel(context, task, vector->columns)) {
+        return false;
+    }
+
+    return !atomic_load(&found);
+}
+
+uint32_t
+vector_count_nonfinite_ctx(linear_context_t* context, const vector_t* vector) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, vector, NULL)) {
+        return 0;
+    }
+
+    vector_lanes_t lanes = {
+        .x       = (const float*) vector->data,
+        .columns = vector->columns,
+    };
+    return vector_count_run(
+        context, &lanes, vector_nonfinite_routine, vector->columns
+    );
+}
+
+bool vector_nan_to_num_ctx(
+    linear_context_t* context,
+    vector_t*         vector,
+    float             nan,
+    float             posinf,
+    float             neginf
+) {
+    context = linear_context_resolve(context);
+    if (NULL == vector || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, vector, NULL)) {
+        return false;
+    }
+
+    float replacements[3] = {nan, posinf, neginf};
+
+    vector_lanes_t lanes = {
+        .y       = replacements,
+        .z       = (float*) vector->data,
+        .columns = vector->columns,
+    };
+    thread_data_t task = {
+        .a       = &lanes,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_nan_to_num_routine,
+    };
+
+    return linear_context_parallel(context, task, vector->columns);
+}
+
+bool vector_ingest_ctx(linear_context_t* context, vector_t* vector) {
+    context = linear_context_resolve(context);
+
+    switch (context->validation) {
+        case VALIDATION_REJECT:
+            if (!vector_all_finite_ctx(context, vector)) {
+                LOG_ERROR("Rejected a vector with non-finite elements.\n");
+                return false;
+            }
+            return true;
+        case VALIDATION_SANITIZE:
+            return vector_nan_to_num_ctx(
+                context, vector, 0.0f, FLT_MAX, -FLT_MAX
+            );
+        default:
+            return NULL != vector;
+    }
+}
+
+// Approximate comparison
+
+// Number of elements compared between checks for an early exit
+#define VECTOR_CLOSE_BLOCK 1024
+
+// Operands of an approximate comparison, passed to each task through task->a
+typedef struct VectorClose {
+    const float* x;        // First operand
+    const float* y;        // Second operand, or a scalar
+    uint32_t     stride;   // Stride of y, 0 for a scalar
+    float        absolute; // Largest absolute difference
+    float        relative; // Largest relative difference
+    uint32_t     ulps;     // Largest distance in units in the last place
+    atomic_uint  mismatch; // Lowest index found not close
+} vector_close_t;
+
+vector_tolerance_t vector_tolerance_default(void) {
+    vector_tolerance_t tolerance = {
+        .absolute = 0.0f,
+        .relative = 1e-3f,
+        .ulps     = 0,
+    };
+    return tolerance;
+}
+
+// Number of representable floats between x and y, saturating
+static inline uint32_t vector_ulp_distance(float x, float y) {
+    int32_t i, j;
+    memcpy(&i, &x, sizeof(i));
+    memcpy(&j, &y, sizeof(j));
+
+    // Map sign and magnitude onto a monotonic scale, where -0 equals +0
+    i = (i < 0) ? INT32_MIN - i : i;
+    j = (j < 0) ? INT32_MIN - j : j;
+
+    int64_t distance = (int64_t) i - (int64_t) j;
+    distance         = (distance < 0) ? -distance : distance;
+    return (distance > UINT32_MAX) ? UINT32_MAX : (uint32_t) distance;
+}
+
+// Select rather than call fmaxf() so that the comparison vectorizes
+static inline uint32_t
+vector_element_is_close(float x, float y, const vector_close_t* close) {
+    float ax    = fabsf(x);
+    float ay    = fabsf(y);
+    float bound = close->relative * ((ax > ay) ? ax : ay);
+    bound       = (bound > close->absolute) ? bound : close->absolute;
+
+    // Tolerances only apply between finite values, an infinite bound or a
+    // single ULP to FLT_MAX would otherwise make infinities close to anything
+    uint32_t finite = 1 ^ (vector_is_nonfinite(x) | vector_is_nonfinite(y));
+    uint32_t near   = (fabsf(x - y) <= bound)
+                    | (vector_ulp_distance(x, y) <= close->ulps);
+    return (x == y) | (finite & near);
+}
+
+// Range kernel accumulating the largest difference into the partial pointed
+// to by result, and lowering the mismatch upon the first block holding one
+static void vector_close_routine(thread_data_t* task) {
+    vector_close_t* close  = (vector_close_t*) task->a;
+    const float*    x      = close->x;
+    const float*    y      = close->y;
+    uint32_t        stride = close->stride;
+    uint32_t        bound;
+
+    // Non-negative floats order as their bits do, and an integer maximum
+    // vectorizes where a float maximum may not
+    memcpy(&bound, task->result, sizeof(bound));
+
+    for (uint32_t i = task->begin; i < task->end; i += VECTOR_CLOSE_BLOCK) {
+        // Blocks past a known mismatch cannot hold the first one
+        if (i > atomic_load_explicit(&close->mismatch, memory_order_relaxed)) {
+            break;
+        }
+
+        uint32_t count = task->end - i;
+        uint32_t end   = i + VECTOR_CLOSE_BLOCK;
+        uint32_t far   = 0;
+        end            = (count < VECTOR_CLOSE_BLOCK) ? task->end : end;
+        for (uint32_t j = i; j < end; j++) {
+            float    xj    = x[j];
+            float    yj    = y[(size_t) j * stride];
+            float    error = fabsf(xj - yj);
+            uint32_t bits;
+            memcpy(&bits, &error, sizeof(bits));
+            bits  &= -(uint32_t) (error == error); // NaN is not an error
+            bound  = (bits > bound) ? bits : bound;
+            far   |= 1 ^ vector_element_is_close(xj, yj, close);
+        }
+
+        if (far) {
+            uint32_t j = i;
+            while (vector_element_is_close(x[j], y[(size_t) j * stride], close)
+            ) {
+                j++;
+            }
+
+            uint32_t first = atomic_load(&close->mismatch);
+            while (j < first
+                   && !atomic_compare_exchange_weak(
+                       &close->mismatch, &first, j
+                   )) {}
+            break;
+        }
+    }
+
+    memcpy(task->result, &bound, sizeof(bound));
+}
+
+// Compare count elements of x against y, splitting the scan over tasks
+static bool vector_close_run(
+    linear_context_t*         context,
+    const float*              x,
+    const float*              y,
+    uint32_t                  stride,
+    uint32_t                  count,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+) {
+    vector_tolerance_t defaults = vector_tolerance_default();
+    tolerance                   = (tolerance) ? tolerance : &defaults;
+
+    vector_close_t close = {
+        .x        = x,
+        .y        = y,
+        .stride   = stride,
+        .absolute = tolerance->absolute,
+        .relative = tolerance->relative,
+        .ulps     = tolerance->ulps,
+    };
+    atomic_init(&close.mismatch, UINT32_MAX);
+
+    thread_data_t task = {
+        .a       = &close,
+        .type    = NUMERIC_FLOAT32,
+        .routine = vector_close_routine,
+    };
+
+    size_t         mark       = linear_context_scratch_mark(context);
+    uint32_t       task_count = 0;
+    float*         partials   = NULL;
+    thread_data_t* tasks      = linear_context_split_scratch(
+        context, task, count, &task_count
+    );
+    if (tasks) {
+        size_t size = sizeof(float) * task_count;
+        partials    = linear_context_scratch_alloc(context, size);
+    }
+    if (NULL == tasks || NULL == partials) {
+        LOG_ERROR("Failed to allocate memory for the partial errors.\n");
+        linear_context_scratch_release(context, mark);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        partials[i]     = 0.0f; // routines accumulate, see the schedule
+        tasks[i].result = &partials[i];
+    }
+    linear_context_schedule(context, tasks, task_count, count);
+
+    float max_error = 0.0f;
+    for (uint32_t i = 0; i < task_count; i++) {
+        max_error = fmaxf(max_error, partials[i]);
+    }
+    linear_context_scratch_release(context, mark);
+
+    uint32_t mismatch = atomic_load(&close.mismatch);
+    if (report) {
+        report->mismatch  = mismatch;
+        report->max_error = max_error;
+    }
+
+    return UINT32_MAX == mismatch;
+}
+
+bool vector_is_close_ctx(
+    linear_context_t*         context,
+    const vector_t*           a,
+    const vector_t*           b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || NULL == b || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, a, b)) {
+        return false;
+    }
+
+    return vector_close_run(
+        context,
+        (const float*) a->data,
+        (const float*) b->data,
+        1,
+        a->columns,
+        tolerance,
+        report
+    );
+}
+
+bool vector_is_close_scalar_ctx(
+    linear_context_t*         context,
+    const vector_t*           a,
+    float                     b,
+    const vector_tolerance_t* tolerance,
+    vector_closeness_t*       report
+) {
+    context = linear_context_resolve(context);
+    if (NULL == a || !linear_context_is_cpu(context)
+        || !vector_lanes_are_valid(NULL, a, NULL)) {
+        return false;
+    }
+
+    return vector_close_run(
+        context, (const float*) a->data, &b, 0, a->columns, tolerance, report
+    );
+}
+
+// Asynchronous operations
+
+// Operands of an asynchronous vector reduction
+typedef struct VectorAsync {
+    const vector_t* a;
+    const vector_t* b;
+    float (*reduce)(linear_context_t*, const vector_t*, const vector_t*);
+} vector_async_t;
+
+static bool vector_async_routine(linear_async_t* op) {
+    const vector_async_t* arguments = (const vector_async_t*) op->arguments;
+    op->value = arguments->reduce(op->context, arguments->a, arguments->b);
+    return !isnan(op->value);
+}
+
+static linear_async_t* vector_async_submit(
+    linear_context_t*             context,
+    const vector_t*               a,
+    const vector_t*               b,
+    float (*reduce)(linear_context_t*, const vector_t*, const vector_t*),
+    const linear_async_options_t* options
+) {
+    vector_async_t arguments = {.a = a, .b = b, .reduce = reduce};
+    return linear_async_submit(
+        context, vector_async_routine, &arguments, sizeof(arguments), options
+    );
+}
+
+// Adapt the unary reductions to the binary signature
+static float vector_magnitude_unary(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    (void) b;
+    return vector_magnitude_ctx(context, a);
+}
+
+static float vector_mean_unary(
+    linear_context_t* context, const vector_t* a, const vector_t* b
+) {
+    (void) b;
+    return vector_mean_ctx(context, a);
+}
+
+linear_async_t* vector_magnitude_async(
+    linear_context_t*             context,
+    const vector_t*               vector,
+    const linear_async_options_t* options
+) {
+    return vector_async_submit(
+        context, vector, NULL, vector_magnitude_unary, options
+    );
+}
+
+linear_async_t* vector_distance_async(
+    linear_context_t*             context,
+    const vector_t*               a,
+    const vector_t*               b,
+    const linear_async_options_t* options
+) {
+    return vector_async_submit(context, a, b, vector_distance_ctx, options);
+}
+
+linear_async_t* vector_mean_async(
+    linear_context_t*             context,
+    const vector_t*               vector,
+    const linear_async_options_t* options
+) {
+    return vector_async_submit(
+        context, vector, NULL, vector_mean_unary, options
+    );
+}
+
+linear_async_t* vector_dot_product_async(
+    linear_context_t*             context,
+    const vector_t*               a,
+    const vector_t*               b,
+    const linear_async_options_t* options
+) {
+    return vector_async_submit(
+        context, a, b, vector_dot_product_ctx, options
+    );
+}
@@ -0,0 +1,284 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_async.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "async.h"
+#include "logger.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** Prototypes */
+
+// Completion notification
+bool test_linear_async_callback(void);
+bool test_linear_async_eventfd(void);
+bool test_linear_async_serial(void);
+bool test_linear_async_failure(void);
+
+// Asynchronous operations
+bool test_matrix_product_async(void);
+bool test_matrix_row_distance_async(void);
+
+/** Fixtures */
+
+// Counts completions through the counter pointed to by user
+static void counting_callback(linear_async_t* op, void* user) {
+    (void) op;
+    atomic_fetch_add((atomic_uint*) user, 1);
+}
+
+// Creates a NUMERIC_FLOAT32 vector holding 1, 2, ..., n
+static vector_t*
+vector_range_fixture(linear_context_t* context, uint32_t n) {
+    vector_t* vector = vector_create_ctx(context, n);
+    float*    data   = (float*) vector->data;
+    for (uint32_t i = 0; i < n; i++) {
+        data[i] = (float) (i + 1);
+    }
+    return vector;
+}
+
+/** Unit Tests */
+
+bool test_linear_async_callback(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    vector_t*         vector  = vector_range_fixture(context, 4096);
+    atomic_uint       calls   = 0;
+
+    linear_async_options_t options = linear_async_options_default();
+    options.callback               = counting_callback;
+    options.user                   = &calls;
+
+    linear_async_t* op = vector_mean_async(context, vector, &options);
+    if (!linear_async_wait(op) || 1 != atomic_load(&calls)) {
+        LOG_ERROR("Expected the callback to run exactly once.\n");
+        result = false;
+    }
+
+    if (fabsf(linear_async_value(op) - 2048.5f) > 1e-3f) {
+        LOG_ERROR("Expected mean 2048.5, got %f.\n", linear_async_value(op));
+        result = false;
+    }
+
+    linear_async_free(op);
+    vector_free_ctx(context, vector);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_async_eventfd(void) {
+    bool result = true;
+
+    linear_context_t* context  = linear_context_create(2);
+    vector_t*         vector   = vector_range_fixture(context, 1024);
+    int               event_fd = linear_async_eventfd();
+
+    linear_async_options_t options = linear_async_options_default();
+    options.event_fd               = event_fd;
+
+    // Several ops may share a single eventfd
+    linear_async_t* dot = vector_dot_product_async(
+        context, vector, vector, &options
+    );
+    linear_async_t* norm = vector_magnitude_async(context, vector, &options);
+
+    // Wait as a reactor would, on the descriptor rather than the pool
+    uint64_t      completed = 0;
+    struct pollfd readable  = {.fd = event_fd, .events = POLLIN};
+    while (completed < 2 && poll(&readable, 1, 1000) > 0) {
+        completed += linear_async_eventfd_drain(event_fd);
+    }
+
+    if (2 != completed || ASYNC_SUCCEEDED != linear_async_status(dot)
+        || ASYNC_SUCCEEDED != linear_async_status(norm)) {
+        LOG_ERROR("Expected 2 completions, got %u.\n", (unsigned) completed);
+        result = false;
+    }
+
+    float dot_value  = linear_async_value(dot);
+    float norm_value = linear_async_value(norm);
+    if (fabsf(sqrtf(dot_value) - norm_value) > 1e-3f * norm_value) {
+        LOG_ERROR("Magnitude %f does not match %f.\n", norm_value, dot_value);
+        result = false;
+    }
+
+    linear_async_free(dot);
+    linear_async_free(norm);
+    close(event_fd);
+    vector_free_ctx(context, vector);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_async_serial(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(1);
+    vector_t*         a       = vector_range_fixture(context, 3);
+    vector_t*         b       = vector_create_ctx(context, 3);
+
+    // Without a pool the op completes before returning
+    linear_async_t* op = vector_distance_async(context, a, b, NULL);
+    if (ASYNC_SUCCEEDED != linear_async_status(op)
+        || fabsf(linear_async_value(op) - sqrtf(14.0f)) > 1e-5f) {
+        LOG_ERROR("Expected a completed distance of sqrt(14).\n");
+        result = false;
+    }
+
+    linear_async_free(op);
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_async_failure(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         a       = matrix_create_ctx(context, 2, 3);
+
+    // Mismatched inner dimensions complete as failed without a result
+    linear_async_t* op = matrix_product_async(context, a, a, NULL);
+    if (linear_async_wait(op) || NULL != linear_async_result(op)) {
+        LOG_ERROR("Expected the product to fail.\n");
+        result = false;
+    }
+
+    linear_async_free(op);
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_product_async(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         a       = matrix_create_ctx(context, 48, 32);
+    matrix_t*         b       = matrix_create_ctx(context, 32, 40);
+    matrix_fill_ctx(context, a, 1.0f);
+    matrix_fill_ctx(context, b, 0.5f);
+
+    linear_async_t* op      = matrix_product_async(context, a, b, NULL);
+    matrix_t*       product = NULL;
+    if (linear_async_wait(op)) {
+        product = (matrix_t*) linear_async_result(op);
+    }
+
+    if (NULL == product || 48 != product->rows || 40 != product->columns) {
+        LOG_ERROR("Expected a 48x40 product.\n");
+        result = false;
+    } else {
+        for (uint32_t i = 0; i < matrix_element_count(product); i++) {
+            if (16.0f != product->data[i]) {
+                LOG_ERROR("Unexpected element %f.\n", product->data[i]);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    linear_async_free(op);
+    matrix_free_ctx(context, a);
+    matrix_free_ctx(context, b);
+    matrix_free_ctx(context, product);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_row_distance_async(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         matrix  = matrix_create_ctx(context, 100, 4);
+    vector_t*         query   = vector_create_ctx(context, 4);
+
+    // Row i holds i in every column, so its distance to 0 is 2i
+    for (uint32_t i = 0; i < matrix_element_count(matrix); i++) {
+        matrix->data[i] = (float) (i / 4);
+    }
+
+    linear_async_t* op = matrix_row_distance_async(
+        context, matrix, query, NULL
+    );
+    vector_t* distances = NULL;
+    if (linear_async_wait(op)) {
+        distances = (vector_t*) linear_async_result(op);
+    }
+
+    if (NULL == distances || 100 != distances->columns) {
+        LOG_ERROR("Expected 100 distances.\n");
+        result = false;
+    } else {
+        float* data = (float*) distances->data;
+        for (uint32_t i = 0; i < distances->columns; i++) {
+            if (fabsf(data[i] - 2.0f * (float) i) > 1e-4f) {
+                LOG_ERROR("Unexpected distance %f at row %u.\n", data[i], i);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    linear_async_free(op);
+    vector_free_ctx(context, distances);
+    vector_free_ctx(context, query);
+    matrix_free_ctx(context, matrix);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Completion notification
+    result &= test_linear_async_callback();
+    result &= test_linear_async_eventfd();
+    result &= test_linear_async_serial();
+    result &= test_linear_async_failure();
+
+    // Asynchronous operations
+    result &= test_matrix_product_async();
+    result &= test_matrix_row_distance_async();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
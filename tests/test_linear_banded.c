@@ -0,0 +1,332 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_banded.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "banded.h"
+#include "context.h"
+#include "logger.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Element access
+bool test_banded_element_access(void);
+
+// Conversion
+bool test_banded_conversion(void);
+
+// Products
+bool test_banded_gbmv(void);
+
+// Solvers
+bool test_banded_solve(void);
+bool test_tridiagonal_solve(void);
+
+/** Fixtures */
+
+// Creates a rows x columns matrix holding values in [-4, 4]
+static matrix_t* dense_fixture(
+    linear_context_t* context, uint32_t rows, uint32_t columns
+) {
+    matrix_t* matrix = matrix_create_ctx(context, rows, columns);
+    for (uint32_t i = 0; i < matrix_element_count(matrix); i++) {
+        matrix->data[i] = (float) (i % 9) - 4.0f;
+    }
+    return matrix;
+}
+
+// Whether a * x is close to b, multiplying densely
+static bool banded_solution_is_close(
+    linear_context_t* context,
+    const banded_t*   a,
+    const matrix_t*   x,
+    const matrix_t*   b
+) {
+    matrix_t* dense = banded_to_matrix_ctx(context, a);
+
+    vector_tolerance_t tolerance = {.absolute = 1e-3f, .relative = 1e-3f};
+    matrix_t*          product   = matrix_product_ctx(context, dense, x);
+
+    bool close = false;
+    if (product) {
+        close = matrix_is_close_ctx(context, product, b, &tolerance, NULL);
+    }
+
+    matrix_free_ctx(context, product);
+    matrix_free_ctx(context, dense);
+    return close;
+}
+
+/** Unit Tests */
+
+bool test_banded_element_access(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(1);
+    banded_t*         banded  = banded_create_ctx(context, 6, 6, 1, 2);
+
+    if (24 != banded_element_count(banded)) {
+        LOG_ERROR("Expected 24 stored elements.\n");
+        result = false;
+    }
+
+    // The band of row 3 spans columns 2 through 5
+    if (!banded_element_set(banded, 3, 2, 5.0f)
+        || !banded_element_set(banded, 3, 5, 7.0f)
+        || banded_element_set(banded, 3, 1, 1.0f)
+        || 5.0f != banded_element_get(banded, 3, 2)
+        || 7.0f != banded_element_get(banded, 3, 5)
+        || 0.0f != banded_element_get(banded, 3, 1)
+        || 5.0f != banded->data[3 * 4]) {
+        LOG_ERROR("Expected (3, 1) to be outside the band.\n");
+        result = false;
+    }
+
+    banded_free_ctx(context, banded);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_banded_conversion(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = dense_fixture(context, 120, 90);
+    banded_t*         banded  = banded_from_matrix_ctx(context, dense, 3, 5);
+    matrix_t*         matrix  = banded_to_matrix_ctx(context, banded);
+
+    if (NULL == banded || NULL == matrix) {
+        LOG_ERROR("Failed to convert the banded matrix.\n");
+        result = false;
+    }
+
+    // Elements within the band round trip, the rest are zero
+    for (uint32_t i = 0; result && i < 120; i++) {
+        for (uint32_t j = 0; j < 90; j++) {
+            bool  inside   = j + 3 >= i && j <= i + 5;
+            float expected = (inside) ? dense->data[i * 90 + j] : 0.0f;
+            if (expected != matrix->data[i * 90 + j]
+                || expected != banded_element_get(banded, i, j)) {
+                LOG_ERROR("Element (%u, %u) differs.\n", i, j);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    matrix_free_ctx(context, matrix);
+    banded_free_ctx(context, banded);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_banded_gbmv(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = dense_fixture(context, 700, 650);
+    banded_t*         banded  = banded_from_matrix_ctx(context, dense, 4, 7);
+    matrix_t*         matrix  = banded_to_matrix_ctx(context, banded);
+    vector_t*         x       = vector_create_ctx(context, 650);
+    vector_t*         y       = vector_create_ctx(context, 700);
+    vector_t*         z       = vector_create_ctx(context, 700);
+
+    for (uint32_t i = 0; i < 700; i++) {
+        ((float*) y->data)[i] = 1.0f;
+        ((float*) z->data)[i] = 1.0f;
+        if (i < 650) {
+            ((float*) x->data)[i] = (float) (i % 5) - 2.0f;
+        }
+    }
+
+    if (!banded_gbmv_ctx(context, 2.0f, banded, x, 0.5f, y)
+        || !matrix_gemv_ctx(context, 2.0f, matrix, x, 0.5f, z)
+        || !vector_is_close_ctx(context, y, z, NULL, NULL)) {
+        LOG_ERROR("Expected the banded GBMV to match the dense GEMV.\n");
+        result = false;
+    }
+
+    // Vectors must match the dimensions of the matrix
+    if (banded_gbmv_ctx(context, 1.0f, banded, y, 0.0f, z)) {
+        LOG_ERROR("Expected mismatched dimensions to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, z);
+    vector_free_ctx(context, y);
+    vector_free_ctx(context, x);
+    matrix_free_ctx(context, matrix);
+    banded_free_ctx(context, banded);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_banded_solve(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    banded_t*         banded  = banded_create_ctx(context, 300, 300, 2, 3);
+    matrix_t*         b       = dense_fixture(context, 300, 40);
+    matrix_t*         x       = matrix_create_ctx(context, 300, 40);
+
+    // Large subdiagonals of odd rows swap them with the row above
+    for (uint32_t i = 0; i < 300; i++) {
+        uint32_t first = (i > 2) ? i - 2 : 0;
+        uint32_t last  = (i + 4 < 300) ? i + 4 : 300;
+        for (uint32_t j = first; j < last; j++) {
+            float value = (float) ((i * 7 + j * 3) % 11) - 5.0f;
+            value = (i == j) ? 6.0f : (i == j + 1 && i % 2) ? 8.0f : value;
+            banded_element_set(banded, i, j, value);
+        }
+    }
+
+    if (!banded_solve_ctx(context, banded, b, x)
+        || !banded_solution_is_close(context, banded, x, b)) {
+        LOG_ERROR("Expected the banded system to be solved.\n");
+        result = false;
+    }
+
+    // Solving in place matches, and singular matrices fail
+    matrix_t* y = matrix_deep_copy_ctx(context, b);
+    if (!banded_solve_ctx(context, banded, y, y)
+        || !matrix_is_close_ctx(context, x, y, NULL, NULL)) {
+        LOG_ERROR("Expected the in-place solve to match.\n");
+        result = false;
+    }
+
+    for (uint32_t j = 148; j < 154; j++) {
+        banded_element_set(banded, 150, j, 0.0f);
+    }
+    if (banded_solve_ctx(context, banded, b, x)) {
+        LOG_ERROR("Expected the singular system to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, y);
+    matrix_free_ctx(context, x);
+    matrix_free_ctx(context, b);
+    banded_free_ctx(context, banded);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_tridiagonal_solve(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    tridiagonal_t*    batch   = tridiagonal_create_ctx(context, 64, 1000);
+    matrix_t*         b       = dense_fixture(context, 64, 1000);
+    matrix_t*         x       = matrix_create_ctx(context, 64, 1000);
+
+    // Diagonally dominant systems, each with its own coefficients
+    for (uint32_t i = 0; i < 64 * 1000; i++) {
+        batch->lower[i]    = -1.0f - (float) (i % 3) * 0.25f;
+        batch->diagonal[i] = 4.0f + (float) (i % 7) * 0.5f;
+        batch->upper[i]    = -1.0f + (float) (i % 5) * 0.25f;
+    }
+
+    if (!tridiagonal_solve_ctx(context, batch, b, x)) {
+        LOG_ERROR("Expected the tridiagonal batch to be solved.\n");
+        result = false;
+    }
+
+    // Substitute every solution back into its own system
+    for (uint32_t s = 0; result && s < 1000; s++) {
+        for (uint32_t i = 0; i < 64; i++) {
+            size_t k   = (size_t) i * 1000 + s;
+            float  sum = batch->diagonal[k] * x->data[k];
+            if (i > 0) {
+                sum += batch->lower[k] * x->data[k - 1000];
+            }
+            if (i < 63) {
+                sum += batch->upper[k] * x->data[k + 1000];
+            }
+
+            if (fabsf(sum - b->data[k]) > 1e-4f) {
+                LOG_ERROR("System %u differs at row %u.\n", s, i);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    // A vanishing pivot in any one system fails the batch
+    batch->diagonal[10 * 1000 + 123] = 0.0f;
+    batch->lower[10 * 1000 + 123]    = 0.0f;
+    if (tridiagonal_solve_ctx(context, batch, b, b)) {
+        LOG_ERROR("Expected the zero pivot to fail.\n");
+        result = false;
+    }
+
+    // So does a pivot that overflowed or turned NaN, which division alone
+    // would silently turn into zeros or NaN solutions
+    const float pivots[] = {INFINITY, NAN};
+
+    batch->diagonal[10 * 1000 + 123] = 4.0f;
+    for (uint32_t i = 0; i < 2; i++) {
+        batch->diagonal[20 * 1000 + 456] = pivots[i];
+        if (tridiagonal_solve_ctx(context, batch, b, x)) {
+            LOG_ERROR("Expected the pivot %f to fail.\n", pivots[i]);
+            result = false;
+        }
+    }
+
+    matrix_free_ctx(context, x);
+    matrix_free_ctx(context, b);
+    tridiagonal_free_ctx(context, batch);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Element access
+    result &= test_banded_element_access();
+
+    // Conversion
+    result &= test_banded_conversion();
+
+    // Products
+    result &= test_banded_gbmv();
+
+    // Solvers
+    result &= test_banded_solve();
+    result &= test_tridiagonal_solve();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
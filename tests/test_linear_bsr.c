@@ -0,0 +1,216 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_bsr.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "bsr.h"
+#include "context.h"
+#include "logger.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Conversion
+bool test_bsr_conversion(void);
+
+// Products
+bool test_bsr_gemm(void);
+bool test_bsr_gemv(void);
+
+/** Fixtures */
+
+// Creates a rows x columns matrix whose size x size blocks are either zero,
+// or hold values in [-4, 4], about one block in three being nonzero
+static matrix_t* pruned_fixture(
+    linear_context_t* context, uint32_t rows, uint32_t columns, uint32_t size
+) {
+    matrix_t* matrix = matrix_create_ctx(context, rows, columns);
+    for (uint32_t i = 0; i < rows; i++) {
+        for (uint32_t j = 0; j < columns; j++) {
+            bool  kept  = 0 == (i / size * 7 + j / size * 5) % 3;
+            float value = (float) ((i * 3 + j) % 9) - 4.0f;
+            matrix->data[i * columns + j] = (kept) ? value : 0.0f;
+        }
+    }
+    return matrix;
+}
+
+/** Unit Tests */
+
+bool test_bsr_conversion(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = pruned_fixture(context, 64, 96, 8);
+
+    // Fill the zero block (1, 2) below the threshold, and a NaN into the
+    // zero block (0, 1), which is then kept
+    for (uint32_t r = 8; r < 16; r++) {
+        for (uint32_t q = 16; q < 24; q++) {
+            dense->data[r * 96 + q] = 0.01f;
+        }
+    }
+    dense->data[5 * 96 + 11] = NAN;
+
+    bsr_t*    bsr    = bsr_from_matrix_ctx(context, dense, 8, 0.5f);
+    matrix_t* matrix = bsr_to_matrix_ctx(context, bsr);
+    if (NULL == bsr || NULL == matrix) {
+        LOG_ERROR("Failed to convert the BSR matrix.\n");
+        result = false;
+    }
+
+    // Stored blocks round trip, dropped ones are zero
+    uint32_t blocks = 0;
+    for (uint32_t k = 0; result && k < 8 * 12; k++) {
+        uint32_t i    = k / 12;
+        uint32_t j    = k % 12;
+        bool     kept = 0 == (i * 7 + j * 5) % 3 || (0 == i && 1 == j);
+        blocks       += kept;
+
+        for (uint32_t r = i * 8; r < i * 8 + 8; r++) {
+            for (uint32_t q = j * 8; q < j * 8 + 8; q++) {
+                float expected = (kept) ? dense->data[r * 96 + q] : 0.0f;
+                float actual   = matrix->data[r * 96 + q];
+                bool  nan      = isnan(expected) && isnan(actual);
+                if (expected != actual && !nan) {
+                    LOG_ERROR("Element (%u, %u) differs.\n", r, q);
+                    result = false;
+                }
+            }
+        }
+    }
+
+    if (result
+        && (blocks != bsr->blocks
+            || fabsf(bsr_density(bsr) - blocks / 96.0f) > 1e-6f)) {
+        LOG_ERROR("Expected %u stored blocks, got %u.\n", blocks, bsr->blocks);
+        result = false;
+    }
+
+    // Block sizes must be supported and tile the matrix
+    if (bsr_from_matrix_ctx(context, dense, 5, 0.0f)
+        || bsr_from_matrix_ctx(context, dense, 64, 0.0f)
+        || bsr_create_ctx(context, 60, 96, 8, 0)) {
+        LOG_ERROR("Expected invalid block sizes to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, matrix);
+    bsr_free_ctx(context, bsr);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_bsr_gemm(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // 150 columns leave a partial tile
+    const uint32_t sizes[] = {4, 8, 16};
+    for (uint32_t s = 0; s < 3; s++) {
+        matrix_t* dense = pruned_fixture(context, 128, 96, sizes[s]);
+        bsr_t*    bsr   = bsr_from_matrix_ctx(context, dense, sizes[s], 0.0f);
+        matrix_t* b     = pruned_fixture(context, 96, 150, 1);
+        matrix_t* c     = matrix_create_ctx(context, 128, 150);
+        matrix_t* d     = matrix_create_ctx(context, 128, 150);
+        matrix_fill_ctx(context, c, 1.0f);
+        matrix_fill_ctx(context, d, 1.0f);
+
+        if (!bsr_gemm_ctx(context, 2.0f, bsr, b, 0.5f, c)
+            || !matrix_gemm_ctx(context, 2.0f, dense, b, 0.5f, d)
+            || !matrix_is_close_ctx(context, c, d, NULL, NULL)) {
+            LOG_ERROR("Expected the BSR GEMM to match, size %u.\n", sizes[s]);
+            result = false;
+        }
+
+        matrix_free_ctx(context, d);
+        matrix_free_ctx(context, c);
+        matrix_free_ctx(context, b);
+        bsr_free_ctx(context, bsr);
+        matrix_free_ctx(context, dense);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_bsr_gemv(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    const uint32_t sizes[] = {4, 8, 16};
+    for (uint32_t s = 0; s < 3; s++) {
+        matrix_t* dense = pruned_fixture(context, 256, 192, sizes[s]);
+        bsr_t*    bsr   = bsr_from_matrix_ctx(context, dense, sizes[s], 0.0f);
+        vector_t* x     = vector_create_ctx(context, 192);
+        vector_t* y     = vector_create_ctx(context, 256);
+        vector_t* z     = vector_create_ctx(context, 256);
+
+        for (uint32_t i = 0; i < 256; i++) {
+            ((float*) y->data)[i] = 1.0f;
+            ((float*) z->data)[i] = 1.0f;
+            if (i < 192) {
+                ((float*) x->data)[i] = (float) (i % 5) - 2.0f;
+            }
+        }
+
+        if (!bsr_gemv_ctx(context, 2.0f, bsr, x, -1.0f, y)
+            || !matrix_gemv_ctx(context, 2.0f, dense, x, -1.0f, z)
+            || !vector_is_close_ctx(context, y, z, NULL, NULL)) {
+            LOG_ERROR("Expected the BSR GEMV to match, size %u.\n", sizes[s]);
+            result = false;
+        }
+
+        vector_free_ctx(context, z);
+        vector_free_ctx(context, y);
+        vector_free_ctx(context, x);
+        bsr_free_ctx(context, bsr);
+        matrix_free_ctx(context, dense);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Conversion
+    result &= test_bsr_conversion();
+
+    // Products
+    result &= test_bsr_gemm();
+    result &= test_bsr_gemv();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1543 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_context.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "context.h"
+#include "logger.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <float.h>
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Prototypes */
+
+// Context lifecycle management
+bool test_linear_context_create(void);
+bool test_linear_context_task_count(void);
+bool test_linear_context_allocator(void);
+bool test_linear_context_schedule(void);
+bool test_linear_thread_cores(void);
+bool test_linear_thread_count(void);
+
+// Thread pool scheduling
+bool test_thread_pool_resize(void);
+bool test_thread_pool_priority(void);
+bool test_thread_pool_deadline(void);
+bool test_thread_pool_starvation(void);
+bool test_thread_pool_nested_wait(void);
+bool test_thread_pool_submit_batch(void);
+bool test_thread_pool_scratch(void);
+bool test_thread_pool_region(void);
+bool test_thread_pool_fork(void);
+
+// Context operations
+bool test_vector_vector_add_ctx(void);
+bool test_vector_dot_product_ctx(void);
+bool test_vector_elementwise_ctx(void);
+bool test_vector_compare_ctx(void);
+bool test_vector_select_ctx(void);
+bool test_vector_filter_ctx(void);
+bool test_vector_nonfinite_ctx(void);
+bool test_vector_is_close_ctx(void);
+bool test_matrix_scalar_multiply_ctx(void);
+bool test_matrix_product_ctx(void);
+bool test_matrix_gemm_batched_ctx(void);
+
+/** Fixtures */
+
+// Counts live allocations made through the context allocator
+static void* counting_allocate(size_t size, void* user) {
+    *(int*) user += 1;
+    return malloc(size);
+}
+
+static void counting_release(void* pointer, void* user) {
+    *(int*) user -= 1;
+    free(pointer);
+}
+
+// Creates a NUMERIC_FLOAT32 vector holding 1, 2, ..., columns
+static vector_t*
+vector_range_fixture(linear_context_t* context, uint32_t n) {
+    vector_t* vector = vector_create_ctx(context, n);
+    float*    data   = (float*) vector->data;
+    for (uint32_t i = 0; i < n; i++) {
+        data[i] = (float) (i + 1);
+    }
+    return vector;
+}
+
+// Blocks the executing worker until the flag pointed to by a is set
+static void gate_routine(thread_data_t* task) {
+    atomic_int* open = (atomic_int*) task->a;
+    while (!atomic_load(open)) {
+        sched_yield();
+    }
+}
+
+// Appends the label pointed to by a to the log pointed to by result
+static void record_routine(thread_data_t* task) {
+    int* log          = (int*) task->result;
+    log[1 + log[0]++] = *(int*) task->a;
+}
+
+// Records a negated label for a task cancelled past its deadline
+static void cancel_routine(thread_data_t* task) {
+    int* log          = (int*) task->result;
+    log[1 + log[0]++] = -*(int*) task->a;
+}
+
+// Increments the counter pointed to by result
+static void increment_routine(thread_data_t* task) {
+    atomic_fetch_add((atomic_uint*) task->result, 1);
+}
+
+// Submits subtasks to the pool pointed to by a from within a worker and waits
+// for them, which requires the worker to help while it waits
+static void nested_routine(thread_data_t* task) {
+    thread_pool_t* pool    = (thread_pool_t*) task->a;
+    thread_data_t  subtask = {
+        .result  = task->result,
+        .routine = increment_routine,
+    };
+    for (uint32_t i = 0; i < 4; i++) {
+        thread_pool_submit(pool, subtask);
+    }
+    thread_pool_wait(pool);
+}
+
+// Number of increments each batch fixture submits, more than a queue holds
+#define BATCH_TASK_COUNT (3 * LINEAR_THREAD_QUEUE_SIZE + 7)
+
+// Batch submits BATCH_TASK_COUNT increments to the pool pointed to by a and
+// waits on them, so several producers fill the same queue at once
+static void batch_routine(thread_data_t* task) {
+    thread_pool_t* pool  = (thread_pool_t*) task->a;
+    thread_group_t group = {0};
+    thread_data_t* batch = malloc(sizeof(thread_data_t) * BATCH_TASK_COUNT);
+    for (uint32_t i = 0; i < BATCH_TASK_COUNT; i++) {
+        batch[i] = (thread_data_t) {
+            .result  = task->result,
+            .routine = increment_routine,
+            .group   = &group,
+        };
+    }
+    thread_pool_submit_batch(
+        pool, batch, BATCH_TASK_COUNT, THREAD_PRIORITY_NORMAL
+    );
+    thread_group_wait(pool, &group);
+    free(batch);
+}
+
+// Writes a scratch allocation of the pool pointed to by a, counting
+// misaligned allocations in the counter pointed to by result
+static void scratch_routine(thread_data_t* task) {
+    thread_pool_t* pool  = (thread_pool_t*) task->a;
+    size_t         mark  = thread_scratch_mark(pool);
+    unsigned char* data  = thread_scratch_alloc(pool, 4096);
+    uintptr_t      align = LINEAR_THREAD_SCRATCH_ALIGNMENT;
+    if (NULL == data || 0 != (uintptr_t) data % align) {
+        atomic_fetch_add((atomic_uint*) task->result, 1);
+    } else {
+        memset(data, 0xab, 4096);
+    }
+    thread_scratch_release(pool, mark);
+}
+
+// Per-member slots of a region and the number of inconsistencies observed
+typedef struct RegionFixture {
+    int         slots[4];
+    atomic_uint errors;
+} region_fixture_t;
+
+// Counts visits to every element of the range, the counts pointed to by a
+static void visit_routine(thread_data_t* task) {
+    atomic_uchar* visits = (atomic_uchar*) task->a;
+    for (uint32_t i = task->begin; i < task->end; i++) {
+        atomic_fetch_add(&visits[i], 1);
+    }
+}
+
+// Alternates write and read phases, checking every member sees the others
+static void phase_region(thread_team_t* team, uint32_t id, void* arg) {
+    region_fixture_t* fixture = (region_fixture_t*) arg;
+    int*              slots   = fixture->slots;
+
+    for (int phase = 0; phase < 100; phase++) {
+        slots[id] = phase + (int) id;
+        thread_team_barrier(team, id);
+
+        uint32_t next = (id + 1) % team->size;
+        if (slots[next] != phase + (int) next) {
+            atomic_fetch_add(&fixture->errors, 1);
+        }
+
+        float sum = thread_team_reduce_sum(team, id, (float) id);
+        float max = thread_team_reduce_max(team, id, (float) id);
+        if (sum != (float) (team->size * (team->size - 1) / 2)
+            || max != (float) (team->size - 1)) {
+            atomic_fetch_add(&fixture->errors, 1);
+        }
+    }
+}
+
+// Pool a region nests another region over and the errors it observed
+typedef struct NestedFixture {
+    thread_pool_t* pool;
+    atomic_uint    errors;
+} nested_fixture_t;
+
+// Opens a region over the pool of the enclosing region from every member,
+// which must run alone rather than wait on the held workers
+static void nested_region(thread_team_t* team, uint32_t id, void* arg) {
+    nested_fixture_t* fixture = (nested_fixture_t*) arg;
+    region_fixture_t  inner   = {0};
+
+    uint32_t size = thread_pool_region(fixture->pool, 0, phase_region, &inner);
+    if (1 != size || 0 != atomic_load(&inner.errors)) {
+        atomic_fetch_add(&fixture->errors, 1);
+    }
+    thread_team_barrier(team, id);
+}
+
+// Context whose pool runs a region and the results member 0 computed
+typedef struct LeaderFixture {
+    linear_context_t* context;
+    const vector_t*   a;
+    float             mean;
+    atomic_uint       counter;
+} leader_fixture_t;
+
+// Runs parallel ops over the pool of the region from member 0 while the
+// other members wait at the barrier, holding every worker
+static void leader_region(thread_team_t* team, uint32_t id, void* arg) {
+    leader_fixture_t* fixture = (leader_fixture_t*) arg;
+
+    if (0 == id) {
+        fixture->mean = vector_mean_ctx(fixture->context, fixture->a);
+
+        thread_pool_t* pool  = fixture->context->pool;
+        thread_group_t group = {0};
+        thread_data_t  task  = {
+            .result  = &fixture->counter,
+            .routine = increment_routine,
+            .group   = &group,
+        };
+        for (uint32_t i = 0; i < 64; i++) {
+            thread_pool_submit(pool, task);
+        }
+        thread_group_wait(pool, &group);
+    }
+    thread_team_barrier(team, id);
+}
+
+// Fills an m x n matrix with small integers so products are exact
+static matrix_t* matrix_pattern_fixture(
+    linear_context_t* context, uint32_t rows, uint32_t columns, int seed
+) {
+    matrix_t* matrix = matrix_create_ctx(context, rows, columns);
+    for (uint32_t i = 0; i < rows * columns; i++) {
+        matrix->data[i] = (float) ((int) (i * 7 + seed) % 5 - 2);
+    }
+    return matrix;
+}
+
+// Compares c against a naive product of a and b
+static bool matrix_product_is_exact(
+    const matrix_t* a, const matrix_t* b, const matrix_t* c
+) {
+    for (uint32_t i = 0; i < c->rows; i++) {
+        for (uint32_t j = 0; j < c->columns; j++) {
+            float expected = 0.0f;
+            for (uint32_t k = 0; k < a->columns; k++) {
+                expected += a->data[i * a->columns + k]
+                            * b->data[k * b->columns + j];
+            }
+            if (expected != c->data[i * c->columns + j]) {
+                LOG_ERROR("Unexpected element at %u, %u.\n", i, j);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Unit Tests */
+
+bool test_linear_context_create(void) {
+    bool result = true;
+
+    linear_context_t* serial = linear_context_create(1);
+    linear_context_t* pooled = linear_context_create(4);
+
+    if (NULL == serial || NULL != serial->pool) {
+        LOG_ERROR("Expected a serial context without a pool.\n");
+        result = false;
+    }
+
+    if (NULL == pooled || NULL == pooled->pool
+        || 4 != linear_context_thread_count(pooled)) {
+        LOG_ERROR("Expected a context with a pool of 4 workers.\n");
+        result = false;
+    }
+
+    if (linear_context_default() != linear_context_resolve(NULL)) {
+        LOG_ERROR("Expected NULL to resolve to the default context.\n");
+        result = false;
+    }
+
+    linear_context_free(serial);
+    linear_context_free(pooled);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_context_task_count(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // Inputs smaller than the grain size stay on a single task
+    linear_context_set_tuning(context, TUNING_LATENCY);
+    if (1 != linear_context_task_count(context, 1000)) {
+        LOG_ERROR("Expected small inputs to execute as a single task.\n");
+        result = false;
+    }
+
+    // Large inputs are split into several tasks per worker
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+    if (16 != linear_context_task_count(context, 1 << 20)) {
+        LOG_ERROR("Expected 16 tasks for 4 workers under throughput.\n");
+        result = false;
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_context_allocator(void) {
+    bool result = true;
+    int  live   = 0;
+
+    linear_context_t*  context   = linear_context_create(1);
+    linear_allocator_t allocator = {
+        .allocate = counting_allocate,
+        .release  = counting_release,
+        .user     = &live,
+    };
+    linear_context_set_allocator(context, allocator);
+
+    vector_t* vector = vector_create_ctx(context, 8);
+    matrix_t* matrix = matrix_create_ctx(context, 2, 2);
+    if (4 != live) {
+        LOG_ERROR("Expected 4 live allocations, got %d.\n", live);
+        result = false;
+    }
+
+    vector_free_ctx(context, vector);
+    matrix_free_ctx(context, matrix);
+    if (0 != live) {
+        LOG_ERROR("Expected 0 live allocations, got %d.\n", live);
+        result = false;
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_context_schedule(void) {
+    bool result = true;
+
+    const uint32_t    count   = 100003; // prime, so chunks never divide evenly
+    linear_context_t* context = linear_context_create(4);
+    atomic_uchar*     visits  = calloc(count, sizeof(atomic_uchar));
+    vector_t*         a       = vector_range_fixture(context, 4096);
+    float             n       = 4096.0f;
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    for (int s = 0; s < SCHEDULE_COUNT; s++) {
+        linear_context_set_schedule(context, (linear_schedule_t) s);
+        for (uint32_t i = 0; i < count; i++) {
+            atomic_store(&visits[i], 0);
+        }
+
+        // Every element is visited exactly once regardless of the schedule
+        thread_data_t task = {.a = visits, .routine = visit_routine};
+        linear_context_parallel(context, task, count);
+        for (uint32_t i = 0; i < count; i++) {
+            if (1 != atomic_load(&visits[i])) {
+                LOG_ERROR("Schedule %d missed element %u.\n", s, i);
+                result = false;
+                break;
+            }
+        }
+
+        // Reductions accumulate every chunk a task executes
+        if (vector_mean_ctx(context, a) != (n + 1.0f) / 2.0f) {
+            LOG_ERROR("Unexpected mean under schedule %d.\n", s);
+            result = false;
+        }
+    }
+
+    free(visits);
+    vector_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_thread_cores(void) {
+    bool result = true;
+
+    uint32_t usable      = linear_thread_core_count(THREAD_CORE_ANY);
+    uint32_t performance = linear_thread_core_count(THREAD_CORE_PERFORMANCE);
+    uint32_t efficiency  = linear_thread_core_count(THREAD_CORE_EFFICIENCY);
+
+    // Homogeneous processors report every core as a performance core
+    if (0 == performance || performance + efficiency != usable
+        || linear_thread_is_hybrid() != (efficiency > 0)) {
+        LOG_ERROR(
+            "Inconsistent core counts %u + %u of %u.\n",
+            performance,
+            efficiency,
+            usable
+        );
+        result = false;
+    }
+
+    // Restricting a pool to performance cores keeps it functional
+    linear_context_t* context = linear_context_create(2);
+    if (!linear_context_set_cores(context, THREAD_CORE_PERFORMANCE)) {
+        LOG_ERROR("Failed to restrict the context to performance cores.\n");
+        result = false;
+    }
+
+    vector_t* a = vector_range_fixture(context, 4096);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+    if (vector_mean_ctx(context, a) != 2048.5f) {
+        LOG_ERROR("Unexpected mean on performance cores.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_linear_thread_count(void) {
+    bool result = true;
+
+    // Keep the environment of the process intact across the test
+    const char* saved    = getenv(LINEAR_THREAD_COUNT_ENV);
+    char*       original = (NULL != saved) ? strdup(saved) : NULL;
+
+    // Without an override the count honors both affinity and quota
+    unsetenv(LINEAR_THREAD_COUNT_ENV);
+    uint32_t detected = linear_thread_count_refresh();
+    uint32_t quota    = linear_thread_quota_count();
+    if (0 == detected || detected > linear_thread_affinity_count()
+        || (quota > 0 && detected > quota)
+        || detected != linear_thread_count()) {
+        LOG_ERROR("Unexpected default thread count %u.\n", detected);
+        result = false;
+    }
+
+    // A valid override wins, and is cached until the next refresh
+    setenv(LINEAR_THREAD_COUNT_ENV, "3", 1);
+    if (3 != linear_thread_count_refresh() || 3 != linear_thread_count()) {
+        LOG_ERROR("Expected the override of 3 threads.\n");
+        result = false;
+    }
+    setenv(LINEAR_THREAD_COUNT_ENV, "5", 1);
+    if (3 != linear_thread_count() || 5 != linear_thread_count_refresh()) {
+        LOG_ERROR("Expected the cached count until a refresh.\n");
+        result = false;
+    }
+
+    // Zero, junk and overflowing overrides fall back to detection
+    const char* invalid[] = {
+        "0", "junk", "4x", " 2", "-2", "4294967296", "99999999999999999999",
+    };
+    for (uint32_t i = 0; i < sizeof(invalid) / sizeof(*invalid); i++) {
+        setenv(LINEAR_THREAD_COUNT_ENV, invalid[i], 1);
+        if (detected != linear_thread_count_refresh()) {
+            LOG_ERROR("Expected '%s' to be ignored.\n", invalid[i]);
+            result = false;
+        }
+    }
+
+    // Default sized pools follow a refreshed count, fixed pools do not
+    setenv(LINEAR_THREAD_COUNT_ENV, "2", 1);
+    linear_thread_count_refresh();
+    thread_pool_t* automatic = thread_pool_create(0);
+    thread_pool_t* fixed     = thread_pool_create(2);
+    setenv(LINEAR_THREAD_COUNT_ENV, "3", 1);
+    if (!thread_pool_refresh(automatic) || 3 != automatic->thread_count
+        || thread_pool_refresh(automatic) || thread_pool_refresh(fixed)
+        || 2 != fixed->thread_count) {
+        LOG_ERROR("Expected only the default sized pool to refresh.\n");
+        result = false;
+    }
+    thread_pool_free(fixed);
+    thread_pool_free(automatic);
+
+    if (NULL != original) {
+        setenv(LINEAR_THREAD_COUNT_ENV, original, 1);
+        free(original);
+    } else {
+        unsetenv(LINEAR_THREAD_COUNT_ENV);
+    }
+    linear_thread_count_refresh();
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_resize(void) {
+    bool result = true;
+
+    thread_pool_t* pool    = thread_pool_create(2);
+    atomic_uint    counter = 0;
+    thread_data_t  task    = {
+        .result  = &counter,
+        .routine = increment_routine,
+    };
+
+    // Every resize lands while the previous tasks are still queued
+    const uint32_t sizes[] = {6, 1, 3};
+    for (uint32_t s = 0; s < 3; s++) {
+        for (uint32_t i = 0; i < 1000; i++) {
+            thread_pool_submit(pool, task);
+        }
+        if (!thread_pool_resize(pool, sizes[s])
+            || sizes[s] != pool->thread_count) {
+            LOG_ERROR("Failed to resize the pool to %u.\n", sizes[s]);
+            result = false;
+        }
+
+        // The new workers take part in a region
+        region_fixture_t fixture = {0};
+        uint32_t size = thread_pool_region(pool, 4, phase_region, &fixture);
+        if (size != ((sizes[s] < 3) ? sizes[s] + 1 : 4)
+            || 0 != atomic_load(&fixture.errors)) {
+            LOG_ERROR("Expected a region over %u workers.\n", sizes[s]);
+            result = false;
+        }
+    }
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        thread_pool_submit(pool, task);
+    }
+    thread_pool_wait(pool);
+
+    if (4000 != atomic_load(&counter)) {
+        LOG_ERROR(
+            "Expected 4000 tasks to run, %u did.\n", atomic_load(&counter)
+        );
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_priority(void) {
+    bool result = true;
+
+    thread_pool_t* pool = thread_pool_create(1);
+    atomic_int     open = 0;
+    int            log[8] = {0};
+    int            labels[THREAD_PRIORITY_COUNT] = {0, 1, 2};
+
+    // Occupy the only worker so the remaining tasks queue up
+    thread_data_t gate = {.a = &open, .routine = gate_routine};
+    thread_pool_submit(pool, gate);
+    while (0 == pool->active_count) {
+        sched_yield();
+    }
+
+    for (uint32_t p = THREAD_PRIORITY_COUNT; p-- > 0;) {
+        thread_data_t task = {
+            .a       = &labels[p],
+            .result  = log,
+            .routine = record_routine,
+        };
+        thread_pool_submit_priority(pool, task, (thread_priority_t) p);
+    }
+
+    atomic_store(&open, 1);
+    thread_pool_wait(pool);
+
+    // Submitted low to high, executed high to low
+    if (3 != log[0] || 0 != log[1] || 1 != log[2] || 2 != log[3]) {
+        LOG_ERROR("Tasks were not executed in priority order.\n");
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_deadline(void) {
+    bool result = true;
+
+    thread_pool_t* pool      = thread_pool_create(1);
+    atomic_int     open      = 0;
+    int            log[4]    = {0};
+    int            label     = 7;
+
+    thread_data_t gate = {.a = &open, .routine = gate_routine};
+    thread_pool_submit(pool, gate);
+    while (0 == pool->active_count) {
+        sched_yield();
+    }
+
+    // Expires while the worker is occupied
+    thread_data_t task = {
+        .a        = &label,
+        .result   = log,
+        .routine  = record_routine,
+        .deadline = thread_deadline_after(1000),
+        .cancel   = cancel_routine,
+    };
+    thread_pool_submit(pool, task);
+
+    // Never expires
+    task.deadline = 0;
+    task.cancel   = NULL;
+    thread_pool_submit(pool, task);
+
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&pause, NULL);
+    atomic_store(&open, 1);
+    thread_pool_wait(pool);
+
+    if (2 != log[0] || -7 != log[1] || 7 != log[2]
+        || 1 != pool->expired_count) {
+        LOG_ERROR("Expected exactly one task to expire.\n");
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_starvation(void) {
+    bool result = true;
+
+    thread_pool_t* pool     = thread_pool_create(1);
+    atomic_int     open     = 0;
+    int            log[64]  = {0};
+    int            high     = 1;
+    int            low      = 2;
+    uint32_t       position = 0;
+
+    thread_data_t gate = {.a = &open, .routine = gate_routine};
+    thread_pool_submit(pool, gate);
+    while (0 == pool->active_count) {
+        sched_yield();
+    }
+
+    thread_data_t task = {
+        .a       = &low,
+        .result  = log,
+        .routine = record_routine,
+    };
+    thread_pool_submit_priority(pool, task, THREAD_PRIORITY_LOW);
+    task.a = &high;
+    for (uint32_t i = 0; i < 2 * LINEAR_THREAD_STARVATION_LIMIT; i++) {
+        thread_pool_submit_priority(pool, task, THREAD_PRIORITY_HIGH);
+    }
+
+    atomic_store(&open, 1);
+    thread_pool_wait(pool);
+
+    for (uint32_t i = 1; i <= (uint32_t) log[0]; i++) {
+        if (low == log[i]) {
+            position = i;
+        }
+    }
+
+    // The low priority task runs once the limit of bypasses is reached
+    if (LINEAR_THREAD_STARVATION_LIMIT + 1 != position) {
+        LOG_ERROR("Low priority task ran at position %u.\n", position);
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_nested_wait(void) {
+    bool result = true;
+
+    thread_pool_t* pool  = thread_pool_create(2);
+    atomic_uint    count = 0;
+
+    // Every worker waits within a task, so only helping makes progress
+    thread_data_t task = {
+        .a       = pool,
+        .result  = &count,
+        .routine = nested_routine,
+    };
+    for (uint32_t i = 0; i < 4; i++) {
+        thread_pool_submit(pool, task);
+    }
+    thread_pool_wait(pool);
+
+    if (16 != atomic_load(&count)) {
+        LOG_ERROR("Expected 16 subtasks, got %u.\n", atomic_load(&count));
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_submit_batch(void) {
+    bool result = true;
+
+    thread_pool_t* pool  = thread_pool_create(4);
+    atomic_uint    count = 0;
+
+    // Four workers and the calling thread produce concurrently
+    thread_data_t producers[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        producers[i] = (thread_data_t) {
+            .a       = pool,
+            .result  = &count,
+            .routine = batch_routine,
+        };
+    }
+    thread_pool_submit_batch(pool, producers, 4, THREAD_PRIORITY_NORMAL);
+    batch_routine(&producers[0]);
+    thread_pool_wait(pool);
+
+    uint32_t expected = 5 * BATCH_TASK_COUNT;
+    if (expected != atomic_load(&count) || 0 != pool->task_count) {
+        LOG_ERROR(
+            "Expected %u increments, got %u.\n", expected, atomic_load(&count)
+        );
+        result = false;
+    }
+
+    // An empty batch is a no-op
+    thread_pool_submit_batch(pool, producers, 0, THREAD_PRIORITY_NORMAL);
+    thread_pool_wait(pool);
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_scratch(void) {
+    bool result = true;
+
+    thread_pool_t* pool = thread_pool_create(2);
+    size_t         size = 4 * LINEAR_THREAD_SCRATCH_SIZE;
+    void*          first[3];
+    void*          large[3];
+
+    // The calling thread outgrows its first block, after which the workspace
+    // settles on a single block and returns the same memory every time
+    for (uint32_t i = 0; i < 3; i++) {
+        size_t mark = thread_scratch_mark(pool);
+        first[i]    = thread_scratch_alloc(pool, 100);
+        large[i]    = thread_scratch_alloc(pool, size);
+        thread_scratch_release(pool, mark);
+    }
+    if (NULL == first[2] || first[1] != first[2] || large[1] != large[2]
+        || 0 != (uintptr_t) large[2] % LINEAR_THREAD_SCRATCH_ALIGNMENT) {
+        LOG_ERROR("Expected the settled workspace to be reused.\n");
+        result = false;
+    }
+
+    // Workers allocate from their own workspaces
+    atomic_uint   errors = 0;
+    thread_data_t task   = {
+        .a       = pool,
+        .result  = &errors,
+        .routine = scratch_routine,
+    };
+    for (uint32_t i = 0; i < 64; i++) {
+        thread_pool_submit(pool, task);
+    }
+    thread_pool_wait(pool);
+
+    if (0 != atomic_load(&errors) || 0 == thread_pool_scratch_size(pool)) {
+        LOG_ERROR("Workers failed to allocate scratch memory.\n");
+        result = false;
+    }
+
+    // Idle workers release their workspaces once asked to
+    thread_pool_trim(pool);
+    for (uint32_t i = 0; i < 100000 && thread_pool_scratch_size(pool); i++) {
+        sched_yield();
+    }
+    if (0 != thread_pool_scratch_size(pool)) {
+        LOG_ERROR("Expected the workers to trim their workspaces.\n");
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_region(void) {
+    bool result = true;
+
+    thread_pool_t*   pool    = thread_pool_create(2);
+    region_fixture_t fixture = {0};
+
+    // Two workers join the calling thread
+    uint32_t size   = thread_pool_region(pool, 0, phase_region, &fixture);
+    uint32_t errors = atomic_load(&fixture.errors);
+    if (3 != size || 0 != errors) {
+        LOG_ERROR("Region of %u members saw %u errors.\n", size, errors);
+        result = false;
+    }
+
+    // Without a pool the region runs with a team of one
+    region_fixture_t serial = {0};
+    if (1 != thread_pool_region(NULL, 4, phase_region, &serial)
+        || 0 != atomic_load(&serial.errors)) {
+        LOG_ERROR("Expected a serial region to run with one member.\n");
+        result = false;
+    }
+
+    // Nested regions over the same pool run inline instead of deadlocking
+    nested_fixture_t nested = {.pool = pool};
+    if (3 != thread_pool_region(pool, 0, nested_region, &nested)
+        || 0 != atomic_load(&nested.errors)) {
+        LOG_ERROR("Expected nested regions to run with one member.\n");
+        result = false;
+    }
+
+    // Member 0 may run ops over the pool whose workers the team holds
+    linear_context_t* context = linear_context_create(2);
+    vector_t*         range   = vector_range_fixture(context, 4096);
+    leader_fixture_t  leader  = {.context = context, .a = range};
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+    if (3 != linear_context_region(context, leader_region, &leader)
+        || 2048.5f != leader.mean || 64 != atomic_load(&leader.counter)) {
+        LOG_ERROR("Expected member 0 to run parallel ops.\n");
+        result = false;
+    }
+    vector_free_ctx(context, range);
+    linear_context_free(context);
+
+    // Leaving the enclosing region restores the full team
+    region_fixture_t after = {0};
+    if (3 != thread_pool_region(pool, 0, phase_region, &after)
+        || 0 != atomic_load(&after.errors)) {
+        LOG_ERROR("Expected a full team after a nested region.\n");
+        result = false;
+    }
+
+    thread_pool_free(pool);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_thread_pool_fork(void) {
+    bool result = true;
+
+    // Configured in the parent without spawning any worker
+    linear_context_t* context = linear_context_create_deferred(2);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+    if (atomic_load(&context->pool->started)) {
+        LOG_ERROR("Expected a deferred pool without workers.\n");
+        result = false;
+    }
+
+    // Start the parent's workers so the child inherits a live pool
+    vector_t* a = vector_range_fixture(context, 4096);
+    float     n = 4096.0f;
+    if (vector_mean_ctx(context, a) != (n + 1.0f) / 2.0f) {
+        LOG_ERROR("Unexpected mean in the parent.\n");
+        result = false;
+    }
+
+    pid_t child = fork();
+    if (0 == child) {
+        // The child rebuilds its workers upon first use
+        bool rebuilt = !atomic_load(&context->pool->started)
+                       && vector_mean_ctx(context, a) == (n + 1.0f) / 2.0f
+                       && atomic_load(&context->pool->started);
+        _exit(rebuilt ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    int status = 0;
+    if (child < 0 || child != waitpid(child, &status, 0)
+        || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status)) {
+        LOG_ERROR("Expected the child to rebuild its pool.\n");
+        result = false;
+    }
+
+    // The parent's pool is unaffected by the fork
+    if (vector_mean_ctx(context, a) != (n + 1.0f) / 2.0f) {
+        LOG_ERROR("Unexpected mean in the parent after fork.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_vector_add_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 100000;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t* a   = vector_range_fixture(context, columns);
+    vector_t* b   = vector_range_fixture(context, columns);
+    vector_t* sum = vector_vector_add_ctx(context, a, b);
+
+    float* data = (float*) sum->data;
+    for (uint32_t i = 0; i < columns; i++) {
+        if (data[i] != 2.0f * (float) (i + 1)) {
+            LOG_ERROR("Unexpected element %f at index %u.\n", data[i], i);
+            result = false;
+            break;
+        }
+    }
+
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    vector_free_ctx(context, sum);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_dot_product_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 4096;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t* a = vector_range_fixture(context, columns);
+    float     n = (float) columns;
+
+    // 1^2 + 2^2 + ... + n^2 = n(n + 1)(2n + 1) / 6
+    float expected = n * (n + 1.0f) * (2.0f * n + 1.0f) / 6.0f;
+    float dot      = vector_dot_product_ctx(context, a, a);
+    if (fabsf(dot - expected) > 1e-3f * expected) {
+        LOG_ERROR("Expected dot product %f, got %f.\n", expected, dot);
+        result = false;
+    }
+
+    float mean = vector_mean_ctx(context, a);
+    if (fabsf(mean - (n + 1.0f) / 2.0f) > 1e-3f) {
+        LOG_ERROR("Expected mean %f, got %f.\n", (n + 1.0f) / 2.0f, mean);
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_elementwise_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 10000;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t* a = vector_range_fixture(context, columns);
+    vector_t* b = vector_create_ctx(context, columns);
+
+    // Every element equal to 2 has magnitude 2 * sqrt(n) and unit 1 / sqrt(n)
+    vector_fill_ctx(context, b, 2.0f);
+    vector_t* unit     = vector_normalize_ctx(context, b, false);
+    float     expected = 1.0f / sqrtf((float) columns);
+    if (NULL == unit || ((float*) b->data)[columns - 1] != 2.0f
+        || fabsf(((float*) unit->data)[columns - 1] - expected) > 1e-6f) {
+        LOG_ERROR("Unexpected fill or normalization.\n");
+        result = false;
+    }
+
+    vector_t* clipped = vector_clip_ctx(context, a, 10.0f, 20.0f, false);
+    vector_clip_ctx(context, a, 100.0f, 200.0f, true);
+
+    float* x = (float*) a->data;
+    float* z = (float*) clipped->data;
+    for (uint32_t i = 0; i < columns; i++) {
+        float value = (float) (i + 1);
+        if (z[i] != fminf(fmaxf(value, 10.0f), 20.0f)
+            || x[i] != fminf(fmaxf(value, 100.0f), 200.0f)) {
+            LOG_ERROR("Unexpected clipped element at index %u.\n", i);
+            result = false;
+            break;
+        }
+    }
+
+    // The shallow copy shares its elements with the source vector
+    vector_t* shallow = vector_shallow_copy_ctx(context, a);
+    if (shallow->data != a->data || shallow->columns != columns) {
+        LOG_ERROR("Shallow copy does not share the source elements.\n");
+        result = false;
+    }
+    linear_context_release(context, shallow);
+
+    vector_t* i = vector_create_ctx(context, 3);
+    vector_t* j = vector_create_ctx(context, 3);
+    ((float*) i->data)[0] = 1.0f;
+    ((float*) j->data)[1] = 1.0f;
+
+    vector_t* k = vector_cross_product_ctx(context, i, j);
+    if (NULL == k || ((float*) k->data)[2] != 1.0f
+        || NULL != vector_cross_product_ctx(context, a, j)) {
+        LOG_ERROR("Unexpected cross product.\n");
+        result = false;
+    }
+
+    vector_t* point = vector_create_ctx(context, 2);
+    ((float*) point->data)[0] = 3.0f;
+    ((float*) point->data)[1] = 4.0f;
+
+    vector_t* polar     = vector_cartesian_to_polar_ctx(context, point);
+    vector_t* cartesian = vector_polar_to_cartesian_ctx(context, polar);
+    if (((float*) polar->data)[0] != 5.0f
+        || fabsf(((float*) cartesian->data)[0] - 3.0f) > 1e-5f
+        || fabsf(((float*) cartesian->data)[1] - 4.0f) > 1e-5f) {
+        LOG_ERROR("Unexpected coordinate conversion.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    vector_free_ctx(context, unit);
+    vector_free_ctx(context, clipped);
+    vector_free_ctx(context, i);
+    vector_free_ctx(context, j);
+    vector_free_ctx(context, k);
+    vector_free_ctx(context, point);
+    vector_free_ctx(context, polar);
+    vector_free_ctx(context, cartesian);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_compare_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 100003; // the last mask word is partial
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t*      a     = vector_range_fixture(context, columns);
+    vector_t*      b     = vector_create_ctx(context, columns);
+    vector_mask_t* lower = vector_mask_create_ctx(context, columns);
+    vector_mask_t* upper = vector_mask_create_ctx(context, columns);
+    float*         y     = (float*) b->data;
+
+    // b matches a on even indices and exceeds it on odd ones
+    for (uint32_t i = 0; i < columns; i++) {
+        y[i] = (float) (i + 1 + i % 2);
+    }
+
+    if (!vector_compare_ctx(context, a, b, VECTOR_COMPARE_EQ, lower)
+        || (columns + 1) / 2 != vector_mask_count_ctx(context, lower)
+        || !vector_compare_ctx(context, a, b, VECTOR_COMPARE_LE, lower)
+        || columns != vector_mask_count_ctx(context, lower)) {
+        LOG_ERROR("Unexpected vector-vector comparisons.\n");
+        result = false;
+    }
+
+    // 1000 < a <= 2000 selects the elements at indices 1000 through 1999
+    vector_compare_scalar_ctx(context, a, 1000.0f, VECTOR_COMPARE_GT, lower);
+    vector_compare_scalar_ctx(context, a, 2000.0f, VECTOR_COMPARE_LE, upper);
+    vector_mask_and_ctx(context, lower, upper, lower);
+    if (1000 != vector_mask_count_ctx(context, lower)
+        || (lower->bits[999 / 64] >> (999 % 64) & 1)
+        || !(lower->bits[1000 / 64] >> (1000 % 64) & 1)) {
+        LOG_ERROR("Unexpected range mask.\n");
+        result = false;
+    }
+
+    // Negation leaves the bits past the last element clear
+    vector_mask_not_ctx(context, lower, upper);
+    if (columns - 1000 != vector_mask_count_ctx(context, upper)) {
+        LOG_ERROR("Expected %u elements outside the range.\n", columns - 1000);
+        result = false;
+    }
+
+    // Only inequality holds for NaN, which also counts as non-zero
+    y[0] = NAN;
+    y[1] = 0.0f;
+    vector_compare_ctx(context, b, b, VECTOR_COMPARE_NE, upper);
+    if (1 != vector_mask_count_ctx(context, upper)
+        || columns - 1 != vector_count_nonzero_ctx(context, b)) {
+        LOG_ERROR("Unexpected comparison or count with NaN.\n");
+        result = false;
+    }
+
+    vector_mask_free_ctx(context, lower);
+    vector_mask_free_ctx(context, upper);
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_select_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 4099;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t*      a    = vector_range_fixture(context, columns);
+    vector_t*      b    = vector_create_ctx(context, columns);
+    vector_mask_t* mask = vector_mask_create_ctx(context, columns);
+
+    // Select the elements greater than 100, and divide them by zero
+    vector_compare_scalar_ctx(context, a, 100.0f, VECTOR_COMPARE_GT, mask);
+    vector_t* selected = vector_select_ctx(context, mask, a, b);
+    vector_t* boolean  = vector_mask_expand_ctx(context, mask);
+    vector_t* quotient = vector_masked_divide_ctx(context, mask, a, b);
+
+    if (NULL == selected || NULL == boolean || NULL == quotient) {
+        LOG_ERROR("Failed to select under a mask.\n");
+        result = false;
+    } else {
+        float* s = (float*) selected->data;
+        float* m = (float*) boolean->data;
+        float* q = (float*) quotient->data;
+        for (uint32_t i = 0; i < columns; i++) {
+            bool  kept     = i >= 100;
+            float expected = (kept) ? (float) (i + 1) : 0.0f;
+            if (s[i] != expected || m[i] != (float) kept
+                || (kept ? !isinf(q[i]) : q[i] != (float) (i + 1))) {
+                LOG_ERROR("Unexpected selection at index %u.\n", i);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    // The mask must cover as many elements as the operands
+    b->columns = columns - 1;
+    if (NULL != vector_masked_add_ctx(context, mask, a, b)) {
+        LOG_ERROR("Expected mismatched operands to fail.\n");
+        result = false;
+    }
+    b->columns = columns;
+
+    vector_free_ctx(context, selected);
+    vector_free_ctx(context, boolean);
+    vector_free_ctx(context, quotient);
+    vector_mask_free_ctx(context, mask);
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_filter_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 1 << 20;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t* a       = vector_create_ctx(context, columns);
+    float*    x       = (float*) a->data;
+    uint32_t* indices = malloc(sizeof(uint32_t) * columns);
+
+    // Roughly a third of the elements are positive, scattered over the words
+    for (uint32_t i = 0; i < columns; i++) {
+        x[i] = (float) ((i * 7919) % 3) - 1.0f + (float) i / columns;
+    }
+
+    uint32_t  expected = 0;
+    vector_t* kept     = vector_filter_ctx(
+        context, a, VECTOR_COMPARE_GT, 0.0f, indices
+    );
+    for (uint32_t i = 0; i < columns; i++) {
+        if (x[i] > 0.0f) {
+            if (NULL == kept || expected >= kept->columns
+                || indices[expected] != i
+                || ((float*) kept->data)[expected] != x[i]) {
+                LOG_ERROR("Unexpected compaction at index %u.\n", i);
+                result = false;
+                break;
+            }
+            expected++;
+        }
+    }
+    if (NULL == kept || expected != kept->columns) {
+        LOG_ERROR("Expected %u elements to be kept.\n", expected);
+        result = false;
+    }
+
+    // Nothing satisfies the predicate, which is not an error
+    vector_t* none = vector_filter_ctx(
+        context, a, VECTOR_COMPARE_GT, 10.0f, NULL
+    );
+    if (NULL == none || 0 != none->columns) {
+        LOG_ERROR("Expected an empty compaction.\n");
+        result = false;
+    }
+
+    // Bits set by the caller past the last element are ignored
+    vector_mask_t* stray = vector_mask_create_ctx(context, 70);
+    vector_t*      ramp  = vector_range_fixture(context, 70);
+    stray->bits[0]       = 1;
+    stray->bits[1]       = ~UINT64_C(0);
+    vector_t* tail       = vector_compress_ctx(context, stray, ramp, NULL);
+    if (7 != vector_mask_count_ctx(context, stray) || NULL == tail
+        || 7 != tail->columns || 70.0f != ((float*) tail->data)[6]
+        || !vector_mask_or_ctx(context, stray, stray, stray)
+        || 0x3f != stray->bits[1]) {
+        LOG_ERROR("Expected the bits past the last element to be ignored.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, tail);
+    vector_free_ctx(context, ramp);
+    vector_mask_free_ctx(context, stray);
+    vector_free_ctx(context, none);
+    vector_free_ctx(context, kept);
+    vector_free_ctx(context, a);
+    free(indices);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_nonfinite_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 100000;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t* a = vector_range_fixture(context, columns);
+    float*    x = (float*) a->data;
+
+    if (!vector_all_finite_ctx(context, a)
+        || 0 != vector_count_nonfinite_ctx(context, a)) {
+        LOG_ERROR("Expected every element to be finite.\n");
+        result = false;
+    }
+
+    x[7]           = NAN;
+    x[columns / 2] = INFINITY;
+    x[columns - 1] = -INFINITY;
+    if (vector_all_finite_ctx(context, a)
+        || 3 != vector_count_nonfinite_ctx(context, a)) {
+        LOG_ERROR("Expected 3 non-finite elements.\n");
+        result = false;
+    }
+
+    // Rejection leaves the vector untouched, sanitization replaces them
+    linear_context_set_validation(context, VALIDATION_REJECT);
+    if (vector_ingest_ctx(context, a) || !isnan(x[7])) {
+        LOG_ERROR("Expected the vector to be rejected.\n");
+        result = false;
+    }
+
+    linear_context_set_validation(context, VALIDATION_SANITIZE);
+    if (!vector_ingest_ctx(context, a) || 0.0f != x[7]
+        || FLT_MAX != x[columns / 2] || -FLT_MAX != x[columns - 1]
+        || 9.0f != x[8] || !vector_all_finite_ctx(context, a)) {
+        LOG_ERROR("Expected the vector to be sanitized.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_vector_is_close_ctx(void) {
+    bool result = true;
+
+    const uint32_t    columns = 100000;
+    linear_context_t* context = linear_context_create(4);
+    linear_context_set_tuning(context, TUNING_THROUGHPUT);
+
+    vector_t*          a      = vector_range_fixture(context, columns);
+    vector_t*          b      = vector_range_fixture(context, columns);
+    float*             y      = (float*) b->data;
+    vector_closeness_t report = {0};
+
+    // Each element of b lies one representable float above a
+    for (uint32_t i = 0; i < columns; i++) {
+        y[i] = nextafterf(y[i], INFINITY);
+    }
+
+    vector_tolerance_t ulps = {.ulps = 1};
+    if (!vector_is_close_ctx(context, a, b, &ulps, &report)
+        || UINT32_MAX != report.mismatch || 0.0f == report.max_error) {
+        LOG_ERROR("Expected elements one ulp apart to be close.\n");
+        result = false;
+    }
+
+    vector_tolerance_t exact = {0};
+    if (vector_is_close_ctx(context, a, b, &exact, &report)
+        || 0 != report.mismatch) {
+        LOG_ERROR("Expected the first element to mismatch exactly.\n");
+        result = false;
+    }
+
+    // The first of several mismatches is reported, wherever the tasks start
+    y[columns - 3] = 0.0f;
+    y[columns / 2] = 0.0f;
+    y[columns / 3] = NAN;
+    if (vector_is_close_ctx(context, a, b, NULL, &report)
+        || columns / 3 != report.mismatch) {
+        LOG_ERROR("Expected the mismatch at %u.\n", columns / 3);
+        result = false;
+    }
+
+    // Infinities are only close to themselves, whatever the tolerance
+    vector_t* c = vector_create_ctx(context, 4);
+    vector_t* d = vector_create_ctx(context, 4);
+    float     u[] = {1.0f, 2.0f, INFINITY, INFINITY};
+    float     v[] = {1.0f, 2.0f, INFINITY, 5.0f};
+    memcpy(c->data, u, sizeof(u));
+    memcpy(d->data, v, sizeof(v));
+    vector_tolerance_t loose = {.absolute = 1.0f, .relative = 1.0f};
+    if (vector_is_close_ctx(context, c, d, &loose, &report)
+        || 3 != report.mismatch) {
+        LOG_ERROR("Expected an infinity to mismatch a finite value.\n");
+        result = false;
+    }
+
+    ((float*) d->data)[3] = -INFINITY;
+    if (vector_is_close_ctx(context, c, d, NULL, &report)
+        || 3 != report.mismatch) {
+        LOG_ERROR("Expected +inf to mismatch -inf.\n");
+        result = false;
+    }
+
+    // Nor is the largest float one ulp from infinity
+    ((float*) d->data)[3] = FLT_MAX;
+    if (vector_is_close_ctx(context, c, d, &ulps, &report)
+        || 3 != report.mismatch) {
+        LOG_ERROR("Expected +inf to mismatch FLT_MAX.\n");
+        result = false;
+    }
+
+    ((float*) d->data)[3] = INFINITY;
+    if (!vector_is_close_ctx(context, c, d, NULL, &report)) {
+        LOG_ERROR("Expected equal infinities to be close.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, d);
+    vector_free_ctx(context, c);
+
+    // Close to a scalar within an absolute tolerance
+    vector_tolerance_t absolute = {.absolute = (float) columns};
+    if (!vector_is_close_scalar_ctx(context, a, 0.0f, &absolute, &report)
+        || (float) columns != report.max_error) {
+        LOG_ERROR("Expected a largest error of %u.\n", columns);
+        result = false;
+    }
+
+    vector_free_ctx(context, a);
+    vector_free_ctx(context, b);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_scalar_multiply_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         matrix  = matrix_create_ctx(context, 64, 64);
+    matrix_fill_ctx(context, matrix, 1.5f);
+
+    matrix_t* product = matrix_scalar_multiply_ctx(context, matrix, 2.0f);
+    for (uint32_t i = 0; i < matrix_element_count(product); i++) {
+        float value = product->data[i];
+        if (3.0f != value) {
+            LOG_ERROR("Unexpected element %f at index %u.\n", value, i);
+            result = false;
+            break;
+        }
+    }
+
+    matrix_free_ctx(context, matrix);
+    matrix_free_ctx(context, product);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_product_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         a       = matrix_pattern_fixture(context, 33, 17, 1);
+    matrix_t*         b       = matrix_pattern_fixture(context, 17, 29, 3);
+    matrix_t*         c       = matrix_product_ctx(context, a, b);
+
+    if (NULL == c || !matrix_product_is_exact(a, b, c)) {
+        LOG_ERROR("Matrix product does not match the naive product.\n");
+        result = false;
+    }
+
+    // Mismatched inner dimensions are rejected
+    if (NULL != matrix_product_ctx(context, a, a)) {
+        LOG_ERROR("Expected mismatched dimensions to be rejected.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, a);
+    matrix_free_ctx(context, b);
+    matrix_free_ctx(context, c);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_gemm_batched_ctx(void) {
+    bool result = true;
+
+    enum { BATCH = 4 };
+
+    linear_context_t* context = linear_context_create(2);
+    const matrix_t*   a[BATCH];
+    const matrix_t*   b[BATCH];
+    matrix_t*         c[BATCH];
+
+    for (int i = 0; i < BATCH; i++) {
+        a[i] = matrix_pattern_fixture(context, 64, 64, i);
+        b[i] = matrix_pattern_fixture(context, 64, 64, i + 1);
+        c[i] = matrix_create_ctx(context, 64, 64);
+    }
+
+    // Items and the rows within each item are both parallel
+    if (!matrix_gemm_batched_ctx(context, BATCH, 1.0f, a, b, 0.0f, c)) {
+        LOG_ERROR("Batched GEMM failed.\n");
+        result = false;
+    }
+
+    for (int i = 0; i < BATCH && result; i++) {
+        result = matrix_product_is_exact(a[i], b[i], c[i]);
+    }
+
+    for (int i = 0; i < BATCH; i++) {
+        matrix_free_ctx(context, (matrix_t*) a[i]);
+        matrix_free_ctx(context, (matrix_t*) b[i]);
+        matrix_free_ctx(context, c[i]);
+    }
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Context lifecycle management
+    result &= test_linear_context_create();
+    result &= test_linear_context_task_count();
+    result &= test_linear_context_allocator();
+    result &= test_linear_context_schedule();
+    result &= test_linear_thread_cores();
+    result &= test_linear_thread_count();
+
+    // Thread pool scheduling
+    result &= test_thread_pool_resize();
+    result &= test_thread_pool_priority();
+    result &= test_thread_pool_deadline();
+    result &= test_thread_pool_starvation();
+    result &= test_thread_pool_nested_wait();
+    result &= test_thread_pool_submit_batch();
+    result &= test_thread_pool_scratch();
+    result &= test_thread_pool_region();
+    result &= test_thread_pool_fork();
+
+    // Context operations
+    result &= test_vector_vector_add_ctx();
+    result &= test_vector_dot_product_ctx();
+    result &= test_vector_elementwise_ctx();
+    result &= test_vector_compare_ctx();
+    result &= test_vector_select_ctx();
+    result &= test_vector_filter_ctx();
+    result &= test_vector_nonfinite_ctx();
+    result &= test_vector_is_close_ctx();
+    result &= test_matrix_scalar_multiply_ctx();
+    result &= test_matrix_product_ctx();
+    result &= test_matrix_gemm_batched_ctx();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,408 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_covariance.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "context.h"
+#include "covariance.h"
+#include "logger.h"
+#include "lowrank.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Covariance
+bool test_covariance_update(void);
+bool test_covariance_merge(void);
+
+// Incremental PCA
+bool test_pca_update(void);
+bool test_pca_merge(void);
+
+/** Fixtures */
+
+// Creates n x d rows of full rank, offset far from the origin so that an
+// uncentered accumulation would lose precision
+static matrix_t*
+rows_fixture(linear_context_t* context, uint32_t n, uint32_t d) {
+    matrix_t* rows = matrix_create_ctx(context, n, d);
+    for (uint32_t r = 0; r < n; r++) {
+        for (uint32_t j = 0; j < d; j++) {
+            float noise = (float) ((r * 7 + j * 3 + r * j) % 17) / 4.0f;
+            rows->data[r * d + j] = 50.0f + noise + 0.1f * j;
+        }
+    }
+    return rows;
+}
+
+// Creates n x d rows of rank 3 around a mean offset from the origin
+static matrix_t*
+rank3_fixture(linear_context_t* context, uint32_t n, uint32_t d) {
+    matrix_t* rows = matrix_create_ctx(context, n, d);
+    for (uint32_t r = 0; r < n; r++) {
+        for (uint32_t j = 0; j < d; j++) {
+            float e = 3.0f + 0.5f * j;
+            for (uint32_t t = 0; t < 3; t++) {
+                float a  = (float) ((r * (t * 5 + 3) + t) % 11) - 5.0f;
+                float b  = (float) ((j * (t + 2) + t * 7) % 13) - 6.0f;
+                e       += a * b / (2.0f + t);
+            }
+            rows->data[r * d + j] = e;
+        }
+    }
+    return rows;
+}
+
+// View of rows [first, first + count) of a matrix
+static matrix_t slice_fixture(matrix_t* rows, uint32_t first, uint32_t count) {
+    matrix_t slice = {
+        .data    = rows->data + (size_t) first * rows->columns,
+        .rows    = count,
+        .columns = rows->columns,
+        .state   = MATRIX_NONE,
+    };
+    return slice;
+}
+
+// Largest relative difference between the unbiased covariance of an
+// accumulator and a two-pass double precision reference over the rows
+static double covariance_error(const covariance_t* cov, const matrix_t* rows) {
+    const uint32_t n = rows->rows;
+    const uint32_t d = rows->columns;
+
+    matrix_t* matrix = covariance_to_matrix_ctx(NULL, cov, true);
+    double*   mean   = calloc(d, sizeof(double));
+    if (NULL == matrix || NULL == mean) {
+        matrix_free_ctx(NULL, matrix);
+        free(mean);
+        return INFINITY;
+    }
+
+    for (uint32_t r = 0; r < n; r++) {
+        for (uint32_t j = 0; j < d; j++) {
+            mean[j] += rows->data[r * d + j] / (double) n;
+        }
+    }
+
+    double error = 0.0;
+    double scale = 0.0;
+    for (uint32_t i = 0; i < d; i++) {
+        error = fmax(error, fabs(cov->mean[i] - mean[i]) / fabs(mean[i]));
+        for (uint32_t j = 0; j < d; j++) {
+            double s = 0.0;
+            for (uint32_t r = 0; r < n; r++) {
+                s += (rows->data[r * d + i] - mean[i])
+                     * (rows->data[r * d + j] - mean[j]);
+            }
+            s     /= n - 1;
+            scale  = fmax(scale, fabs(s));
+            error  = fmax(error, fabs(matrix->data[i * d + j] - s));
+        }
+    }
+
+    matrix_free_ctx(NULL, matrix);
+    free(mean);
+    return error / fmax(scale, 1.0);
+}
+
+// Verify a PCA found orthonormal components with the singular values of
+// the centered rows
+static bool pca_is_valid(
+    linear_context_t* context, const pca_t* pca, const matrix_t* rows
+) {
+    const uint32_t n = rows->rows;
+    const uint32_t d = rows->columns;
+
+    matrix_t* centered = matrix_create_ctx(context, n, d);
+    for (uint32_t j = 0; j < d; j++) {
+        double mean = 0.0;
+        for (uint32_t r = 0; r < n; r++) {
+            mean += rows->data[r * d + j] / (double) n;
+        }
+        for (uint32_t r = 0; r < n; r++) {
+            centered->data[r * d + j] = (float) (rows->data[r * d + j] - mean);
+        }
+    }
+
+    lowrank_t* lowrank = lowrank_from_matrix_ctx(context, centered, pca->rank);
+    bool       result  = NULL != lowrank && pca->size == pca->rank
+                  && pca->count == n;
+
+    for (uint32_t t = 0; result && t < pca->size; t++) {
+        double norm = 0.0;
+        for (uint32_t r = 0; r < n; r++) {
+            float e  = lowrank->u->data[r * pca->rank + t];
+            norm    += (double) e * e;
+        }
+        if (fabs(sqrt(norm) - pca->singular[t]) > 1e-3 * sqrt(norm)) {
+            LOG_ERROR(
+                "Singular value %u is %f, expected %f.\n",
+                t,
+                pca->singular[t],
+                sqrt(norm)
+            );
+            result = false;
+        }
+
+        for (uint32_t s = 0; s < pca->size; s++) {
+            double dot = 0.0;
+            for (uint32_t j = 0; j < d; j++) {
+                dot += (double) pca->components->data[t * d + j]
+                       * pca->components->data[s * d + j];
+            }
+            if (fabs(dot - (s == t ? 1.0 : 0.0)) > 1e-4) {
+                LOG_ERROR("Components %u and %u are not orthonormal.\n", t, s);
+                result = false;
+            }
+        }
+    }
+
+    lowrank_free_ctx(context, lowrank);
+    matrix_free_ctx(context, centered);
+    return result;
+}
+
+/** Unit Tests */
+
+bool test_covariance_update(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // A single tile, then partial tiles on both sides of the diagonal
+    const uint32_t dimensions[] = {37, 130};
+    const uint32_t chunks[]     = {1, 100, 299, 300};
+    for (uint32_t s = 0; s < 2; s++) {
+        const uint32_t d    = dimensions[s];
+        matrix_t*      rows = rows_fixture(context, 700, d);
+        covariance_t*  cov  = covariance_create_ctx(context, d);
+
+        uint32_t first = 0;
+        for (uint32_t c = 0; c < 4; c++) {
+            matrix_t chunk = slice_fixture(rows, first, chunks[c]);
+            if (!covariance_update_ctx(context, cov, &chunk)) {
+                LOG_ERROR("Failed to ingest a chunk of %u rows.\n", chunks[c]);
+                result = false;
+            }
+            first += chunks[c];
+        }
+
+        double error = covariance_error(cov, rows);
+        if (700 != cov->count || error > 1e-4) {
+            LOG_ERROR(
+                "Expected the covariance of %u columns, error %g.\n", d, error
+            );
+            result = false;
+        }
+
+        vector_t* mean = covariance_mean_ctx(context, cov);
+        for (uint32_t j = 0; mean && j < d; j++) {
+            if (((float*) mean->data)[j] != (float) cov->mean[j]) {
+                LOG_ERROR("Mean %u differs.\n", j);
+                result = false;
+            }
+        }
+
+        // Rows of the wrong width are rejected
+        matrix_t* wrong = matrix_create_ctx(context, 3, d + 1);
+        if (covariance_update_ctx(context, cov, wrong) || 700 != cov->count) {
+            LOG_ERROR("Expected rows of the wrong width to fail.\n");
+            result = false;
+        }
+
+        matrix_free_ctx(context, wrong);
+        vector_free_ctx(context, mean);
+        covariance_free_ctx(context, cov);
+        matrix_free_ctx(context, rows);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_covariance_merge(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         rows    = rows_fixture(context, 500, 70);
+    covariance_t*     left    = covariance_create_ctx(context, 70);
+    covariance_t*     right   = covariance_create_ctx(context, 70);
+    covariance_t*     empty   = covariance_create_ctx(context, 70);
+
+    // A single row has no unbiased covariance
+    matrix_t one = slice_fixture(rows, 0, 1);
+    covariance_update_ctx(context, left, &one);
+    if (covariance_to_matrix_ctx(context, left, true)) {
+        LOG_ERROR("Expected a single row to fail.\n");
+        result = false;
+    }
+
+    matrix_t head = slice_fixture(rows, 1, 120);
+    matrix_t tail = slice_fixture(rows, 121, 379);
+    if (!covariance_update_ctx(context, left, &head)
+        || !covariance_update_ctx(context, right, &tail)
+        || !covariance_merge_ctx(context, left, right)
+        || !covariance_merge_ctx(context, left, empty)) {
+        LOG_ERROR("Failed to merge the partial accumulators.\n");
+        result = false;
+    }
+
+    double error = covariance_error(left, rows);
+    if (500 != left->count || error > 1e-4) {
+        LOG_ERROR("Expected the merged covariance, error %g.\n", error);
+        result = false;
+    }
+
+    // Merging into an empty accumulator copies the other
+    if (!covariance_merge_ctx(context, empty, left)
+        || covariance_error(empty, rows) > 1e-4) {
+        LOG_ERROR("Expected an empty accumulator to take the other.\n");
+        result = false;
+    }
+
+    covariance_t* narrow = covariance_create_ctx(context, 69);
+    if (covariance_merge_ctx(context, left, narrow)) {
+        LOG_ERROR("Expected mismatched dimensions to fail.\n");
+        result = false;
+    }
+
+    covariance_free_ctx(context, narrow);
+    covariance_free_ctx(context, empty);
+    covariance_free_ctx(context, right);
+    covariance_free_ctx(context, left);
+    matrix_free_ctx(context, rows);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_pca_update(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         rows    = rank3_fixture(context, 200, 20);
+    pca_t*            pca     = pca_create_ctx(context, 20, 3);
+
+    for (uint32_t first = 0; first < 200; first += 50) {
+        matrix_t chunk = slice_fixture(rows, first, 50);
+        if (!pca_update_ctx(context, pca, &chunk)) {
+            LOG_ERROR("Failed to ingest the rows from %u.\n", first);
+            result = false;
+        }
+    }
+
+    if (!pca_is_valid(context, pca, rows)) {
+        LOG_ERROR("Expected the components of the whole dataset.\n");
+        result = false;
+    }
+
+    // Rank 3 rows are recovered exactly from their scores
+    matrix_t* scores = matrix_create_ctx(context, 200, 3);
+    if (!pca_transform_ctx(context, pca, rows, scores)) {
+        LOG_ERROR("Failed to project the rows.\n");
+        result = false;
+    }
+    for (uint32_t r = 0; result && r < 200; r++) {
+        for (uint32_t j = 0; j < 20; j++) {
+            double e = pca->mean[j];
+            for (uint32_t t = 0; t < 3; t++) {
+                e += scores->data[r * 3 + t]
+                     * pca->components->data[t * 20 + j];
+            }
+            if (fabs(e - rows->data[r * 20 + j]) > 1e-3) {
+                LOG_ERROR("Row %u is not reconstructed.\n", r);
+                result = false;
+                break;
+            }
+        }
+    }
+
+    if (pca_create_ctx(context, 20, 0) || pca_create_ctx(context, 20, 21)) {
+        LOG_ERROR("Expected an invalid rank to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, scores);
+    pca_free_ctx(context, pca);
+    matrix_free_ctx(context, rows);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_pca_merge(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         rows    = rank3_fixture(context, 150, 12);
+    pca_t*            left    = pca_create_ctx(context, 12, 3);
+    pca_t*            right   = pca_create_ctx(context, 12, 3);
+
+    matrix_t head = slice_fixture(rows, 0, 40);
+    matrix_t tail = slice_fixture(rows, 40, 110);
+    if (!pca_update_ctx(context, left, &head)
+        || !pca_update_ctx(context, right, &tail)
+        || !pca_merge_ctx(context, left, right)) {
+        LOG_ERROR("Failed to merge the partial PCAs.\n");
+        result = false;
+    }
+
+    if (!pca_is_valid(context, left, rows)) {
+        LOG_ERROR("Expected the components of the merged dataset.\n");
+        result = false;
+    }
+
+    pca_t* narrow = pca_create_ctx(context, 11, 3);
+    if (pca_merge_ctx(context, left, narrow)) {
+        LOG_ERROR("Expected mismatched dimensions to fail.\n");
+        result = false;
+    }
+
+    pca_free_ctx(context, narrow);
+    pca_free_ctx(context, right);
+    pca_free_ctx(context, left);
+    matrix_free_ctx(context, rows);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Covariance
+    result &= test_covariance_update();
+    result &= test_covariance_merge();
+
+    // Incremental PCA
+    result &= test_pca_update();
+    result &= test_pca_merge();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
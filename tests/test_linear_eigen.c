@@ -0,0 +1,333 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_eigen.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "bsr.h"
+#include "context.h"
+#include "eigen.h"
+#include "logger.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Power iteration
+bool test_eigen_power(void);
+bool test_eigen_block_power(void);
+
+// Lanczos iteration
+bool test_eigen_lanczos(void);
+
+/** Fixtures */
+
+// Creates the n x n Google matrix 0.85 * p + 0.15 / n of a graph whose node
+// i links to nodes i + 1, 3 * i + 1 and 7 * i + 2 modulo n, p being the
+// column-stochastic transition matrix
+static matrix_t* pagerank_fixture(linear_context_t* context, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    for (uint32_t i = 0; i < n; i++) {
+        const uint32_t links[] = {
+            (i + 1) % n,
+            (3 * i + 1) % n,
+            (7 * i + 2) % n,
+        };
+        for (uint32_t l = 0; l < 3; l++) {
+            matrix->data[links[l] * n + i] += 0.85f / 3.0f;
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            matrix->data[j * n + i] += 0.15f / (float) n;
+        }
+    }
+    return matrix;
+}
+
+// Creates the symmetric n x n matrix h * d * h, h being the reflection
+// across the hyperplane orthogonal to u[i] = 1 + i % 3, with the
+// eigenvalues d[i] = (-1)^i * 10 / (1 + i)
+static matrix_t* reflected_fixture(linear_context_t* context, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    double    uu     = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        uu += (1.0 + i % 3) * (1.0 + i % 3);
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            double e = 0.0;
+            for (uint32_t k = 0; k < n; k++) {
+                double d    = ((k % 2) ? -10.0 : 10.0) / (1.0 + k);
+                double hik  = (i == k) - 2.0 * (1 + i % 3) * (1 + k % 3) / uu;
+                double hkj  = (k == j) - 2.0 * (1 + k % 3) * (1 + j % 3) / uu;
+                e          += hik * d * hkj;
+            }
+            matrix->data[i * n + j] = (float) e;
+        }
+    }
+    return matrix;
+}
+
+// Creates the n x n matrix of the second difference, 2 on the diagonal and
+// -1 beside it, whose eigenvalues are 2 - 2 * cos(j * pi / (n + 1))
+static matrix_t* laplacian_fixture(linear_context_t* context, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    for (uint32_t i = 0; i < n; i++) {
+        matrix->data[i * n + i] = 2.0f;
+        if (i + 1 < n) {
+            matrix->data[i * n + i + 1]   = -1.0f;
+            matrix->data[(i + 1) * n + i] = -1.0f;
+        }
+    }
+    return matrix;
+}
+
+// Largest ||a * x - value * x|| over the rows x of vectors
+static float pair_residual(
+    linear_context_t*       context,
+    const eigen_operator_t* op,
+    const matrix_t*         vectors,
+    const vector_t*         values
+) {
+    vector_t* y        = vector_create_ctx(context, op->order);
+    float     residual = 0.0f;
+    for (uint32_t t = 0; t < vectors->rows; t++) {
+        vector_t x = {
+            .data    = vectors->data + t * vectors->columns,
+            .columns = vectors->columns,
+            .type    = NUMERIC_FLOAT32,
+        };
+        if (!op->matvec(context, op->operand, &x, y)) {
+            residual = INFINITY;
+            break;
+        }
+
+        float value = ((float*) values->data)[t];
+        float rr    = 0.0f;
+        for (uint32_t i = 0; i < op->order; i++) {
+            float r  = ((float*) y->data)[i] - value * ((float*) x.data)[i];
+            rr      += r * r;
+        }
+        residual = fmaxf(residual, sqrtf(rr));
+    }
+    vector_free_ctx(context, y);
+    return residual;
+}
+
+/** Unit Tests */
+
+bool test_eigen_power(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         google  = pagerank_fixture(context, 200);
+    vector_t*         x       = vector_create_ctx(context, 200);
+    float*            rank    = (float*) x->data;
+    for (uint32_t i = 0; i < 200; i++) {
+        rank[i] = 1.0f / 200.0f;
+    }
+
+    // The stationary vector of a stochastic matrix has eigenvalue 1
+    eigen_operator_t op    = {eigen_matrix_matvec, google, 200};
+    float            value = 0.0f;
+    if (!eigen_power_ctx(context, &op, x, 1e-5f, 200, &value)
+        || fabsf(value - 1.0f) > 1e-4f) {
+        LOG_ERROR("Expected the stationary vector, got value %f.\n", value);
+        result = false;
+    }
+
+    for (uint32_t i = 0; result && i < 200; i++) {
+        if (!(rank[i] > 0.0f)) {
+            LOG_ERROR("Expected a positive stationary vector.\n");
+            result = false;
+        }
+    }
+
+    // The dominant eigenvalue of the reflected matrix is 10, twice the next
+    matrix_t* reflected = reflected_fixture(context, 40);
+    op.operand          = reflected;
+    op.order            = 40;
+    vector_t* y         = vector_create_ctx(context, 40);
+    for (uint32_t i = 0; i < 40; i++) {
+        ((float*) y->data)[i] = 1.0f;
+    }
+    if (!eigen_power_ctx(context, &op, y, 1e-5f, 100, &value)
+        || fabsf(value - 10.0f) > 1e-3f) {
+        LOG_ERROR("Expected the dominant eigenvalue, got %f.\n", value);
+        result = false;
+    }
+
+    // A zero start has no direction
+    for (uint32_t i = 0; i < 40; i++) {
+        ((float*) y->data)[i] = 0.0f;
+    }
+    if (eigen_power_ctx(context, &op, y, 1e-5f, 100, &value)) {
+        LOG_ERROR("Expected a zero start to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, y);
+    matrix_free_ctx(context, reflected);
+    vector_free_ctx(context, x);
+    matrix_free_ctx(context, google);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_eigen_block_power(void) {
+    bool result = true;
+
+    linear_context_t* context   = linear_context_create(4);
+    matrix_t*         reflected = reflected_fixture(context, 60);
+    matrix_t*         vectors   = matrix_create_ctx(context, 3, 60);
+    vector_t*         values    = vector_create_ctx(context, 3);
+    for (uint32_t i = 0; i < 180; i++) {
+        vectors->data[i] = (float) ((i * 7) % 11) - 5.0f;
+    }
+
+    // By decreasing magnitude, whatever their sign
+    eigen_operator_t op       = {eigen_matrix_matvec, reflected, 60};
+    const float      expected = 10.0f;
+    const float*     found    = (const float*) values->data;
+    if (!eigen_block_power_ctx(context, &op, vectors, values, 1e-5f, 500)
+        || fabsf(found[0] - expected) > 1e-3f
+        || fabsf(found[1] + expected / 2.0f) > 1e-3f
+        || fabsf(found[2] - expected / 3.0f) > 1e-3f) {
+        LOG_ERROR(
+            "Expected eigenvalues 10, -5 and 3.33, got %f, %f and %f.\n",
+            found[0],
+            found[1],
+            found[2]
+        );
+        result = false;
+    }
+
+    if (pair_residual(context, &op, vectors, values) > 1e-3f) {
+        LOG_ERROR("Expected the eigenvectors of the block.\n");
+        result = false;
+    }
+
+    // Rows 0 and 2 repeat, so the starting block has rank 2
+    for (uint32_t i = 0; i < 60; i++) {
+        vectors->data[i]       = 1.0f;
+        vectors->data[60 + i]  = (float) i;
+        vectors->data[120 + i] = 1.0f;
+    }
+    if (eigen_block_power_ctx(context, &op, vectors, values, 1e-5f, 500)) {
+        LOG_ERROR("Expected a rank deficient block to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, values);
+    matrix_free_ctx(context, vectors);
+    matrix_free_ctx(context, reflected);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_eigen_lanczos(void) {
+    bool result = true;
+
+    linear_context_t* context   = linear_context_create(4);
+    matrix_t*         laplacian = laplacian_fixture(context, 64);
+    bsr_t*            sparse    = bsr_from_matrix_ctx(
+        context, laplacian, 4, 0
+    );
+    matrix_t*         vectors   = matrix_create_ctx(context, 3, 64);
+    vector_t*         values    = vector_create_ctx(context, 3);
+    const float*      found     = (const float*) values->data;
+
+    // A full Krylov space finds the clustered top of the spectrum exactly
+    eigen_operator_t op = {eigen_bsr_matvec, sparse, 64};
+    if (!eigen_lanczos_ctx(context, &op, NULL, 64, vectors, values)) {
+        LOG_ERROR("Failed to run the Lanczos iteration.\n");
+        result = false;
+    }
+    for (uint32_t t = 0; result && t < 3; t++) {
+        float expected = 2.0f - 2.0f * cosf((64 - t) * M_PI / 65.0);
+        if (fabsf(found[t] - expected) > 1e-4f) {
+            LOG_ERROR(
+                "Eigenvalue %u is %f, expected %f.\n", t, found[t], expected
+            );
+            result = false;
+        }
+    }
+    if (pair_residual(context, &op, vectors, values) > 1e-3f) {
+        LOG_ERROR("Expected the eigenvectors of the sparse operator.\n");
+        result = false;
+    }
+
+    // Well separated eigenvalues converge in a few steps
+    matrix_t* reflected = reflected_fixture(context, 60);
+    matrix_t* top       = matrix_create_ctx(context, 2, 60);
+    vector_t* pair      = vector_create_ctx(context, 2);
+
+    eigen_operator_t dense = {eigen_matrix_matvec, reflected, 60};
+    if (!eigen_lanczos_ctx(context, &dense, NULL, 24, top, pair)
+        || fabsf(((float*) pair->data)[0] - 10.0f) > 1e-3f
+        || fabsf(((float*) pair->data)[1] + 5.0f) > 1e-3f
+        || pair_residual(context, &dense, top, pair) > 1e-3f) {
+        LOG_ERROR("Expected the top two eigenpairs in 24 steps.\n");
+        result = false;
+    }
+
+    // An eigenvector spans an invariant space of one dimension
+    vector_t* start = vector_create_ctx(context, 64);
+    for (uint32_t i = 0; i < 64; i++) {
+        ((float*) start->data)[i] = sinf(64 * (i + 1) * M_PI / 65.0);
+    }
+    if (eigen_lanczos_ctx(context, &op, start, 64, vectors, values)
+        || eigen_lanczos_ctx(context, &op, NULL, 2, vectors, values)) {
+        LOG_ERROR("Expected too small a Krylov space to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, start);
+    vector_free_ctx(context, pair);
+    matrix_free_ctx(context, top);
+    matrix_free_ctx(context, reflected);
+    vector_free_ctx(context, values);
+    matrix_free_ctx(context, vectors);
+    bsr_free_ctx(context, sparse);
+    matrix_free_ctx(context, laplacian);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Power iteration
+    result &= test_eigen_power();
+    result &= test_eigen_block_power();
+
+    // Lanczos iteration
+    result &= test_eigen_lanczos();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,335 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_lowrank.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "context.h"
+#include "logger.h"
+#include "lowrank.h"
+#include "matrix.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Conversion
+bool test_matrix_transpose(void);
+bool test_lowrank_compression(void);
+bool test_lowrank_truncation(void);
+
+// Products
+bool test_lowrank_gemv(void);
+bool test_lowrank_gemm(void);
+
+/** Fixtures */
+
+// Creates a rows x columns matrix of the given rank as a sum of products of
+// integer patterns with decaying weights
+static matrix_t* rank_fixture(
+    linear_context_t* context, uint32_t rows, uint32_t columns, uint32_t rank
+) {
+    matrix_t* matrix = matrix_create_ctx(context, rows, columns);
+    for (uint32_t t = 0; t < rank; t++) {
+        float weight = 8.0f / (float) (t + 1);
+        for (uint32_t i = 0; i < rows; i++) {
+            float u = (float) ((i * (2 * t + 3) + t) % 11) - 5.0f;
+            for (uint32_t j = 0; j < columns; j++) {
+                float v = (float) ((j * (t + 2) + 3 * t) % 13) - 6.0f;
+                matrix->data[i * columns + j] += weight * u * v / 8.0f;
+            }
+        }
+    }
+    return matrix;
+}
+
+// Largest absolute difference between two matrices of the same size
+static float max_difference(const matrix_t* a, const matrix_t* b) {
+    float max = 0.0f;
+    for (uint32_t i = 0; i < matrix_element_count(a); i++) {
+        max = fmaxf(max, fabsf(a->data[i] - b->data[i]));
+    }
+    return max;
+}
+
+/** Unit Tests */
+
+bool test_matrix_transpose(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // Odd sizes leave partial tiles on both sides
+    matrix_t* matrix = rank_fixture(context, 77, 45, 3);
+    matrix_t* t      = matrix_transpose_ctx(context, matrix);
+    if (NULL == t || 45 != t->rows || 77 != t->columns) {
+        LOG_ERROR("Failed to transpose the matrix.\n");
+        result = false;
+    }
+
+    for (uint32_t i = 0; result && i < 77; i++) {
+        for (uint32_t j = 0; j < 45; j++) {
+            if (matrix->data[i * 45 + j] != t->data[j * 77 + i]) {
+                LOG_ERROR("Element (%u, %u) differs.\n", i, j);
+                result = false;
+            }
+        }
+    }
+
+    matrix_free_ctx(context, t);
+    matrix_free_ctx(context, matrix);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lowrank_compression(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // A rank 5 matrix is recovered exactly at rank 5, wide or tall
+    const uint32_t shapes[][2] = {{96, 64}, {40, 120}};
+    for (uint32_t s = 0; s < 2; s++) {
+        uint32_t   m       = shapes[s][0];
+        uint32_t   n       = shapes[s][1];
+        matrix_t*  dense   = rank_fixture(context, m, n, 5);
+        lowrank_t* lowrank = lowrank_from_matrix_ctx(context, dense, 5);
+        matrix_t*  matrix  = lowrank_to_matrix_ctx(context, lowrank);
+
+        if (NULL == lowrank || NULL == matrix || 5 != lowrank->u->columns
+            || m != lowrank->u->rows || n != lowrank->v->rows) {
+            LOG_ERROR("Failed to compress the %ux%u matrix.\n", m, n);
+            result = false;
+        } else if (max_difference(dense, matrix) > 1e-3f) {
+            LOG_ERROR(
+                "Expected an exact reconstruction of the %ux%u matrix, "
+                "error %g.\n",
+                m,
+                n,
+                max_difference(dense, matrix)
+            );
+            result = false;
+        }
+
+        // The columns of u are scaled by decreasing singular values, and
+        // those of v are orthonormal
+        for (uint32_t t = 0; result && t < 5; t++) {
+            float norm = 0.0f;
+            float next = 0.0f;
+            float unit = 0.0f;
+            for (uint32_t i = 0; i < m; i++) {
+                float e  = lowrank->u->data[i * 5 + t];
+                norm    += e * e;
+                if (t < 4) {
+                    e     = lowrank->u->data[i * 5 + t + 1];
+                    next += e * e;
+                }
+            }
+            for (uint32_t j = 0; j < n; j++) {
+                float e  = lowrank->v->data[j * 5 + t];
+                unit    += e * e;
+            }
+            if (next > norm * (1.0f + 1e-4f) || fabsf(unit - 1.0f) > 1e-4f) {
+                LOG_ERROR("Unexpected singular vector %u.\n", t);
+                result = false;
+            }
+        }
+
+        matrix_free_ctx(context, matrix);
+        lowrank_free_ctx(context, lowrank);
+        matrix_free_ctx(context, dense);
+    }
+
+    // Ranks beyond min(m, n) are reduced, rank zero fails
+    matrix_t*  dense   = rank_fixture(context, 12, 9, 9);
+    lowrank_t* lowrank = lowrank_from_matrix_ctx(context, dense, 20);
+    matrix_t*  matrix  = lowrank_to_matrix_ctx(context, lowrank);
+    if (NULL == matrix || 9 != lowrank->u->columns
+        || max_difference(dense, matrix) > 1e-3f
+        || lowrank_from_matrix_ctx(context, dense, 0)) {
+        LOG_ERROR("Expected a full rank compression.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, matrix);
+    lowrank_free_ctx(context, lowrank);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lowrank_truncation(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // The best rank 2 approximation of diag(4, 3, 2, 1, ...) drops every
+    // diagonal element past the second
+    matrix_t* dense = matrix_create_ctx(context, 50, 30);
+    for (uint32_t i = 0; i < 30; i++) {
+        dense->data[i * 30 + i] = (i < 4) ? 4.0f - i : 0.5f / (i + 1);
+    }
+
+    lowrank_t* lowrank = lowrank_from_matrix_ctx(context, dense, 2);
+    matrix_t*  matrix  = lowrank_to_matrix_ctx(context, lowrank);
+    if (NULL == matrix) {
+        LOG_ERROR("Failed to compress the diagonal matrix.\n");
+        result = false;
+    }
+
+    for (uint32_t i = 0; result && i < 50; i++) {
+        for (uint32_t j = 0; j < 30; j++) {
+            float expected = (i == j && i < 2) ? 4.0f - i : 0.0f;
+            if (fabsf(matrix->data[i * 30 + j] - expected) > 1e-4f) {
+                LOG_ERROR("Element (%u, %u) differs.\n", i, j);
+                result = false;
+            }
+        }
+    }
+
+    matrix_free_ctx(context, matrix);
+    lowrank_free_ctx(context, lowrank);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lowrank_gemv(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = rank_fixture(context, 130, 70, 4);
+    lowrank_t*        lowrank = lowrank_from_matrix_ctx(context, dense, 4);
+    vector_t*         x       = vector_create_ctx(context, 70);
+    vector_t*         y       = vector_create_ctx(context, 130);
+    vector_t*         z       = vector_create_ctx(context, 130);
+
+    for (uint32_t i = 0; i < 130; i++) {
+        ((float*) y->data)[i] = 1.0f;
+        ((float*) z->data)[i] = 1.0f;
+        if (i < 70) {
+            ((float*) x->data)[i] = (float) (i % 5) - 2.0f;
+        }
+    }
+
+    if (!lowrank_gemv_ctx(context, 2.0f, lowrank, x, -1.0f, y)
+        || !matrix_gemv_ctx(context, 2.0f, dense, x, -1.0f, z)) {
+        LOG_ERROR("Failed to compute the low-rank GEMV.\n");
+        result = false;
+    }
+
+    for (uint32_t i = 0; result && i < 130; i++) {
+        float error = ((float*) y->data)[i] - ((float*) z->data)[i];
+        if (fabsf(error) > 1e-2f) {
+            LOG_ERROR("Element %u differs by %g.\n", i, error);
+            result = false;
+        }
+    }
+
+    // Mismatched and aliased operands fail
+    if (lowrank_gemv_ctx(context, 1.0f, lowrank, y, 0.0f, y)
+        || lowrank_gemv_ctx(context, 1.0f, lowrank, x, 0.0f, x)) {
+        LOG_ERROR("Expected invalid operands to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, z);
+    vector_free_ctx(context, y);
+    vector_free_ctx(context, x);
+    lowrank_free_ctx(context, lowrank);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_lowrank_gemm(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = rank_fixture(context, 90, 60, 3);
+    lowrank_t*        lowrank = lowrank_from_matrix_ctx(context, dense, 3);
+    matrix_t*         b       = rank_fixture(context, 60, 37, 6);
+    matrix_t*         c       = matrix_create_ctx(context, 90, 37);
+    matrix_t*         d       = matrix_create_ctx(context, 90, 37);
+    matrix_t*         e       = rank_fixture(context, 90, 60, 2);
+    matrix_t*         f       = matrix_deep_copy_ctx(context, e);
+    matrix_fill_ctx(context, c, 1.0f);
+    matrix_fill_ctx(context, d, 1.0f);
+
+    if (!lowrank_gemm_ctx(context, 2.0f, lowrank, b, 0.5f, c)
+        || !matrix_gemm_ctx(context, 2.0f, dense, b, 0.5f, d)
+        || max_difference(c, d) > 1e-2f) {
+        LOG_ERROR("Expected the low-rank GEMM to match.\n");
+        result = false;
+    }
+
+    // e += -0.5 * a, against the dense sum
+    for (uint32_t i = 0; i < 90 * 60; i++) {
+        f->data[i] -= 0.5f * dense->data[i];
+    }
+    if (!lowrank_add_to_matrix_ctx(context, -0.5f, lowrank, e)
+        || max_difference(e, f) > 1e-3f) {
+        LOG_ERROR("Expected the low-rank sum to match.\n");
+        result = false;
+    }
+
+    // Mismatched operands fail
+    if (lowrank_gemm_ctx(context, 1.0f, lowrank, c, 0.0f, d)
+        || lowrank_add_to_matrix_ctx(context, 1.0f, lowrank, c)) {
+        LOG_ERROR("Expected mismatched operands to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, f);
+    matrix_free_ctx(context, e);
+    matrix_free_ctx(context, d);
+    matrix_free_ctx(context, c);
+    matrix_free_ctx(context, b);
+    lowrank_free_ctx(context, lowrank);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Conversion
+    result &= test_matrix_transpose();
+    result &= test_lowrank_compression();
+    result &= test_lowrank_truncation();
+
+    // Products
+    result &= test_lowrank_gemv();
+    result &= test_lowrank_gemm();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -7,9 +7,1030 @@
  *       The simpler, the better.
  */
 
+#include "context.h"
 #include "logger.h"
 #include "matrix.h"
 
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Prototypes */
+
+// Bulk access and indexing
+bool test_matrix_row_column_ctx(void);
+bool test_matrix_gather_scatter_ctx(void);
+bool test_matrix_index_select_ctx(void);
+
+// Embedding bags
+bool test_matrix_embedding_bag_ctx(void);
+
+// Non-finite detection
+bool test_matrix_nonfinite_ctx(void);
+
+// Approximate comparison
+bool test_matrix_is_close_ctx(void);
+
+// Structure detection and dispatch
+bool test_matrix_analyze_ctx(void);
+bool test_matrix_gemm_structured_ctx(void);
+bool test_matrix_solve_ctx(void);
+
+// Factorization updates
+bool test_matrix_cholesky_update_ctx(void);
+bool test_matrix_inverse_update_ctx(void);
+
+// Least squares
+bool test_matrix_lstsq_ctx(void);
+bool test_matrix_lstsq_batched_ctx(void);
+
+/** Fixtures */
+
+// Creates a matrix whose element at (i, j) holds i * columns + j
+static matrix_t* matrix_index_fixture(
+    linear_context_t* context, uint32_t rows, uint32_t columns
+) {
+    matrix_t* matrix = matrix_create_ctx(context, rows, columns);
+    for (uint32_t i = 0; i < matrix_element_count(matrix); i++) {
+        matrix->data[i] = (float) i;
+    }
+    return matrix;
+}
+
+// Creates an n x n matrix holding values in [1, 5] within the band of lower
+// and upper diagonals, plus diagonal on the diagonal, and zero elsewhere
+static matrix_t* matrix_band_fixture(
+    linear_context_t* context,
+    uint32_t          n,
+    uint32_t          lower,
+    uint32_t          upper,
+    float             diagonal
+) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            if (j + lower >= i && j <= i + upper) {
+                matrix->data[i * n + j] = (float) (1 + (i * 7 + j * 3) % 5);
+            }
+        }
+        matrix->data[i * n + i] = diagonal;
+    }
+    return matrix;
+}
+
+// Verifies a * x matches b, multiplying without the structure of a
+static bool matrix_solution_is_close(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   x,
+    const matrix_t*   b
+) {
+    matrix_t* dense = matrix_deep_copy_ctx(context, a);
+    matrix_invalidate(dense);
+
+    vector_tolerance_t tolerance = {.absolute = 1e-3f, .relative = 1e-3f};
+    matrix_t*          product   = matrix_product_ctx(context, dense, x);
+
+    bool close = false;
+    if (product) {
+        close = matrix_is_close_ctx(context, product, b, &tolerance, NULL);
+    }
+
+    matrix_free_ctx(context, product);
+    matrix_free_ctx(context, dense);
+    return close;
+}
+
+// Verifies r' * r matches a
+static bool matrix_factor_is_close(
+    linear_context_t* context, const matrix_t* r, const matrix_t* a
+) {
+    vector_tolerance_t tolerance = {.absolute = 1e-3f, .relative = 1e-4f};
+    matrix_t*          rt        = matrix_transpose_ctx(context, r);
+    matrix_t*          product   = matrix_product_ctx(context, rt, r);
+
+    bool close = false;
+    if (product) {
+        close = matrix_is_close_ctx(context, product, a, &tolerance, NULL);
+    }
+
+    matrix_free_ctx(context, product);
+    matrix_free_ctx(context, rt);
+    return close;
+}
+
+// Creates an m x n design matrix of full column rank holding values in
+// [-2, 2]
+static matrix_t*
+matrix_design_fixture(linear_context_t* context, uint32_t m, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, m, n);
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            float e                 = (float) ((i * (j + 3) + j * j) % 17);
+            matrix->data[i * n + j] = e / 4.0f - 2.0f;
+        }
+    }
+    return matrix;
+}
+
+// Verifies x minimizes ||a * x - b||^2 + lambda * ||x||^2, its gradient
+// a' * (a * x - b) + lambda * x vanishing relative to a' * b
+static bool matrix_lstsq_is_optimal(
+    linear_context_t* context,
+    const matrix_t*   a,
+    const matrix_t*   b,
+    float             lambda,
+    const matrix_t*   x
+) {
+    matrix_t* at       = matrix_transpose_ctx(context, a);
+    matrix_t* residual = matrix_product_ctx(context, a, x);
+    matrix_t* gradient = matrix_create_ctx(context, x->rows, x->columns);
+    matrix_t* atb      = matrix_product_ctx(context, at, b);
+
+    bool optimal = NULL != residual && NULL != gradient && NULL != atb;
+    for (uint32_t i = 0; optimal && i < matrix_element_count(b); i++) {
+        residual->data[i] -= b->data[i];
+    }
+    optimal = optimal
+              && matrix_gemm_ctx(context, 1.0f, at, residual, 0.0f, gradient);
+
+    float scale = 0.0f;
+    for (uint32_t i = 0; optimal && i < matrix_element_count(x); i++) {
+        scale = fmaxf(scale, fabsf(atb->data[i]));
+    }
+    for (uint32_t i = 0; optimal && i < matrix_element_count(x); i++) {
+        float g = gradient->data[i] + lambda * x->data[i];
+        optimal = fabsf(g) <= 1e-4f * scale;
+    }
+
+    matrix_free_ctx(context, atb);
+    matrix_free_ctx(context, gradient);
+    matrix_free_ctx(context, residual);
+    matrix_free_ctx(context, at);
+    return optimal;
+}
+
+// Pools bag b of an embedding-bag lookup one element at a time
+static float embedding_bag_reference(
+    const matrix_t*  table,
+    const uint32_t*  indices,
+    const uint32_t*  offsets,
+    const float*     weights,
+    matrix_pooling_t pooling,
+    uint32_t         b,
+    uint32_t         j
+) {
+    uint32_t count  = offsets[b + 1] - offsets[b];
+    float    pooled = (MATRIX_POOL_MAX == pooling) ? -INFINITY : 0.0f;
+    for (uint32_t k = offsets[b]; k < offsets[b + 1]; k++) {
+        float x = table->data[indices[k] * table->columns + j];
+        if (MATRIX_POOL_MAX == pooling) {
+            pooled = fmaxf(pooled, x);
+        } else {
+            pooled += ((weights) ? weights[k] : 1.0f) * x;
+        }
+    }
+
+    if (0 == count) {
+        return 0.0f;
+    }
+    return (MATRIX_POOL_MEAN == pooling) ? pooled / (float) count : pooled;
+}
+
+/** Unit Tests */
+
+bool test_matrix_row_column_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         matrix  = matrix_index_fixture(context, 3, 4);
+    vector_t*         row     = vector_create_ctx(context, 4);
+    vector_t*         column  = vector_create_ctx(context, 3);
+    float*            x       = (float*) row->data;
+    float*            y       = (float*) column->data;
+
+    if (!matrix_row_get_ctx(context, matrix, 1, row)
+        || !matrix_column_get_ctx(context, matrix, 2, column)) {
+        LOG_ERROR("Failed to read a row and a column.\n");
+        result = false;
+    }
+
+    if (4.0f != x[0] || 7.0f != x[3] || 2.0f != y[0] || 10.0f != y[2]) {
+        LOG_ERROR("Unexpected row or column elements.\n");
+        result = false;
+    }
+
+    // Writing the row back to the last row, and the column to the first
+    if (!matrix_row_set_ctx(context, matrix, 2, row)
+        || !matrix_column_set_ctx(context, matrix, 0, column)) {
+        LOG_ERROR("Failed to write a row and a column.\n");
+        result = false;
+    }
+
+    if (10.0f != matrix->data[8] || 5.0f != matrix->data[9]
+        || 7.0f != matrix->data[11] || 6.0f != matrix->data[4]) {
+        LOG_ERROR("Unexpected elements after writing.\n");
+        result = false;
+    }
+
+    // Out of bounds and mismatched accesses fail without writing
+    if (matrix_row_get_ctx(context, matrix, 3, row)
+        || matrix_column_get_ctx(context, matrix, 0, row)) {
+        LOG_ERROR("Expected invalid accesses to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, row);
+    vector_free_ctx(context, column);
+    matrix_free_ctx(context, matrix);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_gather_scatter_ctx(void) {
+    bool result = true;
+
+    enum { COUNT = 1 << 16 };
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         matrix  = matrix_index_fixture(context, 64, 64);
+    matrix_t*         sums    = matrix_create_ctx(context, 8, 8);
+    vector_t*         values  = vector_create_ctx(context, COUNT);
+    uint32_t*         indices = malloc(sizeof(uint32_t) * COUNT);
+    float*            x       = (float*) values->data;
+
+    // Large enough to be split across the pool, reading every element often
+    for (uint32_t i = 0; i < COUNT; i++) {
+        indices[i] = (i * 7919) % 4096;
+    }
+
+    if (!matrix_gather_ctx(context, matrix, indices, values)) {
+        LOG_ERROR("Failed to gather %u elements.\n", COUNT);
+        result = false;
+    }
+    for (uint32_t i = 0; i < COUNT && result; i++) {
+        if ((float) indices[i] != x[i]) {
+            LOG_ERROR("Gathered %f at %u.\n", x[i], i);
+            result = false;
+        }
+    }
+
+    // Every value lands on one of 64 elements, so duplicates are contended
+    for (uint32_t i = 0; i < COUNT; i++) {
+        indices[i] = i % 64;
+        x[i]       = 1.0f;
+    }
+    if (!matrix_scatter_add_ctx(context, sums, indices, values)) {
+        LOG_ERROR("Failed to scatter-add %u elements.\n", COUNT);
+        result = false;
+    }
+    for (uint32_t i = 0; i < 64 && result; i++) {
+        if ((float) (COUNT / 64) != sums->data[i]) {
+            LOG_ERROR("Accumulated %f at %u.\n", sums->data[i], i);
+            result = false;
+        }
+    }
+
+    // Scatter writes, and an out of bounds index fails the call
+    for (uint32_t i = 0; i < 64; i++) {
+        x[i] = -(float) i;
+    }
+    values->columns = 64;
+    if (!matrix_scatter_ctx(context, sums, indices, values)
+        || -63.0f != sums->data[63]) {
+        LOG_ERROR("Failed to scatter 64 elements.\n");
+        result = false;
+    }
+    indices[0] = 64;
+    if (matrix_gather_ctx(context, sums, indices, values) || !isnan(x[0])) {
+        LOG_ERROR("Expected an out of bounds gather to fail.\n");
+        result = false;
+    }
+    values->columns = COUNT;
+
+    free(indices);
+    vector_free_ctx(context, values);
+    matrix_free_ctx(context, sums);
+    matrix_free_ctx(context, matrix);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_index_select_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         table   = matrix_index_fixture(context, 100, 16);
+    uint32_t          ids[5]  = {42, 0, 99, 42, 7};
+
+    matrix_t* selected = matrix_index_select_ctx(context, table, ids, 5);
+
+    if (NULL == selected || 5 != selected->rows || 16 != selected->columns) {
+        LOG_ERROR("Expected a 5x16 selection.\n");
+        result = false;
+    } else {
+        for (uint32_t i = 0; i < 5; i++) {
+            for (uint32_t j = 0; j < 16; j++) {
+                float expected = (float) (ids[i] * 16 + j);
+                if (expected != selected->data[i * 16 + j]) {
+                    LOG_ERROR("Unexpected element of row %u.\n", i);
+                    result = false;
+                }
+            }
+        }
+    }
+
+    // Accumulating the selection back doubles the duplicated row 42
+    matrix_t* gradient = matrix_create_ctx(context, 100, 16);
+    if (NULL == selected
+        || !matrix_scatter_add_rows_ctx(context, gradient, ids, selected)
+        || 2.0f * table->data[42 * 16 + 3] != gradient->data[42 * 16 + 3]
+        || table->data[7 * 16] != gradient->data[7 * 16]
+        || 0.0f != gradient->data[1 * 16]) {
+        LOG_ERROR("Unexpected accumulation of the selected rows.\n");
+        result = false;
+    }
+
+    uint32_t invalid[2] = {1, 100};
+    if (NULL != matrix_index_select_ctx(context, table, invalid, 2)) {
+        LOG_ERROR("Expected an out of bounds selection to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, gradient);
+    matrix_free_ctx(context, selected);
+    matrix_free_ctx(context, table);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_embedding_bag_ctx(void) {
+    bool result = true;
+
+    enum { BAGS = 4096, ROWS = 1000, COLUMNS = 8 };
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         table   = matrix_index_fixture(context, ROWS, COLUMNS);
+    matrix_t*         pooled  = matrix_create_ctx(context, BAGS, COLUMNS);
+    uint32_t*         offsets = malloc(sizeof(uint32_t) * (BAGS + 1));
+    uint32_t*         indices = malloc(sizeof(uint32_t) * BAGS * 7);
+    float*            weights = malloc(sizeof(float) * BAGS * 7);
+
+    // Bags hold 0 to 6 rows, so some are empty and sizes are uneven
+    offsets[0] = 0;
+    for (uint32_t b = 0; b < BAGS; b++) {
+        offsets[b + 1] = offsets[b] + b % 7;
+        for (uint32_t k = offsets[b]; k < offsets[b + 1]; k++) {
+            indices[k] = (k * 7919) % ROWS;
+            weights[k] = (float) (k % 3) - 1.0f;
+        }
+    }
+
+    const float*           cases[] = {NULL, NULL, NULL, weights, weights};
+    const matrix_pooling_t modes[] = {
+        MATRIX_POOL_SUM,
+        MATRIX_POOL_MEAN,
+        MATRIX_POOL_MAX,
+        MATRIX_POOL_SUM,
+        MATRIX_POOL_MEAN,
+    };
+
+    for (uint32_t c = 0; c < 5 && result; c++) {
+        if (!matrix_embedding_bag_ctx(
+                context, table, indices, offsets, cases[c], modes[c], pooled
+            )) {
+            LOG_ERROR("Embedding bag with pooling %d failed.\n", modes[c]);
+            result = false;
+            break;
+        }
+
+        for (uint32_t b = 0; b < BAGS && result; b++) {
+            for (uint32_t j = 0; j < COLUMNS; j++) {
+                float expected = embedding_bag_reference(
+                    table, indices, offsets, cases[c], modes[c], b, j
+                );
+                if (fabsf(expected - pooled->data[b * COLUMNS + j]) > 1e-3f) {
+                    LOG_ERROR("Bag %u pooled with %d differs.\n", b, modes[c]);
+                    result = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Max pooling propagates a NaN even when later rows are larger
+    table->data[indices[offsets[3]] * COLUMNS] = NAN;
+    if (!matrix_embedding_bag_ctx(
+            context, table, indices, offsets, NULL, MATRIX_POOL_MAX, pooled
+        )
+        || !isnan(pooled->data[3 * COLUMNS])
+        || isnan(pooled->data[3 * COLUMNS + 1])) {
+        LOG_ERROR("Expected max pooling to propagate NaN.\n");
+        result = false;
+    }
+
+    // Weights do not apply to max pooling, and ids must be within the table
+    indices[1] = ROWS;
+    if (matrix_embedding_bag_ctx(
+            context, table, indices, offsets, weights, MATRIX_POOL_MAX, pooled
+        )
+        || matrix_embedding_bag_ctx(
+            context, table, indices, offsets, NULL, MATRIX_POOL_SUM, pooled
+        )) {
+        LOG_ERROR("Expected invalid embedding bags to fail.\n");
+        result = false;
+    }
+
+    free(weights);
+    free(indices);
+    free(offsets);
+    matrix_free_ctx(context, pooled);
+    matrix_free_ctx(context, table);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_nonfinite_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         matrix  = matrix_index_fixture(context, 300, 300);
+
+    matrix->data[299 * 300 + 299] = NAN;
+    if (matrix_all_finite_ctx(context, matrix)
+        || 1 != matrix_count_nonfinite_ctx(context, matrix)) {
+        LOG_ERROR("Expected the last element to be non-finite.\n");
+        result = false;
+    }
+
+    if (!matrix_nan_to_num_ctx(context, matrix, -1.0f, 0.0f, 0.0f)
+        || -1.0f != matrix->data[299 * 300 + 299]
+        || !matrix_all_finite_ctx(context, matrix)) {
+        LOG_ERROR("Expected the NaN element to be replaced.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, matrix);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_is_close_ctx(void) {
+    bool result = true;
+
+    linear_context_t*  context = linear_context_create(2);
+    matrix_t*          a       = matrix_index_fixture(context, 200, 300);
+    matrix_t*          b       = matrix_index_fixture(context, 200, 300);
+    matrix_t*          square  = matrix_create_ctx(context, 256, 256);
+    vector_closeness_t report  = {0};
+
+    b->data[123 * 300 + 45] = -1.0f;
+    if (matrix_is_close_ctx(context, a, b, NULL, &report)
+        || 123 * 300 + 45 != report.mismatch) {
+        LOG_ERROR("Expected a mismatch at row 123, column 45.\n");
+        result = false;
+    }
+
+    if (!matrix_is_zero_ctx(context, square)
+        || matrix_is_identity_ctx(context, square)) {
+        LOG_ERROR("Expected a zero matrix.\n");
+        result = false;
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+        square->data[i * 256 + i] = 1.0f;
+    }
+    if (matrix_is_zero_ctx(context, square)
+        || !matrix_is_identity_ctx(context, square)
+        || matrix_is_identity_ctx(context, a)) {
+        LOG_ERROR("Expected an identity matrix.\n");
+        result = false;
+    }
+
+    square->data[255 * 256 + 254] = -0.5f;
+    if (matrix_is_identity_ctx(context, square)) {
+        LOG_ERROR("Expected the last row to differ from the identity.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, square);
+    matrix_free_ctx(context, b);
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_analyze_ctx(void) {
+    bool result = true;
+
+    linear_context_t*  context   = linear_context_create(2);
+    matrix_t*          band      = matrix_band_fixture(context, 100, 1, 1, 4);
+    matrix_t*          wide      = matrix_index_fixture(context, 3, 5);
+    matrix_t*          square    = matrix_create_ctx(context, 64, 64);
+    matrix_structure_t structure = {0};
+
+    // The fixture is symmetric only on the diagonal, so set both sides
+    for (uint32_t i = 0; i + 1 < 100; i++) {
+        band->data[i * 100 + i + 1]   = 2.0f;
+        band->data[(i + 1) * 100 + i] = 2.0f;
+    }
+
+    uint32_t expected = MATRIX_SYMMETRIC | MATRIX_BANDED;
+    if (!matrix_analyze_ctx(context, band, &structure)
+        || 1 != structure.lower || 1 != structure.upper
+        || 298 != structure.nonzeros || expected != structure.flags
+        || fabsf(structure.sparsity - 0.9702f) > 1e-6f) {
+        LOG_ERROR("Expected a symmetric tridiagonal matrix.\n");
+        result = false;
+    }
+
+    if (!matrix_analyze_ctx(context, wide, &structure)
+        || 2 != structure.lower || 4 != structure.upper
+        || 0 != structure.flags || 14 != structure.nonzeros) {
+        LOG_ERROR("Expected a dense matrix with a zero first element.\n");
+        result = false;
+    }
+
+    if (!matrix_analyze_ctx(context, square, NULL)
+        || !(MATRIX_ZERO & square->state)) {
+        LOG_ERROR("Expected a zero matrix.\n");
+        result = false;
+    }
+
+    // The cached structure answers property checks until the next write
+    for (uint32_t i = 0; i < 64; i++) {
+        square->data[i * 64 + i] = 1.0f;
+    }
+    matrix_invalidate(square);
+
+    expected = MATRIX_IDENTITY | MATRIX_DIAGONAL | MATRIX_UPPER | MATRIX_LOWER
+               | MATRIX_SYMMETRIC | MATRIX_BANDED;
+    if (!matrix_analyze_ctx(context, square, &structure)
+        || expected != structure.flags || !matrix_is_identity(square)
+        || matrix_is_zero(square)) {
+        LOG_ERROR("Expected an identity matrix.\n");
+        result = false;
+    }
+
+    matrix_fill_ctx(context, square, 0.0f);
+    if ((MATRIX_ANALYZED & square->state) || matrix_is_identity(square)) {
+        LOG_ERROR("Expected filling to invalidate the structure.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, square);
+    matrix_free_ctx(context, wide);
+    matrix_free_ctx(context, band);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_gemm_structured_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         band    = matrix_band_fixture(context, 300, 2, 5, 9);
+    matrix_t*         b       = matrix_index_fixture(context, 300, 40);
+    vector_t*         x       = vector_create_ctx(context, 300);
+    vector_t*         y       = vector_create_ctx(context, 300);
+    vector_t*         z       = vector_create_ctx(context, 300);
+
+    for (uint32_t i = 0; i < 300; i++) {
+        ((float*) x->data)[i] = (float) (i % 11) - 5.0f;
+    }
+
+    // The dense product is the reference for the band-limited one
+    matrix_t* dense = matrix_product_ctx(context, band, b);
+    bool      gemv  = matrix_gemv_ctx(context, 1.0f, band, x, 0.0f, y);
+
+    matrix_analyze_ctx(context, band, NULL);
+    gemv &= matrix_gemv_ctx(context, 1.0f, band, x, 0.0f, z);
+
+    matrix_t* banded = matrix_product_ctx(context, band, b);
+
+    if (NULL == dense || NULL == banded
+        || !matrix_is_close_ctx(context, dense, banded, NULL, NULL)) {
+        LOG_ERROR("Expected the banded GEMM to match the dense GEMM.\n");
+        result = false;
+    }
+
+    if (!gemv || !vector_is_close_ctx(context, y, z, NULL, NULL)) {
+        LOG_ERROR("Expected the banded GEMV to match the dense GEMV.\n");
+        result = false;
+    }
+
+    // The output of a GEMM is no longer analyzed, and vectors must not alias
+    if ((MATRIX_ANALYZED & banded->state)
+        || matrix_gemv_ctx(context, 1.0f, band, x, 0.0f, x)) {
+        LOG_ERROR("Expected an invalidated product and a failed GEMV.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, banded);
+    matrix_free_ctx(context, dense);
+    vector_free_ctx(context, z);
+    vector_free_ctx(context, y);
+    vector_free_ctx(context, x);
+    matrix_free_ctx(context, b);
+    matrix_free_ctx(context, band);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_solve_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(2);
+    matrix_t*         b       = matrix_index_fixture(context, 200, 16);
+    matrix_t*         x       = matrix_create_ctx(context, 200, 16);
+
+    // Each dispatches differently: lower and upper triangular, diagonal,
+    // symmetric positive definite, symmetric indefinite and general
+    matrix_t* cases[] = {
+        matrix_band_fixture(context, 200, 3, 0, 8),
+        matrix_band_fixture(context, 200, 0, 199, 1000),
+        matrix_band_fixture(context, 200, 0, 0, 0.5f),
+        matrix_band_fixture(context, 200, 2, 2, 16),
+        matrix_band_fixture(context, 200, 2, 2, 40),
+        matrix_band_fixture(context, 200, 199, 199, 0),
+    };
+    uint32_t count = sizeof(cases) / sizeof(cases[0]);
+
+    // Make the symmetric cases symmetric, the indefinite one failing Cholesky
+    // halfway, and give the general case a zero diagonal so it must pivot
+    for (uint32_t c = 3; c < 5; c++) {
+        for (uint32_t i = 0; i < 200; i++) {
+            for (uint32_t j = 0; j < i; j++) {
+                cases[c]->data[j * 200 + i] = cases[c]->data[i * 200 + j];
+            }
+        }
+    }
+    for (uint32_t i = 0; i < 200; i++) {
+        cases[4]->data[i * 200 + i]             *= (i < 100) ? 1.0f : -1.0f;
+        cases[5]->data[i * 200 + (i + 1) % 200]  = 1000.0f;
+    }
+
+    for (uint32_t c = 0; c < count; c++) {
+        if (!matrix_solve_ctx(context, cases[c], b, x)
+            || !matrix_solution_is_close(context, cases[c], x, b)) {
+            LOG_ERROR("Expected case %u to be solved.\n", c);
+            result = false;
+        }
+    }
+
+    // The identity solves in place, and singular matrices fail
+    matrix_t* identity = matrix_band_fixture(context, 200, 0, 0, 1);
+    matrix_t* singular = matrix_band_fixture(context, 200, 1, 1, 4);
+    matrix_fill_ctx(context, x, 2.0f);
+    for (uint32_t j = 0; j < 200; j++) {
+        singular->data[100 * 200 + j] = 0.0f;
+    }
+    if (!matrix_solve_ctx(context, identity, x, x) || 2.0f != x->data[0]
+        || matrix_solve_ctx(context, singular, b, x)) {
+        LOG_ERROR("Expected an identity and a singular solve.\n");
+        result = false;
+    }
+
+    for (uint32_t c = 0; c < count; c++) {
+        matrix_free_ctx(context, cases[c]);
+    }
+    matrix_free_ctx(context, singular);
+    matrix_free_ctx(context, identity);
+    matrix_free_ctx(context, x);
+    matrix_free_ctx(context, b);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_cholesky_update_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         a       = matrix_band_fixture(context, 150, 2, 2, 16);
+    matrix_t*         r       = matrix_create_ctx(context, 150, 150);
+    vector_t*         x       = vector_create_ctx(context, 150);
+    for (uint32_t i = 0; i < 150; i++) {
+        for (uint32_t j = 0; j < i; j++) {
+            a->data[j * 150 + i] = a->data[i * 150 + j];
+        }
+        ((float*) x->data)[i] = (float) ((i * 5) % 7) - 3.0f;
+    }
+
+    // An analyzed matrix keeps its band in the factor
+    if (!matrix_analyze_ctx(context, a, NULL)
+        || !matrix_cholesky_ctx(context, a, r)
+        || !matrix_factor_is_close(context, r, a)) {
+        LOG_ERROR("Expected the Cholesky factor to reproduce a.\n");
+        result = false;
+    }
+
+    // a + x * x', then back to a
+    matrix_t* updated = matrix_deep_copy_ctx(context, a);
+    for (uint32_t i = 0; i < 150; i++) {
+        for (uint32_t j = 0; j < 150; j++) {
+            float xi                    = ((float*) x->data)[i];
+            float xj                    = ((float*) x->data)[j];
+            updated->data[i * 150 + j] += xi * xj;
+        }
+    }
+    matrix_invalidate(updated);
+
+    if (!matrix_cholesky_update_ctx(context, r, x)
+        || !matrix_factor_is_close(context, r, updated)) {
+        LOG_ERROR("Expected the updated factor to reproduce a + x x'.\n");
+        result = false;
+    }
+
+    if (!matrix_cholesky_downdate_ctx(context, r, x)
+        || !matrix_factor_is_close(context, r, a)) {
+        LOG_ERROR("Expected the downdated factor to reproduce a.\n");
+        result = false;
+    }
+
+    // Downdating by 10 x loses positive definiteness, leaving r unchanged
+    matrix_t* copy = matrix_deep_copy_ctx(context, r);
+    for (uint32_t i = 0; i < 150; i++) {
+        ((float*) x->data)[i] *= 10.0f;
+    }
+    if (matrix_cholesky_downdate_ctx(context, r, x)
+        || memcmp(copy->data, r->data, sizeof(float) * 150 * 150)) {
+        LOG_ERROR("Expected an indefinite downdate to fail.\n");
+        result = false;
+    }
+
+    // Indefinite matrices do not factor
+    a->data[75 * 150 + 75] = -1.0f;
+    matrix_invalidate(a);
+    if (matrix_cholesky_ctx(context, a, r)) {
+        LOG_ERROR("Expected an indefinite matrix not to factor.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, copy);
+    matrix_free_ctx(context, updated);
+    vector_free_ctx(context, x);
+    matrix_free_ctx(context, r);
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_inverse_update_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context  = linear_context_create(4);
+    matrix_t*         a        = matrix_band_fixture(context, 100, 3, 3, 30);
+    matrix_t*         identity = matrix_band_fixture(context, 100, 0, 0, 1);
+    matrix_t*         inverse  = matrix_create_ctx(context, 100, 100);
+    matrix_t*         u        = matrix_create_ctx(context, 100, 3);
+    matrix_t*         v        = matrix_create_ctx(context, 100, 1);
+    for (uint32_t i = 0; i < 300; i++) {
+        u->data[i] = (float) ((i * 7) % 5) - 2.0f;
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        v->data[i] = (float) (i % 3) - 1.0f;
+    }
+
+    if (!matrix_solve_ctx(context, a, identity, inverse)) {
+        LOG_ERROR("Failed to invert the matrix.\n");
+        result = false;
+    }
+
+    // Sherman-Morrison with the first column of u, then a symmetric rank 3
+    // Woodbury update by u, each checked against (a + u v') b = i
+    for (uint32_t rank = 1; result && rank <= 3; rank += 2) {
+        matrix_t* w = matrix_create_ctx(context, 100, rank);
+        for (uint32_t i = 0; i < 100; i++) {
+            for (uint32_t j = 0; j < rank; j++) {
+                w->data[i * rank + j] = u->data[i * 3 + j];
+            }
+        }
+
+        const matrix_t* right = (1 == rank) ? v : NULL;
+        if (!matrix_inverse_update_ctx(context, inverse, w, right)) {
+            LOG_ERROR("Failed to update the inverse, rank %u.\n", rank);
+            result = false;
+        }
+
+        matrix_t* wt = matrix_transpose_ctx(context, (right) ? right : w);
+        if (!matrix_gemm_ctx(context, 1.0f, w, wt, 1.0f, a)
+            || !matrix_solution_is_close(context, a, inverse, identity)) {
+            LOG_ERROR("Expected the updated inverse, rank %u.\n", rank);
+            result = false;
+        }
+
+        matrix_free_ctx(context, wt);
+        matrix_free_ctx(context, w);
+    }
+
+    // i + e0 * (-e0)' is singular, leaving the inverse unchanged
+    matrix_t* e = matrix_create_ctx(context, 100, 1);
+    matrix_t* f = matrix_create_ctx(context, 100, 1);
+    e->data[0]  = 1.0f;
+    f->data[0]  = -1.0f;
+    if (matrix_inverse_update_ctx(context, identity, e, f)
+        || 1.0f != identity->data[0]) {
+        LOG_ERROR("Expected a singular update to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, f);
+    matrix_free_ctx(context, e);
+    matrix_free_ctx(context, v);
+    matrix_free_ctx(context, u);
+    matrix_free_ctx(context, inverse);
+    matrix_free_ctx(context, identity);
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_lstsq_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         a       = matrix_design_fixture(context, 200, 6);
+    matrix_t*         b       = matrix_create_ctx(context, 200, 2);
+    matrix_t*         qr      = matrix_create_ctx(context, 6, 2);
+    matrix_t*         normal  = matrix_create_ctx(context, 6, 2);
+    for (uint32_t i = 0; i < 400; i++) {
+        b->data[i] = (float) ((i * 11) % 7) - 3.0f;
+    }
+
+    // Ordinary least squares, then a ridge, by both methods
+    vector_tolerance_t tolerance = {.absolute = 1e-3f, .relative = 1e-3f};
+    const float        lambdas[] = {0.0f, 25.0f};
+    for (uint32_t s = 0; s < 2; s++) {
+        if (!matrix_lstsq_qr_ctx(context, a, b, lambdas[s], qr)
+            || !matrix_lstsq_normal_ctx(context, a, b, lambdas[s], normal)) {
+            LOG_ERROR(
+                "Failed to fit the regressions, ridge %f.\n", lambdas[s]
+            );
+            result = false;
+            continue;
+        }
+
+        if (!matrix_lstsq_is_optimal(context, a, b, lambdas[s], qr)
+            || !matrix_is_close_ctx(context, qr, normal, &tolerance, NULL)) {
+            LOG_ERROR("Expected the optimal fit, ridge %f.\n", lambdas[s]);
+            result = false;
+        }
+    }
+
+    // A ridge regularizes a design wider than it is tall
+    matrix_t wide = *a;
+    matrix_t head = *b;
+    wide.rows     = 4;
+    head.rows     = 4;
+    if (!matrix_lstsq_qr_ctx(context, &wide, &head, 1.0f, qr)
+        || !matrix_lstsq_is_optimal(context, &wide, &head, 1.0f, qr)
+        || matrix_lstsq_qr_ctx(context, &wide, &head, 0.0f, qr)) {
+        LOG_ERROR("Expected only the ridge to fit the wide design.\n");
+        result = false;
+    }
+
+    // A zero column leaves both methods rank deficient
+    for (uint32_t i = 0; i < 200; i++) {
+        a->data[i * 6 + 2] = 0.0f;
+    }
+    if (matrix_lstsq_qr_ctx(context, a, b, 0.0f, qr)
+        || matrix_lstsq_normal_ctx(context, a, b, 0.0f, normal)) {
+        LOG_ERROR("Expected a rank deficient design to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, normal);
+    matrix_free_ctx(context, qr);
+    matrix_free_ctx(context, b);
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_matrix_lstsq_batched_ctx(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         a       = matrix_design_fixture(context, 120, 5);
+    matrix_t*         b[8];
+    matrix_t*         x[8];
+    matrix_t*         expected[8];
+    for (uint32_t t = 0; t < 8; t++) {
+        uint32_t r  = 1 + t % 3;
+        b[t]        = matrix_create_ctx(context, 120, r);
+        x[t]        = matrix_create_ctx(context, 5, r);
+        expected[t] = matrix_create_ctx(context, 5, r);
+        for (uint32_t i = 0; i < 120 * r; i++) {
+            b[t]->data[i] = (float) ((i * (t + 5)) % 9) - 4.0f;
+        }
+        matrix_lstsq_normal_ctx(context, a, b[t], 0.5f, expected[t]);
+    }
+
+    vector_tolerance_t tolerance = {.absolute = 1e-5f, .relative = 1e-5f};
+    if (!matrix_lstsq_batched_ctx(
+            context, a, 0.5f, 8, (const matrix_t* const*) b, x
+        )) {
+        LOG_ERROR("Failed to fit the batch.\n");
+        result = false;
+    }
+    for (uint32_t t = 0; result && t < 8; t++) {
+        if (!matrix_is_close_ctx(
+                context, x[t], expected[t], &tolerance, NULL
+            )) {
+            LOG_ERROR("Item %u differs from its own regression.\n", t);
+            result = false;
+        }
+    }
+
+    // A single invalid item rejects the whole batch
+    matrix_t* wrong = b[5];
+    b[5]            = x[5];
+    if (matrix_lstsq_batched_ctx(
+            context, a, 0.5f, 8, (const matrix_t* const*) b, x
+        )) {
+        LOG_ERROR("Expected an invalid item to fail.\n");
+        result = false;
+    }
+    b[5] = wrong;
+
+    for (uint32_t t = 0; t < 8; t++) {
+        matrix_free_ctx(context, expected[t]);
+        matrix_free_ctx(context, x[t]);
+        matrix_free_ctx(context, b[t]);
+    }
+    matrix_free_ctx(context, a);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
 int main(void) {
-    return 0; // @todo
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Bulk access and indexing
+    result &= test_matrix_row_column_ctx();
+    result &= test_matrix_gather_scatter_ctx();
+    result &= test_matrix_index_select_ctx();
+
+    // Embedding bags
+    result &= test_matrix_embedding_bag_ctx();
+
+    // Non-finite detection
+    result &= test_matrix_nonfinite_ctx();
+
+    // Approximate comparison
+    result &= test_matrix_is_close_ctx();
+
+    // Structure detection and dispatch
+    result &= test_matrix_analyze_ctx();
+    result &= test_matrix_gemm_structured_ctx();
+    result &= test_matrix_solve_ctx();
+
+    // Factorization updates
+    result &= test_matrix_cholesky_update_ctx();
+    result &= test_matrix_inverse_update_ctx();
+
+    // Least squares
+    result &= test_matrix_lstsq_ctx();
+    result &= test_matrix_lstsq_batched_ctx();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,281 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_packed.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "context.h"
+#include "logger.h"
+#include "matrix.h"
+#include "packed.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Element access
+bool test_packed_element_access(void);
+
+// Conversion
+bool test_packed_conversion(void);
+
+// Products
+bool test_packed_symv(void);
+bool test_packed_symm(void);
+bool test_packed_trmv(void);
+
+/** Fixtures */
+
+// Creates an n x n symmetric matrix whose element at (i, j) is in [-3, 3]
+static matrix_t* symmetric_fixture(linear_context_t* context, uint32_t n) {
+    matrix_t* matrix = matrix_create_ctx(context, n, n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            matrix->data[i * n + j] = (float) ((i + j) % 7) - 3.0f;
+        }
+    }
+    return matrix;
+}
+
+// Creates a NUMERIC_FLOAT32 vector holding values in [-2, 2]
+static vector_t* vector_fixture(linear_context_t* context, uint32_t n) {
+    vector_t* vector = vector_create_ctx(context, n);
+    float*    data   = (float*) vector->data;
+    for (uint32_t i = 0; i < n; i++) {
+        data[i] = (float) (i % 5) - 2.0f;
+    }
+    return vector;
+}
+
+/** Unit Tests */
+
+bool test_packed_element_access(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(1);
+    packed_t* symmetric = packed_create_ctx(context, 5, PACKED_SYMMETRIC);
+    packed_t* upper     = packed_create_ctx(context, 5, PACKED_UPPER);
+
+    if (15 != packed_element_count(symmetric)) {
+        LOG_ERROR("Expected 15 stored elements.\n");
+        result = false;
+    }
+
+    // Mirrored elements of a symmetric matrix share their storage
+    packed_element_set(symmetric, 1, 3, 7.0f);
+    if (7.0f != packed_element_get(symmetric, 3, 1)) {
+        LOG_ERROR("Expected (3, 1) to mirror (1, 3).\n");
+        result = false;
+    }
+
+    // Only the upper triangle of an upper matrix may be set
+    if (!packed_element_set(upper, 1, 3, 7.0f)
+        || packed_element_set(upper, 3, 1, 7.0f)
+        || 0.0f != packed_element_get(upper, 3, 1)
+        || 7.0f != upper->data[5 + 2]) {
+        LOG_ERROR("Expected (3, 1) to be outside the upper triangle.\n");
+        result = false;
+    }
+
+    packed_free_ctx(context, upper);
+    packed_free_ctx(context, symmetric);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_packed_conversion(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = matrix_create_ctx(context, 150, 150);
+    for (uint32_t i = 0; i < matrix_element_count(dense); i++) {
+        dense->data[i] = (float) (i % 13) + 1.0f;
+    }
+
+    for (packed_kind_t kind = 0; kind < PACKED_COUNT; kind++) {
+        packed_t* packed   = packed_from_matrix_ctx(context, dense, kind);
+        matrix_t* unpacked = packed_to_matrix_ctx(context, packed);
+        if (NULL == packed || NULL == unpacked) {
+            LOG_ERROR("Failed to convert kind %d.\n", kind);
+            result = false;
+            break;
+        }
+
+        // Stored elements round trip, symmetric ones mirror the lower
+        // triangle, and the rest of a triangular matrix is zero
+        for (uint32_t i = 0; i < 150; i++) {
+            for (uint32_t j = 0; j < 150; j++) {
+                float expected = dense->data[i * 150 + j];
+                if (PACKED_SYMMETRIC == kind && j > i) {
+                    expected = dense->data[j * 150 + i];
+                } else if ((PACKED_LOWER == kind && j > i)
+                           || (PACKED_UPPER == kind && j < i)) {
+                    expected = 0.0f;
+                }
+
+                if (expected != unpacked->data[i * 150 + j]
+                    || expected != packed_element_get(packed, i, j)) {
+                    LOG_ERROR("Kind %d differs at (%u, %u).\n", kind, i, j);
+                    result = false;
+                    i      = 150;
+                    break;
+                }
+            }
+        }
+
+        matrix_free_ctx(context, unpacked);
+        packed_free_ctx(context, packed);
+    }
+
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_packed_symv(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = symmetric_fixture(context, 500);
+    packed_t*         packed
+        = packed_from_matrix_ctx(context, dense, PACKED_SYMMETRIC);
+    vector_t* x = vector_fixture(context, 500);
+    vector_t* y = vector_fixture(context, 500);
+    vector_t* z = vector_fixture(context, 500);
+
+    // Accumulating into y exercises beta as well as the partial vectors
+    if (!packed_symv_ctx(context, 2.0f, packed, x, 0.5f, y)
+        || !matrix_gemv_ctx(context, 2.0f, dense, x, 0.5f, z)
+        || !vector_is_close_ctx(context, y, z, NULL, NULL)) {
+        LOG_ERROR("Expected the packed SYMV to match the dense GEMV.\n");
+        result = false;
+    }
+
+    // Triangular matrices and aliased vectors are rejected
+    packed_t* lower = packed_create_ctx(context, 500, PACKED_LOWER);
+    if (packed_symv_ctx(context, 1.0f, lower, x, 0.0f, y)
+        || packed_symv_ctx(context, 1.0f, packed, x, 0.0f, x)) {
+        LOG_ERROR("Expected invalid SYMV operands to fail.\n");
+        result = false;
+    }
+
+    packed_free_ctx(context, lower);
+    vector_free_ctx(context, z);
+    vector_free_ctx(context, y);
+    vector_free_ctx(context, x);
+    packed_free_ctx(context, packed);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_packed_symm(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = symmetric_fixture(context, 200);
+    packed_t*         packed
+        = packed_from_matrix_ctx(context, dense, PACKED_SYMMETRIC);
+    matrix_t* b = matrix_create_ctx(context, 200, 48);
+    matrix_t* c = matrix_create_ctx(context, 200, 48);
+    matrix_t* d = matrix_create_ctx(context, 200, 48);
+
+    for (uint32_t i = 0; i < matrix_element_count(b); i++) {
+        b->data[i] = (float) (i % 9) - 4.0f;
+        c->data[i] = 1.0f;
+        d->data[i] = 1.0f;
+    }
+
+    if (!packed_symm_ctx(context, 1.0f, packed, b, -1.0f, c)
+        || !matrix_gemm_ctx(context, 1.0f, dense, b, -1.0f, d)
+        || !matrix_is_close_ctx(context, c, d, NULL, NULL)) {
+        LOG_ERROR("Expected the packed SYMM to match the dense GEMM.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, d);
+    matrix_free_ctx(context, c);
+    matrix_free_ctx(context, b);
+    packed_free_ctx(context, packed);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_packed_trmv(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    matrix_t*         dense   = symmetric_fixture(context, 400);
+    vector_t*         x       = vector_fixture(context, 400);
+    vector_t*         y       = vector_create_ctx(context, 400);
+    vector_t*         z       = vector_create_ctx(context, 400);
+
+    // The dense reference multiplies by the unpacked triangle
+    for (packed_kind_t kind = PACKED_LOWER; kind <= PACKED_UPPER; kind++) {
+        packed_t* packed   = packed_from_matrix_ctx(context, dense, kind);
+        matrix_t* unpacked = packed_to_matrix_ctx(context, packed);
+
+        if (!packed_trmv_ctx(context, packed, x, y)
+            || !matrix_gemv_ctx(context, 1.0f, unpacked, x, 0.0f, z)
+            || !vector_is_close_ctx(context, y, z, NULL, NULL)) {
+            LOG_ERROR("Expected the packed TRMV of kind %d to match.\n", kind);
+            result = false;
+        }
+
+        matrix_free_ctx(context, unpacked);
+        packed_free_ctx(context, packed);
+    }
+
+    vector_free_ctx(context, z);
+    vector_free_ctx(context, y);
+    vector_free_ctx(context, x);
+    matrix_free_ctx(context, dense);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Element access
+    result &= test_packed_element_access();
+
+    // Conversion
+    result &= test_packed_conversion();
+
+    // Products
+    result &= test_packed_symv();
+    result &= test_packed_symm();
+    result &= test_packed_trmv();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,379 @@
+/**
+ * Copyright © 2024 Austin Berrio
+ *
+ * @file tests/test_linear_toeplitz.c
+ *
+ * @note keep fixtures and related tests as simple as reasonably possible.
+ *       The simpler, the better.
+ */
+
+#include "context.h"
+#include "logger.h"
+#include "matrix.h"
+#include "toeplitz.h"
+#include "vector.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Prototypes */
+
+// Conversion
+bool test_toeplitz_conversion(void);
+
+// Products
+bool test_toeplitz_products(void);
+bool test_circulant_products(void);
+
+// Solvers
+bool test_toeplitz_solve(void);
+bool test_circulant_solve(void);
+
+/** Fixtures */
+
+// Creates a vector of n elements in [-2, 2], with a dominant first element
+// when diagonal is nonzero
+static vector_t*
+pattern_fixture(linear_context_t* context, uint32_t n, float diagonal) {
+    vector_t* vector = vector_create_ctx(context, n);
+    float*    data   = (float*) vector->data;
+    for (uint32_t i = 0; i < n; i++) {
+        data[i] = ((float) ((i * 7 + 3) % 9) - 4.0f) / (2.0f + i);
+    }
+    data[0] += diagonal;
+    return vector;
+}
+
+// Largest absolute difference between two vectors of the same size
+static float max_difference(const vector_t* a, const vector_t* b) {
+    float max = 0.0f;
+    for (uint32_t i = 0; i < a->columns; i++) {
+        float d = ((float*) a->data)[i] - ((float*) b->data)[i];
+        max     = fmaxf(max, fabsf(d));
+    }
+    return max;
+}
+
+/** Unit Tests */
+
+bool test_toeplitz_conversion(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+    vector_t*         column  = pattern_fixture(context, 6, 1.0f);
+    vector_t*         row     = pattern_fixture(context, 6, 1.0f);
+    for (uint32_t i = 1; i < 6; i++) {
+        ((float*) row->data)[i] = 10.0f + i;
+    }
+
+    toeplitz_t*  toeplitz  = toeplitz_from_vectors_ctx(context, column, row);
+    circulant_t* circulant = circulant_from_vector_ctx(context, column);
+    matrix_t*    t         = toeplitz_to_matrix_ctx(context, toeplitz);
+    matrix_t*    c         = circulant_to_matrix_ctx(context, circulant);
+    if (NULL == t || NULL == c) {
+        LOG_ERROR("Failed to convert the structured matrices.\n");
+        result = false;
+    }
+
+    const float* first = (const float*) column->data;
+    const float* top   = (const float*) row->data;
+    for (uint32_t i = 0; result && i < 6; i++) {
+        for (uint32_t j = 0; j < 6; j++) {
+            float expected = (i >= j) ? first[i - j] : top[j - i];
+            float wrapped  = first[(i + 6 - j) % 6];
+            if (expected != t->data[i * 6 + j]
+                || wrapped != c->data[i * 6 + j]) {
+                LOG_ERROR("Element (%u, %u) differs.\n", i, j);
+                result = false;
+            }
+        }
+    }
+
+    // The first row and column must agree on their shared corner
+    ((float*) row->data)[0] = 5.0f;
+    if (toeplitz_from_vectors_ctx(context, column, row)) {
+        LOG_ERROR("Expected mismatched corners to fail.\n");
+        result = false;
+    }
+
+    matrix_free_ctx(context, c);
+    matrix_free_ctx(context, t);
+    circulant_free_ctx(context, circulant);
+    toeplitz_free_ctx(context, toeplitz);
+    vector_free_ctx(context, row);
+    vector_free_ctx(context, column);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_toeplitz_products(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // Direct sums, and FFTs of the next power of two above 2n - 1
+    const uint32_t orders[] = {9, 64, 65, 300};
+    for (uint32_t s = 0; s < 4; s++) {
+        uint32_t  n      = orders[s];
+        vector_t* column = pattern_fixture(context, n, 1.0f);
+        vector_t* row    = pattern_fixture(context, n, 1.0f);
+        vector_t* x      = pattern_fixture(context, n, 0.0f);
+        vector_t* y      = pattern_fixture(context, n, 0.0f);
+        vector_t* z      = pattern_fixture(context, n, 0.0f);
+        matrix_t* b      = matrix_create_ctx(context, n, 13);
+        matrix_t* c      = matrix_create_ctx(context, n, 13);
+        matrix_t* d      = matrix_create_ctx(context, n, 13);
+        for (uint32_t i = 1; i < n; i++) {
+            ((float*) row->data)[i] = (float) (i % 4) - 1.5f;
+        }
+        for (uint32_t i = 0; i < n * 13; i++) {
+            b->data[i] = (float) (i % 11) - 5.0f;
+        }
+        matrix_fill_ctx(context, c, 1.0f);
+        matrix_fill_ctx(context, d, 1.0f);
+
+        toeplitz_t* toeplitz = toeplitz_from_vectors_ctx(context, column, row);
+        matrix_t*   dense    = toeplitz_to_matrix_ctx(context, toeplitz);
+
+        if (!toeplitz_gemv_ctx(context, 2.0f, toeplitz, x, -0.5f, y)
+            || !matrix_gemv_ctx(context, 2.0f, dense, x, -0.5f, z)
+            || max_difference(y, z) > 1e-3f) {
+            LOG_ERROR("Expected the Toeplitz GEMV to match, order %u.\n", n);
+            result = false;
+        }
+
+        if (!toeplitz_gemm_ctx(context, 2.0f, toeplitz, b, 0.5f, c)
+            || !matrix_gemm_ctx(context, 2.0f, dense, b, 0.5f, d)) {
+            LOG_ERROR("Failed to compute the Toeplitz GEMM, order %u.\n", n);
+            result = false;
+        }
+        for (uint32_t i = 0; result && i < n * 13; i++) {
+            if (fabsf(c->data[i] - d->data[i]) > 1e-2f) {
+                LOG_ERROR("Element %u differs, order %u.\n", i, n);
+                result = false;
+            }
+        }
+
+        matrix_free_ctx(context, dense);
+        toeplitz_free_ctx(context, toeplitz);
+        matrix_free_ctx(context, d);
+        matrix_free_ctx(context, c);
+        matrix_free_ctx(context, b);
+        vector_free_ctx(context, z);
+        vector_free_ctx(context, y);
+        vector_free_ctx(context, x);
+        vector_free_ctx(context, row);
+        vector_free_ctx(context, column);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_circulant_products(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    const uint32_t orders[] = {7, 100, 256};
+    for (uint32_t s = 0; s < 3; s++) {
+        uint32_t     n         = orders[s];
+        vector_t*    column    = pattern_fixture(context, n, 1.0f);
+        vector_t*    x         = pattern_fixture(context, n, 0.0f);
+        vector_t*    y         = vector_create_ctx(context, n);
+        vector_t*    z         = vector_create_ctx(context, n);
+        matrix_t*    b         = matrix_create_ctx(context, n, 5);
+        matrix_t*    c         = matrix_create_ctx(context, n, 5);
+        matrix_t*    d         = matrix_create_ctx(context, n, 5);
+        circulant_t* circulant = circulant_from_vector_ctx(context, column);
+        matrix_t*    dense     = circulant_to_matrix_ctx(context, circulant);
+        for (uint32_t i = 0; i < n * 5; i++) {
+            b->data[i] = (float) (i % 7) - 3.0f;
+        }
+
+        if (!circulant_gemv_ctx(context, 1.0f, circulant, x, 0.0f, y)
+            || !matrix_gemv_ctx(context, 1.0f, dense, x, 0.0f, z)
+            || max_difference(y, z) > 1e-3f) {
+            LOG_ERROR("Expected the circulant GEMV to match, order %u.\n", n);
+            result = false;
+        }
+
+        if (!circulant_gemm_ctx(context, -1.0f, circulant, b, 0.0f, c)
+            || !matrix_gemm_ctx(context, -1.0f, dense, b, 0.0f, d)) {
+            LOG_ERROR("Failed to compute the circulant GEMM, order %u.\n", n);
+            result = false;
+        }
+        for (uint32_t i = 0; result && i < n * 5; i++) {
+            if (fabsf(c->data[i] - d->data[i]) > 1e-3f) {
+                LOG_ERROR("Element %u differs, order %u.\n", i, n);
+                result = false;
+            }
+        }
+
+        // Aliased and mismatched operands fail
+        if (circulant_gemv_ctx(context, 1.0f, circulant, x, 0.0f, x)
+            || circulant_gemm_ctx(context, 1.0f, circulant, b, 0.0f, b)) {
+            LOG_ERROR("Expected aliased operands to fail.\n");
+            result = false;
+        }
+
+        matrix_free_ctx(context, dense);
+        circulant_free_ctx(context, circulant);
+        matrix_free_ctx(context, d);
+        matrix_free_ctx(context, c);
+        matrix_free_ctx(context, b);
+        vector_free_ctx(context, z);
+        vector_free_ctx(context, y);
+        vector_free_ctx(context, x);
+        vector_free_ctx(context, column);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_toeplitz_solve(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // A nonsymmetric, diagonally dominant matrix, and a symmetric one
+    const uint32_t orders[] = {1, 40, 257};
+    for (uint32_t s = 0; s < 3; s++) {
+        uint32_t  n      = orders[s];
+        vector_t* column = pattern_fixture(context, n, 4.0f);
+        vector_t* row    = pattern_fixture(context, n, 4.0f);
+        vector_t* b      = pattern_fixture(context, n, 0.0f);
+        vector_t* x      = vector_create_ctx(context, n);
+        vector_t* y      = vector_create_ctx(context, n);
+        for (uint32_t i = 1; i < n; i++) {
+            ((float*) row->data)[i] = 1.0f / (i * i + 1);
+        }
+
+        for (uint32_t symmetric = 0; symmetric < 2; symmetric++) {
+            toeplitz_t* toeplitz = toeplitz_from_vectors_ctx(
+                context, column, (symmetric) ? NULL : row
+            );
+
+            if (!toeplitz_solve_ctx(context, toeplitz, b, x)
+                || !toeplitz_gemv_ctx(context, 1.0f, toeplitz, x, 0.0f, y)
+                || max_difference(y, b) > 1e-4f) {
+                LOG_ERROR(
+                    "Expected the Levinson solution to satisfy the system, "
+                    "order %u.\n",
+                    n
+                );
+                result = false;
+            }
+
+            toeplitz_free_ctx(context, toeplitz);
+        }
+
+        vector_free_ctx(context, y);
+        vector_free_ctx(context, x);
+        vector_free_ctx(context, b);
+        vector_free_ctx(context, row);
+        vector_free_ctx(context, column);
+    }
+
+    // [[0, 1], [1, 0]] is invertible, but its leading element is not
+    toeplitz_t* toeplitz = toeplitz_create_ctx(context, 2);
+    vector_t*   b        = pattern_fixture(context, 2, 0.0f);
+    toeplitz->data[0]    = 1.0f;
+    toeplitz->data[2]    = 1.0f;
+    if (toeplitz_solve_ctx(context, toeplitz, b, b)) {
+        LOG_ERROR("Expected a singular leading submatrix to fail.\n");
+        result = false;
+    }
+
+    vector_free_ctx(context, b);
+    toeplitz_free_ctx(context, toeplitz);
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+bool test_circulant_solve(void) {
+    bool result = true;
+
+    linear_context_t* context = linear_context_create(4);
+
+    // Powers of two transform directly, others through Bluestein's algorithm
+    const uint32_t orders[] = {1, 64, 100, 257};
+    for (uint32_t s = 0; s < 4; s++) {
+        uint32_t     n         = orders[s];
+        vector_t*    column    = pattern_fixture(context, n, 4.0f);
+        vector_t*    b         = pattern_fixture(context, n, 0.0f);
+        vector_t*    x         = vector_create_ctx(context, n);
+        vector_t*    y         = vector_create_ctx(context, n);
+        circulant_t* circulant = circulant_from_vector_ctx(context, column);
+
+        if (!circulant_solve_ctx(context, circulant, b, x)
+            || !circulant_gemv_ctx(context, 1.0f, circulant, x, 0.0f, y)
+            || max_difference(y, b) > 1e-4f) {
+            LOG_ERROR(
+                "Expected the spectral solution to satisfy the system, order "
+                "%u.\n",
+                n
+            );
+            result = false;
+        }
+
+        // The all-ones column has eigenvalues n and zero
+        for (uint32_t i = 0; i < n; i++) {
+            circulant->data[i] = 1.0f;
+        }
+        if (n > 1 && circulant_solve_ctx(context, circulant, b, x)) {
+            LOG_ERROR("Expected a singular circulant matrix to fail.\n");
+            result = false;
+        }
+
+        circulant_free_ctx(context, circulant);
+        vector_free_ctx(context, y);
+        vector_free_ctx(context, x);
+        vector_free_ctx(context, b);
+        vector_free_ctx(context, column);
+    }
+
+    linear_context_free(context);
+
+    printf("%s", result ? "." : "x");
+    return result;
+}
+
+int main(void) {
+    initialize_global_logger(
+        LOG_LEVEL_DEBUG, LOG_TYPE_STREAM, "stream", stderr, NULL
+    );
+
+    bool result = true;
+
+    // Conversion
+    result &= test_toeplitz_conversion();
+
+    // Products
+    result &= test_toeplitz_products();
+    result &= test_circulant_products();
+
+    // Solvers
+    result &= test_toeplitz_solve();
+    result &= test_circulant_solve();
+
+    printf("\n");
+    if (result) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Tests failed. Please review the logs for more information.\n");
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}